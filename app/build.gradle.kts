@@ -20,6 +20,10 @@ android {
             cmake {
                 cppFlags("")
                 arguments("-DANDROID_STL=c++_shared")
+                // JNI bridge benchmark library for androidTest JniBridgeBenchmark
+                if (project.hasProperty("ircmdBenchmarks")) {
+                    arguments("-DIRCMD_BENCHMARKS=ON")
+                }
             }
         }
     }
@@ -0,0 +1,215 @@
+// JNI bridge benchmark: each call pattern as it was before JniBridge ("old") and as it is
+// now ("new"), driven from JniBridgeBenchmark.kt. The camera is replaced by static data, so
+// only the JNI crossing and the marshalling around it are measured.
+//
+// Built only when CMake gets -DIRCMD_BENCHMARKS=ON, which app/build.gradle.kts passes when
+// the ircmdBenchmarks property is set (one command line):
+//
+//   ./gradlew connectedDebugAndroidTest -PircmdBenchmarks
+//       -Pandroid.testInstrumentationRunnerArguments.class=com.example.ircmd_handle.JniBridgeBenchmark
+//
+// Results are logged under the JniBridgeBenchmark tag.
+
+#include <jni.h>
+#include <android/log.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#define BENCH_TAG "JniBridgeBench"
+#define BENCH_LOGE(...) __android_log_print(ANDROID_LOG_ERROR, BENCH_TAG, __VA_ARGS__)
+
+namespace {
+
+// Capture and encoder frame sizes of the 256x192 sensor
+constexpr int kWidth = 256;
+constexpr int kHeight = 192;
+constexpr int kYuyvSize = kWidth * kHeight * 2;
+constexpr int kYuv420Size = kWidth * kHeight * 3 / 2;
+
+// Slots filled by nativeGetTelemetry (TELEMETRY_COUNT) and by the old nativeGetStreamTimings
+constexpr int kTelemetryCount = 20;
+constexpr int kStreamTimingsCount = 9;
+
+// What JniBridge::onLoad resolves for the paths measured here
+jfieldID g_wrapper_value = nullptr;
+jmethodID g_frame_array_method = nullptr;
+jmethodID g_frame_buffer_method = nullptr;
+
+std::vector<uint8_t> g_capture(kYuyvSize, 0x80);
+std::vector<uint8_t> g_yuv420(kYuv420Size, 0x80);
+std::vector<uint8_t> g_frame_buffer(kYuv420Size);
+jobject g_frame_buffer_ref = nullptr;
+
+}
+
+extern "C" {
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* /* reserved */) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
+
+    jclass wrapper = env->FindClass("com/example/ircmd_handle/IrcmdManager$MutableIntWrapper");
+    jclass bench = env->FindClass("com/example/ircmd_handle/JniBridgeBenchmark");
+    if (!wrapper || !bench) {
+        env->ExceptionClear();
+        BENCH_LOGE("Benchmark classes not found at load");
+        return JNI_ERR;
+    }
+    g_wrapper_value = env->GetFieldID(wrapper, "value", "I");
+    g_frame_array_method = env->GetMethodID(bench, "onFrameArray", "([BIIJ)V");
+    g_frame_buffer_method = env->GetMethodID(bench, "onFrameBuffer", "(Ljava/nio/ByteBuffer;IIJ)V");
+    env->DeleteLocalRef(wrapper);
+    env->DeleteLocalRef(bench);
+
+    jobject buffer = env->NewDirectByteBuffer(g_frame_buffer.data(), kYuv420Size);
+    g_frame_buffer_ref = env->NewGlobalRef(buffer);
+    env->DeleteLocalRef(buffer);
+    return JNI_VERSION_1_6;
+}
+
+// ===== Camera dimensions =====
+
+// Old: boxed kotlin.Pair<Int, Int>, classes and constructors looked up per call
+JNIEXPORT jobject JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_oldDimensions(JNIEnv* env, jobject /* this */) {
+    jclass pairClass = env->FindClass("kotlin/Pair");
+    jmethodID pairConstructor = env->GetMethodID(pairClass, "<init>", "(Ljava/lang/Object;Ljava/lang/Object;)V");
+    jclass integerClass = env->FindClass("java/lang/Integer");
+    jmethodID integerConstructor = env->GetMethodID(integerClass, "<init>", "(I)V");
+
+    jobject width = env->NewObject(integerClass, integerConstructor, kWidth);
+    jobject height = env->NewObject(integerClass, integerConstructor, kHeight);
+    jobject pair = env->NewObject(pairClass, pairConstructor, width, height);
+
+    env->DeleteLocalRef(width);
+    env->DeleteLocalRef(height);
+    env->DeleteLocalRef(integerClass);
+    env->DeleteLocalRef(pairClass);
+    return pair;
+}
+
+// New: IntArray(2)
+JNIEXPORT jintArray JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_newDimensions(JNIEnv* env, jobject /* this */) {
+    const jint dimensions[2] = {kWidth, kHeight};
+    jintArray result = env->NewIntArray(2);
+    if (result) {
+        env->SetIntArrayRegion(result, 0, 2, dimensions);
+    }
+    return result;
+}
+
+// ===== Get-function result =====
+
+// Old: field ID looked up on every call
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_oldGetFunction(JNIEnv* env, jobject /* this */, jobject resultObj) {
+    jclass integerClass = env->GetObjectClass(resultObj);
+    jfieldID valueField = env->GetFieldID(integerClass, "value", "I");
+    env->SetIntField(resultObj, valueField, 50);
+    env->DeleteLocalRef(integerClass);
+    return 0;
+}
+
+// New: field ID resolved at load
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_newGetFunction(JNIEnv* env, jobject /* this */, jobject resultObj) {
+    env->SetIntField(resultObj, g_wrapper_value, 50);
+    return 0;
+}
+
+// ===== Captured frame =====
+
+// Old: temporary heap copy, then byte[] with an 8-byte width/height header
+JNIEXPORT jbyteArray JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_oldCapture(JNIEnv* env, jobject /* this */) {
+    uint8_t* buffer = new uint8_t[kYuyvSize];
+    std::memcpy(buffer, g_capture.data(), kYuyvSize);
+
+    jbyteArray result = env->NewByteArray(kYuyvSize + 8);
+    if (result) {
+        jbyte* java_buffer = env->GetByteArrayElements(result, nullptr);
+        *reinterpret_cast<int32_t*>(java_buffer) = kWidth;
+        *reinterpret_cast<int32_t*>(java_buffer + 4) = kHeight;
+        std::memcpy(java_buffer + 8, buffer, kYuyvSize);
+        env->ReleaseByteArrayElements(result, java_buffer, 0);
+    }
+
+    delete[] buffer;
+    return result;
+}
+
+// New: copy into the caller's direct buffer, dimensions into a reused IntArray
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_newCapture(JNIEnv* env, jobject /* this */, jobject buffer, jintArray dims) {
+    auto* target = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (target == nullptr || capacity < kYuyvSize || env->GetArrayLength(dims) < 2) {
+        return -1;
+    }
+
+    std::memcpy(target, g_capture.data(), kYuyvSize);
+    const jint dimensions[2] = {kWidth, kHeight};
+    env->SetIntArrayRegion(dims, 0, 2, dimensions);
+    return kYuyvSize;
+}
+
+// ===== Encoder frame delivery =====
+
+// Old: new byte[] per frame
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_oldDeliverFrame(JNIEnv* env, jobject thiz, jlong timestampUs) {
+    jbyteArray frame = env->NewByteArray(kYuv420Size);
+    if (!frame) {
+        return;
+    }
+    env->SetByteArrayRegion(frame, 0, kYuv420Size, reinterpret_cast<const jbyte*>(g_yuv420.data()));
+    env->CallVoidMethod(thiz, g_frame_array_method, frame, kWidth, kHeight, timestampUs);
+    env->DeleteLocalRef(frame);
+}
+
+// New: copy into the direct buffer made at load
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_newDeliverFrame(JNIEnv* env, jobject thiz, jlong timestampUs) {
+    std::memcpy(g_frame_buffer.data(), g_yuv420.data(), kYuv420Size);
+    env->CallVoidMethod(thiz, g_frame_buffer_method, g_frame_buffer_ref, kWidth, kHeight, timestampUs);
+}
+
+// ===== Telemetry =====
+
+// Old: nativeGetStreamTimings allocated a LongArray per poll ...
+JNIEXPORT jlongArray JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_oldStreamTimings(JNIEnv* env, jobject /* this */) {
+    jlong values[kStreamTimingsCount];
+    for (int i = 0; i < kStreamTimingsCount; i++) {
+        values[i] = i;
+    }
+    jlongArray result = env->NewLongArray(kStreamTimingsCount);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, kStreamTimingsCount, values);
+    }
+    return result;
+}
+
+// ... and time to first frame was a call of its own
+JNIEXPORT jlong JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_oldTimeToFirstFrame(JNIEnv* /* env */, jobject /* this */) {
+    return 120;
+}
+
+// New: every counter into the caller's LongArray in one call
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_JniBridgeBenchmark_newTelemetry(JNIEnv* env, jobject /* this */, jlongArray out) {
+    jlong values[kTelemetryCount];
+    for (int i = 0; i < kTelemetryCount; i++) {
+        values[i] = i;
+    }
+    const jsize count = env->GetArrayLength(out) < kTelemetryCount ? env->GetArrayLength(out) : kTelemetryCount;
+    env->SetLongArrayRegion(out, 0, count, values);
+    return count;
+}
+
+}
@@ -0,0 +1,123 @@
+package com.example.ircmd_handle
+
+import android.util.Log
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Assert.assertEquals
+import org.junit.Assume.assumeTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.nio.ByteBuffer
+
+/**
+ * Per-call cost of the JNI bridge before and after JniBridge, on the device.
+ *
+ * Each pair of natives in libircmd_bench reproduces one call pattern the old way and the
+ * new way, with static data in place of the camera. The library is only built with
+ * -PircmdBenchmarks; without it every test here is skipped. Results go to logcat under
+ * the JniBridgeBenchmark tag.
+ */
+@RunWith(AndroidJUnit4::class)
+class JniBridgeBenchmark {
+    companion object {
+        private const val TAG = "JniBridgeBenchmark"
+        private const val WARMUP_ITERATIONS = 2_000
+        private const val ITERATIONS = 20_000
+        private const val FRAME_ITERATIONS = 2_000
+        private const val TELEMETRY_COUNT = 20
+
+        private val libraryLoaded: Boolean = try {
+            System.loadLibrary("ircmd_bench")
+            true
+        } catch (e: UnsatisfiedLinkError) {
+            false
+        }
+    }
+
+    private external fun oldDimensions(): Any?
+    private external fun newDimensions(): IntArray?
+    private external fun oldGetFunction(resultObj: IrcmdManager.MutableIntWrapper): Int
+    private external fun newGetFunction(resultObj: IrcmdManager.MutableIntWrapper): Int
+    private external fun oldCapture(): ByteArray?
+    private external fun newCapture(buffer: ByteBuffer, dims: IntArray): Int
+    private external fun oldDeliverFrame(timestampUs: Long)
+    private external fun newDeliverFrame(timestampUs: Long)
+    private external fun oldStreamTimings(): LongArray?
+    private external fun oldTimeToFirstFrame(): Long
+    private external fun newTelemetry(out: LongArray): Int
+
+    // Frames received by the two delivery paths, so the callbacks are not optimized away
+    private var deliveredBytes = 0L
+
+    @Suppress("unused") // Called from native code
+    private fun onFrameArray(yuvData: ByteArray, width: Int, height: Int, timestampUs: Long) {
+        deliveredBytes += yuvData[0] + yuvData.size
+    }
+
+    @Suppress("unused") // Called from native code
+    private fun onFrameBuffer(yuvData: ByteBuffer, width: Int, height: Int, timestampUs: Long) {
+        deliveredBytes += yuvData.get(0) + yuvData.capacity()
+    }
+
+    @Before
+    fun requireLibrary() {
+        assumeTrue("libircmd_bench not built, run with -PircmdBenchmarks", libraryLoaded)
+    }
+
+    // Average ns per call of block over iterations, after a warm-up
+    private inline fun measure(iterations: Int, block: () -> Unit): Double {
+        repeat(WARMUP_ITERATIONS.coerceAtMost(iterations)) { block() }
+        val start = System.nanoTime()
+        repeat(iterations) { block() }
+        return (System.nanoTime() - start).toDouble() / iterations
+    }
+
+    private fun report(name: String, oldNs: Double, newNs: Double) {
+        Log.i(TAG, String.format("%-16s old %9.0f ns  new %9.0f ns  (%.1fx)", name, oldNs, newNs, oldNs / newNs))
+    }
+
+    @Test
+    fun cameraDimensions() {
+        val oldNs = measure(ITERATIONS) { oldDimensions() }
+        val newNs = measure(ITERATIONS) { newDimensions() }
+        report("dimensions", oldNs, newNs)
+    }
+
+    @Test
+    fun getFunction() {
+        val wrapper = IrcmdManager.MutableIntWrapper(0)
+        val oldNs = measure(ITERATIONS) { oldGetFunction(wrapper) }
+        val newNs = measure(ITERATIONS) { newGetFunction(wrapper) }
+        assertEquals(50, wrapper.value)
+        report("get function", oldNs, newNs)
+    }
+
+    @Test
+    fun capturedFrame() {
+        val buffer = ByteBuffer.allocateDirect(256 * 192 * 2)
+        val dims = IntArray(2)
+        val oldNs = measure(FRAME_ITERATIONS) { oldCapture() }
+        val newNs = measure(FRAME_ITERATIONS) { newCapture(buffer, dims) }
+        assertEquals(256, dims[0])
+        report("captured frame", oldNs, newNs)
+    }
+
+    @Test
+    fun encoderFrame() {
+        val oldNs = measure(FRAME_ITERATIONS) { oldDeliverFrame(System.nanoTime() / 1000) }
+        val newNs = measure(FRAME_ITERATIONS) { newDeliverFrame(System.nanoTime() / 1000) }
+        report("encoder frame", oldNs, newNs)
+        Log.d(TAG, "Delivered checksum $deliveredBytes")
+    }
+
+    @Test
+    fun telemetryPoll() {
+        val telemetry = LongArray(TELEMETRY_COUNT)
+        val oldNs = measure(ITERATIONS) {
+            oldStreamTimings()
+            oldTimeToFirstFrame()
+        }
+        val newNs = measure(ITERATIONS) { newTelemetry(telemetry) }
+        report("telemetry poll", oldNs, newNs)
+    }
+}
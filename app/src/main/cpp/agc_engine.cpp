@@ -0,0 +1,221 @@
+#include "agc_engine.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr int kSubHistograms = 4;
+constexpr int kRawBins = 1 << AgcEngine::kRawBinBits;
+
+} // namespace
+
+AgcEngine::AgcEngine() {
+    configure(AgcParams());
+}
+
+bool AgcEngine::configure(const AgcParams& params) {
+    if ((params.rawBits != 14 && params.rawBits != 16) || params.plateau <= 0.0f || params.plateau > 1.0f ||
+        params.tailRejection < 0.0f || params.tailRejection >= 0.5f ||
+        params.smoothing <= 0.0f || params.smoothing > 1.0f ||
+        params.regions.size() > static_cast<size_t>(kMaxRegions)) {
+        return false;
+    }
+    for (const AgcRegion& region : params.regions) {
+        if (region.width <= 0 || region.height <= 0 || region.weight < 1 || region.weight > kMaxRegionWeight) {
+            return false;
+        }
+    }
+
+    std::atomic_store(&params_, std::shared_ptr<const AgcParams>(std::make_shared<AgcParams>(params)));
+    AGC_LOGI("AGC %s: %d-bit raw, plateau %.3f, tails %.4f, smoothing %.2f, %zu weighted regions",
+             params.enabled ? "enabled" : "disabled", params.rawBits, params.plateau,
+             params.tailRejection, params.smoothing, params.regions.size());
+    return true;
+}
+
+AgcParams AgcEngine::getParams() const {
+    return *std::atomic_load(&params_);
+}
+
+bool AgcEngine::isEnabled() const {
+    return std::atomic_load(&params_)->enabled;
+}
+
+void AgcEngine::processRaw(const uint16_t* raw, int width, int height, uint8_t* yuyv) {
+    const std::shared_ptr<const AgcParams> params = std::atomic_load(&params_);
+    const int shift = params->rawBits - kRawBinBits;
+    buildHistogram(raw, width, height, shift, kRawBins);
+
+    // Region weights: their pixels are counted weight - 1 more times
+    for (const AgcRegion& region : params->regions) {
+        const int x0 = std::max(0, region.x);
+        const int y0 = std::max(0, region.y);
+        const int x1 = std::min(width, region.x + region.width);
+        const int y1 = std::min(height, region.y + region.height);
+        const uint32_t extra = region.weight - 1;
+        for (int y = y0; y < y1; y++) {
+            const uint16_t* row = raw + static_cast<size_t>(y) * width;
+            for (int x = x0; x < x1; x++) {
+                histogram_[std::min(row[x] >> shift, kRawBins - 1)] += extra;
+            }
+        }
+    }
+
+    updateMapping(*params, kRawBins);
+
+    const size_t count = static_cast<size_t>(width) * height;
+    const uint8_t* lut = lut_.data();
+    for (size_t i = 0; i < count; i++) {
+        yuyv[i * 2] = lut[std::min(raw[i] >> shift, kRawBins - 1)];
+        yuyv[i * 2 + 1] = 128;
+    }
+}
+
+void AgcEngine::processLuma(const uint8_t* srcYuyv, int width, int height, uint8_t* yuyv) {
+    const std::shared_ptr<const AgcParams> params = std::atomic_load(&params_);
+    buildLumaHistogram(srcYuyv, width, height);
+
+    for (const AgcRegion& region : params->regions) {
+        const int x0 = std::max(0, region.x);
+        const int y0 = std::max(0, region.y);
+        const int x1 = std::min(width, region.x + region.width);
+        const int y1 = std::min(height, region.y + region.height);
+        const uint32_t extra = region.weight - 1;
+        for (int y = y0; y < y1; y++) {
+            const uint8_t* row = srcYuyv + static_cast<size_t>(y) * width * 2;
+            for (int x = x0; x < x1; x++) {
+                histogram_[row[x * 2]] += extra;
+            }
+        }
+    }
+
+    updateMapping(*params, kLumaBins);
+
+    const size_t bytes = static_cast<size_t>(width) * height * 2;
+    const uint8_t* lut = lut_.data();
+    for (size_t i = 0; i < bytes; i += 2) {
+        yuyv[i] = lut[srcYuyv[i]];
+        yuyv[i + 1] = srcYuyv[i + 1];
+    }
+}
+
+void AgcEngine::buildHistogram(const uint16_t* raw, int width, int height, int shift, int bins) {
+    sub_histograms_.assign(static_cast<size_t>(bins) * kSubHistograms, 0);
+    uint32_t* sub = sub_histograms_.data();
+    const size_t count = static_cast<size_t>(width) * height;
+    const uint16_t max_bin = static_cast<uint16_t>(bins - 1);
+    size_t i = 0;
+
+    // Bin k of sub-histogram s lives at k * 4 + s, so the four lanes never share a counter
+#if defined(__ARM_NEON)
+    const int16x8_t shift_right = vdupq_n_s16(static_cast<int16_t>(-shift));
+    const uint16x8_t max_index = vdupq_n_u16(max_bin);
+    uint16_t bin[8];
+    for (; i + 8 <= count; i += 8) {
+        vst1q_u16(bin, vminq_u16(vshlq_u16(vld1q_u16(raw + i), shift_right), max_index));
+        sub[bin[0] * kSubHistograms]++;
+        sub[bin[1] * kSubHistograms + 1]++;
+        sub[bin[2] * kSubHistograms + 2]++;
+        sub[bin[3] * kSubHistograms + 3]++;
+        sub[bin[4] * kSubHistograms]++;
+        sub[bin[5] * kSubHistograms + 1]++;
+        sub[bin[6] * kSubHistograms + 2]++;
+        sub[bin[7] * kSubHistograms + 3]++;
+    }
+#endif
+    for (; i < count; i++) {
+        sub[std::min<uint16_t>(raw[i] >> shift, max_bin) * kSubHistograms + (i & 3)]++;
+    }
+
+    histogram_.resize(bins);
+    for (int b = 0; b < bins; b++) {
+        const uint32_t* lanes = sub + b * kSubHistograms;
+        histogram_[b] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+}
+
+void AgcEngine::buildLumaHistogram(const uint8_t* yuyv, int width, int height) {
+    sub_histograms_.assign(static_cast<size_t>(kLumaBins) * kSubHistograms, 0);
+    uint32_t* sub = sub_histograms_.data();
+    const size_t count = static_cast<size_t>(width) * height;
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    uint8_t luma[16];
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(luma, vld2q_u8(yuyv + i * 2).val[0]);
+        for (int lane = 0; lane < 16; lane++) {
+            sub[luma[lane] * kSubHistograms + (lane & 3)]++;
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        sub[yuyv[i * 2] * kSubHistograms + (i & 3)]++;
+    }
+
+    histogram_.resize(kLumaBins);
+    for (int b = 0; b < kLumaBins; b++) {
+        const uint32_t* lanes = sub + b * kSubHistograms;
+        histogram_[b] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+}
+
+void AgcEngine::updateMapping(const AgcParams& params, int bins) {
+    uint64_t total = 0;
+    for (int b = 0; b < bins; b++) {
+        total += histogram_[b];
+    }
+    if (total == 0) {
+        return;
+    }
+
+    // Tails: the darkest and brightest tailRejection of the pixels saturate
+    const uint64_t tail = static_cast<uint64_t>(total * params.tailRejection);
+    int low = 0;
+    uint64_t below = 0;
+    while (low < bins - 1 && below + histogram_[low] <= tail) {
+        below += histogram_[low++];
+    }
+    int high = bins - 1;
+    uint64_t above = 0;
+    while (high > low && above + histogram_[high] <= tail) {
+        above += histogram_[high--];
+    }
+
+    // Plateau: no bin may claim more than its share of the output range
+    const uint32_t limit = std::max<uint32_t>(1, static_cast<uint32_t>(total * params.plateau));
+    uint64_t clipped_total = 0;
+    for (int b = low; b <= high; b++) {
+        clipped_total += std::min(histogram_[b], limit);
+    }
+
+    if (mapping_bins_ != bins) {
+        mapping_.assign(bins, 0.0f);
+        lut_.assign(bins, 0);
+    }
+    const float alpha = mapping_bins_ == bins ? params.smoothing : 1.0f;
+    mapping_bins_ = bins;
+
+    // Each bin maps to the middle of its share of the clipped cumulative histogram
+    uint64_t cumulative = 0;
+    const float scale = clipped_total > 0 ? 255.0f / clipped_total : 0.0f;
+    for (int b = 0; b < bins; b++) {
+        float target;
+        if (b < low) {
+            target = 0.0f;
+        } else if (b > high) {
+            target = 255.0f;
+        } else {
+            const uint32_t clipped = std::min(histogram_[b], limit);
+            target = (cumulative + clipped * 0.5f) * scale;
+            cumulative += clipped;
+        }
+        mapping_[b] += alpha * (target - mapping_[b]);
+        lut_[b] = static_cast<uint8_t>(std::min(255.0f, mapping_[b] + 0.5f));
+    }
+}
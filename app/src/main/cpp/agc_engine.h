@@ -0,0 +1,74 @@
+#pragma once
+
+#include <android/log.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Logging macros
+#define AGC_TAG "AgcEngine"
+#define AGC_LOGI(...) __android_log_print(ANDROID_LOG_INFO, AGC_TAG, __VA_ARGS__)
+
+// Part of the frame whose pixels count weight times in the histogram
+struct AgcRegion {
+    int x;
+    int y;
+    int width;
+    int height;
+    int weight;             // 1..kMaxRegionWeight
+};
+
+struct AgcParams {
+    bool enabled = false;
+    int rawBits = 16;               // Significant bits of the raw counts: 14 or 16
+    float plateau = 0.01f;          // Bin count limit as a share of all counted pixels
+    float tailRejection = 0.001f;   // Share of pixels clipped to black and to white
+    float smoothing = 0.25f;        // Weight of a new frame's mapping, 1 disables smoothing
+    std::vector<AgcRegion> regions;
+};
+
+/**
+ * Host-side automatic gain control: plateau histogram equalization to an 8-bit LUT.
+ *
+ * Raw counts are binned into 14 bits (16-bit counts lose their two low bits). The histogram
+ * is spread over four sub-histograms, one per lane of the NEON loop that computes the bin
+ * indices, so consecutive equal pixels never wait on each other's increment; they are
+ * summed before equalization. Bins are clipped at the plateau before the cumulative sum,
+ * so large uniform areas cannot take all of the gray range, and the resulting mapping is
+ * blended with the previous frame's to keep the picture from flickering. Frames without a
+ * raw plane are equalized on their luma with the same steps over 256 bins.
+ */
+class AgcEngine {
+public:
+    static constexpr int kRawBinBits = 14;
+    static constexpr int kLumaBins = 256;
+    static constexpr int kMaxRegions = 8;
+    static constexpr int kMaxRegionWeight = 16;
+
+    AgcEngine();
+
+    // Any thread; applied from the next frame. Returns false if the params are out of range.
+    bool configure(const AgcParams& params);
+    AgcParams getParams() const;
+    bool isEnabled() const;
+
+    // Frame thread: update the mapping from this frame, then write the mapped image as YUYV
+    // (neutral chroma for raw input, the source chroma for luma input)
+    void processRaw(const uint16_t* raw, int width, int height, uint8_t* yuyv);
+    void processLuma(const uint8_t* srcYuyv, int width, int height, uint8_t* yuyv);
+
+private:
+    void buildHistogram(const uint16_t* raw, int width, int height, int shift, int bins);
+    void buildLumaHistogram(const uint8_t* yuyv, int width, int height);
+    void updateMapping(const AgcParams& params, int bins);
+
+    std::shared_ptr<const AgcParams> params_;   // Accessed with std::atomic_load/atomic_store
+
+    // Frame thread only
+    std::vector<uint32_t> sub_histograms_;      // 4 interleaved histograms
+    std::vector<uint32_t> histogram_;
+    std::vector<float> mapping_;
+    int mapping_bins_ = 0;                      // 0 until the first frame, resets smoothing
+    std::vector<uint8_t> lut_;
+};
@@ -0,0 +1,235 @@
+#include "alarm_engine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool isValidMetric(AlarmSource source, AlarmMetric metric) {
+    switch (source) {
+        case AlarmSource::GLOBAL:
+        case AlarmSource::ROI:
+            return metric == AlarmMetric::MIN || metric == AlarmMetric::MAX ||
+                   metric == AlarmMetric::MEAN || metric == AlarmMetric::STDDEV;
+        case AlarmSource::BLOB:
+            return metric == AlarmMetric::MAX || metric == AlarmMetric::AREA || metric == AlarmMetric::COUNT;
+    }
+    return false;
+}
+
+float blobValue(const TrackedBlob& blob, AlarmMetric metric) {
+    return metric == AlarmMetric::AREA ? static_cast<float>(blob.area) : blob.peak;
+}
+
+} // namespace
+
+AlarmEngine::AlarmEngine() {
+    std::atomic_store(&program_, std::shared_ptr<const Program>(std::make_shared<Program>()));
+    roi_results_.reserve(RoiEngine::kMaxRois);
+    blobs_.reserve(BlobTracker::kMaxTracks);
+}
+
+bool AlarmEngine::setRules(const std::vector<AlarmRule>& rules) {
+    if (rules.size() > static_cast<size_t>(kMaxRules)) {
+        ALARM_LOGW("%zu alarm rules, at most %d supported", rules.size(), kMaxRules);
+        return false;
+    }
+
+    auto program = std::make_shared<Program>();
+    for (const AlarmRule& rule : rules) {
+        if (!isValidMetric(rule.source, rule.metric) || rule.hysteresis < 0.0f || std::isnan(rule.threshold)) {
+            ALARM_LOGW("Alarm rule %d is invalid: source %d, metric %d, hysteresis %.2f", rule.id,
+                       static_cast<int>(rule.source), static_cast<int>(rule.metric), rule.hysteresis);
+            return false;
+        }
+
+        Operand key = {rule.source, rule.target, rule.metric, false};
+        if (rule.source == AlarmSource::GLOBAL || rule.metric == AlarmMetric::COUNT) {
+            key.target = -1;
+        } else if (rule.source == AlarmSource::BLOB && rule.target < 0) {
+            key.target = -1;
+            key.lowest = rule.op == AlarmOp::LESS;
+        }
+        size_t slot = 0;
+        while (slot < program->operands.size()) {
+            const Operand& o = program->operands[slot];
+            if (o.source == key.source && o.target == key.target && o.metric == key.metric && o.lowest == key.lowest) {
+                break;
+            }
+            slot++;
+        }
+        if (slot == program->operands.size()) {
+            program->operands.push_back(key);
+        }
+
+        const bool greater = rule.op == AlarmOp::GREATER;
+        program->operand.push_back(static_cast<uint16_t>(slot));
+        program->greater.push_back(greater ? 1 : 0);
+        program->triggerAt.push_back(rule.threshold);
+        program->clearAt.push_back(greater ? rule.threshold - rule.hysteresis : rule.threshold + rule.hysteresis);
+        program->triggerFrames.push_back(static_cast<uint16_t>(std::clamp(rule.triggerFrames, 1, 65535)));
+        program->clearFrames.push_back(static_cast<uint16_t>(std::clamp(rule.clearFrames, 1, 65535)));
+        program->ruleIds.push_back(rule.id);
+        program->actions.push_back(rule.actions);
+        program->needsRois |= rule.source == AlarmSource::ROI;
+        program->needsBlobs |= rule.source == AlarmSource::BLOB;
+    }
+
+    std::atomic_store(&program_, std::shared_ptr<const Program>(std::move(program)));
+    ALARM_LOGI("🚨 %zu alarm rules loaded", rules.size());
+    return true;
+}
+
+size_t AlarmEngine::getRuleCount() const {
+    return std::atomic_load(&program_)->ruleIds.size();
+}
+
+void AlarmEngine::setCallback(Callback callback, void* userPtr) {
+    callback_ = callback;
+    callback_user_ptr_ = userPtr;
+}
+
+void AlarmEngine::evaluate(const FrameStats& stats, RoiEngine& rois, BlobTracker& blobs) {
+    const std::shared_ptr<const Program> program = std::atomic_load(&program_);
+    const size_t count = program->ruleIds.size();
+    if (program != running_program_) {
+        // New rules start inactive
+        running_program_ = program;
+        values_.assign(program->operands.size(), NAN);
+        counters_.assign(count, 0);
+        active_.assign(count, 0);
+    }
+    FrameStatsRecord frame;
+    if (count == 0 || !stats.read(&frame)) {
+        return;
+    }
+    const int64_t start_ns = steadyNanos();
+
+    if (program->needsRois) {
+        rois.getResults(&roi_results_);
+    }
+    if (program->needsBlobs) {
+        blobs.getTracks(&blobs_);
+    }
+    gatherOperands(*program, frame);
+
+    const uint16_t* operand = program->operand.data();
+    const uint8_t* greater = program->greater.data();
+    const float* trigger_at = program->triggerAt.data();
+    const float* clear_at = program->clearAt.data();
+    for (size_t i = 0; i < count; i++) {
+        const float value = values_[operand[i]];
+        // NaN compares false: a missing operand never triggers and lets an alarm clear
+        const bool hit = greater[i] ? value > trigger_at[i] : value < trigger_at[i];
+        const bool released = greater[i] ? !(value > clear_at[i]) : !(value < clear_at[i]);
+        const bool advance = active_[i] ? released : hit;
+        counters_[i] = advance ? counters_[i] + 1 : 0;
+        if (counters_[i] >= (active_[i] ? program->clearFrames[i] : program->triggerFrames[i])) {
+            active_[i] ^= 1;
+            counters_[i] = 0;
+            emit({program->ruleIds[i], active_[i] != 0, value, frame.timestampUs, program->actions[i]});
+        }
+    }
+
+    const int64_t elapsed_ns = steadyNanos() - start_ns;
+    evaluations_.fetch_add(1, std::memory_order_relaxed);
+    last_ns_.store(elapsed_ns, std::memory_order_relaxed);
+    total_ns_.fetch_add(elapsed_ns, std::memory_order_relaxed);
+    if (elapsed_ns > max_ns_.load(std::memory_order_relaxed)) {
+        max_ns_.store(elapsed_ns, std::memory_order_relaxed);
+    }
+}
+
+void AlarmEngine::gatherOperands(const Program& program, const FrameStatsRecord& frame) {
+    const bool celsius = frame.source == StatsSource::RAW_TEMPERATURE;
+    for (size_t slot = 0; slot < program.operands.size(); slot++) {
+        const Operand& o = program.operands[slot];
+        float value = NAN;
+        switch (o.source) {
+            case AlarmSource::GLOBAL:
+                switch (o.metric) {
+                    case AlarmMetric::MIN: value = celsius ? frame.minC : static_cast<float>(frame.min); break;
+                    case AlarmMetric::MAX: value = celsius ? frame.maxC : static_cast<float>(frame.max); break;
+                    case AlarmMetric::MEAN: value = celsius ? frame.meanC : frame.mean; break;
+                    default: value = celsius ? frame.stddevC : frame.stddev; break;
+                }
+                break;
+
+            case AlarmSource::ROI: {
+                // Results are in the order ROIs were added, so ids ascend
+                auto it = std::lower_bound(roi_results_.begin(), roi_results_.end(), o.target,
+                                           [](const RoiResult& r, int id) { return r.id < id; });
+                if (it == roi_results_.end() || it->id != o.target || it->pixelCount == 0) {
+                    break;
+                }
+                switch (o.metric) {
+                    case AlarmMetric::MIN: value = it->min; break;
+                    case AlarmMetric::MAX: value = it->max; break;
+                    case AlarmMetric::MEAN: value = it->mean; break;
+                    default: value = std::sqrt(std::max(it->variance, 0.0f)); break;
+                }
+                break;
+            }
+
+            case AlarmSource::BLOB:
+                if (o.metric == AlarmMetric::COUNT) {
+                    value = static_cast<float>(blobs_.size());
+                    break;
+                }
+                for (const TrackedBlob& blob : blobs_) {
+                    if (o.target >= 0 && blob.id != o.target) {
+                        continue;
+                    }
+                    const float v = blobValue(blob, o.metric);
+                    if (std::isnan(value) || (o.lowest ? v < value : v > value)) {
+                        value = v;
+                    }
+                }
+                break;
+        }
+        values_[slot] = value;
+    }
+}
+
+void AlarmEngine::emit(const AlarmEvent& event) {
+    if (callback_) {
+        callback_(event, callback_user_ptr_);
+    }
+    event_total_.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    if (event_count_ == static_cast<size_t>(kEventQueueDepth)) {
+        event_head_ = (event_head_ + 1) % kEventQueueDepth;
+        event_count_--;
+        dropped_events_.fetch_add(1, std::memory_order_relaxed);
+    }
+    events_[(event_head_ + event_count_) % kEventQueueDepth] = event;
+    event_count_++;
+}
+
+size_t AlarmEngine::takeEvents(AlarmEvent* out, size_t maxEvents) {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    const size_t count = std::min(maxEvents, event_count_);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = events_[event_head_];
+        event_head_ = (event_head_ + 1) % kEventQueueDepth;
+    }
+    event_count_ -= count;
+    return count;
+}
+
+AlarmStats AlarmEngine::getStats() const {
+    AlarmStats stats;
+    stats.evaluations = evaluations_.load(std::memory_order_relaxed);
+    stats.events = event_total_.load(std::memory_order_relaxed);
+    stats.droppedEvents = dropped_events_.load(std::memory_order_relaxed);
+    stats.lastNs = last_ns_.load(std::memory_order_relaxed);
+    stats.maxNs = max_ns_.load(std::memory_order_relaxed);
+    stats.totalNs = total_ns_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "blob_tracker.h"
+#include "frame_stats.h"
+#include "roi_engine.h"
+
+// Logging macros
+#define ALARM_TAG "AlarmEngine"
+#define ALARM_LOGI(...) __android_log_print(ANDROID_LOG_INFO, ALARM_TAG, __VA_ARGS__)
+#define ALARM_LOGW(...) __android_log_print(ANDROID_LOG_WARN, ALARM_TAG, __VA_ARGS__)
+
+// Values are kept in sync with CameraActivity.ALARM_*
+enum class AlarmSource {
+    GLOBAL = 0,         // Whole frame (FrameStats)
+    ROI = 1,            // target is the ROI id
+    BLOB = 2            // target is a track id, or -1 for the hottest (GREATER) / coolest (LESS) blob
+};
+
+enum class AlarmMetric {
+    MIN = 0,
+    MAX = 1,            // Peak for blobs
+    MEAN = 2,
+    STDDEV = 3,
+    AREA = 4,           // Blobs only, pixels
+    COUNT = 5           // Blobs only, number tracked; target is ignored
+};
+
+enum class AlarmOp {
+    GREATER = 0,
+    LESS = 1
+};
+
+// Bits of AlarmRule::actions
+enum AlarmAction {
+    ALARM_ACTION_SNAPSHOT = 1,      // Capture the triggering frame like nativeSetCaptureFlag
+    ALARM_ACTION_RECORD = 2         // Ask the app to start recording
+};
+
+/**
+ * "source metric op threshold for N frames". The alarm triggers after triggerFrames
+ * consecutive frames meeting the condition and clears after clearFrames consecutive frames
+ * on the other side of threshold -/+ hysteresis. Values are °C when the frame has a
+ * temperature plane and luma otherwise.
+ */
+struct AlarmRule {
+    int id;
+    AlarmSource source;
+    int target;
+    AlarmMetric metric;
+    AlarmOp op;
+    float threshold;
+    float hysteresis = 0.0f;
+    int triggerFrames = 1;
+    int clearFrames = 1;
+    int actions = 0;
+};
+
+// Ints per rule in the spec passed to nativeSetAlarmRules, followed by threshold and
+// hysteresis per rule in a float array; keep in sync with CameraActivity.ALARM_RULE_*
+enum AlarmRuleIndex {
+    ALARM_RULE_ID = 0,
+    ALARM_RULE_SOURCE,
+    ALARM_RULE_TARGET,
+    ALARM_RULE_METRIC,
+    ALARM_RULE_OP,
+    ALARM_RULE_TRIGGER_FRAMES,
+    ALARM_RULE_CLEAR_FRAMES,
+    ALARM_RULE_ACTIONS,
+    ALARM_RULE_STRIDE
+};
+
+struct AlarmEvent {
+    int ruleId;
+    bool triggered;                 // false when the alarm cleared
+    float value;
+    int64_t timestampUs;
+    int actions;
+};
+
+// Doubles per event in the array filled by nativeGetAlarmEvents; keep in sync with CameraActivity.ALARM_EVENT_*
+enum AlarmEventIndex {
+    ALARM_EVENT_RULE_ID = 0,
+    ALARM_EVENT_TRIGGERED,
+    ALARM_EVENT_VALUE,
+    ALARM_EVENT_TIMESTAMP_US,
+    ALARM_EVENT_ACTIONS,
+    ALARM_EVENT_STRIDE
+};
+
+// Slots of the array filled by nativeGetAlarmStats; keep in sync with CameraActivity.ALARM_STATS_*
+enum AlarmStatsIndex {
+    ALARM_STATS_RULES = 0,
+    ALARM_STATS_EVALUATIONS,
+    ALARM_STATS_EVENTS,
+    ALARM_STATS_DROPPED_EVENTS,
+    ALARM_STATS_LAST_NS,
+    ALARM_STATS_MAX_NS,
+    ALARM_STATS_MEAN_NS,
+    ALARM_STATS_COUNT
+};
+
+struct AlarmStats {
+    uint64_t evaluations;
+    uint64_t events;
+    uint64_t droppedEvents;         // Queued events overwritten before they were read
+    int64_t lastNs;                 // Evaluation time of the latest frame
+    int64_t maxNs;
+    int64_t totalNs;
+};
+
+/**
+ * Per-frame threshold alarms over the global, ROI and blob measurements.
+ *
+ * setRules() compiles the rules into a flat program: every distinct (source, target,
+ * metric) becomes one operand slot, and every rule becomes an instruction reading a slot
+ * and comparing it against precomputed trigger and clear thresholds. Per frame the
+ * operands are gathered once (ROI results and tracks are only read if a rule needs them),
+ * then the instructions run as one loop over contiguous arrays, so a hundred rules cost a
+ * few microseconds. A missing operand (ROI removed, no blob) counts as not meeting the
+ * condition.
+ *
+ * Transitions call the callback on the frame thread and are queued for polling.
+ */
+class AlarmEngine {
+public:
+    static constexpr int kMaxRules = 256;
+    static constexpr int kEventQueueDepth = 64;
+
+    using Callback = void (*)(const AlarmEvent& event, void* userPtr);
+
+    AlarmEngine();
+
+    // Any thread; replaces all rules and resets their state. Returns false, keeping the
+    // current rules, if a rule is invalid.
+    bool setRules(const std::vector<AlarmRule>& rules);
+    size_t getRuleCount() const;
+
+    // Set once before streaming; called on the frame thread for every transition
+    void setCallback(Callback callback, void* userPtr);
+
+    // Frame thread, after the measurements of the frame are published
+    void evaluate(const FrameStats& stats, RoiEngine& rois, BlobTracker& blobs);
+
+    // Any thread: move up to maxEvents queued events, oldest first, into out
+    size_t takeEvents(AlarmEvent* out, size_t maxEvents);
+
+    AlarmStats getStats() const;
+
+private:
+    struct Operand {
+        AlarmSource source;
+        int target;
+        AlarmMetric metric;
+        bool lowest;                // Blob target -1: coolest instead of hottest
+    };
+
+    struct Program {
+        std::vector<Operand> operands;
+        // Instructions, structure of arrays
+        std::vector<uint16_t> operand;
+        std::vector<uint8_t> greater;
+        std::vector<float> triggerAt;
+        std::vector<float> clearAt;
+        std::vector<uint16_t> triggerFrames;
+        std::vector<uint16_t> clearFrames;
+        std::vector<int> ruleIds;
+        std::vector<int> actions;
+        bool needsRois = false;
+        bool needsBlobs = false;
+    };
+
+    void gatherOperands(const Program& program, const FrameStatsRecord& frame);
+    void emit(const AlarmEvent& event);
+
+    std::shared_ptr<const Program> program_;    // Accessed with std::atomic_load/atomic_store
+    Callback callback_ = nullptr;
+    void* callback_user_ptr_ = nullptr;
+
+    // Frame thread only
+    std::shared_ptr<const Program> running_program_;
+    std::vector<float> values_;
+    std::vector<uint16_t> counters_;
+    std::vector<uint8_t> active_;
+    std::vector<RoiResult> roi_results_;
+    std::vector<TrackedBlob> blobs_;
+
+    std::mutex event_mutex_;
+    AlarmEvent events_[kEventQueueDepth];
+    size_t event_head_ = 0;
+    size_t event_count_ = 0;
+
+    std::atomic<uint64_t> evaluations_{0};
+    std::atomic<uint64_t> event_total_{0};
+    std::atomic<uint64_t> dropped_events_{0};
+    std::atomic<int64_t> last_ns_{0};
+    std::atomic<int64_t> max_ns_{0};
+    std::atomic<int64_t> total_ns_{0};
+};
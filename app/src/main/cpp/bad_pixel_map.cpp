@@ -0,0 +1,341 @@
+#include "bad_pixel_map.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr char kFileMagic[4] = {'B', 'P', 'M', '1'};
+
+// Optimal 8-input sorting network (19 comparators, 6 layers)
+constexpr int kSortNetwork[19][2] = {
+    {0, 2}, {1, 3}, {4, 6}, {5, 7},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7},
+    {0, 1}, {2, 3}, {4, 5}, {6, 7},
+    {2, 4}, {3, 5},
+    {1, 4}, {3, 6},
+    {1, 2}, {3, 4}, {5, 6},
+};
+
+inline void compareExchange(uint16_t& a, uint16_t& b) {
+    const uint16_t lo = std::min(a, b);
+    b = std::max(a, b);
+    a = lo;
+}
+
+#if defined(__ARM_NEON)
+inline void compareExchange(uint16x8_t& a, uint16x8_t& b) {
+    const uint16x8_t lo = vminq_u16(a, b);
+    b = vmaxq_u16(a, b);
+    a = lo;
+}
+#endif
+
+template <typename V>
+inline void sort8(V* v) {
+    for (const auto& pair : kSortNetwork) {
+        compareExchange(v[pair[0]], v[pair[1]]);
+    }
+}
+
+float medianOf(float* values, int count) {
+    std::nth_element(values, values + count / 2, values + count);
+    const float upper = values[count / 2];
+    if (count % 2) {
+        return upper;
+    }
+    return 0.5f * (upper + *std::max_element(values, values + count / 2));
+}
+
+} // namespace
+
+BadPixelMap::BadPixelMap() {
+    std::atomic_store(&map_, std::shared_ptr<const Map>(std::make_shared<Map>()));
+    std::atomic_store(&learn_params_, std::shared_ptr<const BadPixelLearnParams>(std::make_shared<BadPixelLearnParams>()));
+}
+
+std::shared_ptr<const BadPixelMap::Map> BadPixelMap::compile(int width, int height, std::vector<uint32_t> pixels) {
+    auto map = std::make_shared<Map>();
+    map->width = width;
+    map->height = height;
+    const uint32_t total = static_cast<uint32_t>(width) * height;
+    std::sort(pixels.begin(), pixels.end());
+    pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+    pixels.erase(std::lower_bound(pixels.begin(), pixels.end(), total), pixels.end());
+
+    std::vector<uint8_t> bad(total, 0);
+    for (uint32_t pixel : pixels) {
+        bad[pixel] = 1;
+    }
+
+    map->corrected.reserve(pixels.size());
+    map->neighbors.reserve(pixels.size() * 8);
+    map->oddMask.reserve(pixels.size());
+    for (uint32_t pixel : pixels) {
+        const int px = static_cast<int>(pixel % width);
+        const int py = static_cast<int>(pixel / width);
+        int32_t found[8];
+        int count = 0;
+        // 3x3 first; the 5x5 ring only when no direct neighbour is good
+        for (int radius = 1; radius <= 2 && count == 0; radius++) {
+            for (int dy = -radius; dy <= radius && count < 8; dy++) {
+                for (int dx = -radius; dx <= radius && count < 8; dx++) {
+                    if (std::max(std::abs(dx), std::abs(dy)) != radius) {
+                        continue;
+                    }
+                    const int x = px + dx;
+                    const int y = py + dy;
+                    if (x < 0 || y < 0 || x >= width || y >= height) {
+                        continue;
+                    }
+                    const int32_t index = y * width + x;
+                    if (!bad[index]) {
+                        found[count++] = index;
+                    }
+                }
+            }
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        // Padding split so the sorted slots 3 and 4 are the real median
+        const int padding = 8 - count;
+        const int low = padding / 2;
+        for (int i = 0; i < low; i++) {
+            map->neighbors.push_back(kPadLow);
+        }
+        map->neighbors.insert(map->neighbors.end(), found, found + count);
+        for (int i = low + count; i < 8; i++) {
+            map->neighbors.push_back(kPadHigh);
+        }
+        map->corrected.push_back(pixel);
+        map->oddMask.push_back(count % 2 ? 0xFFFF : 0);
+    }
+    map->pixels = std::move(pixels);
+    return map;
+}
+
+bool BadPixelMap::setPixels(int width, int height, std::vector<uint32_t> pixels) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    std::shared_ptr<const Map> map = compile(width, height, std::move(pixels));
+    BAD_PIXEL_LOGI("Bad pixel map %dx%d: %zu pixels, %zu without a good neighbour", width, height,
+                   map->pixels.size(), map->pixels.size() - map->corrected.size());
+    std::atomic_store(&map_, std::move(map));
+    return true;
+}
+
+void BadPixelMap::clear() {
+    std::atomic_store(&map_, std::shared_ptr<const Map>(std::make_shared<Map>()));
+}
+
+size_t BadPixelMap::getPixelCount() const {
+    return std::atomic_load(&map_)->pixels.size();
+}
+
+bool BadPixelMap::load(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        BAD_PIXEL_LOGW("No bad pixel map at %s", path.c_str());
+        return false;
+    }
+    char magic[4];
+    uint32_t header[3];
+    std::vector<uint32_t> pixels;
+    bool ok = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && std::equal(magic, magic + 4, kFileMagic) &&
+              fread(header, sizeof(uint32_t), 3, file) == 3 && header[0] > 0 && header[1] > 0 &&
+              header[2] <= static_cast<uint64_t>(header[0]) * header[1];
+    if (ok) {
+        pixels.resize(header[2]);
+        ok = fread(pixels.data(), sizeof(uint32_t), pixels.size(), file) == pixels.size();
+    }
+    fclose(file);
+    if (!ok) {
+        BAD_PIXEL_LOGE("Bad pixel map %s is corrupt", path.c_str());
+        return false;
+    }
+    return setPixels(static_cast<int>(header[0]), static_cast<int>(header[1]), std::move(pixels));
+}
+
+bool BadPixelMap::save(const std::string& path) const {
+    const std::shared_ptr<const Map> map = std::atomic_load(&map_);
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        BAD_PIXEL_LOGE("Cannot write bad pixel map %s", path.c_str());
+        return false;
+    }
+    const uint32_t header[3] = {static_cast<uint32_t>(map->width), static_cast<uint32_t>(map->height),
+                                static_cast<uint32_t>(map->pixels.size())};
+    bool ok = fwrite(kFileMagic, 1, sizeof(kFileMagic), file) == sizeof(kFileMagic) &&
+              fwrite(header, sizeof(uint32_t), 3, file) == 3 &&
+              fwrite(map->pixels.data(), sizeof(uint32_t), map->pixels.size(), file) == map->pixels.size();
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+bool BadPixelMap::startLearning(const BadPixelLearnParams& params) {
+    if (params.frames < 2 || params.deviationThreshold <= 0.0f || params.noiseThreshold <= 1.0f) {
+        return false;
+    }
+    std::atomic_store(&learn_params_, std::shared_ptr<const BadPixelLearnParams>(std::make_shared<BadPixelLearnParams>(params)));
+    learn_generation_.fetch_add(1, std::memory_order_release);
+    learning_.store(true, std::memory_order_relaxed);
+    BAD_PIXEL_LOGI("🔍 Learning bad pixels over %d flat-field frames", params.frames);
+    return true;
+}
+
+void BadPixelMap::process(uint8_t* yuyv, uint16_t* raw, int width, int height) {
+    if (learning_.load(std::memory_order_relaxed)) {
+        accumulate(yuyv, raw, width, height);
+        return;
+    }
+    const std::shared_ptr<const Map> map = std::atomic_load(&map_);
+    if (map->corrected.empty() || map->width != width || map->height != height) {
+        return;
+    }
+    if (raw) {
+        correctPlane<uint16_t, 1>(*map, raw);
+    }
+    if (yuyv) {
+        correctPlane<uint8_t, 2>(*map, yuyv);
+    }
+}
+
+template <typename T, int Step>
+void BadPixelMap::correctPlane(const Map& map, T* plane) {
+    const size_t count = map.corrected.size();
+    const int32_t* neighbors = map.neighbors.data();
+    auto fetch = [plane](int32_t index) -> uint16_t {
+        return index >= 0 ? plane[static_cast<size_t>(index) * Step] : (index == kPadLow ? 0 : 0xFFFF);
+    };
+
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    // Eight defects per pass: slot s of all eight in one register
+    uint16_t lanes[8][8];
+    uint16_t medians[8];
+    for (; i + 8 <= count; i += 8) {
+        for (int p = 0; p < 8; p++) {
+            const int32_t* n = neighbors + (i + p) * 8;
+            for (int s = 0; s < 8; s++) {
+                lanes[s][p] = fetch(n[s]);
+            }
+        }
+        uint16x8_t v[8];
+        for (int s = 0; s < 8; s++) {
+            v[s] = vld1q_u16(lanes[s]);
+        }
+        sort8(v);
+        const uint16x8_t median = vbslq_u16(vld1q_u16(map.oddMask.data() + i), v[3], vrhaddq_u16(v[3], v[4]));
+        vst1q_u16(medians, median);
+        for (int p = 0; p < 8; p++) {
+            plane[static_cast<size_t>(map.corrected[i + p]) * Step] = static_cast<T>(medians[p]);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        uint16_t v[8];
+        const int32_t* n = neighbors + i * 8;
+        for (int s = 0; s < 8; s++) {
+            v[s] = fetch(n[s]);
+        }
+        sort8(v);
+        const uint16_t median = map.oddMask[i] ? v[3] : static_cast<uint16_t>((v[3] + v[4] + 1) / 2);
+        plane[static_cast<size_t>(map.corrected[i]) * Step] = static_cast<T>(median);
+    }
+}
+
+void BadPixelMap::accumulate(const uint8_t* yuyv, const uint16_t* raw, int width, int height) {
+    const uint32_t generation = learn_generation_.load(std::memory_order_acquire);
+    const size_t pixels = static_cast<size_t>(width) * height;
+    if (generation != seen_generation_ || width != learn_width_ || height != learn_height_) {
+        seen_generation_ = generation;
+        learn_width_ = width;
+        learn_height_ = height;
+        learned_frames_ = 0;
+        sum_.assign(pixels, 0);
+        sum_sq_.assign(pixels, 0);
+    }
+
+    // Raw counts when the stream has them, luma otherwise
+    for (size_t i = 0; i < pixels; i++) {
+        const uint64_t value = raw ? raw[i] : yuyv[i * 2];
+        sum_[i] += value;
+        sum_sq_[i] += value * value;
+    }
+    if (++learned_frames_ >= std::atomic_load(&learn_params_)->frames) {
+        finishLearning();
+    }
+}
+
+void BadPixelMap::finishLearning() {
+    const BadPixelLearnParams params = *std::atomic_load(&learn_params_);
+    const int width = learn_width_;
+    const int height = learn_height_;
+    const size_t pixels = static_cast<size_t>(width) * height;
+    const double frames = learned_frames_;
+
+    std::vector<float> mean(pixels);
+    std::vector<float> noise(pixels);
+    for (size_t i = 0; i < pixels; i++) {
+        const double m = sum_[i] / frames;
+        mean[i] = static_cast<float>(m);
+        noise[i] = static_cast<float>(std::sqrt(std::max(0.0, sum_sq_[i] / frames - m * m)));
+    }
+
+    // Deviation of each pixel's mean from the median of its neighbours' means
+    std::vector<float> deviation(pixels);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float around[8];
+            int count = 0;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    const int nx = x + dx;
+                    const int ny = y + dy;
+                    if ((dx || dy) && nx >= 0 && ny >= 0 && nx < width && ny < height) {
+                        around[count++] = mean[static_cast<size_t>(ny) * width + nx];
+                    }
+                }
+            }
+            const size_t i = static_cast<size_t>(y) * width + x;
+            deviation[i] = count ? mean[i] - medianOf(around, count) : 0.0f;
+        }
+    }
+
+    // Robust scales: MAD of the deviations, median temporal noise
+    std::vector<float> scratch(pixels);
+    for (size_t i = 0; i < pixels; i++) {
+        scratch[i] = std::abs(deviation[i]);
+    }
+    const float sigma = std::max(1.4826f * medianOf(scratch.data(), static_cast<int>(pixels)), 0.5f);
+    scratch = noise;
+    const float typical_noise = medianOf(scratch.data(), static_cast<int>(pixels));
+
+    std::vector<uint32_t> flagged;
+    for (size_t i = 0; i < pixels; i++) {
+        const bool offset = std::abs(deviation[i]) > params.deviationThreshold * sigma;
+        const bool flickering = typical_noise > 0.0f && noise[i] > params.noiseThreshold * typical_noise;
+        const bool stuck = typical_noise > 0.0f && noise[i] < typical_noise / params.noiseThreshold;
+        if (offset || flickering || stuck) {
+            flagged.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    learning_.store(false, std::memory_order_relaxed);
+    sum_ = std::vector<uint64_t>();
+    sum_sq_ = std::vector<uint64_t>();
+    if (flagged.size() > params.maxFraction * pixels) {
+        BAD_PIXEL_LOGE("Learning flagged %zu of %zu pixels; the scene was not a flat field, map unchanged",
+                       flagged.size(), pixels);
+        return;
+    }
+    BAD_PIXEL_LOGI("Learned from %d frames: sigma %.2f, noise %.2f", learned_frames_, sigma, typical_noise);
+    setPixels(width, height, std::move(flagged));
+}
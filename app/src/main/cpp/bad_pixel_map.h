@@ -0,0 +1,94 @@
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Logging macros
+#define BAD_PIXEL_TAG "BadPixelMap"
+#define BAD_PIXEL_LOGI(...) __android_log_print(ANDROID_LOG_INFO, BAD_PIXEL_TAG, __VA_ARGS__)
+#define BAD_PIXEL_LOGW(...) __android_log_print(ANDROID_LOG_WARN, BAD_PIXEL_TAG, __VA_ARGS__)
+#define BAD_PIXEL_LOGE(...) __android_log_print(ANDROID_LOG_ERROR, BAD_PIXEL_TAG, __VA_ARGS__)
+
+// Flat-field learning: point the camera at a uniform scene (lens cap, closed shutter)
+struct BadPixelLearnParams {
+    int frames = 32;                // Frames averaged
+    float deviationThreshold = 8.0f;// Robust sigmas a pixel's mean may differ from its neighbours'
+    float noiseThreshold = 6.0f;    // Multiples of the median temporal noise a pixel may show
+    float maxFraction = 0.02f;      // More flagged pixels than this means the scene was not flat
+};
+
+/**
+ * Host-side defective pixel correction, independent of the device's DPC calibration.
+ *
+ * The map is a sorted list of pixel indices. When it is set, each defective pixel gets the
+ * indices of up to eight good neighbours (3x3, or the 5x5 ring when the 3x3 has none);
+ * slots left over are padded with equal numbers of lowest and highest sentinels, so the
+ * middle of the sorted eight is still the median of the real neighbours. Per frame the
+ * neighbours are gathered and eight pixels at a time run through a 19 comparator sorting
+ * network in NEON registers. The cost follows the defect count, not the resolution.
+ *
+ * Pixels are replaced in the frame buffer itself, in the raw plane and in the luma of the
+ * image plane, before any other stage reads the frame. While learning, frames are
+ * accumulated uncorrected.
+ */
+class BadPixelMap {
+public:
+    BadPixelMap();
+
+    // Any thread. A map replaces the current one, learned or loaded.
+    bool setPixels(int width, int height, std::vector<uint32_t> pixels);
+    void clear();
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Any thread: learn a new map from the next params.frames frames. The current map stays
+    // in use until learning succeeds.
+    bool startLearning(const BadPixelLearnParams& params);
+    bool isLearning() const { return learning_.load(std::memory_order_relaxed); }
+
+    size_t getPixelCount() const;
+    bool isActive() const { return isLearning() || getPixelCount() > 0; }
+
+    // Frame thread; either plane may be null. Both planes are width x height.
+    void process(uint8_t* yuyv, uint16_t* raw, int width, int height);
+
+private:
+    // Padding neighbour indices
+    static constexpr int32_t kPadLow = -1;
+    static constexpr int32_t kPadHigh = -2;
+
+    struct Map {
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> pixels;       // All defective pixels, sorted
+        std::vector<uint32_t> corrected;    // Those with at least one good neighbour
+        std::vector<int32_t> neighbors;     // 8 per corrected pixel
+        std::vector<uint16_t> oddMask;      // 0xFFFF when the real neighbour count is odd
+    };
+
+    static std::shared_ptr<const Map> compile(int width, int height, std::vector<uint32_t> pixels);
+
+    template <typename T, int Step>
+    static void correctPlane(const Map& map, T* plane);
+
+    void accumulate(const uint8_t* yuyv, const uint16_t* raw, int width, int height);
+    void finishLearning();
+
+    std::shared_ptr<const Map> map_;                    // Accessed with std::atomic_load/atomic_store
+    std::shared_ptr<const BadPixelLearnParams> learn_params_;
+    std::atomic<bool> learning_{false};
+    std::atomic<uint32_t> learn_generation_{0};
+
+    // Frame thread only
+    uint32_t seen_generation_ = 0;
+    int learned_frames_ = 0;
+    int learn_width_ = 0;
+    int learn_height_ = 0;
+    std::vector<uint64_t> sum_;
+    std::vector<uint64_t> sum_sq_;
+};
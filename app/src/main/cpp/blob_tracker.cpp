@@ -0,0 +1,316 @@
+#include "blob_tracker.h"
+#include "trace_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Maximum luma row the tracker converts without allocating
+constexpr int kMaxWidth = 1024;
+
+// Weight of the newest displacement in the smoothed velocity
+constexpr float kVelocitySmoothing = 0.5f;
+
+int64_t steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+BlobTracker::BlobTracker()
+    : runs_(kMaxRuns), components_(kMaxRuns), luma_row_(kMaxWidth) {
+    blobs_.reserve(kMaxBlobs);
+    tracks_.reserve(kMaxTracks);
+    published_.reserve(kMaxTracks);
+    configure(BlobTrackerParams());
+}
+
+void BlobTracker::configure(const BlobTrackerParams& params) {
+    std::atomic_store(&params_, std::shared_ptr<const BlobTrackerParams>(std::make_shared<BlobTrackerParams>(params)));
+    BLOB_LOGI("Blob tracking %s: threshold %.1f, min area %d, match distance %.0f px, %d missed frames",
+              params.enabled ? "enabled" : "disabled", params.threshold, params.minArea,
+              params.maxMatchDistance, params.maxMissedFrames);
+}
+
+BlobTrackerParams BlobTracker::getParams() const {
+    return *std::atomic_load(&params_);
+}
+
+void BlobTracker::process(const ThermalFrame& frame) {
+    const std::shared_ptr<const BlobTrackerParams> params = std::atomic_load(&params_);
+    if (!params->enabled) {
+        // Tracks from before the tracker was disabled must not keep being reported
+        if (!tracks_.empty()) {
+            tracks_.clear();
+            std::lock_guard<std::mutex> lock(result_mutex_);
+            published_.clear();
+            compute_us_ = 0;
+        }
+        return;
+    }
+    if ((!frame.celsius && !frame.image) || frame.width <= 0 || frame.height <= 0 ||
+        (!frame.celsius && frame.width > kMaxWidth)) {
+        return;
+    }
+    const int64_t start_us = steadyMicros();
+
+    run_count_ = 0;
+    previous_row_start_ = previous_row_end_ = 0;
+    overflowed_ = false;
+    for (int y = 0; y < frame.height && !overflowed_; y++) {
+        const float* row;
+        if (frame.celsius) {
+            row = frame.celsius + static_cast<size_t>(y) * frame.width;
+        } else {
+            const uint8_t* yuyv = frame.image + static_cast<size_t>(y) * frame.width * 2;
+            for (int x = 0; x < frame.width; x++) {
+                luma_row_[x] = yuyv[x * 2];
+            }
+            row = luma_row_.data();
+        }
+        labelRow(row, y, frame.width, params->threshold);
+    }
+    if (overflowed_) {
+        TRACE(BLOB_RUNS_OVERFLOW, kMaxRuns);
+    }
+
+    collectBlobs(params->minArea);
+    updateTracks(*params);
+
+    const int64_t elapsed_us = steadyMicros() - start_us;
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    published_.clear();
+    for (const Track& track : tracks_) {
+        if (track.missed == 0) {
+            published_.push_back(track.blob);
+        }
+    }
+    compute_us_ = elapsed_us;
+}
+
+int64_t BlobTracker::getTracks(std::vector<TrackedBlob>* out) {
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    *out = published_;
+    return compute_us_;
+}
+
+int BlobTracker::findRoot(int run) {
+    while (runs_[run].parent != run) {
+        runs_[run].parent = runs_[runs_[run].parent].parent;    // Path halving
+        run = runs_[run].parent;
+    }
+    return run;
+}
+
+void BlobTracker::unite(int a, int b) {
+    a = findRoot(a);
+    b = findRoot(b);
+    if (a == b) {
+        return;
+    }
+    if (a > b) {
+        std::swap(a, b);    // The older run stays the root
+    }
+
+    Component& into = components_[a];
+    const Component& from = components_[b];
+    into.area += from.area;
+    into.sumX += from.sumX;
+    into.sumY += from.sumY;
+    if (from.peak > into.peak) {
+        into.peak = from.peak;
+        into.peakX = from.peakX;
+        into.peakY = from.peakY;
+    }
+    into.left = std::min(into.left, from.left);
+    into.top = std::min(into.top, from.top);
+    into.right = std::max(into.right, from.right);
+    into.bottom = std::max(into.bottom, from.bottom);
+    runs_[b].parent = a;
+}
+
+bool BlobTracker::addRun(int y, int x0, int x1, const float* row) {
+    if (run_count_ >= kMaxRuns) {
+        overflowed_ = true;
+        return false;
+    }
+
+    const int index = run_count_++;
+    runs_[index] = {y, x0, x1, index};
+    Component& component = components_[index];
+    const int length = x1 - x0 + 1;
+    component.area = length;
+    component.sumX = static_cast<int64_t>(x0 + x1) * length / 2;
+    component.sumY = static_cast<int64_t>(y) * length;
+    component.peak = row[x0];
+    component.peakX = x0;
+    for (int x = x0 + 1; x <= x1; x++) {
+        if (row[x] > component.peak) {
+            component.peak = row[x];
+            component.peakX = x;
+        }
+    }
+    component.peakY = y;
+    component.left = x0;
+    component.right = x1;
+    component.top = component.bottom = y;
+
+    // 8-connectivity: runs of the row above touching [x0 - 1, x1 + 1]
+    for (int above = previous_row_start_; above < previous_row_end_; above++) {
+        if (runs_[above].x1 < x0 - 1) {
+            continue;
+        }
+        if (runs_[above].x0 > x1 + 1) {
+            break;
+        }
+        unite(above, index);
+    }
+    return true;
+}
+
+void BlobTracker::labelRow(const float* row, int y, int width, float threshold) {
+    const int row_start = run_count_;
+    int x = 0;
+    while (x < width) {
+#if defined(__ARM_NEON)
+        // Skip cold pixels four at a time
+        const float32x4_t limit = vdupq_n_f32(threshold);
+        while (x + 4 <= width) {
+            const uint32x4_t hot = vcgtq_f32(vld1q_f32(row + x), limit);
+            const uint32x2_t folded = vorr_u32(vget_low_u32(hot), vget_high_u32(hot));
+            if (vget_lane_u32(vpmax_u32(folded, folded), 0) != 0) {
+                break;
+            }
+            x += 4;
+        }
+#endif
+        while (x < width && !(row[x] > threshold)) {
+            x++;
+        }
+        if (x >= width) {
+            break;
+        }
+        const int run_start = x;
+        while (x < width && row[x] > threshold) {
+            x++;
+        }
+        if (!addRun(y, run_start, x - 1, row)) {
+            return;
+        }
+    }
+    previous_row_start_ = row_start;
+    previous_row_end_ = run_count_;
+}
+
+void BlobTracker::collectBlobs(int minArea) {
+    blobs_.clear();
+    for (int run = 0; run < run_count_; run++) {
+        if (runs_[run].parent != run || components_[run].area < minArea) {
+            continue;
+        }
+        const Component& c = components_[run];
+        TrackedBlob blob = {};
+        blob.area = c.area;
+        blob.centroidX = static_cast<float>(c.sumX) / c.area;
+        blob.centroidY = static_cast<float>(c.sumY) / c.area;
+        blob.peak = c.peak;
+        blob.peakX = c.peakX;
+        blob.peakY = c.peakY;
+        blob.left = c.left;
+        blob.top = c.top;
+        blob.right = c.right;
+        blob.bottom = c.bottom;
+
+        // Keep the largest kMaxBlobs
+        if (blobs_.size() < static_cast<size_t>(kMaxBlobs)) {
+            blobs_.push_back(blob);
+        } else {
+            auto smallest = std::min_element(blobs_.begin(), blobs_.end(),
+                [](const TrackedBlob& a, const TrackedBlob& b) { return a.area < b.area; });
+            if (smallest->area < blob.area) {
+                *smallest = blob;
+            }
+        }
+    }
+}
+
+void BlobTracker::updateTracks(const BlobTrackerParams& params) {
+    // Greedy matching: repeatedly take the closest unmatched track/blob pair in range
+    bool blob_matched[kMaxBlobs] = {};
+    bool track_matched[kMaxTracks] = {};
+    const float max_distance_sq = params.maxMatchDistance * params.maxMatchDistance;
+    while (true) {
+        float best = max_distance_sq;
+        int best_track = -1;
+        int best_blob = -1;
+        for (size_t t = 0; t < tracks_.size(); t++) {
+            if (track_matched[t]) {
+                continue;
+            }
+            const TrackedBlob& previous = tracks_[t].blob;
+            const float predicted_x = previous.centroidX + previous.velocityX * (tracks_[t].missed + 1);
+            const float predicted_y = previous.centroidY + previous.velocityY * (tracks_[t].missed + 1);
+            for (size_t b = 0; b < blobs_.size(); b++) {
+                if (blob_matched[b]) {
+                    continue;
+                }
+                const float dx = blobs_[b].centroidX - predicted_x;
+                const float dy = blobs_[b].centroidY - predicted_y;
+                const float distance_sq = dx * dx + dy * dy;
+                if (distance_sq <= best) {
+                    best = distance_sq;
+                    best_track = static_cast<int>(t);
+                    best_blob = static_cast<int>(b);
+                }
+            }
+        }
+        if (best_track < 0) {
+            break;
+        }
+
+        Track& track = tracks_[best_track];
+        TrackedBlob updated = blobs_[best_blob];
+        const float frames = static_cast<float>(track.missed + 1);
+        updated.id = track.blob.id;
+        updated.age = track.blob.age + track.missed + 1;
+        updated.velocityX = track.blob.velocityX +
+            kVelocitySmoothing * ((updated.centroidX - track.blob.centroidX) / frames - track.blob.velocityX);
+        updated.velocityY = track.blob.velocityY +
+            kVelocitySmoothing * ((updated.centroidY - track.blob.centroidY) / frames - track.blob.velocityY);
+        track.blob = updated;
+        track.missed = 0;
+        track_matched[best_track] = true;
+        blob_matched[best_blob] = true;
+    }
+
+    // Unmatched tracks age out; erasing keeps the remaining tracks in creation order
+    size_t kept = 0;
+    for (size_t t = 0; t < tracks_.size(); t++) {
+        if (!track_matched[t] && ++tracks_[t].missed > params.maxMissedFrames) {
+            continue;
+        }
+        tracks_[kept++] = tracks_[t];
+    }
+    tracks_.resize(kept);
+
+    // Unmatched blobs start new tracks while there is room
+    for (size_t b = 0; b < blobs_.size() && tracks_.size() < static_cast<size_t>(kMaxTracks); b++) {
+        if (blob_matched[b]) {
+            continue;
+        }
+        Track track;
+        track.blob = blobs_[b];
+        track.blob.id = next_id_++;
+        track.blob.age = 1;
+        track.blob.velocityX = track.blob.velocityY = 0.0f;
+        track.missed = 0;
+        tracks_.push_back(track);
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <android/log.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "radiometric.h"
+
+// Logging macros
+#define BLOB_TAG "BlobTracker"
+#define BLOB_LOGI(...) __android_log_print(ANDROID_LOG_INFO, BLOB_TAG, __VA_ARGS__)
+#define BLOB_LOGW(...) __android_log_print(ANDROID_LOG_WARN, BLOB_TAG, __VA_ARGS__)
+
+struct BlobTrackerParams {
+    bool enabled = false;
+    float threshold = 40.0f;        // Pixels above it are hot: °C, or luma without a temperature plane
+    int minArea = 4;                // Smaller components are ignored
+    float maxMatchDistance = 24.0f; // Pixels a centroid may move between frames and keep its id
+    int maxMissedFrames = 5;        // Frames a track survives without a matching blob
+};
+
+// One tracked hot object on the latest frame
+struct TrackedBlob {
+    int id;                         // Stable while the object is tracked
+    int age;                        // Frames since the track started
+    int area;
+    float centroidX;
+    float centroidY;
+    float peak;
+    int peakX;
+    int peakY;
+    int left, top, right, bottom;   // Inclusive bounding box
+    float velocityX;                // Pixels per frame, smoothed
+    float velocityY;
+};
+
+// Floats per blob in the array filled by nativeGetTrackedBlobs; keep in sync with CameraActivity.BLOB_*
+enum TrackedBlobIndex {
+    BLOB_ID = 0,
+    BLOB_AGE,
+    BLOB_AREA,
+    BLOB_CENTROID_X,
+    BLOB_CENTROID_Y,
+    BLOB_PEAK,
+    BLOB_PEAK_X,
+    BLOB_PEAK_Y,
+    BLOB_LEFT,
+    BLOB_TOP,
+    BLOB_RIGHT,
+    BLOB_BOTTOM,
+    BLOB_VELOCITY_X,
+    BLOB_VELOCITY_Y,
+    BLOB_STRIDE
+};
+
+/**
+ * Hot object detection and frame-to-frame tracking.
+ *
+ * Each row is thresholded into runs of hot pixels (NEON skips four cold pixels at a time);
+ * a run overlapping a run of the row above, diagonals included, joins its component through
+ * union-find, so labeling takes a single pass over the frame. Area, centroid, peak and
+ * bounding box are accumulated in the component's root as runs are merged. Blobs are then
+ * matched to the previous frame's tracks greedily by centroid distance. All storage is
+ * sized at construction: a frame with more than kMaxRuns runs is labeled up to that run.
+ */
+class BlobTracker {
+public:
+    static constexpr int kMaxRuns = 8192;
+    static constexpr int kMaxBlobs = 64;
+    static constexpr int kMaxTracks = 32;
+
+    BlobTracker();
+
+    // Any thread; applied from the next frame
+    void configure(const BlobTrackerParams& params);
+    BlobTrackerParams getParams() const;
+
+    // Frame thread
+    void process(const ThermalFrame& frame);
+
+    // Tracks of the latest processed frame; returns how long that frame took in microseconds
+    int64_t getTracks(std::vector<TrackedBlob>* out);
+
+private:
+    struct Run {
+        int y;
+        int x0;
+        int x1;                     // Inclusive
+        int parent;                 // Union-find over run indices
+    };
+
+    struct Component {
+        int area;
+        int64_t sumX;
+        int64_t sumY;
+        float peak;
+        int peakX;
+        int peakY;
+        int left, top, right, bottom;
+    };
+
+    struct Track {
+        TrackedBlob blob;
+        int missed;
+    };
+
+    int findRoot(int run);
+    void unite(int a, int b);
+    bool addRun(int y, int x0, int x1, const float* row);
+    void labelRow(const float* row, int y, int width, float threshold);
+    void collectBlobs(int minArea);
+    void updateTracks(const BlobTrackerParams& params);
+
+    std::shared_ptr<const BlobTrackerParams> params_;   // Accessed with std::atomic_load/atomic_store
+
+    // Frame thread only, capacity fixed at construction
+    std::vector<Run> runs_;
+    std::vector<Component> components_;     // Indexed like runs_, valid at roots
+    std::vector<TrackedBlob> blobs_;
+    std::vector<Track> tracks_;
+    std::vector<float> luma_row_;
+    int run_count_ = 0;
+    int previous_row_start_ = 0;
+    int previous_row_end_ = 0;
+    bool overflowed_ = false;
+    int next_id_ = 1;
+
+    std::mutex result_mutex_;
+    std::vector<TrackedBlob> published_;
+    int64_t compute_us_ = 0;
+};
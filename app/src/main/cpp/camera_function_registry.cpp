@@ -2,24 +2,190 @@
 #include "libircmd.h"
 #include <sstream>
 
-void CameraFunctionRegistry::registerSetFunction(CameraFunctionId id, SetFunction func) {
-    setFunctions_[id] = func;
-    REGISTRY_LOGI("Registered SET function for ID: %d", static_cast<int>(id));
+namespace {
+
+// Batch apply priorities, see CameraFunctionRegistry::getApplyPriority()
+constexpr uint8_t kPriorityDevice = 0;   // Stream/device configuration, the image pipeline depends on it
+constexpr uint8_t kPriorityScene = 1;    // Scene mode loads a full set of image levels on the device
+constexpr uint8_t kPriorityPalette = 2;
+constexpr uint8_t kPriorityImage = 3;    // Individual image levels override whatever the scene mode loaded
+constexpr uint8_t kPriorityShutter = 4;  // Last, so a freeze or shutter close is not undone by the steps above
+
+int gammaLevelNotImplemented(IrcmdHandle_t* handle, int value) {
+    // Note: This function may not exist in all SDK versions
+    REGISTRY_LOGW("Gamma level function not implemented in current SDK");
+    return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
 }
 
-void CameraFunctionRegistry::registerSetFunction2(CameraFunctionId id, SetFunction2 func) {
-    setFunctions2_[id] = func;
-    REGISTRY_LOGI("Registered SET2 function for ID: %d", static_cast<int>(id));
+// Dispatch table, one row per CameraFunctionId in denseFunctionIndex() order
+constexpr FunctionTableEntry kFunctionTable[] = {
+    // Image processing functions
+    {CameraFunctionId::BRIGHTNESS,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_image_brightness_level_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_current_brightness_level_get(handle, value)); },
+     nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_attribute_of_brightness_level_get(handle, attribute)); }},
+    {CameraFunctionId::CONTRAST,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_image_contrast_level_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_current_contrast_level_get(handle, value)); },
+     nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_attribute_of_contrast_level_get(handle, attribute)); }},
+    {CameraFunctionId::GLOBAL_CONTRAST,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_global_contrast_level_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_global_contrast_level_get(handle, value)); },
+     nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_attribute_of_global_contrast_level_get(handle, attribute)); }},
+    {CameraFunctionId::DETAIL_ENHANCEMENT,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_image_detail_enhance_level_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_current_detail_enhance_level_get(handle, value)); },
+     nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_attribute_of_detail_enhance_level_get(handle, attribute)); }},
+    {CameraFunctionId::NOISE_REDUCTION,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_image_noise_reduction_level_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_current_image_noise_reduction_level_get(handle, value)); },
+     nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_attribute_of_noise_reduction_level_get(handle, attribute)); }},
+    {CameraFunctionId::ROI_LEVEL,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_image_roi_level_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_current_image_roi_level_get(handle, value)); },
+     nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_attribute_of_roi_level_get(handle, attribute)); }},
+    {CameraFunctionId::AGC_LEVEL,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_image_agc_level_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_current_agc_level_get(handle, value)); },
+     nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_attribute_of_agc_level_get(handle, attribute)); }},
+
+    // Scene and palette functions
+    {CameraFunctionId::SCENE_MODE,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_image_scene_mode_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_current_image_scene_mode_get(handle, value)); },
+     nullptr, kPriorityScene, false,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_attribute_of_scene_mode_get(handle, attribute)); }},
+    {CameraFunctionId::PALETTE_INDEX,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_palette_idx_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_palette_idx_get(handle, value)); },
+     nullptr, kPriorityPalette, false, nullptr},
+
+    // FFC (Flat Field Correction) function
+    {CameraFunctionId::FFC_UPDATE, nullptr, nullptr, nullptr,
+     [](IrcmdHandle_t* handle) -> int { return static_cast<int>(basic_ffc_update(handle)); },
+     kPriorityShutter, false, nullptr},
+
+    // Advanced functions - these may return errors if the device does not support them
+    {CameraFunctionId::GAMMA_LEVEL, gammaLevelNotImplemented, nullptr, nullptr, nullptr, kPriorityImage, true, nullptr},
+    {CameraFunctionId::EDGE_ENHANCE,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(adv_edge_enhance_set(handle, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(adv_edge_enhance_get(handle, value)); },
+     nullptr, kPriorityImage, true, nullptr},
+    // Time/space noise reduction levels (used by presets together with NOISE_REDUCTION)
+    {CameraFunctionId::TIME_NOISE_REDUCTION,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_time_noise_reduce_level_set(handle, value)); },
+     nullptr, nullptr, nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_time_noise_reduce_attribute_get(handle, attribute)); }},
+    {CameraFunctionId::SPACE_NOISE_REDUCTION,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_space_noise_reduce_level_set(handle, value)); },
+     nullptr, nullptr, nullptr, kPriorityImage, true,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_space_noise_reduce_attribute_get(handle, attribute)); }},
+
+    // Device control functions (MINI2-compatible SET only)
+    {CameraFunctionId::DEVICE_SLEEP,
+     [](IrcmdHandle_t* handle, int status) -> int { return static_cast<int>(adv_device_sleep_set(handle, status)); },
+     nullptr, nullptr, nullptr, kPriorityDevice, false, nullptr},
+    // Analog video output (2 parameters: status, format)
+    {CameraFunctionId::ANALOG_VIDEO_OUTPUT, nullptr,
+     [](IrcmdHandle_t* handle, int status, int format) -> int { return static_cast<int>(adv_analog_video_output_set(handle, status, format)); },
+     nullptr, nullptr, kPriorityDevice, false, nullptr},
+    {CameraFunctionId::OUTPUT_FRAME_RATE,
+     [](IrcmdHandle_t* handle, int rate) -> int { return static_cast<int>(adv_output_frame_rate_set(handle, rate)); },
+     nullptr, nullptr, nullptr, kPriorityDevice, false, nullptr},
+    {CameraFunctionId::YUV_FORMAT,
+     [](IrcmdHandle_t* handle, int format) -> int { return static_cast<int>(adv_yuv_format_set(handle, format)); },
+     nullptr, nullptr, nullptr, kPriorityDevice, false, nullptr},
+    {CameraFunctionId::SHUTTER_STATUS,
+     [](IrcmdHandle_t* handle, int status) -> int { return static_cast<int>(adv_shutter_status_set(handle, status)); },
+     nullptr, nullptr, nullptr, kPriorityShutter, false, nullptr},
+    {CameraFunctionId::PICTURE_FREEZE,
+     [](IrcmdHandle_t* handle, int status) -> int { return static_cast<int>(adv_picture_freeze_status_set(handle, status)); },
+     nullptr, nullptr, nullptr, kPriorityShutter, false, nullptr},
+    {CameraFunctionId::MIRROR_AND_FLIP,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_mirror_and_flip_status_set(handle, value)); },
+     nullptr, nullptr, nullptr, kPriorityDevice, false, nullptr},
+    {CameraFunctionId::AUTO_FFC_STATUS,
+     [](IrcmdHandle_t* handle, int status) -> int { return static_cast<int>(basic_auto_ffc_status_set(handle, status)); },
+     nullptr, nullptr, nullptr, kPriorityShutter, false, nullptr},
+    {CameraFunctionId::ALL_FFC_FUNCTION_STATUS,
+     [](IrcmdHandle_t* handle, int status) -> int { return static_cast<int>(basic_all_ffc_function_status_set(handle, status)); },
+     nullptr, nullptr, nullptr, kPriorityShutter, false, nullptr},
+    {CameraFunctionId::STREAM_SOURCE_MODE,
+     [](IrcmdHandle_t* handle, int mode) -> int { return static_cast<int>(adv_stream_source_mode_set(handle, mode)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* mode) -> int { return static_cast<int>(adv_stream_source_mode_get(handle, mode)); },
+     nullptr, kPriorityDevice, false, nullptr},
+    // Auto FFC parameters, one row per basic_auto_ffc_param_e so each keeps its own value and range
+    {CameraFunctionId::AUTO_FFC_TEMP_THRESHOLD,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_auto_ffc_current_params_set(handle, BASIC_AUTO_TEMP_THRESHOLD, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_auto_ffc_current_params_get(handle, BASIC_AUTO_TEMP_THRESHOLD, value)); },
+     nullptr, kPriorityShutter, false,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_auto_ffc_params_attribute_get(handle, BASIC_AUTO_TEMP_THRESHOLD, attribute)); }},
+    {CameraFunctionId::AUTO_FFC_MIN_INTERVAL,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_auto_ffc_current_params_set(handle, BASIC_AUTO_MIN_INTERVAL, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_auto_ffc_current_params_get(handle, BASIC_AUTO_MIN_INTERVAL, value)); },
+     nullptr, kPriorityShutter, false,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_auto_ffc_params_attribute_get(handle, BASIC_AUTO_MIN_INTERVAL, attribute)); }},
+    {CameraFunctionId::AUTO_FFC_MAX_INTERVAL,
+     [](IrcmdHandle_t* handle, int value) -> int { return static_cast<int>(basic_auto_ffc_current_params_set(handle, BASIC_AUTO_MAX_INTERVAL, value)); },
+     nullptr,
+     [](IrcmdHandle_t* handle, int* value) -> int { return static_cast<int>(basic_auto_ffc_current_params_get(handle, BASIC_AUTO_MAX_INTERVAL, value)); },
+     nullptr, kPriorityShutter, false,
+     [](IrcmdHandle_t* handle, param_attribute_t* attribute) -> int { return static_cast<int>(basic_auto_ffc_params_attribute_get(handle, BASIC_AUTO_MAX_INTERVAL, attribute)); }},
+};
+
+constexpr int kTableSize = static_cast<int>(sizeof(kFunctionTable) / sizeof(kFunctionTable[0]));
+
+// Every row must sit at its own dense index; together with the size check this rules out
+// duplicate, missing and out-of-order IDs.
+constexpr bool tableIsDense() {
+    for (int i = 0; i < kTableSize; i++) {
+        if (denseFunctionIndex(kFunctionTable[i].id) != i) {
+            return false;
+        }
+    }
+    return true;
 }
 
-void CameraFunctionRegistry::registerGetFunction(CameraFunctionId id, GetFunction func) {
-    getFunctions_[id] = func;
-    REGISTRY_LOGI("Registered GET function for ID: %d", static_cast<int>(id));
+constexpr size_t countOperations() {
+    size_t count = 0;
+    for (const auto& entry : kFunctionTable) {
+        count += (entry.set != nullptr) + (entry.set2 != nullptr) + (entry.get != nullptr) + (entry.action != nullptr);
+    }
+    return count;
 }
 
-void CameraFunctionRegistry::registerActionFunction(CameraFunctionId id, ActionFunction func) {
-    actionFunctions_[id] = func;
-    REGISTRY_LOGI("Registered ACTION function for ID: %d", static_cast<int>(id));
+static_assert(kTableSize == kFunctionCount, "Function table must have one row per CameraFunctionId");
+static_assert(tableIsDense(), "Function table has a duplicate, missing or misplaced CameraFunctionId");
+static_assert(denseFunctionIndex(functionIdAtIndex(kFunctionCount - 1)) == kFunctionCount - 1,
+              "functionIdAtIndex must invert denseFunctionIndex");
+
+} // namespace
+
+std::atomic<bool> CameraFunctionRegistry::verbose_logging_{false};
+
+const FunctionTableEntry* CameraFunctionRegistry::lookup(CameraFunctionId id) {
+    const int index = denseFunctionIndex(id);
+    return index >= 0 ? &kFunctionTable[index] : nullptr;
 }
 
 int CameraFunctionRegistry::executeSetFunction(CameraFunctionId id, IrcmdHandle_t* handle, int value) {
@@ -28,17 +194,18 @@ int CameraFunctionRegistry::executeSetFunction(CameraFunctionId id, IrcmdHandle_
         return static_cast<int>(RegistryError::INVALID_HANDLE);
     }
 
-    auto it = setFunctions_.find(id);
-    if (it == setFunctions_.end()) {
+    const FunctionTableEntry* entry = lookup(id);
+    if (!entry || !entry->set) {
         REGISTRY_LOGE("SET function not found for ID: %d", static_cast<int>(id));
         return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
     }
 
-    REGISTRY_LOGI("Executing SET function ID: %d with value: %d", static_cast<int>(id), value);
-    int result = it->second(handle, value);
+    REGISTRY_LOGV("Executing SET function ID: %d with value: %d", static_cast<int>(id), value);
+    TRACE(REGISTRY_SET, static_cast<int>(id), value);
+    int result = entry->set(handle, value);
     
     if (result != 0) {
-        REGISTRY_LOGW("SET function ID: %d failed with SDK error: %d", static_cast<int>(id), result);
+        TRACE(REGISTRY_SET_FAILED, static_cast<int>(id), result);
     }
     
     return result;
@@ -50,17 +217,18 @@ int CameraFunctionRegistry::executeSetFunction2(CameraFunctionId id, IrcmdHandle
         return static_cast<int>(RegistryError::INVALID_HANDLE);
     }
 
-    auto it = setFunctions2_.find(id);
-    if (it == setFunctions2_.end()) {
+    const FunctionTableEntry* entry = lookup(id);
+    if (!entry || !entry->set2) {
         REGISTRY_LOGE("SET2 function not found for ID: %d", static_cast<int>(id));
         return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
     }
 
-    REGISTRY_LOGI("Executing SET2 function ID: %d with values: %d, %d", static_cast<int>(id), value1, value2);
-    int result = it->second(handle, value1, value2);
+    REGISTRY_LOGV("Executing SET2 function ID: %d with values: %d, %d", static_cast<int>(id), value1, value2);
+    TRACE(REGISTRY_SET2, static_cast<int>(id), value1, value2);
+    int result = entry->set2(handle, value1, value2);
     
     if (result != 0) {
-        REGISTRY_LOGW("SET2 function ID: %d failed with SDK error: %d", static_cast<int>(id), result);
+        TRACE(REGISTRY_SET2_FAILED, static_cast<int>(id), result);
     }
     
     return result;
@@ -72,19 +240,20 @@ int CameraFunctionRegistry::executeGetFunction(CameraFunctionId id, IrcmdHandle_
         return static_cast<int>(RegistryError::INVALID_PARAMETER);
     }
 
-    auto it = getFunctions_.find(id);
-    if (it == getFunctions_.end()) {
+    const FunctionTableEntry* entry = lookup(id);
+    if (!entry || !entry->get) {
         REGISTRY_LOGE("GET function not found for ID: %d", static_cast<int>(id));
         return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
     }
 
-    REGISTRY_LOGI("Executing GET function ID: %d", static_cast<int>(id));
-    int result = it->second(handle, value);
+    REGISTRY_LOGV("Executing GET function ID: %d", static_cast<int>(id));
+    int result = entry->get(handle, value);
     
     if (result == 0) {
-        REGISTRY_LOGI("GET function ID: %d returned value: %d", static_cast<int>(id), *value);
+        REGISTRY_LOGV("GET function ID: %d returned value: %d", static_cast<int>(id), *value);
+        TRACE(REGISTRY_GET, static_cast<int>(id), *value);
     } else {
-        REGISTRY_LOGW("GET function ID: %d failed with SDK error: %d", static_cast<int>(id), result);
+        TRACE(REGISTRY_GET_FAILED, static_cast<int>(id), result);
     }
     
     return result;
@@ -96,243 +265,146 @@ int CameraFunctionRegistry::executeActionFunction(CameraFunctionId id, IrcmdHand
         return static_cast<int>(RegistryError::INVALID_HANDLE);
     }
 
-    auto it = actionFunctions_.find(id);
-    if (it == actionFunctions_.end()) {
+    const FunctionTableEntry* entry = lookup(id);
+    if (!entry || !entry->action) {
         REGISTRY_LOGE("ACTION function not found for ID: %d", static_cast<int>(id));
         return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
     }
 
-    REGISTRY_LOGI("Executing ACTION function ID: %d", static_cast<int>(id));
-    int result = it->second(handle);
+    REGISTRY_LOGV("Executing ACTION function ID: %d", static_cast<int>(id));
+    TRACE(REGISTRY_ACTION, static_cast<int>(id));
+    int result = entry->action(handle);
     
     if (result != 0) {
-        REGISTRY_LOGW("ACTION function ID: %d failed with SDK error: %d", static_cast<int>(id), result);
+        TRACE(REGISTRY_ACTION_FAILED, static_cast<int>(id), result);
     }
     
     return result;
 }
 
+int CameraFunctionRegistry::executeAttributeFunction(CameraFunctionId id, IrcmdHandle_t* handle, param_attribute_t* attribute) {
+    if (!handle || !attribute) {
+        REGISTRY_LOGE("Invalid parameters for ATTRIBUTE function ID: %d", static_cast<int>(id));
+        return static_cast<int>(RegistryError::INVALID_PARAMETER);
+    }
+
+    const FunctionTableEntry* entry = lookup(id);
+    if (!entry || !entry->attribute) {
+        REGISTRY_LOGE("ATTRIBUTE function not found for ID: %d", static_cast<int>(id));
+        return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
+    }
+
+    REGISTRY_LOGV("Executing ATTRIBUTE function ID: %d", static_cast<int>(id));
+    int result = entry->attribute(handle, attribute);
+
+    if (result == 0) {
+        REGISTRY_LOGV("ATTRIBUTE function ID: %d returned min: %u, max: %u, step: %u", static_cast<int>(id),
+                      attribute->min_value, attribute->max_value, attribute->step);
+        TRACE(REGISTRY_ATTRIBUTE, static_cast<int>(id), attribute->min_value, attribute->max_value, attribute->step);
+    } else {
+        TRACE(REGISTRY_ATTRIBUTE_FAILED, static_cast<int>(id), result);
+    }
+
+    return result;
+}
+
 bool CameraFunctionRegistry::isSetFunctionRegistered(CameraFunctionId id) const {
-    return setFunctions_.find(id) != setFunctions_.end();
+    const FunctionTableEntry* entry = lookup(id);
+    return entry && entry->set;
 }
 
 bool CameraFunctionRegistry::isSetFunction2Registered(CameraFunctionId id) const {
-    return setFunctions2_.find(id) != setFunctions2_.end();
+    const FunctionTableEntry* entry = lookup(id);
+    return entry && entry->set2;
 }
 
 bool CameraFunctionRegistry::isGetFunctionRegistered(CameraFunctionId id) const {
-    return getFunctions_.find(id) != getFunctions_.end();
+    const FunctionTableEntry* entry = lookup(id);
+    return entry && entry->get;
 }
 
 bool CameraFunctionRegistry::isActionFunctionRegistered(CameraFunctionId id) const {
-    return actionFunctions_.find(id) != actionFunctions_.end();
+    const FunctionTableEntry* entry = lookup(id);
+    return entry && entry->action;
 }
 
-void CameraFunctionRegistry::initializeAllFunctions() {
-    REGISTRY_LOGI("Initializing all camera functions...");
-    
-    initializeImageProcessingFunctions();
-    initializeSceneAndPaletteFunctions();
-    initializeActionFunctions();
-    initializeAdvancedFunctions();
-    initializeDeviceControlFunctions();
-    
-    REGISTRY_LOGI("Function registry initialization complete. Total functions: %zu", getRegisteredFunctionCount());
-    logRegisteredFunctions();
+bool CameraFunctionRegistry::isAttributeFunctionRegistered(CameraFunctionId id) const {
+    const FunctionTableEntry* entry = lookup(id);
+    return entry && entry->attribute;
 }
 
-void CameraFunctionRegistry::initializeImageProcessingFunctions() {
-    REGISTRY_LOGI("Initializing image processing functions...");
-    
-    // Brightness functions
-    registerSetFunction(CameraFunctionId::BRIGHTNESS, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_image_brightness_level_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::BRIGHTNESS, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_current_brightness_level_get(handle, value));
-    });
-
-    // Contrast functions
-    registerSetFunction(CameraFunctionId::CONTRAST, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_image_contrast_level_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::CONTRAST, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_current_contrast_level_get(handle, value));
-    });
-
-    // Global contrast functions
-    registerSetFunction(CameraFunctionId::GLOBAL_CONTRAST, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_global_contrast_level_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::GLOBAL_CONTRAST, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_global_contrast_level_get(handle, value));
-    });
-
-    // Detail enhancement functions
-    registerSetFunction(CameraFunctionId::DETAIL_ENHANCEMENT, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_image_detail_enhance_level_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::DETAIL_ENHANCEMENT, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_current_detail_enhance_level_get(handle, value));
-    });
-
-    // Noise reduction functions
-    registerSetFunction(CameraFunctionId::NOISE_REDUCTION, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_image_noise_reduction_level_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::NOISE_REDUCTION, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_current_image_noise_reduction_level_get(handle, value));
-    });
-
-    // ROI level functions
-    registerSetFunction(CameraFunctionId::ROI_LEVEL, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_image_roi_level_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::ROI_LEVEL, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_current_image_roi_level_get(handle, value));
-    });
-
-    // AGC level functions
-    registerSetFunction(CameraFunctionId::AGC_LEVEL, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_image_agc_level_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::AGC_LEVEL, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_current_agc_level_get(handle, value));
-    });
+void CameraFunctionRegistry::initializeAllFunctions() {
+    REGISTRY_LOGI("Function registry ready (static table). Total functions: %zu", getRegisteredFunctionCount());
+    if (isVerboseLogging()) {
+        logRegisteredFunctions();
+    }
 }
 
-void CameraFunctionRegistry::initializeSceneAndPaletteFunctions() {
-    REGISTRY_LOGI("Initializing scene and palette functions...");
-    
-    // Scene mode functions
-    registerSetFunction(CameraFunctionId::SCENE_MODE, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_image_scene_mode_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::SCENE_MODE, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_current_image_scene_mode_get(handle, value));
-    });
-
-    // Palette functions
-    registerSetFunction(CameraFunctionId::PALETTE_INDEX, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_palette_idx_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::PALETTE_INDEX, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(basic_palette_idx_get(handle, value));
-    });
+size_t CameraFunctionRegistry::getRegisteredFunctionCount() const {
+    return countOperations();
 }
 
-void CameraFunctionRegistry::initializeActionFunctions() {
-    REGISTRY_LOGI("Initializing action functions...");
-    
-    // FFC (Flat Field Correction) function
-    registerActionFunction(CameraFunctionId::FFC_UPDATE, [](IrcmdHandle_t* handle) -> int {
-        return static_cast<int>(basic_ffc_update(handle));
-    });
+void CameraFunctionRegistry::logRegisteredFunctions() const {
+    size_t setCount = 0, set2Count = 0, getCount = 0, actionCount = 0;
+    std::stringstream ss;
+    ss << "SET function IDs: ";
+    for (const auto& entry : kFunctionTable) {
+        setCount += entry.set != nullptr;
+        set2Count += entry.set2 != nullptr;
+        getCount += entry.get != nullptr;
+        actionCount += entry.action != nullptr;
+        if (entry.set) {
+            ss << static_cast<int>(entry.id) << " ";
+        }
+    }
+
+    REGISTRY_LOGI("=== Registered Functions Summary ===");
+    REGISTRY_LOGI("SET functions: %zu", setCount);
+    REGISTRY_LOGI("SET2 functions: %zu", set2Count);
+    REGISTRY_LOGI("GET functions: %zu", getCount);
+    REGISTRY_LOGI("ACTION functions: %zu", actionCount);
+    REGISTRY_LOGI("Total functions: %zu", getRegisteredFunctionCount());
+    REGISTRY_LOGI("%s", ss.str().c_str());
 }
 
-void CameraFunctionRegistry::initializeAdvancedFunctions() {
-    REGISTRY_LOGI("Initializing advanced functions...");
-    
-    // These functions may not be available on all devices
-    // We register them but they may return errors if not supported
-    
-    // Gamma level functions (if available)
-    registerSetFunction(CameraFunctionId::GAMMA_LEVEL, [](IrcmdHandle_t* handle, int value) -> int {
-        // Note: This function may not exist in all SDK versions
-        // Return not implemented error for now
-        REGISTRY_LOGW("Gamma level function not implemented in current SDK");
-        return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
-    });
-    
-    // Edge enhance functions (if available)
-    registerSetFunction(CameraFunctionId::EDGE_ENHANCE, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(adv_edge_enhance_set(handle, value));
-    });
-    
-    registerGetFunction(CameraFunctionId::EDGE_ENHANCE, [](IrcmdHandle_t* handle, int* value) -> int {
-        return static_cast<int>(adv_edge_enhance_get(handle, value));
-    });
+int CameraFunctionRegistry::getApplyPriority(CameraFunctionId id) const {
+    const FunctionTableEntry* entry = lookup(id);
+    return entry ? entry->applyPriority : kPriorityImage;
 }
 
-void CameraFunctionRegistry::initializeDeviceControlFunctions() {
-    REGISTRY_LOGI("Initializing device control functions (MINI2-compatible SET only)...");
-    
-    // Device sleep control
-    registerSetFunction(CameraFunctionId::DEVICE_SLEEP, [](IrcmdHandle_t* handle, int status) -> int {
-        return static_cast<int>(adv_device_sleep_set(handle, status));
-    });
-    
-    // Analog video output (2 parameters: status, format) 
-    registerSetFunction2(CameraFunctionId::ANALOG_VIDEO_OUTPUT, [](IrcmdHandle_t* handle, int status, int format) -> int {
-        return static_cast<int>(adv_analog_video_output_set(handle, status, format));
-    });
-    
-    // Output frame rate
-    registerSetFunction(CameraFunctionId::OUTPUT_FRAME_RATE, [](IrcmdHandle_t* handle, int rate) -> int {
-        return static_cast<int>(adv_output_frame_rate_set(handle, rate));
-    });
-    
-    // YUV format
-    registerSetFunction(CameraFunctionId::YUV_FORMAT, [](IrcmdHandle_t* handle, int format) -> int {
-        return static_cast<int>(adv_yuv_format_set(handle, format));
-    });
-    
-    // Shutter status
-    registerSetFunction(CameraFunctionId::SHUTTER_STATUS, [](IrcmdHandle_t* handle, int status) -> int {
-        return static_cast<int>(adv_shutter_status_set(handle, status));
-    });
-    
-    // Picture freeze
-    registerSetFunction(CameraFunctionId::PICTURE_FREEZE, [](IrcmdHandle_t* handle, int status) -> int {
-        return static_cast<int>(adv_picture_freeze_status_set(handle, status));
-    });
-    
-    // Mirror and flip
-    registerSetFunction(CameraFunctionId::MIRROR_AND_FLIP, [](IrcmdHandle_t* handle, int value) -> int {
-        return static_cast<int>(basic_mirror_and_flip_status_set(handle, value));
-    });
-    
-    // Auto FFC status
-    registerSetFunction(CameraFunctionId::AUTO_FFC_STATUS, [](IrcmdHandle_t* handle, int status) -> int {
-        return static_cast<int>(basic_auto_ffc_status_set(handle, status));
-    });
-    
-    // All FFC function status
-    registerSetFunction(CameraFunctionId::ALL_FFC_FUNCTION_STATUS, [](IrcmdHandle_t* handle, int status) -> int {
-        return static_cast<int>(basic_all_ffc_function_status_set(handle, status));
-    });
-    
-    REGISTRY_LOGI("Device control functions initialized");
+bool CameraFunctionRegistry::isImageLevel(CameraFunctionId id) const {
+    const FunctionTableEntry* entry = lookup(id);
+    return entry && entry->imageLevel;
 }
 
-size_t CameraFunctionRegistry::getRegisteredFunctionCount() const {
-    return setFunctions_.size() + setFunctions2_.size() + getFunctions_.size() + actionFunctions_.size();
+bool CameraFunctionRegistry::invalidatesImageLevels(CameraFunctionId id) const {
+    return id == CameraFunctionId::SCENE_MODE;
 }
 
-void CameraFunctionRegistry::logRegisteredFunctions() const {
-    REGISTRY_LOGI("=== Registered Functions Summary ===");
-    REGISTRY_LOGI("SET functions: %zu", setFunctions_.size());
-    REGISTRY_LOGI("SET2 functions: %zu", setFunctions2_.size());
-    REGISTRY_LOGI("GET functions: %zu", getFunctions_.size());
-    REGISTRY_LOGI("ACTION functions: %zu", actionFunctions_.size());
-    REGISTRY_LOGI("Total functions: %zu", getRegisteredFunctionCount());
-    
-    // Log specific function IDs for debugging
-    std::stringstream ss;
-    ss << "SET function IDs: ";
-    for (const auto& pair : setFunctions_) {
-        ss << static_cast<int>(pair.first) << " ";
+bool CameraFunctionRegistry::isPersistent(CameraFunctionId id) const {
+    // Explicit list, so a new function is not replayed on reconnect until someone decides it should be
+    switch (id) {
+        case CameraFunctionId::BRIGHTNESS:
+        case CameraFunctionId::CONTRAST:
+        case CameraFunctionId::GLOBAL_CONTRAST:
+        case CameraFunctionId::DETAIL_ENHANCEMENT:
+        case CameraFunctionId::NOISE_REDUCTION:
+        case CameraFunctionId::ROI_LEVEL:
+        case CameraFunctionId::AGC_LEVEL:
+        case CameraFunctionId::SCENE_MODE:
+        case CameraFunctionId::PALETTE_INDEX:
+        case CameraFunctionId::GAMMA_LEVEL:
+        case CameraFunctionId::EDGE_ENHANCE:
+        case CameraFunctionId::TIME_NOISE_REDUCTION:
+        case CameraFunctionId::SPACE_NOISE_REDUCTION:
+        case CameraFunctionId::ANALOG_VIDEO_OUTPUT:
+        case CameraFunctionId::MIRROR_AND_FLIP:
+        case CameraFunctionId::AUTO_FFC_STATUS:
+        case CameraFunctionId::ALL_FFC_FUNCTION_STATUS:
+            return true;
+        default:
+            return false;
     }
-    REGISTRY_LOGI("%s", ss.str().c_str());
 }
 
 RegistryError convertSdkError(IrlibError_e sdkError) {
@@ -350,6 +422,8 @@ const char* getRegistryErrorMessage(RegistryError error) {
     switch (error) {
         case RegistryError::SUCCESS:
             return "Success";
+        case RegistryError::SKIPPED_UNCHANGED:
+            return "Skipped, value unchanged";
         case RegistryError::FUNCTION_NOT_FOUND:
             return "Function not found in registry";
         case RegistryError::INVALID_HANDLE:
@@ -358,6 +432,10 @@ const char* getRegistryErrorMessage(RegistryError error) {
             return "Invalid parameter";
         case RegistryError::SDK_ERROR:
             return "SDK error";
+        case RegistryError::OUT_OF_RANGE:
+            return "Value outside the device range";
+        case RegistryError::VALUE_UNKNOWN:
+            return "Value not known yet";
         default:
             return "Unknown error";
     }
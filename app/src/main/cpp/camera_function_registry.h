@@ -1,10 +1,11 @@
 #pragma once
 
-#include <unordered_map>
-#include <functional>
-#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <android/log.h>
 #include "libircmd.h"
+#include "trace_ring.h"
 
 // Logging macros
 #define REGISTRY_TAG "CameraFunctionRegistry"
@@ -12,6 +13,14 @@
 #define REGISTRY_LOGW(...) __android_log_print(ANDROID_LOG_WARN, REGISTRY_TAG, __VA_ARGS__)
 #define REGISTRY_LOGE(...) __android_log_print(ANDROID_LOG_ERROR, REGISTRY_TAG, __VA_ARGS__)
 
+// Per-command logging, only emitted when verbose logging is enabled at runtime
+#define REGISTRY_LOGV(...) \
+    do { \
+        if (CameraFunctionRegistry::isVerboseLogging()) { \
+            __android_log_print(ANDROID_LOG_DEBUG, REGISTRY_TAG, __VA_ARGS__); \
+        } \
+    } while (0)
+
 // Function types for camera operations
 enum class FunctionType {
     SET = 0,    // Functions that set a parameter value
@@ -19,7 +28,8 @@ enum class FunctionType {
     ACTION = 2  // Functions that perform an action (no parameters)
 };
 
-// Camera function IDs - these will replace the manual enum synchronization
+// Camera function IDs - these will replace the manual enum synchronization.
+// IDs inside each thousand-block must stay contiguous; see kFunctionGroupSizes.
 enum class CameraFunctionId {
     // Image processing functions
     BRIGHTNESS = 1000,
@@ -53,19 +63,73 @@ enum class CameraFunctionId {
     MIRROR_AND_FLIP = 5006,
     AUTO_FFC_STATUS = 5007,
     ALL_FFC_FUNCTION_STATUS = 5008,
+    STREAM_SOURCE_MODE = 5009,      // adv_stream_source_mode_e, selects the radiometric plane
+    AUTO_FFC_TEMP_THRESHOLD = 5010, // Sensor drift that triggers auto FFC, in counts (~36 per °C)
+    AUTO_FFC_MIN_INTERVAL = 5011,   // Seconds
+    AUTO_FFC_MAX_INTERVAL = 5012,   // Seconds
     
-    // Add more as needed...
+    // Add more as needed (and bump kFunctionGroupSizes)...
 };
 
-// Type aliases for function signatures
-using SetFunction = std::function<int(IrcmdHandle_t*, int)>;
-using SetFunction2 = std::function<int(IrcmdHandle_t*, int, int)>; // For functions with 2 int parameters
-using GetFunction = std::function<int(IrcmdHandle_t*, int*)>;
-using ActionFunction = std::function<int(IrcmdHandle_t*)>;
+// Number of IDs in each thousand-block of CameraFunctionId (index = id / 1000)
+constexpr int kFunctionGroupSizes[] = {0, 7, 2, 1, 4, 13};
+constexpr int kFunctionGroupCount = sizeof(kFunctionGroupSizes) / sizeof(kFunctionGroupSizes[0]);
+
+constexpr int functionGroupBase(int group) {
+    int base = 0;
+    for (int i = 0; i < group; i++) {
+        base += kFunctionGroupSizes[i];
+    }
+    return base;
+}
+
+// Total number of function IDs, i.e. the size of the dense dispatch table
+constexpr int kFunctionCount = functionGroupBase(kFunctionGroupCount);
+
+// Map a CameraFunctionId to its slot in the dispatch table, or -1 if it is not a known ID
+constexpr int denseFunctionIndex(CameraFunctionId id) {
+    const int raw = static_cast<int>(id);
+    const int group = raw / 1000;
+    const int offset = raw % 1000;
+    if (raw < 0 || group >= kFunctionGroupCount || offset >= kFunctionGroupSizes[group]) {
+        return -1;
+    }
+    return functionGroupBase(group) + offset;
+}
+
+// Inverse of denseFunctionIndex(), index must be in [0, kFunctionCount)
+constexpr CameraFunctionId functionIdAtIndex(int index) {
+    int group = 0;
+    while (index >= kFunctionGroupSizes[group]) {
+        index -= kFunctionGroupSizes[group];
+        group++;
+    }
+    return static_cast<CameraFunctionId>(group * 1000 + index);
+}
+
+// Plain function pointer signatures used by the dispatch table
+using SetFunction = int (*)(IrcmdHandle_t*, int);
+using SetFunction2 = int (*)(IrcmdHandle_t*, int, int); // For functions with 2 int parameters
+using GetFunction = int (*)(IrcmdHandle_t*, int*);
+using ActionFunction = int (*)(IrcmdHandle_t*);
+using AttributeFunction = int (*)(IrcmdHandle_t*, param_attribute_t*); // Range query, safe unlike most GETs
+
+// One row of the dispatch table; unsupported operations are nullptr
+struct FunctionTableEntry {
+    CameraFunctionId id;
+    SetFunction set;
+    SetFunction2 set2;
+    GetFunction get;
+    ActionFunction action;
+    uint8_t applyPriority;  // Batch apply order, lower first
+    bool imageLevel;        // Reloaded by the device when the scene mode changes
+    AttributeFunction attribute;  // Min/max/step of the SET value, nullptr if the SDK has none
+};
 
 /**
- * Registry class that maps function IDs to actual libircmd.h function calls
- * This eliminates the need for manual enum synchronization across layers
+ * Registry class that maps function IDs to actual libircmd.h function calls.
+ * The mapping is a compile-time table of function pointers indexed by denseFunctionIndex(),
+ * so nothing is registered at startup and dispatch is a bounds-checked array index.
  */
 class CameraFunctionRegistry {
 public:
@@ -74,31 +138,45 @@ public:
         return instance;
     }
 
-    // Register functions for different types
-    void registerSetFunction(CameraFunctionId id, SetFunction func);
-    void registerSetFunction2(CameraFunctionId id, SetFunction2 func);
-    void registerGetFunction(CameraFunctionId id, GetFunction func);
-    void registerActionFunction(CameraFunctionId id, ActionFunction func);
-
     // Execute functions by ID
     int executeSetFunction(CameraFunctionId id, IrcmdHandle_t* handle, int value);
     int executeSetFunction2(CameraFunctionId id, IrcmdHandle_t* handle, int value1, int value2);
     int executeGetFunction(CameraFunctionId id, IrcmdHandle_t* handle, int* value);
     int executeActionFunction(CameraFunctionId id, IrcmdHandle_t* handle);
+    int executeAttributeFunction(CameraFunctionId id, IrcmdHandle_t* handle, param_attribute_t* attribute);
 
     // Check if function is registered
     bool isSetFunctionRegistered(CameraFunctionId id) const;
     bool isSetFunction2Registered(CameraFunctionId id) const;
     bool isGetFunctionRegistered(CameraFunctionId id) const;
     bool isActionFunctionRegistered(CameraFunctionId id) const;
+    bool isAttributeFunctionRegistered(CameraFunctionId id) const;
 
-    // Initialize all function mappings
+    // Kept for callers that initialize the registry on connect; the table is static, so this only logs
     void initializeAllFunctions();
 
     // Get function information
     size_t getRegisteredFunctionCount() const;
     void logRegisteredFunctions() const;
 
+    // Order in which SET functions are applied when several are sent together.
+    // Lower values go first: scene mode resets the image levels, so it must precede them.
+    int getApplyPriority(CameraFunctionId id) const;
+
+    // Image levels are reloaded by the device whenever a function that invalidates them is applied
+    bool isImageLevel(CameraFunctionId id) const;
+    bool invalidatesImageLevels(CameraFunctionId id) const;
+
+    // Settings worth restoring on reconnect: the image levels, scene, palette, mirror and the
+    // FFC switches. Transient states (sleep, shutter, freeze) are not, nor is what the host
+    // programs at runtime: the output frame rate, YUV format and stream source follow the
+    // stream UVCCamera runs, and the auto FFC parameters belong to the FFC scheduler.
+    bool isPersistent(CameraFunctionId id) const;
+
+    // Runtime switch for per-command logging (REGISTRY_LOGV)
+    static void setVerboseLogging(bool enabled) { verbose_logging_.store(enabled, std::memory_order_relaxed); }
+    static bool isVerboseLogging() { return verbose_logging_.load(std::memory_order_relaxed); }
+
 private:
     CameraFunctionRegistry() = default;
     ~CameraFunctionRegistry() = default;
@@ -107,27 +185,22 @@ private:
     CameraFunctionRegistry(const CameraFunctionRegistry&) = delete;
     CameraFunctionRegistry& operator=(const CameraFunctionRegistry&) = delete;
 
-    // Function storage maps
-    std::unordered_map<CameraFunctionId, SetFunction> setFunctions_;
-    std::unordered_map<CameraFunctionId, SetFunction2> setFunctions2_;
-    std::unordered_map<CameraFunctionId, GetFunction> getFunctions_;
-    std::unordered_map<CameraFunctionId, ActionFunction> actionFunctions_;
-
-    // Helper methods for initialization
-    void initializeImageProcessingFunctions();
-    void initializeSceneAndPaletteFunctions();
-    void initializeActionFunctions();
-    void initializeAdvancedFunctions();
-    void initializeDeviceControlFunctions();
+    // Bounds-checked table lookup, nullptr for unknown IDs
+    static const FunctionTableEntry* lookup(CameraFunctionId id);
+
+    static std::atomic<bool> verbose_logging_;
 };
 
 // Error codes for registry operations
 enum class RegistryError {
     SUCCESS = 0,
+    SKIPPED_UNCHANGED = 1,   // Batch entry not sent because the device already has this value
     FUNCTION_NOT_FOUND = -1001,
     INVALID_HANDLE = -1002,
     INVALID_PARAMETER = -1003,
-    SDK_ERROR = -1004
+    SDK_ERROR = -1004,
+    OUT_OF_RANGE = -1005,    // Rejected locally, value outside the range reported by the device
+    VALUE_UNKNOWN = -1006    // No value has been set since connect, so there is nothing to report
 };
 
 // Convert libircmd errors to registry errors
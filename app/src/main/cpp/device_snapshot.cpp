@@ -0,0 +1,325 @@
+#include "device_snapshot.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+uint32_t fnv1a(uint32_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t snapshotChecksum(const SnapshotHeader& header, const void* payload, size_t payloadSize) {
+    uint32_t hash = fnv1a(2166136261u, &header, offsetof(SnapshotHeader, checksum));
+    return fnv1a(hash, payload, payloadSize);
+}
+
+size_t payloadSize(const SnapshotHeader& header) {
+    return header.frameCount * sizeof(SnapshotFrame) + header.parameterCount * sizeof(SnapshotParameter);
+}
+
+bool sameStreamCtrl(const uvc_stream_ctrl_t& a, const uvc_stream_ctrl_t& b) {
+    return a.bFormatIndex == b.bFormatIndex &&
+           a.bFrameIndex == b.bFrameIndex &&
+           a.dwFrameInterval == b.dwFrameInterval &&
+           a.bInterfaceNumber == b.bInterfaceNumber;
+}
+
+} // namespace
+
+DeviceSnapshot::DeviceSnapshot()
+    : vendor_id_(0), product_id_(0), mapping_(nullptr), mapping_size_(0), header_(nullptr) {
+    serial_[0] = '\0';
+}
+
+DeviceSnapshot::~DeviceSnapshot() {
+    close();
+}
+
+void DeviceSnapshot::setDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory;
+    SNAPSHOT_LOGI("Snapshot directory: %s", directory_.c_str());
+}
+
+bool DeviceSnapshot::load(uint16_t vendorId, uint16_t productId, const char* serial) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unmapLocked();
+
+    vendor_id_ = vendorId;
+    product_id_ = productId;
+    memset(serial_, 0, sizeof(serial_));
+    if (serial) {
+        strncpy(serial_, serial, sizeof(serial_) - 1);
+    }
+
+    if (directory_.empty()) {
+        path_.clear();
+        SNAPSHOT_LOGW("No snapshot directory set, warm start disabled");
+        return false;
+    }
+
+    // Keep the file name portable whatever the device reports as serial number
+    std::string safeSerial;
+    for (const char* c = serial_; *c; c++) {
+        const bool safe = (*c >= '0' && *c <= '9') || (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z');
+        safeSerial += safe ? *c : '_';
+    }
+    char name[128];
+    snprintf(name, sizeof(name), "/device_%04x_%04x_%s.snap", vendorId, productId,
+             safeSerial.empty() ? "noserial" : safeSerial.c_str());
+    path_ = directory_ + name;
+
+    return mapLocked();
+}
+
+void DeviceSnapshot::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unmapLocked();
+    path_.clear();
+}
+
+bool DeviceSnapshot::isLoaded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return header_ != nullptr;
+}
+
+bool DeviceSnapshot::findStreamControl(int width, int height, int fps, uvc_stream_ctrl_t* outCtrl) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_ || !header_->hasStreamCtrl ||
+        header_->streamWidth != width || header_->streamHeight != height || header_->streamFps != fps) {
+        return false;
+    }
+    *outCtrl = header_->streamCtrl;
+    return true;
+}
+
+std::vector<SnapshotFrame> DeviceSnapshot::getFrames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_) {
+        return {};
+    }
+    const SnapshotFrame* frames = framesLocked();
+    return std::vector<SnapshotFrame>(frames, frames + header_->frameCount);
+}
+
+std::vector<SnapshotParameter> DeviceSnapshot::getParameters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_) {
+        return {};
+    }
+    const SnapshotParameter* parameters = parametersLocked();
+    return std::vector<SnapshotParameter>(parameters, parameters + header_->parameterCount);
+}
+
+bool DeviceSnapshot::saveStream(const uvc_format_desc_t* formats, const uvc_stream_ctrl_t& ctrl, int width, int height, int fps) {
+    std::vector<SnapshotFrame> frames = collectFrames(formats);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty()) {
+        return false;
+    }
+
+    // Nothing to write if the mapped snapshot already describes this stream
+    if (header_ && header_->hasStreamCtrl && sameStreamCtrl(header_->streamCtrl, ctrl) &&
+        header_->streamWidth == width && header_->streamHeight == height && header_->streamFps == fps &&
+        header_->frameCount == frames.size() &&
+        memcmp(framesLocked(), frames.data(), frames.size() * sizeof(SnapshotFrame)) == 0) {
+        return true;
+    }
+
+    std::vector<SnapshotParameter> parameters;
+    if (header_) {
+        parameters.assign(parametersLocked(), parametersLocked() + header_->parameterCount);
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.streamWidth = static_cast<uint16_t>(width);
+    header.streamHeight = static_cast<uint16_t>(height);
+    header.streamFps = static_cast<uint16_t>(fps);
+    header.hasStreamCtrl = 1;
+    header.streamCtrl = ctrl;
+    return writeLocked(header, frames, parameters);
+}
+
+bool DeviceSnapshot::saveParameters(const std::vector<SnapshotParameter>& parameters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty()) {
+        return false;
+    }
+
+    if (header_ && header_->parameterCount == parameters.size() &&
+        memcmp(parametersLocked(), parameters.data(), parameters.size() * sizeof(SnapshotParameter)) == 0) {
+        return true;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    std::vector<SnapshotFrame> frames;
+    if (header_) {
+        // Keep the stream part of the current snapshot
+        header.streamWidth = header_->streamWidth;
+        header.streamHeight = header_->streamHeight;
+        header.streamFps = header_->streamFps;
+        header.hasStreamCtrl = header_->hasStreamCtrl;
+        header.streamCtrl = header_->streamCtrl;
+        frames.assign(framesLocked(), framesLocked() + header_->frameCount);
+    }
+    return writeLocked(header, frames, parameters);
+}
+
+bool DeviceSnapshot::matchesDescriptors(const uvc_format_desc_t* formats) const {
+    std::vector<SnapshotFrame> live = collectFrames(formats);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return header_ && header_->frameCount == live.size() &&
+           memcmp(framesLocked(), live.data(), live.size() * sizeof(SnapshotFrame)) == 0;
+}
+
+void DeviceSnapshot::invalidate(const char* reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unmapLocked();
+    if (!path_.empty() && unlink(path_.c_str()) == 0) {
+        SNAPSHOT_LOGW("Snapshot %s invalidated: %s", path_.c_str(), reason);
+    }
+}
+
+std::vector<SnapshotFrame> DeviceSnapshot::collectFrames(const uvc_format_desc_t* formats) {
+    std::vector<SnapshotFrame> frames;
+    for (const uvc_format_desc_t* format = formats; format; format = format->next) {
+        for (const uvc_frame_desc_t* desc = format->frame_descs; desc; desc = desc->next) {
+            SnapshotFrame frame;
+            memset(&frame, 0, sizeof(frame));
+            frame.formatIndex = format->bFormatIndex;
+            frame.frameIndex = desc->bFrameIndex;
+            frame.descriptorSubtype = static_cast<uint8_t>(desc->bDescriptorSubtype);
+            frame.width = desc->wWidth;
+            frame.height = desc->wHeight;
+            frame.defaultInterval = desc->dwDefaultFrameInterval;
+            frame.minInterval = desc->dwMinFrameInterval;
+            frame.maxInterval = desc->dwMaxFrameInterval;
+            frame.intervalStep = desc->dwFrameIntervalStep;
+            if (desc->bFrameIntervalType > 0 && desc->intervals) {
+                int count = desc->bFrameIntervalType < kSnapshotMaxIntervals ? desc->bFrameIntervalType : kSnapshotMaxIntervals;
+                frame.intervalCount = static_cast<uint8_t>(count);
+                memcpy(frame.intervals, desc->intervals, count * sizeof(uint32_t));
+            }
+            frames.push_back(frame);
+        }
+    }
+    return frames;
+}
+
+bool DeviceSnapshot::mapLocked() {
+    int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        SNAPSHOT_LOGI("No snapshot for %04x:%04x (%s), cold start", vendor_id_, product_id_, serial_);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+        ::close(fd);
+        SNAPSHOT_LOGW("Snapshot %s is truncated, ignoring it", path_.c_str());
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        SNAPSHOT_LOGE("Failed to map snapshot %s: %s", path_.c_str(), strerror(errno));
+        return false;
+    }
+
+    const SnapshotHeader* header = static_cast<const SnapshotHeader*>(mapping);
+    const size_t size = static_cast<size_t>(st.st_size);
+    const bool valid = header->magic == kSnapshotMagic &&
+                       header->version == kSnapshotVersion &&
+                       header->ctrlSize == sizeof(uvc_stream_ctrl_t) &&
+                       header->vendorId == vendor_id_ &&
+                       header->productId == product_id_ &&
+                       strncmp(header->serial, serial_, sizeof(serial_)) == 0 &&
+                       size == sizeof(SnapshotHeader) + payloadSize(*header) &&
+                       header->checksum == snapshotChecksum(*header, header + 1, payloadSize(*header));
+    if (!valid) {
+        munmap(mapping, st.st_size);
+        SNAPSHOT_LOGW("Snapshot %s does not match this device or build, ignoring it", path_.c_str());
+        return false;
+    }
+
+    mapping_ = mapping;
+    mapping_size_ = size;
+    header_ = header;
+    SNAPSHOT_LOGI("Mapped snapshot for %04x:%04x: %u frames, %u parameters, stream ctrl %s",
+                  vendor_id_, product_id_, header_->frameCount, header_->parameterCount,
+                  header_->hasStreamCtrl ? "present" : "absent");
+    return true;
+}
+
+void DeviceSnapshot::unmapLocked() {
+    if (mapping_) {
+        munmap(mapping_, mapping_size_);
+    }
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+    header_ = nullptr;
+}
+
+bool DeviceSnapshot::writeLocked(const SnapshotHeader& templateHeader,
+                                 const std::vector<SnapshotFrame>& frames,
+                                 const std::vector<SnapshotParameter>& parameters) {
+    SnapshotHeader header = templateHeader;
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.ctrlSize = sizeof(uvc_stream_ctrl_t);
+    header.vendorId = vendor_id_;
+    header.productId = product_id_;
+    memcpy(header.serial, serial_, sizeof(header.serial));
+    header.frameCount = static_cast<uint16_t>(frames.size());
+    header.parameterCount = static_cast<uint16_t>(parameters.size());
+
+    std::vector<uint8_t> payload(payloadSize(header));
+    memcpy(payload.data(), frames.data(), frames.size() * sizeof(SnapshotFrame));
+    memcpy(payload.data() + frames.size() * sizeof(SnapshotFrame), parameters.data(),
+           parameters.size() * sizeof(SnapshotParameter));
+    header.checksum = snapshotChecksum(header, payload.data(), payload.size());
+
+    // Write next to the target and rename, so a reader never sees a half-written file
+    const std::string tempPath = path_ + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        SNAPSHOT_LOGE("Failed to create %s: %s", tempPath.c_str(), strerror(errno));
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (payload.empty() || fwrite(payload.data(), payload.size(), 1, file) == 1);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tempPath.c_str(), path_.c_str()) != 0) {
+        SNAPSHOT_LOGE("Failed to write snapshot %s: %s", path_.c_str(), strerror(errno));
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    unmapLocked();
+    mapLocked();
+    SNAPSHOT_LOGI("Saved snapshot: %zu frames, %zu parameters", frames.size(), parameters.size());
+    return true;
+}
+
+const SnapshotFrame* DeviceSnapshot::framesLocked() const {
+    return reinterpret_cast<const SnapshotFrame*>(header_ + 1);
+}
+
+const SnapshotParameter* DeviceSnapshot::parametersLocked() const {
+    return reinterpret_cast<const SnapshotParameter*>(framesLocked() + header_->frameCount);
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <android/log.h>
+#include <libuvc/libuvc.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Logging macros
+#define SNAPSHOT_TAG "DeviceSnapshot"
+#define SNAPSHOT_LOGI(...) __android_log_print(ANDROID_LOG_INFO, SNAPSHOT_TAG, __VA_ARGS__)
+#define SNAPSHOT_LOGW(...) __android_log_print(ANDROID_LOG_WARN, SNAPSHOT_TAG, __VA_ARGS__)
+#define SNAPSHOT_LOGE(...) __android_log_print(ANDROID_LOG_ERROR, SNAPSHOT_TAG, __VA_ARGS__)
+
+constexpr uint32_t kSnapshotMagic = 0x4E535249;  // "IRSN"
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr int kSnapshotMaxIntervals = 8;
+constexpr int kSnapshotSerialLength = 64;
+
+// One parsed frame descriptor (format + resolution + frame intervals)
+struct SnapshotFrame {
+    uint8_t formatIndex;
+    uint8_t frameIndex;
+    uint8_t descriptorSubtype;      // uvc_vs_desc_subtype of the frame
+    uint8_t intervalCount;          // 0 = continuous (min/max/step), otherwise entries used in intervals
+    uint16_t width;
+    uint16_t height;
+    uint32_t defaultInterval;       // 100ns units, like libuvc
+    uint32_t minInterval;
+    uint32_t maxInterval;
+    uint32_t intervalStep;
+    uint32_t intervals[kSnapshotMaxIntervals];
+};
+
+// One shadow parameter value (CameraFunctionId, value, value2)
+struct SnapshotParameter {
+    int32_t functionId;
+    int32_t value;
+    int32_t value2;
+};
+
+// On-disk layout: SnapshotHeader, frameCount SnapshotFrame, parameterCount SnapshotParameter.
+// The file is only ever read back by the same build, so structs are stored as-is;
+// version and ctrlSize reject files written by an incompatible layout.
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t ctrlSize;              // sizeof(uvc_stream_ctrl_t) of the writer
+    uint16_t vendorId;
+    uint16_t productId;
+    char serial[kSnapshotSerialLength];
+    uint16_t frameCount;
+    uint16_t parameterCount;
+    uint16_t streamWidth;           // Request the stored stream control was negotiated for
+    uint16_t streamHeight;
+    uint16_t streamFps;
+    uint16_t hasStreamCtrl;
+    uvc_stream_ctrl_t streamCtrl;   // Last successfully started stream control
+    uint32_t checksum;              // FNV-1a over the header up to here and the payload
+};
+
+/**
+ * Warm-start snapshot of a device, keyed by VID/PID/serial.
+ *
+ * Holds what a reconnect would otherwise have to rediscover: the parsed format/frame
+ * descriptors, the last stream control that started successfully and the shadow
+ * parameter values. The file is memory-mapped on load and read in place; updates
+ * rewrite it (a few KB) to a temporary file that is renamed over the old one.
+ *
+ * Thread-safe: the stream path, the background validation and JNI all use it.
+ */
+class DeviceSnapshot {
+public:
+    DeviceSnapshot();
+    ~DeviceSnapshot();
+
+    // Directory snapshots are stored in (the app's files dir), set once from Java
+    void setDirectory(const std::string& directory);
+
+    // Select the device and map its snapshot if a valid one exists.
+    // The key is kept either way so the snapshot can be written later.
+    bool load(uint16_t vendorId, uint16_t productId, const char* serial);
+
+    // Unmap and forget the current device
+    void close();
+
+    bool isLoaded() const;
+
+    // Stored stream control for this request, if the last start used the same one
+    bool findStreamControl(int width, int height, int fps, uvc_stream_ctrl_t* outCtrl) const;
+
+    // Copies of the stored descriptors and parameter values
+    std::vector<SnapshotFrame> getFrames() const;
+    std::vector<SnapshotParameter> getParameters() const;
+
+    // Persist the descriptors and the stream control that just started successfully
+    bool saveStream(const uvc_format_desc_t* formats, const uvc_stream_ctrl_t& ctrl, int width, int height, int fps);
+
+    // Persist the shadow parameter values
+    bool saveParameters(const std::vector<SnapshotParameter>& parameters);
+
+    // True if the stored descriptors equal the ones libuvc parsed from the device
+    bool matchesDescriptors(const uvc_format_desc_t* formats) const;
+
+    // Delete the snapshot file, e.g. when validation found it stale
+    void invalidate(const char* reason);
+
+    // Flatten libuvc's descriptor lists
+    static std::vector<SnapshotFrame> collectFrames(const uvc_format_desc_t* formats);
+
+private:
+    // All private helpers expect mutex_ to be held
+    bool mapLocked();
+    void unmapLocked();
+    bool writeLocked(const SnapshotHeader& header,
+                     const std::vector<SnapshotFrame>& frames,
+                     const std::vector<SnapshotParameter>& parameters);
+    const SnapshotFrame* framesLocked() const;
+    const SnapshotParameter* parametersLocked() const;
+
+    mutable std::mutex mutex_;
+    std::string directory_;
+    std::string path_;
+    uint16_t vendor_id_;
+    uint16_t product_id_;
+    char serial_[kSnapshotSerialLength];
+
+    // Current mapping, header_ is nullptr when nothing valid is mapped
+    void* mapping_;
+    size_t mapping_size_;
+    const SnapshotHeader* header_;
+};
@@ -0,0 +1,261 @@
+#include "display_renderer.h"
+#include "trace_ring.h"
+#include <libyuv.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+DisplayRenderer::DisplayRenderer() {
+    setZoom(DisplayZoom());
+    setOrientation(DisplayOrientation());
+}
+
+bool DisplayRenderer::setZoom(const DisplayZoom& zoom) {
+    if (!(zoom.zoom >= 1.0f && zoom.zoom <= kMaxZoom) || zoom.filter < libyuv::kFilterNone ||
+        zoom.filter > libyuv::kFilterBox) {
+        return false;
+    }
+    DisplayZoom clamped = zoom;
+    clamped.centerX = std::clamp(zoom.centerX, 0.0f, 1.0f);
+    clamped.centerY = std::clamp(zoom.centerY, 0.0f, 1.0f);
+    std::atomic_store(&zoom_, std::shared_ptr<const DisplayZoom>(std::make_shared<DisplayZoom>(clamped)));
+    return true;
+}
+
+DisplayZoom DisplayRenderer::getZoom() const {
+    return *std::atomic_load(&zoom_);
+}
+
+bool DisplayRenderer::setOrientation(const DisplayOrientation& orientation) {
+    if (orientation.rotation % 90 != 0) {
+        return false;
+    }
+    DisplayOrientation normalized = orientation;
+    normalized.rotation = (orientation.rotation % 360 + 360) % 360;
+    std::atomic_store(&orientation_,
+                      std::shared_ptr<const DisplayOrientation>(std::make_shared<DisplayOrientation>(normalized)));
+    return true;
+}
+
+DisplayOrientation DisplayRenderer::getOrientation() const {
+    return *std::atomic_load(&orientation_);
+}
+
+void DisplayRenderer::getOutputSize(const uvc_frame_t* frame, int* width, int* height) {
+    const std::shared_ptr<const DisplayOrientation> orientation = std::atomic_load(&orientation_);
+    // A top-bottom flip is a half turn of the left-right mirror image
+    frame_orientation_.rotation = (orientation->rotation + (orientation->flip ? 180 : 0)) % 360;
+    frame_orientation_.mirror = orientation->mirror != orientation->flip;
+
+    const bool quarter = frame_orientation_.rotation % 180 != 0;
+    *width = static_cast<int>(quarter ? frame->height : frame->width);
+    *height = static_cast<int>(quarter ? frame->width : frame->height);
+}
+
+int DisplayRenderer::orientBlock(const uint8_t* src, int srcStride, int width, int height, uint8_t* dst,
+                                 int dstStride) const {
+    const Orientation& orientation = frame_orientation_;
+    // A mirrored quarter turn is the opposite quarter turn of the rows in reverse order,
+    // which libyuv takes as a negative height
+    int result;
+    switch (orientation.rotation) {
+        case 90:
+            result = orientation.mirror
+                ? libyuv::ARGBRotate(src, srcStride, dst, dstStride, width, -height, libyuv::kRotate270)
+                : libyuv::ARGBRotate(src, srcStride, dst, dstStride, width, height, libyuv::kRotate90);
+            break;
+        case 270:
+            result = orientation.mirror
+                ? libyuv::ARGBRotate(src, srcStride, dst, dstStride, width, -height, libyuv::kRotate90)
+                : libyuv::ARGBRotate(src, srcStride, dst, dstStride, width, height, libyuv::kRotate270);
+            break;
+        case 180:
+            result = orientation.mirror
+                ? libyuv::ARGBCopy(src, srcStride, dst, dstStride, width, -height)
+                : libyuv::ARGBRotate(src, srcStride, dst, dstStride, width, height, libyuv::kRotate180);
+            break;
+        default:
+            result = orientation.mirror
+                ? libyuv::ARGBMirror(src, srcStride, dst, dstStride, width, height)
+                : libyuv::ARGBCopy(src, srcStride, dst, dstStride, width, height);
+            break;
+    }
+    if (result != 0) {
+        TRACE(FRAME_ORIENT_FAILED, orientation.rotation, orientation.mirror, result);
+    }
+    return result;
+}
+
+int DisplayRenderer::render(const uvc_frame_t* frame, const ThermalFrame& thermal, uint8_t* dst, int dstStrideBytes) {
+    const int width = static_cast<int>(frame->width);
+    const int height = static_cast<int>(frame->height);
+    const uint8_t* src = static_cast<const uint8_t*>(frame->data);
+    const Orientation orientation = frame_orientation_;
+
+    if (frame->frame_format == UVC_FRAME_FORMAT_MJPEG) {
+        // MJPEG needs to be decoded first - for now, create a placeholder
+        TRACE(FRAME_MJPEG_PLACEHOLDER);
+        const int output_height = orientation.rotation % 180 != 0 ? width : height;
+        memset(dst, 0x80, static_cast<size_t>(dstStrideBytes) * output_height); // Gray placeholder
+        return 0;
+    }
+    if (frame->frame_format != UVC_FRAME_FORMAT_YUYV && frame->frame_format != UVC_FRAME_FORMAT_UYVY &&
+        frame->frame_format != UVC_FRAME_FORMAT_UNCOMPRESSED) {
+        TRACE(FRAME_UNSUPPORTED_FORMAT, frame->frame_format);
+        return -1;
+    }
+
+    const bool isotherms = isotherms_.beginFrame() && thermal.width == width && thermal.height == height;
+    const std::shared_ptr<const DisplayZoom> zoom = std::atomic_load(&zoom_);
+    if (zoom->zoom > 1.0f) {
+        return renderZoomed(frame, thermal, *zoom, isotherms, dst, dstStrideBytes);
+    }
+
+    // Upright and flipped frames are converted straight into the window buffer, the flipped
+    // ones bottom-up; any other orientation goes through a strip of scratch
+    const bool upright = orientation.rotation == 0 && !orientation.mirror;
+    const bool flipped = orientation.rotation == 180 && orientation.mirror;
+    const int strip_stride = width * 4;
+    if (!upright && !flipped) {
+        strip_rgba_.resize(static_cast<size_t>(strip_stride) * kStripRows);
+    }
+
+    for (int y = 0; y < height; y += kStripRows) {
+        const int rows = std::min(kStripRows, height - y);
+        const uint8_t* src_strip = src + static_cast<size_t>(y) * frame->step;
+        uint8_t* dst_strip;
+        int dst_strip_stride;
+        if (upright) {
+            dst_strip = dst + static_cast<ptrdiff_t>(y) * dstStrideBytes;
+            dst_strip_stride = dstStrideBytes;
+        } else if (flipped) {
+            dst_strip = dst + static_cast<ptrdiff_t>(height - 1 - y) * dstStrideBytes;
+            dst_strip_stride = -dstStrideBytes;
+        } else {
+            dst_strip = strip_rgba_.data();
+            dst_strip_stride = strip_stride;
+        }
+
+        // Uncompressed is treated as YUYV
+        int result = frame->frame_format == UVC_FRAME_FORMAT_UYVY
+            ? libyuv::UYVYToARGB(src_strip, frame->step, dst_strip, dst_strip_stride, width, rows)
+            : libyuv::YUY2ToARGB(src_strip, frame->step, dst_strip, dst_strip_stride, width, rows);
+        if (result != 0) {
+            TRACE(FRAME_CONVERSION_FAILED, frame->frame_format, result);
+            return result;
+        }
+
+        // For little-endian systems (like Android), RGBA_8888 is actually stored as ABGR in memory
+        result = libyuv::ARGBToABGR(dst_strip, dst_strip_stride, dst_strip, dst_strip_stride, width, rows);
+        if (result != 0) {
+            TRACE(FRAME_ABGR_FAILED, result);
+            return result;
+        }
+
+        if (isotherms) {
+            isotherms_.apply(thermal, 0, y, width, rows, dst_strip, dst_strip_stride);
+        }
+
+        if (!upright && !flipped) {
+            // The strip's block in the oriented image: rows for a half turn, columns for a quarter
+            const int block_x = orientation.rotation == 90 ? height - y - rows : orientation.rotation == 270 ? y : 0;
+            const int block_y = orientation.rotation == 180 ? height - y - rows : orientation.rotation == 0 ? y : 0;
+            result = orientBlock(dst_strip, dst_strip_stride, width, rows,
+                                 dst + static_cast<ptrdiff_t>(block_y) * dstStrideBytes + block_x * 4, dstStrideBytes);
+            if (result != 0) {
+                return result;
+            }
+        }
+    }
+    return 0;
+}
+
+int DisplayRenderer::renderZoomed(const uvc_frame_t* frame, const ThermalFrame& thermal, const DisplayZoom& zoom,
+                                  bool isotherms, uint8_t* dst, int dstStrideBytes) {
+    const int width = static_cast<int>(frame->width);
+    const int height = static_cast<int>(frame->height);
+    const Orientation orientation = frame_orientation_;
+    const bool quarter = orientation.rotation % 180 != 0;
+
+    // The center is given on the displayed image; take it back through the orientation
+    float center_x = zoom.centerX;
+    float center_y = zoom.centerY;
+    switch (orientation.rotation) {
+        case 90:
+            center_x = zoom.centerY;
+            center_y = 1.0f - zoom.centerX;
+            break;
+        case 180:
+            center_x = 1.0f - zoom.centerX;
+            center_y = 1.0f - zoom.centerY;
+            break;
+        case 270:
+            center_x = 1.0f - zoom.centerY;
+            center_y = zoom.centerX;
+            break;
+        default:
+            break;
+    }
+    if (orientation.mirror) {
+        center_x = 1.0f - center_x;
+    }
+
+    // Crop in source pixels; x stays even so it starts on a whole YUYV macropixel
+    const int crop_width = std::max(2, static_cast<int>(std::lround(width / zoom.zoom)) & ~1);
+    const int crop_height = std::max(1, static_cast<int>(std::lround(height / zoom.zoom)));
+    const int crop_x = std::clamp(static_cast<int>(std::lround(center_x * width)) - crop_width / 2,
+                                  0, width - crop_width) & ~1;
+    const int crop_y = std::clamp(static_cast<int>(std::lround(center_y * height)) - crop_height / 2,
+                                  0, height - crop_height);
+
+    const int crop_stride = crop_width * 4;
+    crop_rgba_.resize(static_cast<size_t>(crop_stride) * crop_height);
+    uint8_t* crop = crop_rgba_.data();
+    const uint8_t* src = static_cast<const uint8_t*>(frame->data) + static_cast<size_t>(crop_y) * frame->step + crop_x * 2;
+
+    int result = frame->frame_format == UVC_FRAME_FORMAT_UYVY
+        ? libyuv::UYVYToARGB(src, frame->step, crop, crop_stride, crop_width, crop_height)
+        : libyuv::YUY2ToARGB(src, frame->step, crop, crop_stride, crop_width, crop_height);
+    if (result != 0) {
+        TRACE(FRAME_CONVERSION_FAILED, frame->frame_format, result);
+        return result;
+    }
+    result = libyuv::ARGBToABGR(crop, crop_stride, crop, crop_stride, crop_width, crop_height);
+    if (result != 0) {
+        TRACE(FRAME_ABGR_FAILED, result);
+        return result;
+    }
+    if (isotherms) {
+        isotherms_.apply(thermal, crop_x, crop_y, crop_width, crop_height, crop, crop_stride);
+    }
+
+    // Oriented at the crop's size, before the scaling makes it larger
+    const uint8_t* scaled = crop;
+    int scaled_stride = crop_stride;
+    int scaled_width = crop_width;
+    int scaled_height = crop_height;
+    if (orientation.rotation != 0 || orientation.mirror) {
+        if (quarter) {
+            std::swap(scaled_width, scaled_height);
+        }
+        scaled_stride = scaled_width * 4;
+        oriented_rgba_.resize(static_cast<size_t>(scaled_stride) * scaled_height);
+        result = orientBlock(crop, crop_stride, crop_width, crop_height, oriented_rgba_.data(), scaled_stride);
+        if (result != 0) {
+            return result;
+        }
+        scaled = oriented_rgba_.data();
+    }
+
+    // Byte order does not matter to the scaler
+    result = libyuv::ARGBScale(scaled, scaled_stride, scaled_width, scaled_height, dst, dstStrideBytes,
+                               quarter ? height : width, quarter ? width : height,
+                               static_cast<libyuv::FilterMode>(zoom.filter));
+    if (result != 0) {
+        TRACE(FRAME_CONVERSION_FAILED, frame->frame_format, result);
+    }
+    return result;
+}
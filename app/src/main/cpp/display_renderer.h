@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <libuvc/libuvc.h>
+#include "isotherm_overlay.h"
+#include "radiometric.h"
+
+// Digital zoom of the display only; the other consumers keep the full frame
+struct DisplayZoom {
+    float zoom = 1.0f;              // 1 shows the whole frame
+    float centerX = 0.5f;           // Center of the shown area, as a share of the displayed image
+    float centerY = 0.5f;
+    int filter = 2;                 // libyuv::FilterMode: 0 none, 1 linear, 2 bilinear, 3 box
+};
+
+// Orientation of the display only, applied on the host without a device command
+struct DisplayOrientation {
+    int rotation = 0;               // Clockwise degrees: 0, 90, 180 or 270
+    bool mirror = false;            // Left-right, before the rotation
+    bool flip = false;              // Top-bottom, before the rotation
+};
+
+/**
+ * Frame to RGBA_8888 window buffer conversion with the native overlays.
+ *
+ * The frame is converted in strips of kStripRows rows: libyuv to ARGB, the swizzle to the
+ * window's byte order, then every overlay on the same strip while it is still in cache,
+ * instead of one full-frame pass per stage.
+ *
+ * While zoomed, only the shown part of the source is converted, straight from the frame
+ * into a buffer of the crop's size, overlaid there, and scaled into the window buffer with
+ * libyuv's ARGBScale; no full-size intermediate exists.
+ *
+ * The orientation is folded into the same strip pass. A flip alone is the conversion
+ * written bottom-up into the window buffer through a negative stride. Otherwise each strip
+ * is converted and overlaid in a strip-sized scratch buffer and moved to its final place
+ * with libyuv's ARGBMirror / ARGBRotate, the mirror taken as a reversed row order of the
+ * strip where it combines with a quarter turn. A zoomed frame has its crop oriented before
+ * the scaling. The orientation is latched once per frame by getOutputSize(), so the window
+ * geometry and the rendering always agree.
+ */
+class DisplayRenderer {
+public:
+    static constexpr int kStripRows = 16;
+    static constexpr float kMaxZoom = 8.0f;
+
+    DisplayRenderer();
+
+    IsothermOverlay& getIsotherms() { return isotherms_; }
+
+    // Any thread; applied from the next frame. Returns false if the zoom is out of range.
+    bool setZoom(const DisplayZoom& zoom);
+    DisplayZoom getZoom() const;
+
+    // Any thread; applied from the next frame. Returns false for a rotation other than a
+    // multiple of 90 degrees.
+    bool setOrientation(const DisplayOrientation& orientation);
+    DisplayOrientation getOrientation() const;
+
+    // Frame thread, once per frame before render(): latches the orientation and returns the
+    // size of the rendered image, the frame's with width and height swapped by a quarter turn
+    void getOutputSize(const uvc_frame_t* frame, int* width, int* height);
+
+    // Frame thread. dst holds the output height rows of dstStrideBytes; thermal supplies the
+    // values the overlays test and must have the frame's size. Returns 0 on success.
+    int render(const uvc_frame_t* frame, const ThermalFrame& thermal, uint8_t* dst, int dstStrideBytes);
+
+private:
+    // Rotation in 0..270 with the flip folded in as a half turn plus a mirror
+    struct Orientation {
+        int rotation;
+        bool mirror;
+    };
+
+    int orientBlock(const uint8_t* src, int srcStride, int width, int height, uint8_t* dst, int dstStride) const;
+    int renderZoomed(const uvc_frame_t* frame, const ThermalFrame& thermal, const DisplayZoom& zoom, bool isotherms,
+                     uint8_t* dst, int dstStrideBytes);
+
+    IsothermOverlay isotherms_;
+    std::shared_ptr<const DisplayZoom> zoom_;   // Accessed with std::atomic_load/atomic_store
+    std::shared_ptr<const DisplayOrientation> orientation_;     // Accessed with std::atomic_load/atomic_store
+
+    // Frame thread only
+    Orientation frame_orientation_ = {0, false};
+    std::vector<uint8_t> crop_rgba_;
+    std::vector<uint8_t> oriented_rgba_;
+    std::vector<uint8_t> strip_rgba_;
+};
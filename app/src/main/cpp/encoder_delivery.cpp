@@ -0,0 +1,188 @@
+#include "encoder_delivery.h"
+#include "jni_bridge.h"
+#include <cstring>
+
+EncoderDelivery::~EncoderDelivery() {
+    stop();
+}
+
+bool EncoderDelivery::start(JavaVM* vm) {
+    if (vm == nullptr) {
+        DELIVERY_LOGE("No JavaVM, encoder frames cannot be delivered");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_.load()) {
+        return true;
+    }
+
+    // A thread that failed to attach has already exited
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    free_slots_.clear();
+    ready_slots_.clear();
+    for (int i = kQueueDepth - 1; i >= 0; i--) {
+        free_slots_.push_back(i);
+    }
+
+    stop_requested_.store(false);
+    running_.store(true);
+    thread_ = std::thread(&EncoderDelivery::deliveryLoop, this, vm);
+    return true;
+}
+
+void EncoderDelivery::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+        stop_requested_.store(true);
+    }
+    ready_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void EncoderDelivery::submit(const uint8_t* data, size_t size, int width, int height, int64_t timestampUs) {
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.load()) {
+            dropped_not_running_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (!free_slots_.empty()) {
+            index = free_slots_.back();
+            free_slots_.pop_back();
+        } else if (!ready_slots_.empty()) {
+            // Kotlin is behind: reuse the oldest frame it has not taken yet
+            index = ready_slots_.front();
+            ready_slots_.pop_front();
+            dropped_queue_full_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            dropped_queue_full_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // The slot belongs to this thread until it is queued, so copy without the lock
+    Slot& slot = slots_[index];
+    if (slot.data.size() < size) {
+        slot.data.resize(size);
+    }
+    memcpy(slot.data.data(), data, size);
+    slot.size = size;
+    slot.width = width;
+    slot.height = height;
+    slot.timestampUs = timestampUs;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.load()) {
+            free_slots_.push_back(index);
+            dropped_not_running_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ready_slots_.push_back(index);
+    }
+    ready_cv_.notify_one();
+}
+
+int EncoderDelivery::getFreeSlots() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_.load() ? static_cast<int>(free_slots_.size()) : 0;
+}
+
+EncoderDelivery::Counters EncoderDelivery::getCounters() const {
+    return {
+        submitted_.load(std::memory_order_relaxed),
+        delivered_.load(std::memory_order_relaxed),
+        dropped_queue_full_.load(std::memory_order_relaxed),
+        dropped_not_running_.load(std::memory_order_relaxed),
+        dropped_delivery_failed_.load(std::memory_order_relaxed)
+    };
+}
+
+jobject EncoderDelivery::bufferFor(JNIEnv* env, Slot& slot) {
+    if (slot.buffer && slot.bufferData == slot.data.data() && slot.bufferSize == slot.size) {
+        return slot.buffer;
+    }
+
+    if (slot.buffer) {
+        env->DeleteGlobalRef(slot.buffer);
+        slot.buffer = nullptr;
+    }
+    jobject local = env->NewDirectByteBuffer(slot.data.data(), static_cast<jlong>(slot.size));
+    if (!local) {
+        env->ExceptionClear();
+        return nullptr;
+    }
+    slot.buffer = env->NewGlobalRef(local);
+    env->DeleteLocalRef(local);
+    slot.bufferData = slot.data.data();
+    slot.bufferSize = slot.size;
+    return slot.buffer;
+}
+
+void EncoderDelivery::deliveryLoop(JavaVM* vm) {
+    JNIEnv* env = nullptr;
+    JavaVMAttachArgs args = {JNI_VERSION_1_6, "EncoderDelivery", nullptr};
+    if (vm->AttachCurrentThread(&env, &args) != JNI_OK) {
+        DELIVERY_LOGE("Failed to attach delivery thread to the JVM");
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+        return;
+    }
+    DELIVERY_LOGI("🎬 Encoder delivery thread started");
+
+    while (true) {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_cv_.wait(lock, [this] { return stop_requested_.load() || !ready_slots_.empty(); });
+            if (stop_requested_.load()) {
+                break;
+            }
+            index = ready_slots_.front();
+            ready_slots_.pop_front();
+        }
+
+        Slot& slot = slots_[index];
+        jobject buffer = bufferFor(env, slot);
+        if (buffer && JniBridge::getInstance().callEncoderTarget(env, buffer, slot.width, slot.height, slot.timestampUs)) {
+            delivered_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            dropped_delivery_failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_slots_.push_back(index);
+        }
+    }
+
+    // Global refs must be released while still attached
+    for (Slot& slot : slots_) {
+        if (slot.buffer) {
+            env->DeleteGlobalRef(slot.buffer);
+            slot.buffer = nullptr;
+        }
+        slot.bufferData = nullptr;
+        slot.bufferSize = 0;
+    }
+
+    const Counters counters = getCounters();
+    DELIVERY_LOGI("🛑 Encoder delivery thread stopped: %llu of %llu frames delivered, dropped %llu queue full, "
+                  "%llu not running, %llu failed",
+                  static_cast<unsigned long long>(counters.delivered),
+                  static_cast<unsigned long long>(counters.submitted),
+                  static_cast<unsigned long long>(counters.droppedQueueFull),
+                  static_cast<unsigned long long>(counters.droppedNotRunning),
+                  static_cast<unsigned long long>(counters.droppedDeliveryFailed));
+    vm->DetachCurrentThread();
+}
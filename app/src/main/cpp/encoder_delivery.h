@@ -0,0 +1,95 @@
+#pragma once
+
+#include <jni.h>
+#include <android/log.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Logging macros
+#define DELIVERY_TAG "EncoderDelivery"
+#define DELIVERY_LOGI(...) __android_log_print(ANDROID_LOG_INFO, DELIVERY_TAG, __VA_ARGS__)
+#define DELIVERY_LOGE(...) __android_log_print(ANDROID_LOG_ERROR, DELIVERY_TAG, __VA_ARGS__)
+
+/**
+ * Hands encoder frames from the libuvc callback thread to Kotlin.
+ *
+ * The callback thread is not attached to the JVM, and attaching per frame is expensive.
+ * Instead submit() copies the frame into one of a few preallocated slots and returns;
+ * a delivery thread attached once at start() calls VideoRecorder.onNativeYUVFrame with
+ * a direct ByteBuffer over the slot. When Kotlin falls behind, the oldest queued frame
+ * is dropped so the capture thread never waits and latency stays bounded.
+ */
+class EncoderDelivery {
+public:
+    static constexpr int kQueueDepth = 3;
+
+    struct Counters {
+        uint64_t submitted;
+        uint64_t delivered;
+        uint64_t droppedQueueFull;      // Overwritten in the queue before Kotlin took it
+        uint64_t droppedNotRunning;     // Submitted while the thread was stopped
+        uint64_t droppedDeliveryFailed; // No target, buffer allocation failed or Kotlin threw
+    };
+
+    EncoderDelivery() = default;
+    ~EncoderDelivery();
+
+    // Start the delivery thread and attach it to vm; no-op if already running
+    bool start(JavaVM* vm);
+
+    // Stop and join the thread; queued frames are discarded
+    void stop();
+
+    bool isRunning() const { return running_.load(); }
+
+    // Called on the capture thread; copies the frame and never blocks on Kotlin
+    void submit(const uint8_t* data, size_t size, int width, int height, int64_t timestampUs);
+
+    // Frames submit() can take now without displacing a queued one; 0 while stopped
+    int getFreeSlots();
+
+    Counters getCounters() const;
+
+private:
+    EncoderDelivery(const EncoderDelivery&) = delete;
+    EncoderDelivery& operator=(const EncoderDelivery&) = delete;
+
+    struct Slot {
+        std::vector<uint8_t> data;
+        size_t size = 0;
+        int width = 0;
+        int height = 0;
+        int64_t timestampUs = 0;
+
+        // Delivery thread only: direct buffer over data, recreated when data moves or resizes
+        jobject buffer = nullptr;
+        const uint8_t* bufferData = nullptr;
+        size_t bufferSize = 0;
+    };
+
+    void deliveryLoop(JavaVM* vm);
+    jobject bufferFor(JNIEnv* env, Slot& slot);
+
+    Slot slots_[kQueueDepth];
+
+    std::mutex mutex_;
+    std::condition_variable ready_cv_;
+    std::vector<int> free_slots_;
+    std::deque<int> ready_slots_;       // Oldest first
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_requested_{false};
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> dropped_queue_full_{0};
+    std::atomic<uint64_t> dropped_not_running_{0};
+    std::atomic<uint64_t> dropped_delivery_failed_{0};
+};
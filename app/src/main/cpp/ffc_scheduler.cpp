@@ -0,0 +1,310 @@
+#include "ffc_scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+int64_t steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+constexpr float kSlopeSmoothing = 0.2f;     // EWMA weight of the newest temperature slope
+constexpr float kCountsPerDegree = 36.0f;   // BASIC_AUTO_TEMP_THRESHOLD unit
+constexpr int kAutoTempThreshold = 0;       // basic_auto_ffc_param_e
+constexpr int kAutoMinInterval = 1;
+constexpr int kAutoMaxInterval = 2;
+
+} // namespace
+
+FfcScheduler::~FfcScheduler() {
+    stopThread();
+}
+
+void FfcScheduler::setDeviceOps(const FfcDeviceOps& ops) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ops_ = ops;
+}
+
+void FfcScheduler::configure(const FfcSchedulerParams& params) {
+    FfcSchedulerParams checked = params;
+    checked.toleranceC = std::max(checked.toleranceC, 0.05f);
+    checked.minIntervalS = std::max(checked.minIntervalS, 5);
+    checked.maxIntervalS = std::max(checked.maxIntervalS, checked.minIntervalS + 1);
+    checked.lookaheadS = std::max(checked.lookaheadS, 0);
+    checked.maxDeferS = std::max(checked.maxDeferS, 0);
+    checked.staticFrames = std::max(checked.staticFrames, 1);
+    checked.samplePeriodMs = std::clamp(checked.samplePeriodMs, 100, 10000);
+
+    FfcDeviceOps ops;
+    bool was_enabled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        was_enabled = params_.enabled;
+        params_ = checked;
+        ops = ops_;
+        static_threshold_.store(checked.staticThreshold, std::memory_order_relaxed);
+        static_frames_.store(checked.staticFrames, std::memory_order_relaxed);
+        if (checked.enabled && !was_enabled) {
+            last_ffc_us_ = steadyMicros();
+            ffc_temp_c_ = sensor_temp_c_;
+            slope_c_per_us_ = 0.0f;
+            due_since_us_ = -1;
+        }
+    }
+
+    if (!checked.enabled) {
+        stopThread();
+    } else if (!thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = false;
+        }
+        thread_ = std::thread(&FfcScheduler::telemetryLoop, this);
+    } else {
+        wake_cv_.notify_one();
+    }
+
+    // Enabled, the device keeps a looser auto FFC as a backstop; disabled, it takes over
+    // with the scheduler's own tolerance and intervals
+    if (ops.setAutoFfcParam && (checked.enabled || was_enabled)) {
+        const float scale = checked.enabled ? 2.0f : 1.0f;
+        const int threshold = static_cast<int>(std::lround(checked.toleranceC * scale * kCountsPerDegree));
+        const int max_interval = static_cast<int>(checked.maxIntervalS * scale);
+        // The device rejects a max below its current min, so when the new max is that low
+        // the min goes first; otherwise the max does, which keeps a raised min below it
+        int current_min = -1;
+        if (ops.getAutoFfcParam && ops.getAutoFfcParam(kAutoMinInterval, &current_min, ops.userPtr) != 0) {
+            current_min = -1;
+        }
+        const bool min_first = max_interval < current_min;
+        int result = min_first ? ops.setAutoFfcParam(kAutoMinInterval, checked.minIntervalS, ops.userPtr)
+                               : ops.setAutoFfcParam(kAutoMaxInterval, max_interval, ops.userPtr);
+        if (result == 0) {
+            result = min_first ? ops.setAutoFfcParam(kAutoMaxInterval, max_interval, ops.userPtr)
+                               : ops.setAutoFfcParam(kAutoMinInterval, checked.minIntervalS, ops.userPtr);
+        }
+        if (result == 0) {
+            result = ops.setAutoFfcParam(kAutoTempThreshold, threshold, ops.userPtr);
+        }
+        if (result != 0) {
+            FFC_LOGW("Cannot program device auto FFC (%d)", result);
+        }
+    }
+
+    FFC_LOGI("📸 FFC scheduler %s: tolerance %.2f°C, interval %d-%d s, lookahead %d s",
+             checked.enabled ? "enabled" : "disabled", checked.toleranceC, checked.minIntervalS,
+             checked.maxIntervalS, checked.lookaheadS);
+}
+
+FfcSchedulerParams FfcScheduler::getParams() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return params_;
+}
+
+void FfcScheduler::onFrame(const FrameStats& stats, const InfoLineParser& infoLine, bool recording) {
+    recording_.store(recording, std::memory_order_relaxed);
+
+    bool shutter_closed = false;
+    FrameMetadata metadata;
+    if (infoLine.getRows() > 0 && infoLine.read(&metadata)) {
+        shutter_closed = metadata.ffcInProgress;
+        info_temp_c_.store(metadata.sensorTemperatureC, std::memory_order_relaxed);
+        if (metadata.ffcCount != seen_device_count_) {
+            seen_device_count_ = metadata.ffcCount;
+            device_count_.store(metadata.ffcCount, std::memory_order_relaxed);
+            baseline_stddev_ = NAN;
+        }
+    }
+    const uint32_t generation = ffc_generation_.load(std::memory_order_relaxed);
+    if (generation != seen_generation_) {
+        seen_generation_ = generation;
+        baseline_stddev_ = NAN;
+    }
+
+    FrameStatsRecord frame;
+    if (shutter_closed || !stats.read(&frame)) {
+        // A frozen frame says nothing about the scene
+        static_run_ = 0;
+        previous_mean_ = NAN;
+        scene_static_.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    const bool temperature = frame.source == StatsSource::RAW_TEMPERATURE;
+    const float mean = temperature ? frame.meanC : frame.mean;
+    const float stddev = temperature ? frame.stddevC : frame.stddev;
+    const float threshold = static_threshold_.load(std::memory_order_relaxed);
+
+    if (!std::isnan(previous_mean_) && std::fabs(mean - previous_mean_) < threshold) {
+        static_run_++;
+    } else {
+        static_run_ = 0;
+        baseline_stddev_ = NAN;     // The baseline only describes the scene it was taken on
+        fpn_.store(NAN, std::memory_order_relaxed);
+    }
+    previous_mean_ = mean;
+
+    const bool is_static = static_run_ >= static_frames_.load(std::memory_order_relaxed);
+    scene_static_.store(is_static, std::memory_order_relaxed);
+    if (!is_static) {
+        return;
+    }
+    // Scene and optics unchanged: spatial variance over the post-FFC baseline is pattern noise
+    if (std::isnan(baseline_stddev_)) {
+        baseline_stddev_ = stddev;
+    }
+    const float excess = stddev * stddev - baseline_stddev_ * baseline_stddev_;
+    fpn_.store(excess > 0.0f ? std::sqrt(excess) : 0.0f, std::memory_order_relaxed);
+}
+
+FfcEstimate FfcScheduler::getEstimate() {
+    const int64_t now_us = steadyMicros();
+    std::lock_guard<std::mutex> lock(mutex_);
+    FfcEstimate estimate;
+    estimate.secondsToNext = (nextFfcUsLocked(params_) - now_us) / 1e6;
+    estimate.sensorTempC = sensor_temp_c_;
+    estimate.driftC = sensor_temp_c_ - ffc_temp_c_;
+    estimate.slopeCPerMin = slope_c_per_us_ * 60e6f;
+    estimate.secondsSinceLast = (now_us - last_ffc_us_) / 1e6;
+    estimate.fpn = fpn_.load(std::memory_order_relaxed);
+    estimate.sceneStatic = scene_static_.load(std::memory_order_relaxed);
+    estimate.hold = hold_.load(std::memory_order_relaxed);
+    estimate.hostCount = host_count_;
+    estimate.deviceCount = device_count_.load(std::memory_order_relaxed);
+    return estimate;
+}
+
+void FfcScheduler::telemetryLoop() {
+    uint64_t seen_device_count = device_count_.load(std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        wake_cv_.wait_for(lock, std::chrono::milliseconds(params_.samplePeriodMs), [this] { return stop_; });
+        if (stop_) {
+            break;
+        }
+        const FfcSchedulerParams params = params_;
+        const FfcDeviceOps ops = ops_;
+        lock.unlock();
+
+        // The device query goes through IrcmdManager's lock, never held together with ours
+        float temperature = NAN;
+        bool read_failed = true;
+        if (ops.readTemperature) {
+            read_failed = ops.readTemperature(&temperature, ops.userPtr) != 0;
+        }
+        if (read_failed) {
+            temperature = info_temp_c_.load(std::memory_order_relaxed);
+        }
+        const int64_t now_us = steadyMicros();
+        const uint64_t device_count = device_count_.load(std::memory_order_relaxed);
+
+        lock.lock();
+        if (read_failed != temperature_read_failed_) {
+            temperature_read_failed_ = read_failed;
+            if (read_failed) {
+                FFC_LOGW("Device temperature unavailable, using the info line");
+            }
+        }
+        if (!std::isnan(temperature)) {
+            if (!std::isnan(sensor_temp_c_) && now_us > last_sample_us_) {
+                const float slope = (temperature - sensor_temp_c_) / static_cast<float>(now_us - last_sample_us_);
+                slope_c_per_us_ += kSlopeSmoothing * (slope - slope_c_per_us_);
+            }
+            sensor_temp_c_ = temperature;
+            last_sample_us_ = now_us;
+            if (std::isnan(ffc_temp_c_)) {
+                ffc_temp_c_ = temperature;
+            }
+        }
+        if (device_count != seen_device_count) {
+            // Shutter closed, by us or by the device: drift restarts from here
+            seen_device_count = device_count;
+            last_ffc_us_ = now_us;
+            ffc_temp_c_ = sensor_temp_c_;
+            due_since_us_ = -1;
+        }
+        if (ops.performFfc && tickLocked(params, now_us)) {
+            // The FFC goes through IrcmdManager's lock too, and blocks while the shutter moves
+            lock.unlock();
+            const int result = ops.performFfc(ops.userPtr);
+            lock.lock();
+            if (result != 0) {
+                FFC_LOGW("FFC failed (%d)", result);
+            }
+        }
+    }
+}
+
+// Decides whether an FFC is taken now and, if so, books it; the caller runs it after releasing mutex_
+bool FfcScheduler::tickLocked(const FfcSchedulerParams& params, int64_t nowUs) {
+    if (nowUs - last_ffc_us_ < static_cast<int64_t>(params.minIntervalS) * 1000000) {
+        return false;
+    }
+    const int64_t next_us = nextFfcUsLocked(params);
+    const float drift = std::isnan(sensor_temp_c_ - ffc_temp_c_) ? 0.0f : std::fabs(sensor_temp_c_ - ffc_temp_c_);
+    const float fpn = fpn_.load(std::memory_order_relaxed);
+    const bool fpn_due = params.fpnTolerance > 0.0f && !std::isnan(fpn) && fpn >= params.fpnTolerance;
+    const bool held = hold_.load(std::memory_order_relaxed) || recording_.load(std::memory_order_relaxed);
+    const bool quiet = !held && scene_static_.load(std::memory_order_relaxed);
+
+    const char* reason = nullptr;
+    if (nowUs >= next_us || fpn_due) {
+        if (due_since_us_ < 0) {
+            due_since_us_ = nowUs;
+        }
+        if (quiet) {
+            reason = fpn_due ? "pattern noise" : "due, scene static";
+        } else if (!held && nowUs - due_since_us_ >= static_cast<int64_t>(params.maxDeferS) * 1000000) {
+            reason = "overdue";
+        } else if (held && drift >= 2.0f * params.toleranceC) {
+            reason = "drift past twice the tolerance while held";
+        }
+    } else if (quiet && next_us - nowUs <= static_cast<int64_t>(params.lookaheadS) * 1000000) {
+        reason = "early, scene static";
+    }
+    if (!reason) {
+        return false;
+    }
+    startFfcLocked(nowUs, reason);
+    return true;
+}
+
+void FfcScheduler::startFfcLocked(int64_t nowUs, const char* reason) {
+    FFC_LOGI("📸 FFC after %.0f s, drift %.2f°C: %s", (nowUs - last_ffc_us_) / 1e6,
+             sensor_temp_c_ - ffc_temp_c_, reason);
+    last_ffc_us_ = nowUs;
+    ffc_temp_c_ = sensor_temp_c_;
+    due_since_us_ = -1;
+    host_count_++;
+    ffc_generation_.fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t FfcScheduler::nextFfcUsLocked(const FfcSchedulerParams& params) const {
+    int64_t next_us = last_ffc_us_ + static_cast<int64_t>(params.maxIntervalS) * 1000000;
+    const float drift = std::fabs(sensor_temp_c_ - ffc_temp_c_);
+    const float slope = std::fabs(slope_c_per_us_);
+    if (!std::isnan(drift)) {
+        if (drift >= params.toleranceC) {
+            next_us = std::min(next_us, last_sample_us_);
+        } else if (slope > 0.0f) {
+            const double remaining_us = (params.toleranceC - drift) / slope;
+            if (remaining_us < static_cast<double>(next_us - last_sample_us_)) {
+                next_us = last_sample_us_ + static_cast<int64_t>(remaining_us);
+            }
+        }
+    }
+    return std::max(next_us, last_ffc_us_ + static_cast<int64_t>(params.minIntervalS) * 1000000);
+}
+
+void FfcScheduler::stopThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "frame_stats.h"
+#include "info_line.h"
+
+// Logging macros
+#define FFC_TAG "FfcScheduler"
+#define FFC_LOGI(...) __android_log_print(ANDROID_LOG_INFO, FFC_TAG, __VA_ARGS__)
+#define FFC_LOGW(...) __android_log_print(ANDROID_LOG_WARN, FFC_TAG, __VA_ARGS__)
+
+struct FfcSchedulerParams {
+    bool enabled = false;
+    float toleranceC = 0.5f;        // Sensor drift since the last FFC the image tolerates
+    float fpnTolerance = 0.0f;      // Fixed-pattern noise growth on a static scene (stats units); 0 ignores it
+    int minIntervalS = 30;
+    int maxIntervalS = 600;
+    int lookaheadS = 30;            // An FFC due this soon is taken early at a quiet moment
+    int maxDeferS = 20;             // How long a due FFC waits for the scene to settle
+    float staticThreshold = 0.05f;  // Frame mean change per frame below which the scene is static
+    int staticFrames = 25;          // Consecutive frames below it
+    int samplePeriodMs = 1000;      // Telemetry thread period
+};
+
+// Device access of the scheduler, called on its telemetry thread; each returns 0 on success
+struct FfcDeviceOps {
+    int (*readTemperature)(float* celsius, void* userPtr) = nullptr;
+    int (*performFfc)(void* userPtr) = nullptr;
+    int (*setAutoFfcParam)(int param, int value, void* userPtr) = nullptr;   // basic_auto_ffc_param_e
+    int (*getAutoFfcParam)(int param, int* value, void* userPtr) = nullptr;
+    void* userPtr = nullptr;
+};
+
+// Slots of the array filled by nativeGetFfcEstimate; keep in sync with CameraActivity.FFC_*
+enum FfcEstimateIndex {
+    FFC_SECONDS_TO_NEXT = 0,        // Negative when overdue and deferred
+    FFC_SENSOR_TEMP_C,              // NaN before the first sample
+    FFC_DRIFT_C,                    // Sensor temperature change since the last FFC
+    FFC_SLOPE_C_PER_MIN,
+    FFC_SECONDS_SINCE_LAST,
+    FFC_FPN,                        // Estimated fixed-pattern noise growth, NaN when unknown
+    FFC_SCENE_STATIC,
+    FFC_HOLD,
+    FFC_HOST_COUNT,                 // FFCs triggered by the scheduler
+    FFC_DEVICE_COUNT,               // Shutter closings seen in the info line, host or device
+    FFC_ESTIMATE_COUNT
+};
+
+struct FfcEstimate {
+    double secondsToNext;
+    float sensorTempC;
+    float driftC;
+    float slopeCPerMin;
+    double secondsSinceLast;
+    float fpn;
+    bool sceneStatic;
+    bool hold;
+    uint64_t hostCount;
+    uint64_t deviceCount;
+};
+
+/**
+ * Schedules flat field corrections from the host instead of leaving them to the device's
+ * timer, so the image freezes at a moment that hurts least.
+ *
+ * A telemetry thread samples the sensor temperature once a second (basic_device_temp_get,
+ * falling back to the info line) and tracks its slope; non-uniformity is taken to grow
+ * with the drift since the last FFC, and the time the drift reaches toleranceC is the
+ * next-FFC estimate, capped by maxIntervalS. On a static scene the frame thread also
+ * watches the frame's spatial stddev grow over the value measured right after the FFC,
+ * which is the fixed-pattern noise building up.
+ *
+ * An FFC within lookaheadS of being due is taken as soon as the scene is static and
+ * nothing holds it (recording, app measurements). A due FFC waits up to maxDeferS for a
+ * static scene; while held it waits until the drift doubles. The device's auto FFC stays
+ * enabled as a backstop with twice the tolerance and interval, so it only fires if the
+ * host does not. FFCs the device runs itself, seen in the info line, restart the estimate.
+ */
+class FfcScheduler {
+public:
+    FfcScheduler() = default;
+    ~FfcScheduler();
+
+    // Set before configure(); the ops must stay valid while the scheduler runs
+    void setDeviceOps(const FfcDeviceOps& ops);
+
+    // Any thread; starts or stops the telemetry thread and programs the device backstop
+    void configure(const FfcSchedulerParams& params);
+    FfcSchedulerParams getParams();
+
+    // Any thread: defer FFCs while set, e.g. during a measurement
+    void setHold(bool hold) { hold_.store(hold, std::memory_order_relaxed); }
+
+    // Frame thread
+    void onFrame(const FrameStats& stats, const InfoLineParser& infoLine, bool recording);
+
+    FfcEstimate getEstimate();
+
+private:
+    FfcScheduler(const FfcScheduler&) = delete;
+    FfcScheduler& operator=(const FfcScheduler&) = delete;
+
+    void telemetryLoop();
+    bool tickLocked(const FfcSchedulerParams& params, int64_t nowUs);
+    void startFfcLocked(int64_t nowUs, const char* reason);
+    int64_t nextFfcUsLocked(const FfcSchedulerParams& params) const;
+    void stopThread();
+
+    std::mutex mutex_;
+    FfcSchedulerParams params_;
+    FfcDeviceOps ops_;
+    std::thread thread_;
+    std::condition_variable wake_cv_;
+    bool stop_ = false;
+
+    // Telemetry state, guarded by mutex_
+    float sensor_temp_c_ = NAN;
+    int64_t last_sample_us_ = 0;
+    float slope_c_per_us_ = 0.0f;
+    float ffc_temp_c_ = NAN;
+    int64_t last_ffc_us_ = 0;
+    int64_t due_since_us_ = -1;
+    uint64_t host_count_ = 0;
+    bool temperature_read_failed_ = false;
+
+    // Read by the frame thread
+    std::atomic<float> static_threshold_{0.05f};
+    std::atomic<int> static_frames_{25};
+
+    // Published by the frame thread
+    std::atomic<bool> scene_static_{false};
+    std::atomic<bool> recording_{false};
+    std::atomic<bool> hold_{false};
+    std::atomic<float> fpn_{NAN};
+    std::atomic<float> info_temp_c_{NAN};
+    std::atomic<uint64_t> device_count_{0};
+    std::atomic<uint32_t> ffc_generation_{0};   // Bumped by every FFC, host or device
+
+    // Frame thread only
+    uint32_t seen_generation_ = 0;
+    uint64_t seen_device_count_ = 0;
+    float previous_mean_ = NAN;
+    int static_run_ = 0;
+    float baseline_stddev_ = NAN;       // First static stddev after an FFC
+};
@@ -0,0 +1,228 @@
+#include "frame_stats.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+int64_t steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct RowStats {
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint64_t sumSq;
+};
+
+// Y of a YUYV row: 16 pixels per step, Y deinterleaved by vld2q_u8
+RowStats lumaRowStats(const uint8_t* row, int width) {
+    RowStats stats = {255, 0, 0, 0};
+    int x = 0;
+#if defined(__ARM_NEON)
+    uint8x16_t vmin = vdupq_n_u8(255);
+    uint8x16_t vmax = vdupq_n_u8(0);
+    uint32x4_t vsum = vdupq_n_u32(0);
+    uint32x4_t vsq = vdupq_n_u32(0);
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t y = vld2q_u8(row + x * 2).val[0];
+        vmin = vminq_u8(vmin, y);
+        vmax = vmaxq_u8(vmax, y);
+        vsum = vpadalq_u16(vsum, vpaddlq_u8(y));
+        vsq = vpadalq_u16(vsq, vmull_u8(vget_low_u8(y), vget_low_u8(y)));
+        vsq = vpadalq_u16(vsq, vmull_u8(vget_high_u8(y), vget_high_u8(y)));
+    }
+    uint8_t lanes_min[16];
+    uint8_t lanes_max[16];
+    uint32_t lanes_sum[4];
+    uint32_t lanes_sq[4];
+    vst1q_u8(lanes_min, vmin);
+    vst1q_u8(lanes_max, vmax);
+    vst1q_u32(lanes_sum, vsum);
+    vst1q_u32(lanes_sq, vsq);
+    for (int lane = 0; lane < 16; lane++) {
+        stats.min = std::min<uint32_t>(stats.min, lanes_min[lane]);
+        stats.max = std::max<uint32_t>(stats.max, lanes_max[lane]);
+    }
+    for (int lane = 0; lane < 4; lane++) {
+        stats.sum += lanes_sum[lane];
+        stats.sumSq += lanes_sq[lane];
+    }
+#endif
+    for (; x < width; x++) {
+        const uint32_t y = row[x * 2];
+        stats.min = std::min(stats.min, y);
+        stats.max = std::max(stats.max, y);
+        stats.sum += y;
+        stats.sumSq += y * y;
+    }
+    return stats;
+}
+
+// Raw temperature row: 8 pixels per step, squares widened to 64 bits
+RowStats rawRowStats(const uint16_t* row, int width) {
+    RowStats stats = {0xFFFF, 0, 0, 0};
+    int x = 0;
+#if defined(__ARM_NEON)
+    uint16x8_t vmin = vdupq_n_u16(0xFFFF);
+    uint16x8_t vmax = vdupq_n_u16(0);
+    uint32x4_t vsum = vdupq_n_u32(0);
+    uint64x2_t vsq = vdupq_n_u64(0);
+    for (; x + 8 <= width; x += 8) {
+        const uint16x8_t v = vld1q_u16(row + x);
+        vmin = vminq_u16(vmin, v);
+        vmax = vmaxq_u16(vmax, v);
+        vsum = vpadalq_u16(vsum, v);
+        vsq = vpadalq_u32(vsq, vmull_u16(vget_low_u16(v), vget_low_u16(v)));
+        vsq = vpadalq_u32(vsq, vmull_u16(vget_high_u16(v), vget_high_u16(v)));
+    }
+    uint16_t lanes_min[8];
+    uint16_t lanes_max[8];
+    uint32_t lanes_sum[4];
+    uint64_t lanes_sq[2];
+    vst1q_u16(lanes_min, vmin);
+    vst1q_u16(lanes_max, vmax);
+    vst1q_u32(lanes_sum, vsum);
+    vst1q_u64(lanes_sq, vsq);
+    for (int lane = 0; lane < 8; lane++) {
+        stats.min = std::min<uint32_t>(stats.min, lanes_min[lane]);
+        stats.max = std::max<uint32_t>(stats.max, lanes_max[lane]);
+    }
+    for (int lane = 0; lane < 4; lane++) {
+        stats.sum += lanes_sum[lane];
+    }
+    stats.sumSq = lanes_sq[0] + lanes_sq[1];
+#endif
+    for (; x < width; x++) {
+        const uint64_t v = row[x];
+        stats.min = std::min<uint32_t>(stats.min, row[x]);
+        stats.max = std::max<uint32_t>(stats.max, row[x]);
+        stats.sum += v;
+        stats.sumSq += v * v;
+    }
+    return stats;
+}
+
+int findInLumaRow(const uint8_t* row, int width, uint32_t value) {
+    for (int x = 0; x < width; x++) {
+        if (row[x * 2] == value) {
+            return x;
+        }
+    }
+    return 0;
+}
+
+int findInRawRow(const uint16_t* row, int width, uint32_t value) {
+    for (int x = 0; x < width; x++) {
+        if (row[x] == value) {
+            return x;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+void FrameStats::update(const ThermalFrame& frame, const TemperatureLut& lut) {
+    if ((!frame.raw && !frame.image) || frame.width <= 0 || frame.height <= 0) {
+        return;
+    }
+    const int64_t start_us = steadyMicros();
+
+    FrameStatsRecord record = {};
+    record.frameNumber = ++frame_number_;
+    record.timestampUs = frame.timestampUs;
+    record.source = frame.raw ? StatsSource::RAW_TEMPERATURE : StatsSource::LUMA;
+    record.width = frame.width;
+    record.height = frame.height;
+
+    // Frame extremes are tracked per row; their columns are looked up afterwards
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    uint64_t sum = 0;
+    uint64_t sum_sq = 0;
+    int min_row = 0;
+    int max_row = 0;
+    for (int y = 0; y < frame.height; y++) {
+        const RowStats row = frame.raw
+            ? rawRowStats(frame.raw + static_cast<size_t>(y) * frame.width, frame.width)
+            : lumaRowStats(frame.image + static_cast<size_t>(y) * frame.width * 2, frame.width);
+        if (row.min < min) {
+            min = row.min;
+            min_row = y;
+        }
+        if (row.max > max) {
+            max = row.max;
+            max_row = y;
+        }
+        sum += row.sum;
+        sum_sq += row.sumSq;
+    }
+
+    if (frame.raw) {
+        record.minX = findInRawRow(frame.raw + static_cast<size_t>(min_row) * frame.width, frame.width, min);
+        record.maxX = findInRawRow(frame.raw + static_cast<size_t>(max_row) * frame.width, frame.width, max);
+    } else {
+        record.minX = findInLumaRow(frame.image + static_cast<size_t>(min_row) * frame.width * 2, frame.width, min);
+        record.maxX = findInLumaRow(frame.image + static_cast<size_t>(max_row) * frame.width * 2, frame.width, max);
+    }
+    record.minY = min_row;
+    record.maxY = max_row;
+
+    const double count = static_cast<double>(frame.width) * frame.height;
+    const double mean = sum / count;
+    const double variance = std::max(0.0, sum_sq / count - mean * mean);
+    record.min = static_cast<int32_t>(min);
+    record.max = static_cast<int32_t>(max);
+    record.mean = static_cast<float>(mean);
+    record.stddev = static_cast<float>(std::sqrt(variance));
+
+    if (frame.raw) {
+        // The conversion is monotonic, so the extremes map exactly; mean and spread use
+        // the local slope of the conversion around the mean
+        const uint16_t mean_raw = static_cast<uint16_t>(std::min(65534.0, mean));
+        const float mean_low = lut.toCelsius(mean_raw);
+        const float slope = lut.toCelsius(mean_raw + 1) - mean_low;
+        record.minC = lut.toCelsius(static_cast<uint16_t>(min));
+        record.maxC = lut.toCelsius(static_cast<uint16_t>(max));
+        record.meanC = mean_low + slope * static_cast<float>(mean - mean_raw);
+        record.stddevC = record.stddev * slope;
+    } else {
+        record.minC = record.maxC = record.meanC = record.stddevC = NAN;
+    }
+
+    record.computeUs = steadyMicros() - start_us;
+    publish(record);
+}
+
+void FrameStats::publish(const FrameStatsRecord& record) {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record_ = record;
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+bool FrameStats::read(FrameStatsRecord* out) const {
+    while (true) {
+        const uint32_t before = sequence_.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if (before & 1) {
+            continue;
+        }
+        const FrameStatsRecord copy = record_;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) {
+            *out = copy;
+            return true;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "radiometric.h"
+
+// What a FrameStatsRecord was computed over
+enum class StatsSource {
+    NONE = 0,
+    LUMA = 1,               // Y of the YUYV image plane
+    RAW_TEMPERATURE = 2     // 16-bit raw temperature plane
+};
+
+// Slots of the array filled by nativeGetFrameStats; keep in sync with CameraActivity.FRAME_STATS_*
+enum FrameStatsIndex {
+    FRAME_STATS_FRAME_NUMBER = 0,
+    FRAME_STATS_TIMESTAMP_US,
+    FRAME_STATS_SOURCE,
+    FRAME_STATS_WIDTH,
+    FRAME_STATS_HEIGHT,
+    FRAME_STATS_MIN,
+    FRAME_STATS_MAX,
+    FRAME_STATS_MEAN,
+    FRAME_STATS_STDDEV,
+    FRAME_STATS_MIN_X,
+    FRAME_STATS_MIN_Y,
+    FRAME_STATS_MAX_X,
+    FRAME_STATS_MAX_Y,
+    FRAME_STATS_MIN_C,
+    FRAME_STATS_MAX_C,
+    FRAME_STATS_MEAN_C,
+    FRAME_STATS_STDDEV_C,
+    FRAME_STATS_COMPUTE_US,
+    FRAME_STATS_COUNT
+};
+
+// Statistics of one frame. min/max/mean/stddev are in source units (luma or raw counts);
+// the °C fields are NaN for luma. Extremes are the first pixel in row-major order.
+struct FrameStatsRecord {
+    uint64_t frameNumber;
+    int64_t timestampUs;
+    StatsSource source;
+    int width;
+    int height;
+    int32_t min;
+    int32_t max;
+    float mean;
+    float stddev;
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+    float minC;
+    float maxC;
+    float meanC;
+    float stddevC;
+    int64_t computeUs;
+};
+
+/**
+ * Per-frame min/max/mean/stddev and hotspot/coldspot location.
+ *
+ * One vectorized pass accumulates sum, sum of squares and per-row extremes; only the two
+ * rows holding the frame's extremes are scanned again for their column. The result is
+ * published through a sequence lock, so the frame thread never waits for a reader and a
+ * reader never sees a half-written record.
+ */
+class FrameStats {
+public:
+    // Frame thread: temperature plane when the frame has one, otherwise the luma
+    void update(const ThermalFrame& frame, const TemperatureLut& lut);
+
+    // Any thread; false until the first frame was measured
+    bool read(FrameStatsRecord* out) const;
+
+private:
+    void publish(const FrameStatsRecord& record);
+
+    mutable std::atomic<uint32_t> sequence_{0};     // Odd while a write is in progress
+    FrameStatsRecord record_ = {};
+    uint64_t frame_number_ = 0;                     // Frame thread only
+};
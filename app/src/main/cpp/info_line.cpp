@@ -0,0 +1,106 @@
+#include "info_line.h"
+#include "libircmd.h"
+#include <cmath>
+
+namespace {
+
+constexpr int kFieldCount = static_cast<int>(InfoLineField::COUNT);
+
+int64_t extractField(const uint8_t* line, size_t bytes, const InfoLineFieldLayout& field) {
+    if (field.word < 0 || static_cast<size_t>(field.word) * 4 + 4 > bytes) {
+        return -1;
+    }
+    const uint8_t* p = line + static_cast<size_t>(field.word) * 4;
+    const uint32_t word = p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+    const uint32_t mask = field.bits >= 32 ? 0xFFFFFFFFu : (1u << field.bits) - 1;
+    return (word >> field.shift) & mask;
+}
+
+} // namespace
+
+InfoLineParser::InfoLineParser() {
+    configure(InfoLineLayout());
+}
+
+void InfoLineParser::configure(const InfoLineLayout& layout) {
+    auto copy = std::make_shared<InfoLineLayout>(layout);
+    for (InfoLineFieldLayout& field : copy->fields) {
+        if (field.shift < 0 || field.shift > 31 || field.bits < 1 || field.shift + field.bits > 32) {
+            field.word = -1;
+        }
+    }
+    if (copy->rows < 0) {
+        copy->rows = 0;
+    }
+    std::atomic_store(&layout_, std::shared_ptr<const InfoLineLayout>(std::move(copy)));
+    rows_.store(layout.rows > 0 ? layout.rows : 0, std::memory_order_relaxed);
+    INFO_LINE_LOGI("Info line: %d rows", layout.rows);
+}
+
+InfoLineLayout InfoLineParser::getLayout() const {
+    return *std::atomic_load(&layout_);
+}
+
+void InfoLineParser::parse(const uint8_t* line, size_t bytes, int64_t timestampUs) {
+    const std::shared_ptr<const InfoLineLayout> layout = std::atomic_load(&layout_);
+    if (layout != parsed_layout_) {
+        // New layout: counters restart with it
+        parsed_layout_ = layout;
+        frame_number_ = 0;
+        last_counter_ = last_shutter_ = -1;
+        frames_skipped_ = ffc_count_ = 0;
+    }
+
+    FrameMetadata record = {};
+    record.frameNumber = ++frame_number_;
+    record.timestampUs = timestampUs;
+    for (int i = 0; i < kFieldCount; i++) {
+        record.values[i] = extractField(line, bytes, layout->fields[i]);
+    }
+
+    const int64_t counter = record.values[static_cast<int>(InfoLineField::FRAME_COUNTER)];
+    if (counter >= 0 && last_counter_ >= 0 && counter > last_counter_ + 1) {
+        frames_skipped_ += counter - last_counter_ - 1;
+    }
+    last_counter_ = counter;
+
+    const int64_t shutter = record.values[static_cast<int>(InfoLineField::SHUTTER_STATUS)];
+    record.ffcInProgress = shutter == ADV_SHUTTER_CLOSE_STA;
+    if (record.ffcInProgress && last_shutter_ != ADV_SHUTTER_CLOSE_STA) {
+        ffc_count_++;
+    }
+    last_shutter_ = shutter;
+
+    const int64_t sensor_temp = record.values[static_cast<int>(InfoLineField::SENSOR_TEMPERATURE)];
+    record.sensorTemperatureC = sensor_temp >= 0
+        ? sensor_temp * layout->sensorTempScale + layout->sensorTempOffset : NAN;
+    record.deviceFramesSkipped = frames_skipped_;
+    record.ffcCount = ffc_count_;
+    publish(record);
+}
+
+void InfoLineParser::publish(const FrameMetadata& record) {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record_ = record;
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+bool InfoLineParser::read(FrameMetadata* out) const {
+    while (true) {
+        const uint32_t before = sequence_.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if (before & 1) {
+            continue;
+        }
+        const FrameMetadata copy = record_;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) {
+            *out = copy;
+            return true;
+        }
+    }
+}
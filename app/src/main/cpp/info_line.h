@@ -0,0 +1,124 @@
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Logging macros
+#define INFO_LINE_TAG "InfoLine"
+#define INFO_LINE_LOGI(...) __android_log_print(ANDROID_LOG_INFO, INFO_LINE_TAG, __VA_ARGS__)
+
+// Device state fields carried by the embedded info line
+enum class InfoLineField {
+    FRAME_COUNTER = 0,
+    MODEL_STATUS,
+    SHUTTER_STATUS,         // adv_shutter_status_e
+    AUTO_SHUTTER_STATUS,    // basic_auto_ffc_status_e
+    TPD_FORMAT,
+    MIRROR,
+    FLIP,
+    SENSOR_TEMPERATURE,     // Raw; converted with InfoLineLayout::sensorTempScale/Offset
+    COUNT
+};
+
+// Where a field sits in the info line: bits [shift, shift + bits) of the little-endian
+// 32-bit word at index word. word -1 leaves the field unmapped.
+struct InfoLineFieldLayout {
+    int word;
+    int shift;
+    int bits;
+};
+
+/**
+ * Info line geometry and field positions. The SDK documents the field order
+ * (adv_info_line_index_e) but not the byte layout, so the defaults put each index in its
+ * own word and everything can be overridden per firmware. The sensor temperature has no
+ * index and is unmapped by default.
+ */
+struct InfoLineLayout {
+    int rows = 0;                   // Rows appended below the frame; 0 disables parsing
+    InfoLineFieldLayout fields[static_cast<int>(InfoLineField::COUNT)] = {
+        {1, 0, 32},                 // FRAME_COUNTER: ADV_SW_FRAME_INFO
+        {3, 0, 32},                 // MODEL_STATUS: ADV_SW_MODEL_STATUS
+        {4, 0, 8},                  // SHUTTER_STATUS: ADV_SW_SHUTTER_STATUS
+        {5, 0, 8},                  // AUTO_SHUTTER_STATUS: ADV_SW_AUTO_SHUTTER_STATUS
+        {7, 0, 8},                  // TPD_FORMAT: ADV_SW_TPD_FORMAT
+        {8, 0, 1},                  // MIRROR: ADV_SW_MIRROR_ENALBE
+        {9, 0, 1},                  // FLIP: ADV_SW_FLIP_ENALBE
+        {-1, 0, 16},                // SENSOR_TEMPERATURE
+    };
+    float sensorTempScale = 0.01f;
+    float sensorTempOffset = 0.0f;
+};
+
+// Slots of the array filled by nativeGetFrameMetadata; keep in sync with CameraActivity.METADATA_*
+enum FrameMetadataIndex {
+    METADATA_FRAME_NUMBER = 0,
+    METADATA_TIMESTAMP_US,
+    METADATA_DEVICE_FRAME_COUNTER,
+    METADATA_DEVICE_FRAMES_SKIPPED,
+    METADATA_SHUTTER_STATUS,
+    METADATA_AUTO_SHUTTER_STATUS,
+    METADATA_MODEL_STATUS,
+    METADATA_TPD_FORMAT,
+    METADATA_MIRROR,
+    METADATA_FLIP,
+    METADATA_FFC_IN_PROGRESS,
+    METADATA_FFC_COUNT,
+    METADATA_SENSOR_TEMP_MILLI_C,
+    METADATA_COUNT
+};
+
+// Device state decoded from one frame's info line. Unmapped fields are -1.
+struct FrameMetadata {
+    uint64_t frameNumber;           // Frames parsed since the parser was configured
+    int64_t timestampUs;
+    int64_t values[static_cast<int>(InfoLineField::COUNT)];
+    uint64_t deviceFramesSkipped;   // Gaps in the device frame counter
+    bool ffcInProgress;             // Shutter closed
+    uint64_t ffcCount;              // Shutter closings seen
+    float sensorTemperatureC;       // NaN when unmapped
+};
+
+/**
+ * Per-frame device metadata from the info line embedded in the video frame, replacing the
+ * adv_info_line_get / adv_shutter_status_get / basic_device_temp_get round trips.
+ *
+ * parse() reads a handful of words out of the rows below the picture, so it costs next to
+ * nothing on the frame thread. Records are published through a sequence lock like
+ * FrameStats.
+ */
+class InfoLineParser {
+public:
+    InfoLineParser();
+
+    // Any thread; the caller restarts the stream when the row count changes
+    void configure(const InfoLineLayout& layout);
+    InfoLineLayout getLayout() const;
+    int getRows() const { return rows_.load(std::memory_order_relaxed); }
+
+    // Frame thread: line points at the first info line row
+    void parse(const uint8_t* line, size_t bytes, int64_t timestampUs);
+
+    // Any thread; false until the first info line was parsed
+    bool read(FrameMetadata* out) const;
+
+private:
+    void publish(const FrameMetadata& record);
+
+    std::shared_ptr<const InfoLineLayout> layout_;  // Accessed with std::atomic_load/atomic_store
+    std::atomic<int> rows_{0};
+
+    // Frame thread only
+    std::shared_ptr<const InfoLineLayout> parsed_layout_;
+    uint64_t frame_number_ = 0;
+    int64_t last_counter_ = -1;
+    int64_t last_shutter_ = -1;
+    uint64_t frames_skipped_ = 0;
+    uint64_t ffc_count_ = 0;
+
+    mutable std::atomic<uint32_t> sequence_{0};     // Odd while a write is in progress
+    FrameMetadata record_ = {};
+};
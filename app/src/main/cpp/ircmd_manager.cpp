@@ -2,9 +2,11 @@
 #include <libusb.h>
 #include <pthread.h>
 #include <thread>
+#include <algorithm>
 #include "libircmd.h"
 #include "error.h"
 #include "libircam.h"
+#include "startup_profiler.h"
 
 // Forward declaration if the type isn't available from headers
 #ifndef IrcmdHandle_t
@@ -64,6 +66,8 @@ bool IrcmdManager::init(int fileDescriptor, int deviceType) {
         return true;
     }
 
+    ScopedStartupPhase phase("ircmd: init");
+
     // Register both SDK logging callbacks
     ircam_log_register(IRCAM_LOG_DEBUG, ircam_log_callback, nullptr);
     ircmd_log_register(IRCMD_LOG_DEBUG, ircmd_log_callback, nullptr);
@@ -153,35 +157,7 @@ bool IrcmdManager::init(int fileDescriptor, int deviceType) {
     }
     IRCMD_LOGI("Device verified as Thermal Camera Co.,Ltd camera");
 
-    // After getting the device descriptor, enumerate interfaces
-    libusb_config_descriptor* config;
-    int res_config = libusb_get_active_config_descriptor(usb_dev, &config);
-    if (res_config == LIBUSB_SUCCESS) {
-        IRCMD_LOGI("Device has %d interfaces", config->bNumInterfaces);
-        
-        for (int i = 0; i < config->bNumInterfaces; i++) {
-            const libusb_interface* interface = &config->interface[i];
-            IRCMD_LOGI("Interface %d has %d alternate settings", i, interface->num_altsetting);
-            
-            for (int j = 0; j < interface->num_altsetting; j++) {
-                const libusb_interface_descriptor* if_desc = &interface->altsetting[j];
-                IRCMD_LOGI("  Interface %d, Alt Setting %d:", i, j);
-                IRCMD_LOGI("    Class: %d", if_desc->bInterfaceClass);
-                IRCMD_LOGI("    Subclass: %d", if_desc->bInterfaceSubClass);
-                IRCMD_LOGI("    Protocol: %d", if_desc->bInterfaceProtocol);
-                IRCMD_LOGI("    Number of endpoints: %d", if_desc->bNumEndpoints);
-                
-                for (int k = 0; k < if_desc->bNumEndpoints; k++) {
-                    const libusb_endpoint_descriptor* ep = &if_desc->endpoint[k];
-                    IRCMD_LOGI("      Endpoint %d:", k);
-                    IRCMD_LOGI("        Address: 0x%02x", ep->bEndpointAddress);
-                    IRCMD_LOGI("        Attributes: 0x%02x", ep->bmAttributes);
-                    IRCMD_LOGI("        Max packet size: %d", ep->wMaxPacketSize);
-                }
-            }
-        }
-        libusb_free_config_descriptor(config);
-    }
+    // The interface/endpoint walk is diagnostic only, see logUsbTopology()
 
     // Create IRCMD handle structures
     IRCMD_LOGI("Creating handle structures...");
@@ -271,6 +247,13 @@ bool IrcmdManager::init(int fileDescriptor, int deviceType) {
     auto& registry = CameraFunctionRegistry::getInstance();
     registry.initializeAllFunctions();
     IRCMD_LOGI("Camera function registry initialized");
+
+    // Ranges are fetched once so SETs can be validated without a round trip
+    parameter_store_.reset();
+    {
+        ScopedStartupPhase rangesPhase("ircmd: parameter ranges");
+        parameter_store_.fetchRanges(getCmdHandle());
+    }
     
     is_initialized_ = true;
     IRCMD_LOGI("IrcmdManager initialized successfully");
@@ -319,6 +302,7 @@ void IrcmdManager::cleanup() {
         usb_ctx_ = nullptr;
     }
     
+    parameter_store_.reset();
     is_initialized_ = false;
     last_error_ = 0;
 }
@@ -416,10 +400,14 @@ int IrcmdManager::executeGetFunction(CameraFunction func, int& outValue) {
                  * 2. Improper initialization sequence for the SDK
                  * 3. Possible SDK bug in the read functions
                  * 
-                 * For now, returning a default value to avoid crashes
+                 * The last brightness that reached the device is served from the
+                 * parameter store instead; before any SET a default is returned.
                  */
-                IRCMD_LOGI("Get brightness called - disabled to prevent crash");
-                outValue = 50; // Default value
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    const ParameterState* state = parameter_store_.get(CameraFunctionId::BRIGHTNESS);
+                    outValue = (state && state->hasValue) ? state->value : 50; // Default value
+                }
                 return 0; // Success
             
             // Add more cases as needed
@@ -438,17 +426,22 @@ int IrcmdManager::executeGetFunction(CameraFunction func, int& outValue) {
 }
 
 int IrcmdManager::executeSetFunction(CameraFunction func, int value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
     if (!is_initialized_ || !ircmd_handle_) {
         IRCMD_LOGE("Cannot execute function: IrcmdManager not initialized");
         return -2;
     }
     
+    CameraFunctionId functionId;
     switch (func) {
         case SET_BRIGHTNESS:
-            return basic_image_brightness_level_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::BRIGHTNESS;
+            break;
         
         case SET_CONTRAST:
-            return basic_image_contrast_level_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::CONTRAST;
+            break;
         
         case SET_PALETTE:
             // Ensure value is within valid range (0-11)
@@ -456,7 +449,8 @@ int IrcmdManager::executeSetFunction(CameraFunction func, int value) {
                 IRCMD_LOGE("Invalid palette index: %d", value);
                 return -1;
             }
-            return basic_palette_idx_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::PALETTE_INDEX;
+            break;
         
         case SET_SCENE_MODE:
             // Ensure value is within valid range (0-11)
@@ -464,30 +458,50 @@ int IrcmdManager::executeSetFunction(CameraFunction func, int value) {
                 IRCMD_LOGE("Invalid scene mode: %d", value);
                 return -1;
             }
-            return basic_image_scene_mode_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::SCENE_MODE;
+            break;
 
         case SET_NOISE_REDUCTION:
-            return basic_image_noise_reduction_level_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::NOISE_REDUCTION;
+            break;
 
         case SET_TIME_NOISE_REDUCTION:
-            return basic_time_noise_reduce_level_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::TIME_NOISE_REDUCTION;
+            break;
 
         case SET_SPACE_NOISE_REDUCTION:
-            return basic_space_noise_reduce_level_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::SPACE_NOISE_REDUCTION;
+            break;
 
         case SET_DETAIL_ENHANCEMENT:
-            return basic_image_detail_enhance_level_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::DETAIL_ENHANCEMENT;
+            break;
 
         case SET_GLOBAL_CONTRAST:
-            return basic_global_contrast_level_set(getCmdHandle(), value);
+            functionId = CameraFunctionId::GLOBAL_CONTRAST;
+            break;
         
         default:
             IRCMD_LOGE("Unknown set function: %d", func);
             return -1;
     }
+
+    // Same path as registry SETs, so the parameter store validates and records legacy calls too
+    int result = parameter_store_.validate(functionId, value, 0);
+    if (result != 0) {
+        return result;
+    }
+
+    result = CameraFunctionRegistry::getInstance().executeSetFunction(functionId, getCmdHandle(), value);
+    if (result == 0) {
+        parameter_store_.recordSet(functionId, value, 0);
+    }
+    return result;
 }
 
 int IrcmdManager::executeActionFunction(CameraFunction func) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
     if (!is_initialized_ || !ircmd_handle_) {
         IRCMD_LOGE("Cannot execute function: IrcmdManager not initialized");
         return -2;
@@ -508,6 +522,8 @@ int IrcmdManager::executeActionFunction(CameraFunction func) {
 // ===== NEW REGISTRY-BASED FUNCTION IMPLEMENTATIONS =====
 
 int IrcmdManager::executeSetFunction(CameraFunctionId functionId, int value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
     if (!is_initialized_ || !ircmd_handle_) {
         IRCMD_LOGE("Cannot execute function: IrcmdManager not initialized");
         return -2;
@@ -516,23 +532,42 @@ int IrcmdManager::executeSetFunction(CameraFunctionId functionId, int value) {
     IRCMD_LOGI("Executing registry-based SET function ID: %d with value: %d", 
                static_cast<int>(functionId), value);
     
+    int result = parameter_store_.validate(functionId, value, 0);
+    if (result != 0) {
+        return result;
+    }
+
     auto& registry = CameraFunctionRegistry::getInstance();
-    return registry.executeSetFunction(functionId, getCmdHandle(), value);
+    result = registry.executeSetFunction(functionId, getCmdHandle(), value);
+    if (result == 0) {
+        parameter_store_.recordSet(functionId, value, 0);
+    }
+    return result;
 }
 
 int IrcmdManager::executeGetFunction(CameraFunctionId functionId, int& outValue) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
     if (!is_initialized_ || !ircmd_handle_) {
         IRCMD_LOGE("Cannot execute function: IrcmdManager not initialized");
         return -2;
     }
-    
-    IRCMD_LOGI("Executing registry-based GET function ID: %d", static_cast<int>(functionId));
-    
-    auto& registry = CameraFunctionRegistry::getInstance();
-    return registry.executeGetFunction(functionId, getCmdHandle(), &outValue);
+
+    // Device reads crash in libircmd (standard_cmd_read), so answer from the shadow store
+    const ParameterState* state = parameter_store_.get(functionId);
+    if (!state) {
+        return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
+    }
+    if (!state->hasValue) {
+        return static_cast<int>(RegistryError::VALUE_UNKNOWN);
+    }
+    outValue = state->value;
+    return 0;
 }
 
 int IrcmdManager::executeSetFunction2(CameraFunctionId functionId, int value1, int value2) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
     if (!is_initialized_ || !ircmd_handle_) {
         IRCMD_LOGE("Cannot execute function: IrcmdManager not initialized");
         return -2;
@@ -541,11 +576,22 @@ int IrcmdManager::executeSetFunction2(CameraFunctionId functionId, int value1, i
     IRCMD_LOGI("Executing registry-based SET function 2 ID: %d with values: %d, %d", 
                static_cast<int>(functionId), value1, value2);
     
+    int result = parameter_store_.validate(functionId, value1, value2);
+    if (result != 0) {
+        return result;
+    }
+
     auto& registry = CameraFunctionRegistry::getInstance();
-    return registry.executeSetFunction2(functionId, getCmdHandle(), value1, value2);
+    result = registry.executeSetFunction2(functionId, getCmdHandle(), value1, value2);
+    if (result == 0) {
+        parameter_store_.recordSet(functionId, value1, value2);
+    }
+    return result;
 }
 
 int IrcmdManager::executeActionFunction(CameraFunctionId functionId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
     if (!is_initialized_ || !ircmd_handle_) {
         IRCMD_LOGE("Cannot execute function: IrcmdManager not initialized");
         return -2;
@@ -555,4 +601,142 @@ int IrcmdManager::executeActionFunction(CameraFunctionId functionId) {
     
     auto& registry = CameraFunctionRegistry::getInstance();
     return registry.executeActionFunction(functionId, getCmdHandle());
-} 
\ No newline at end of file
+} 
+
+int IrcmdManager::readDeviceTemperature(float& celsius) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!is_initialized_ || !ircmd_handle_) {
+        return -2;
+    }
+    // Polled by the FFC scheduler; failures are not logged here
+    return static_cast<int>(basic_device_temp_get(getCmdHandle(), &celsius));
+}
+
+// ===== BATCHED PARAMETER APPLICATION =====
+
+int IrcmdManager::applyBatchEntryLocked(const ParameterBatchEntry& entry) {
+    auto& registry = CameraFunctionRegistry::getInstance();
+    const bool isSet2 = registry.isSetFunction2Registered(entry.functionId);
+    const int value2 = isSet2 ? entry.value2 : 0;
+
+    if (parameter_store_.matches(entry.functionId, entry.value, value2)) {
+        return static_cast<int>(RegistryError::SKIPPED_UNCHANGED);
+    }
+
+    int result = parameter_store_.validate(entry.functionId, entry.value, value2);
+    if (result != 0) {
+        return result;
+    }
+
+    result = isSet2
+        ? registry.executeSetFunction2(entry.functionId, getCmdHandle(), entry.value, entry.value2)
+        : registry.executeSetFunction(entry.functionId, getCmdHandle(), entry.value);
+    if (result == 0) {
+        parameter_store_.recordSet(entry.functionId, entry.value, value2);
+    }
+    return result;
+}
+
+int IrcmdManager::executeSetFunctionBatch(const std::vector<ParameterBatchEntry>& entries, std::vector<int>& results) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    results.assign(entries.size(), -2);
+    if (!is_initialized_ || !ircmd_handle_) {
+        IRCMD_LOGE("Cannot execute batch: IrcmdManager not initialized");
+        return -2;
+    }
+
+    // Apply in dependency order, keeping the caller's order within the same priority
+    auto& registry = CameraFunctionRegistry::getInstance();
+    std::vector<size_t> order(entries.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return registry.getApplyPriority(entries[a].functionId) < registry.getApplyPriority(entries[b].functionId);
+    });
+
+    int firstError = 0;
+    int applied = 0;
+    int skipped = 0;
+    for (size_t index : order) {
+        int result = applyBatchEntryLocked(entries[index]);
+        results[index] = result;
+        if (result == 0) {
+            applied++;
+        } else if (result == static_cast<int>(RegistryError::SKIPPED_UNCHANGED)) {
+            skipped++;
+        } else if (firstError == 0) {
+            firstError = result;
+        }
+    }
+
+    IRCMD_LOGI("Batch of %zu entries: %d applied, %d skipped, %zu failed",
+               entries.size(), applied, skipped, entries.size() - applied - skipped);
+    return firstError;
+}
+
+bool IrcmdManager::getParameterState(CameraFunctionId functionId, ParameterState& outState) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const ParameterState* state = parameter_store_.get(functionId);
+    if (!state) {
+        return false;
+    }
+    outState = *state;
+    return true;
+}
+
+std::vector<ParameterBatchEntry> IrcmdManager::getKnownParameters() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& registry = CameraFunctionRegistry::getInstance();
+    std::vector<ParameterBatchEntry> entries;
+    for (int i = 0; i < kFunctionCount; i++) {
+        const CameraFunctionId id = functionIdAtIndex(i);
+        const ParameterState* state = parameter_store_.get(id);
+        if (state && state->hasValue && registry.isPersistent(id)) {
+            entries.push_back({id, state->value, state->value2});
+        }
+    }
+    return entries;
+}
+
+void IrcmdManager::logUsbTopology() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!is_initialized_ || !usb_devh_) {
+        IRCMD_LOGW("Cannot log USB topology: IrcmdManager not initialized");
+        return;
+    }
+
+    libusb_config_descriptor* config;
+    int res_config = libusb_get_active_config_descriptor(libusb_get_device(usb_devh_), &config);
+    if (res_config == LIBUSB_SUCCESS) {
+        IRCMD_LOGI("Device has %d interfaces", config->bNumInterfaces);
+        
+        for (int i = 0; i < config->bNumInterfaces; i++) {
+            const libusb_interface* interface = &config->interface[i];
+            IRCMD_LOGI("Interface %d has %d alternate settings", i, interface->num_altsetting);
+            
+            for (int j = 0; j < interface->num_altsetting; j++) {
+                const libusb_interface_descriptor* if_desc = &interface->altsetting[j];
+                IRCMD_LOGI("  Interface %d, Alt Setting %d:", i, j);
+                IRCMD_LOGI("    Class: %d", if_desc->bInterfaceClass);
+                IRCMD_LOGI("    Subclass: %d", if_desc->bInterfaceSubClass);
+                IRCMD_LOGI("    Protocol: %d", if_desc->bInterfaceProtocol);
+                IRCMD_LOGI("    Number of endpoints: %d", if_desc->bNumEndpoints);
+                
+                for (int k = 0; k < if_desc->bNumEndpoints; k++) {
+                    const libusb_endpoint_descriptor* ep = &if_desc->endpoint[k];
+                    IRCMD_LOGI("      Endpoint %d:", k);
+                    IRCMD_LOGI("        Address: 0x%02x", ep->bEndpointAddress);
+                    IRCMD_LOGI("        Attributes: 0x%02x", ep->bmAttributes);
+                    IRCMD_LOGI("        Max packet size: %d", ep->wMaxPacketSize);
+                }
+            }
+        }
+        libusb_free_config_descriptor(config);
+    }
+}
@@ -3,8 +3,10 @@
 #include <android/log.h>
 #include <libusb.h>
 #include <mutex>
+#include <vector>
 #include "libircmd.h"  // Include this for error codes and function declarations
 #include "camera_function_registry.h"  // Include our new registry
+#include "parameter_store.h"
 
 // Logging macros
 #define IRCMD_LOG_TAG "IrcmdManager"
@@ -131,6 +133,13 @@ enum CameraFunction {
     // Add more as needed...
 };
 
+// One entry of a batched parameter update
+struct ParameterBatchEntry {
+    CameraFunctionId functionId;
+    int value;
+    int value2;     // Only used by SET2 functions
+};
+
 class IrcmdManager {
 public:
     IrcmdManager();
@@ -156,11 +165,28 @@ public:
         return reinterpret_cast<IrcmdHandle_t*>(ircmd_handle_);
     }
 
-    // New registry-based function execution  
+    // New registry-based function execution.
+    // GETs are answered from the parameter store (no USB traffic): RegistryError::VALUE_UNKNOWN until a SET succeeded.
+    // SETs outside the range reported by the device return RegistryError::OUT_OF_RANGE without being sent.
     int executeGetFunction(CameraFunctionId functionId, int& outValue);
     int executeSetFunction(CameraFunctionId functionId, int value);
     int executeSetFunction2(CameraFunctionId functionId, int value1, int value2);
     int executeActionFunction(CameraFunctionId functionId);
+
+    // Apply several SET/SET2 functions in dependency order under a single lock.
+    // Entries whose value matches the last applied value are skipped.
+    // results[i] receives the outcome of entries[i]: 0, RegistryError::SKIPPED_UNCHANGED or an error code.
+    // Returns 0 if no entry failed, otherwise the first error encountered.
+    int executeSetFunctionBatch(const std::vector<ParameterBatchEntry>& entries, std::vector<int>& results);
+
+    // Module temperature read from the device (basic_device_temp_get), not cached; 0 on success
+    int readDeviceTemperature(float& celsius);
+
+    // Copy of the shadow state of one parameter. Returns false for unknown IDs.
+    bool getParameterState(CameraFunctionId functionId, ParameterState& outState);
+
+    // Persistent settings with a known value, in a form executeSetFunctionBatch() can re-apply
+    std::vector<ParameterBatchEntry> getKnownParameters();
     
     // Legacy function execution (for backward compatibility during transition)
     int executeGetFunction(CameraFunction func, int& outValue);
@@ -170,10 +196,16 @@ public:
     // Set device type based on actual device
     void setDeviceType();
 
+    // Log every interface and endpoint of the device. Diagnostic only, not part of init().
+    void logUsbTopology();
+
 private:
     // Set the last error code
     void setError(int error_code);
 
+    // Must be called with mutex_ held
+    int applyBatchEntryLocked(const ParameterBatchEntry& entry);
+
     // Internal state
     bool is_initialized_;
     int last_error_;
@@ -185,4 +217,7 @@ private:
 
     // IRCMD handle
     MySdk_IrcmdHandle_t* ircmd_handle_;
+
+    // Values that reached the device and ranges reported by it, guarded by mutex_
+    ParameterStore parameter_store_;
 }; 
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "isotherm_overlay.h"
+#include <atomic>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Opacity used in TRANSPARENT mode when a band color has no alpha
+constexpr uint8_t kDefaultAlpha = 128;
+
+} // namespace
+
+IsothermOverlay::IsothermOverlay() {
+    configure(IsothermConfig());
+}
+
+bool IsothermOverlay::configure(const IsothermConfig& config) {
+    if (config.bands.size() > static_cast<size_t>(kMaxBands)) {
+        return false;
+    }
+
+    auto state = std::make_shared<State>();
+    state->config = config;
+    for (const IsothermBand& band : config.bands) {
+        Band prepared;
+        prepared.lower = band.lower;
+        prepared.upper = band.upper;
+        prepared.color[0] = static_cast<uint8_t>(band.argb >> 16);
+        prepared.color[1] = static_cast<uint8_t>(band.argb >> 8);
+        prepared.color[2] = static_cast<uint8_t>(band.argb);
+        prepared.color[3] = 255;
+        const uint8_t alpha = static_cast<uint8_t>(band.argb >> 24);
+        prepared.alpha = config.mode == IsothermMode::SOLID ? 255 : (alpha ? alpha : kDefaultAlpha);
+        for (int c = 0; c < 4; c++) {
+            prepared.premultiplied[c] = static_cast<uint16_t>(prepared.color[c] * prepared.alpha + 128);
+        }
+        state->bands.push_back(prepared);
+    }
+
+    std::atomic_store(&state_, std::shared_ptr<const State>(std::move(state)));
+    ISOTHERM_LOGI("Isotherms: mode %d%s, %zu bands", static_cast<int>(config.mode),
+                  config.inverse ? " (inverse)" : "", config.bands.size());
+    return true;
+}
+
+IsothermConfig IsothermOverlay::getConfig() const {
+    return std::atomic_load(&state_)->config;
+}
+
+bool IsothermOverlay::beginFrame() {
+    frame_state_ = std::atomic_load(&state_);
+    return frame_state_->config.mode != IsothermMode::OFF && !frame_state_->bands.empty();
+}
+
+void IsothermOverlay::apply(const ThermalFrame& frame, int x0, int y0, int columns, int rows, uint8_t* rgba,
+                            int strideBytes) {
+    if (!frame_state_ || (!frame.celsius && !frame.image)) {
+        return;
+    }
+    const State& state = *frame_state_;
+
+    for (int row = 0; row < rows; row++) {
+        const size_t y = static_cast<size_t>(y0 + row);
+        const float* values;
+        if (frame.celsius) {
+            values = frame.celsius + y * frame.width + x0;
+        } else {
+            luma_row_.resize(columns);
+            const uint8_t* yuyv = frame.image + (y * frame.width + x0) * 2;
+            for (int x = 0; x < columns; x++) {
+                luma_row_[x] = yuyv[x * 2];
+            }
+            values = luma_row_.data();
+        }
+        applyRow(state, values, rgba + static_cast<ptrdiff_t>(row) * strideBytes, columns);
+    }
+}
+
+void IsothermOverlay::applyRow(const State& state, const float* values, uint8_t* rgba, int width) const {
+    const bool inverse = state.config.inverse;
+    const bool solid = state.config.mode == IsothermMode::SOLID;
+    const size_t band_count = state.bands.size();
+    int x = 0;
+
+#if defined(__ARM_NEON)
+    // Four pixels per step: one float compare per bound, blend in 16-bit, select per pixel
+    float32x4_t lower[kMaxBands];
+    float32x4_t upper[kMaxBands];
+    uint8x16_t color[kMaxBands];
+    uint16x8_t premultiplied[kMaxBands];
+    uint8x8_t inverse_alpha[kMaxBands];
+    for (size_t b = 0; b < band_count; b++) {
+        const Band& band = state.bands[b];
+        lower[b] = vdupq_n_f32(band.lower);
+        upper[b] = vdupq_n_f32(band.upper);
+        color[b] = vreinterpretq_u8_u32(vdupq_n_u32(band.color[0] | band.color[1] << 8 |
+                                                    band.color[2] << 16 | static_cast<uint32_t>(band.color[3]) << 24));
+        const uint16x4_t premultiplied_pixel = vld1_u16(band.premultiplied);
+        premultiplied[b] = vcombine_u16(premultiplied_pixel, premultiplied_pixel);
+        inverse_alpha[b] = vdup_n_u8(255 - band.alpha);
+    }
+
+    // The blend rounds 255 down to 254; the window gets opaque pixels regardless
+    const uint8x16_t opaque = vreinterpretq_u8_u32(vdupq_n_u32(0xFF000000u));
+    for (; x + 4 <= width; x += 4) {
+        const float32x4_t v = vld1q_f32(values + x);
+        const uint8x16_t pixels = vld1q_u8(rgba + x * 4);
+        uint8x16_t out = pixels;
+        uint32x4_t claimed = vdupq_n_u32(0);
+        for (size_t b = 0; b < band_count; b++) {
+            uint32x4_t match = vandq_u32(vcgeq_f32(v, lower[b]), vcleq_f32(v, upper[b]));
+            if (inverse) {
+                match = vmvnq_u32(match);
+            }
+            match = vbicq_u32(match, claimed);
+            claimed = vorrq_u32(claimed, match);
+
+            uint8x16_t recolored;
+            if (solid) {
+                recolored = color[b];
+            } else {
+                const uint8x8_t low = vshrn_n_u16(vmlal_u8(premultiplied[b], vget_low_u8(pixels), inverse_alpha[b]), 8);
+                const uint8x8_t high = vshrn_n_u16(vmlal_u8(premultiplied[b], vget_high_u8(pixels), inverse_alpha[b]), 8);
+                recolored = vorrq_u8(vcombine_u8(low, high), opaque);
+            }
+            out = vbslq_u8(vreinterpretq_u8_u32(match), recolored, out);
+        }
+        vst1q_u8(rgba + x * 4, out);
+    }
+#endif
+
+    for (; x < width; x++) {
+        const float v = values[x];
+        uint8_t* pixel = rgba + x * 4;
+        for (size_t b = 0; b < band_count; b++) {
+            const Band& band = state.bands[b];
+            if ((v >= band.lower && v <= band.upper) == inverse) {
+                continue;
+            }
+            for (int c = 0; c < 3; c++) {
+                pixel[c] = solid ? band.color[c]
+                                 : static_cast<uint8_t>((band.premultiplied[c] + pixel[c] * (255 - band.alpha)) >> 8);
+            }
+            pixel[3] = 255;
+            break;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <android/log.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "radiometric.h"
+
+// Logging macros
+#define ISOTHERM_TAG "IsothermOverlay"
+#define ISOTHERM_LOGI(...) __android_log_print(ANDROID_LOG_INFO, ISOTHERM_TAG, __VA_ARGS__)
+
+// Values are shared with Kotlin (CameraActivity.ISOTHERM_MODE_*)
+enum class IsothermMode {
+    OFF = 0,
+    SOLID = 1,          // Matching pixels are replaced by the band color
+    TRANSPARENT = 2     // Band color is blended over matching pixels with the color's alpha
+};
+
+// Pixels with lower <= value <= upper match; values are °C when the frame has a temperature
+// plane and luma otherwise
+struct IsothermBand {
+    float lower;
+    float upper;
+    uint32_t argb;      // 0xAARRGGBB, alpha is only used in TRANSPARENT mode
+};
+
+struct IsothermConfig {
+    IsothermMode mode = IsothermMode::OFF;
+    bool inverse = false;               // Match pixels outside a band instead of inside
+    std::vector<IsothermBand> bands;    // Earlier bands win where bands overlap
+};
+
+/**
+ * Threshold bands recolored on the display buffer, in place of the firmware isotherm.
+ *
+ * configure() builds the per-band constants off to the side and swaps them in, so a change
+ * is picked up by the next frame without a device round trip. Per frame the renderer calls
+ * beginFrame() once and then apply() on each strip of rows right after converting it; NEON
+ * compares four values against every band and blends the four RGBA pixels with a bit select.
+ */
+class IsothermOverlay {
+public:
+    static constexpr int kMaxBands = 4;
+
+    IsothermOverlay();
+
+    // Any thread. Returns false if the config has more than kMaxBands bands.
+    bool configure(const IsothermConfig& config);
+    IsothermConfig getConfig() const;
+
+    // Frame thread: false when there is nothing to draw this frame
+    bool beginFrame();
+
+    // Frame thread: recolors rows [y0, y0 + rows) and columns [x0, x0 + columns) of an
+    // RGBA_8888 buffer whose first pixel is frame pixel (x0, y0); a negative strideBytes
+    // walks the buffer upwards
+    void apply(const ThermalFrame& frame, int x0, int y0, int columns, int rows, uint8_t* rgba, int strideBytes);
+
+private:
+    struct Band {
+        float lower;
+        float upper;
+        uint8_t color[4];       // RGBA_8888 byte order
+        uint8_t alpha;
+        uint16_t premultiplied[4];  // color * alpha + 128, for the transparent blend
+    };
+
+    struct State {
+        IsothermConfig config;
+        std::vector<Band> bands;
+    };
+
+    void applyRow(const State& state, const float* values, uint8_t* rgba, int width) const;
+
+    std::shared_ptr<const State> state_;    // Accessed with std::atomic_load/atomic_store
+    std::shared_ptr<const State> frame_state_;  // Frame thread only
+    std::vector<float> luma_row_;               // Frame thread only
+};
@@ -0,0 +1,82 @@
+#include "jni_bridge.h"
+
+jclass JniBridge::findClass(JNIEnv* env, const char* name) {
+    jclass local = env->FindClass(name);
+    if (!local) {
+        env->ExceptionClear();
+        BRIDGE_LOGW("Class %s not found at load, it will be resolved per call", name);
+        return nullptr;
+    }
+    jclass global = static_cast<jclass>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+void JniBridge::onLoad(JavaVM* vm, JNIEnv* env) {
+    vm_ = vm;
+
+    int_wrapper_class_ = findClass(env, "com/example/ircmd_handle/IrcmdManager$MutableIntWrapper");
+    if (int_wrapper_class_) {
+        int_wrapper_value_ = env->GetFieldID(int_wrapper_class_, "value", "I");
+    }
+
+    jclass recorder_class = findClass(env, "com/example/ircmd_handle/VideoRecorder");
+    if (recorder_class) {
+        encoder_frame_method_ = env->GetMethodID(recorder_class, "onNativeYUVFrame", "(Ljava/nio/ByteBuffer;IIJ)V");
+        // Method IDs stay valid while the class is loaded; VideoRecorder is never unloaded
+        env->DeleteGlobalRef(recorder_class);
+    }
+
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+    }
+    BRIDGE_LOGI("JNI IDs cached: int wrapper %s, encoder callback %s",
+                int_wrapper_value_ ? "yes" : "no", encoder_frame_method_ ? "yes" : "no");
+}
+
+void JniBridge::setIntWrapper(JNIEnv* env, jobject wrapper, int value) {
+    if (int_wrapper_value_) {
+        env->SetIntField(wrapper, int_wrapper_value_, value);
+        return;
+    }
+
+    jclass wrapper_class = env->GetObjectClass(wrapper);
+    jfieldID value_field = env->GetFieldID(wrapper_class, "value", "I");
+    env->SetIntField(wrapper, value_field, value);
+    env->DeleteLocalRef(wrapper_class);
+}
+
+void JniBridge::setEncoderTarget(JNIEnv* env, jobject recorder) {
+    std::lock_guard<std::mutex> lock(encoder_mutex_);
+    if (encoder_target_) {
+        env->DeleteGlobalRef(encoder_target_);
+        encoder_target_ = nullptr;
+    }
+    if (recorder) {
+        encoder_target_ = env->NewGlobalRef(recorder);
+    }
+}
+
+bool JniBridge::callEncoderTarget(JNIEnv* env, jobject buffer, int width, int height, int64_t timestampUs) {
+    std::lock_guard<std::mutex> lock(encoder_mutex_);
+    if (!encoder_target_ || !encoder_frame_method_) {
+        return false;
+    }
+
+    env->CallVoidMethod(encoder_target_, encoder_frame_method_, buffer,
+                        width, height, static_cast<jlong>(timestampUs));
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+        return false;
+    }
+    return true;
+}
+
+extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* /* reserved */) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
+    JniBridge::getInstance().onLoad(vm, env);
+    return JNI_VERSION_1_6;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <jni.h>
+#include <android/log.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Logging macros
+#define BRIDGE_TAG "JniBridge"
+#define BRIDGE_LOGI(...) __android_log_print(ANDROID_LOG_INFO, BRIDGE_TAG, __VA_ARGS__)
+#define BRIDGE_LOGW(...) __android_log_print(ANDROID_LOG_WARN, BRIDGE_TAG, __VA_ARGS__)
+
+// Slots of the array filled by nativeGetTelemetry; keep in sync with CameraActivity.TELEMETRY_*
+enum TelemetryIndex {
+    TELEMETRY_STREAMING = 0,
+    TELEMETRY_FRAMES_RECEIVED,
+    TELEMETRY_FRAMES_DECIMATED,
+    TELEMETRY_FRAMES_RENDERED,
+    TELEMETRY_FRAMES_ENCODED,
+    TELEMETRY_TIME_TO_FIRST_FRAME_US,
+    TELEMETRY_STREAM_START_US,
+    TELEMETRY_STREAM_START_CACHED,
+    TELEMETRY_FPS_SWITCH_US,
+    TELEMETRY_FPS_SWITCH_CACHED,
+    TELEMETRY_FPS_SWITCH_MODE,
+    TELEMETRY_FPS_SWITCH_LATENCY_US,
+    TELEMETRY_FPS_SWITCH_LOST_FRAMES,
+    TELEMETRY_NEGOTIATION_HITS,
+    TELEMETRY_NEGOTIATION_MISSES,
+    TELEMETRY_TRACE_DROPPED_EVENTS,
+    TELEMETRY_ENCODER_DELIVERED,
+    TELEMETRY_ENCODER_DROPPED_QUEUE_FULL,
+    TELEMETRY_ENCODER_DROPPED_NOT_RUNNING,
+    TELEMETRY_ENCODER_DROPPED_FAILED,
+    TELEMETRY_COUNT
+};
+
+/**
+ * JNI lookups done once instead of on every call.
+ *
+ * Class, method and field IDs are resolved in JNI_OnLoad; a lookup that fails there
+ * (class not loaded by the app's loader yet) is left null and the caller falls back to
+ * resolving it per call. Encoder frames reach Kotlin in direct ByteBuffers (see
+ * EncoderDelivery), so a frame costs no Java array allocation or copy.
+ */
+class JniBridge {
+public:
+    static JniBridge& getInstance() {
+        static JniBridge instance;
+        return instance;
+    }
+
+    // Called from JNI_OnLoad
+    void onLoad(JavaVM* vm, JNIEnv* env);
+
+    JavaVM* getJavaVM() const { return vm_; }
+
+    // IrcmdManager.MutableIntWrapper.value = value
+    void setIntWrapper(JNIEnv* env, jobject wrapper, int value);
+
+    // VideoRecorder.onNativeYUVFrame(ByteBuffer, Int, Int, Long) was resolved at load
+    bool hasEncoderFrameMethod() const { return encoder_frame_method_ != nullptr; }
+
+    // VideoRecorder instance that receives encoder frames; null clears it
+    void setEncoderTarget(JNIEnv* env, jobject recorder);
+
+    // Call onNativeYUVFrame on the target with a direct buffer holding one YUV420 frame.
+    // Returns false if there is no target or the call threw.
+    bool callEncoderTarget(JNIEnv* env, jobject buffer, int width, int height, int64_t timestampUs);
+
+private:
+    JniBridge() = default;
+    JniBridge(const JniBridge&) = delete;
+    JniBridge& operator=(const JniBridge&) = delete;
+
+    // Global ref to a class, or nullptr with the pending exception cleared
+    static jclass findClass(JNIEnv* env, const char* name);
+
+    JavaVM* vm_ = nullptr;
+    jclass int_wrapper_class_ = nullptr;
+    jfieldID int_wrapper_value_ = nullptr;
+    jmethodID encoder_frame_method_ = nullptr;
+
+    // Held across the call so the target cannot go away mid-frame
+    std::mutex encoder_mutex_;
+    jobject encoder_target_ = nullptr;      // Global ref to the VideoRecorder
+};
@@ -0,0 +1,57 @@
+#include "measurement_recorder.h"
+#include <cmath>
+#include <string>
+
+void MeasurementRecorder::record(TimeSeriesStore& store, const FrameStats& stats, RoiEngine& rois,
+                                 const InfoLineParser& infoLine) {
+    if (store_ != &store) {
+        store_ = &store;
+        frame_min_ = store.getSeries("frame.min");
+        frame_max_ = store.getSeries("frame.max");
+        frame_mean_ = store.getSeries("frame.mean");
+        sensor_temp_ = store.getSeries("device.sensor_temp_c");
+        ffc_ = store.getSeries("device.ffc");
+        roi_series_.clear();
+    }
+
+    FrameStatsRecord frame;
+    if (!stats.read(&frame)) {
+        return;
+    }
+    const int64_t timestamp_us = frame.timestampUs;
+    if (frame.source == StatsSource::RAW_TEMPERATURE) {
+        store.append(frame_min_, timestamp_us, frame.minC);
+        store.append(frame_max_, timestamp_us, frame.maxC);
+        store.append(frame_mean_, timestamp_us, frame.meanC);
+    } else {
+        store.append(frame_min_, timestamp_us, static_cast<float>(frame.min));
+        store.append(frame_max_, timestamp_us, static_cast<float>(frame.max));
+        store.append(frame_mean_, timestamp_us, frame.mean);
+    }
+
+    rois.getResults(&roi_results_);
+    for (const RoiResult& result : roi_results_) {
+        if (result.pixelCount == 0) {
+            continue;
+        }
+        auto it = roi_series_.find(result.id);
+        if (it == roi_series_.end()) {
+            const std::string prefix = "roi." + std::to_string(result.id);
+            it = roi_series_.emplace(result.id, RoiSeries{store.getSeries(prefix + ".mean"),
+                                                          store.getSeries(prefix + ".max")}).first;
+        }
+        store.append(it->second.mean, timestamp_us, result.mean);
+        store.append(it->second.max, timestamp_us, result.max);
+    }
+
+    FrameMetadata metadata;
+    if (infoLine.getRows() > 0 && infoLine.read(&metadata)) {
+        if (!std::isnan(metadata.sensorTemperatureC)) {
+            store.append(sensor_temp_, timestamp_us, metadata.sensorTemperatureC);
+        }
+        if (metadata.ffcCount != last_ffc_count_) {
+            last_ffc_count_ = metadata.ffcCount;
+            store.append(ffc_, timestamp_us, static_cast<float>(metadata.ffcCount));
+        }
+    }
+}
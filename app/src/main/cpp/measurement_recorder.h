@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "frame_stats.h"
+#include "info_line.h"
+#include "roi_engine.h"
+#include "timeseries_store.h"
+
+/**
+ * Feeds the per-frame measurements into a TimeSeriesStore:
+ *
+ *   frame.min / frame.max / frame.mean     °C with a temperature plane, luma otherwise
+ *   roi.<id>.mean / roi.<id>.max
+ *   device.sensor_temp_c                   when the info line maps it
+ *   device.ffc                             running FFC count, appended when it changes
+ *
+ * Series ids are looked up once and cached, so a frame costs a few appends.
+ */
+class MeasurementRecorder {
+public:
+    // Frame thread, after FrameStats, RoiEngine and InfoLineParser saw the frame
+    void record(TimeSeriesStore& store, const FrameStats& stats, RoiEngine& rois, const InfoLineParser& infoLine);
+
+private:
+    struct RoiSeries {
+        int mean;
+        int max;
+    };
+
+    TimeSeriesStore* store_ = nullptr;      // Store the cached ids belong to
+    int frame_min_ = -1;
+    int frame_max_ = -1;
+    int frame_mean_ = -1;
+    int sensor_temp_ = -1;
+    int ffc_ = -1;
+    uint64_t last_ffc_count_ = UINT64_MAX;
+    std::unordered_map<int, RoiSeries> roi_series_;
+    std::vector<RoiResult> roi_results_;
+};
@@ -0,0 +1,172 @@
+#include "motion_detector.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+constexpr int kBlockSize = 4;               // Sum of a block is its mean in 12.4 fixed point
+constexpr int kFractionBits = 4;
+constexpr float kGlobalChangeFraction = 0.5f;
+
+} // namespace
+
+MotionDetector::MotionDetector() {
+    configure(MotionParams());
+}
+
+bool MotionDetector::configure(const MotionParams& params) {
+    if (params.threshold < 1 || params.threshold > 255 || params.activeFraction <= 0.0f ||
+        params.activeFraction >= kGlobalChangeFraction || params.triggerFrames < 1 ||
+        params.holdOffMs < 0 || params.backgroundShift < 1 || params.backgroundShift > 10) {
+        return false;
+    }
+    std::atomic_store(&params_, std::shared_ptr<const MotionParams>(std::make_shared<MotionParams>(params)));
+    MOTION_LOGI("Motion detection %s: threshold %d, active at %.2f%% of blocks for %d frames, hold %d ms",
+                params.enabled ? "enabled" : "disabled", params.threshold, params.activeFraction * 100.0f,
+                params.triggerFrames, params.holdOffMs);
+    return true;
+}
+
+MotionParams MotionDetector::getParams() const {
+    return *std::atomic_load(&params_);
+}
+
+bool MotionDetector::isEnabled() const {
+    return std::atomic_load(&params_)->enabled;
+}
+
+void MotionDetector::process(const uint8_t* yuyv, int width, int height, int64_t timestampUs) {
+    const int64_t start_ns = steadyNanos();
+    const std::shared_ptr<const MotionParams> params = std::atomic_load(&params_);
+    const int blocks_x = width / kBlockSize;
+    const int blocks_y = height / kBlockSize;
+    if (blocks_x <= 0 || blocks_y <= 0) {
+        return;
+    }
+
+    // New size or new params: the background is learned again from this frame
+    if (blocks_x != blocks_x_ || blocks_y != blocks_y_ || params != running_params_) {
+        blocks_x_ = blocks_x;
+        blocks_y_ = blocks_y;
+        blocks_.resize(static_cast<size_t>(blocks_x) * blocks_y);
+        background_.resize(blocks_.size());
+        running_params_ = params;
+        primed_ = false;
+        active_run_ = 0;
+        active_.store(false, std::memory_order_relaxed);
+    }
+
+    const size_t row_bytes = static_cast<size_t>(width) * 2;
+    for (int by = 0; by < blocks_y; by++) {
+        downsampleRows(yuyv + by * kBlockSize * row_bytes, width, blocks_x, blocks_.data() + by * blocks_x);
+    }
+
+    const int count = static_cast<int>(blocks_.size());
+    float score = 0.0f;
+    if (!primed_) {
+        background_ = blocks_;
+        primed_ = true;
+    } else {
+        const int changed = compareBlocks(blocks_.data(), background_.data(), count,
+                                          static_cast<int16_t>(params->threshold << kFractionBits),
+                                          params->backgroundShift);
+        score = static_cast<float>(changed) / count;
+        if (score >= kGlobalChangeFraction) {
+            // Shutter or gain step, not a scene event
+            background_ = blocks_;
+            score = 0.0f;
+        }
+    }
+
+    if (score >= params->activeFraction) {
+        active_run_++;
+        if (active_run_ >= params->triggerFrames) {
+            last_motion_us_ = timestampUs;
+            if (!active_.load(std::memory_order_relaxed)) {
+                active_.store(true, std::memory_order_relaxed);
+                activations_.fetch_add(1, std::memory_order_relaxed);
+                MOTION_LOGI("🏃 Activity started: %.2f%% of blocks changed", score * 100.0f);
+            }
+        }
+    } else {
+        active_run_ = 0;
+        if (active_.load(std::memory_order_relaxed) &&
+            timestampUs - last_motion_us_ > static_cast<int64_t>(params->holdOffMs) * 1000) {
+            active_.store(false, std::memory_order_relaxed);
+            MOTION_LOGI("Activity ended");
+        }
+    }
+    score_.store(score, std::memory_order_relaxed);
+
+    const int64_t elapsed_ns = steadyNanos() - start_ns;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    last_ns_.store(elapsed_ns, std::memory_order_relaxed);
+    total_ns_.fetch_add(elapsed_ns, std::memory_order_relaxed);
+}
+
+void MotionDetector::downsampleRows(const uint8_t* yuyv, int width, int blocksX, int16_t* blocks) {
+    const size_t row_bytes = static_cast<size_t>(width) * 2;
+    int bx = 0;
+#if defined(__ARM_NEON)
+    // 16 pixels, four blocks, per iteration
+    for (; bx + 4 <= blocksX; bx += 4) {
+        const uint8_t* src = yuyv + bx * kBlockSize * 2;
+        uint16x8_t pairs = vpaddlq_u8(vld2q_u8(src).val[0]);
+        for (int row = 1; row < kBlockSize; row++) {
+            pairs = vpadalq_u8(pairs, vld2q_u8(src + row * row_bytes).val[0]);
+        }
+        const uint16x4_t sums = vpadd_u16(vget_low_u16(pairs), vget_high_u16(pairs));
+        vst1_s16(blocks + bx, vreinterpret_s16_u16(sums));
+    }
+#endif
+    for (; bx < blocksX; bx++) {
+        int sum = 0;
+        for (int row = 0; row < kBlockSize; row++) {
+            const uint8_t* src = yuyv + row * row_bytes + bx * kBlockSize * 2;
+            sum += src[0] + src[2] + src[4] + src[6];
+        }
+        blocks[bx] = static_cast<int16_t>(sum);
+    }
+}
+
+int MotionDetector::compareBlocks(const int16_t* blocks, int16_t* background, int count, int16_t threshold, int shift) {
+    int changed = 0;
+    int i = 0;
+#if defined(__ARM_NEON)
+    const int16x8_t threshold_v = vdupq_n_s16(threshold);
+    const int16x8_t shift_v = vdupq_n_s16(static_cast<int16_t>(-shift));
+    uint32x4_t changed_v = vdupq_n_u32(0);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t bg = vld1q_s16(background + i);
+        const int16x8_t diff = vsubq_s16(vld1q_s16(blocks + i), bg);
+        const uint16x8_t is_changed = vcgtq_s16(vabsq_s16(diff), threshold_v);
+        changed_v = vpadalq_u16(changed_v, vshrq_n_u16(is_changed, 15));
+        vst1q_s16(background + i, vaddq_s16(bg, vrshlq_s16(diff, shift_v)));
+    }
+    changed = static_cast<int>(vgetq_lane_u32(changed_v, 0) + vgetq_lane_u32(changed_v, 1) +
+                               vgetq_lane_u32(changed_v, 2) + vgetq_lane_u32(changed_v, 3));
+#endif
+    const int round = 1 << (shift - 1);
+    for (; i < count; i++) {
+        const int diff = blocks[i] - background[i];
+        changed += std::abs(diff) > threshold;
+        background[i] = static_cast<int16_t>(background[i] + ((diff + round) >> shift));
+    }
+    return changed;
+}
+
+MotionState MotionDetector::getState() const {
+    return {active_.load(std::memory_order_relaxed), score_.load(std::memory_order_relaxed),
+            activations_.load(std::memory_order_relaxed), frames_.load(std::memory_order_relaxed),
+            last_ns_.load(std::memory_order_relaxed), total_ns_.load(std::memory_order_relaxed)};
+}
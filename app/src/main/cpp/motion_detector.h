@@ -0,0 +1,92 @@
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Logging macros
+#define MOTION_TAG "MotionDetector"
+#define MOTION_LOGI(...) __android_log_print(ANDROID_LOG_INFO, MOTION_TAG, __VA_ARGS__)
+
+struct MotionParams {
+    bool enabled = false;
+    int threshold = 6;              // Luma change of a 4x4 block average that counts as changed
+    float activeFraction = 0.002f;  // Changed blocks, as a share of all, that make a frame active
+    int triggerFrames = 3;          // Consecutive active frames before activity starts
+    int holdOffMs = 3000;           // Quiet time before activity ends
+    int backgroundShift = 5;        // Background adapts by 1 / 2^shift of the difference per frame
+};
+
+// Slots of the array filled by nativeGetMotionState; keep in sync with CameraActivity.MOTION_*
+enum MotionStateIndex {
+    MOTION_ACTIVE = 0,
+    MOTION_SCORE,                   // Changed share of the latest frame, 0..1
+    MOTION_ACTIVATIONS,
+    MOTION_FRAMES,
+    MOTION_LAST_NS,
+    MOTION_MEAN_NS,
+    MOTION_PRE_ROLL_FRAMES,         // Filled by the caller from PreRollBuffer
+    MOTION_STATE_COUNT
+};
+
+struct MotionState {
+    bool active;
+    float score;
+    uint64_t activations;
+    uint64_t frames;
+    int64_t lastNs;
+    int64_t totalNs;
+};
+
+/**
+ * Scene change detection driving motion-triggered recording.
+ *
+ * The luma is averaged over 4x4 blocks (pairwise widening adds, 16 pixels per NEON
+ * iteration), and every block is compared with a running background kept in 12.4 fixed
+ * point: blocks differing by more than threshold count as changed, and the background
+ * moves towards the frame by a rounding shift, so objects that stop become background.
+ * The activity score is the changed share of the blocks. A frame where most blocks change
+ * at once (FFC, a gain jump) restarts the background instead of counting as activity.
+ *
+ * Activity starts after triggerFrames consecutive frames over activeFraction and ends
+ * holdOffMs after the last one; the app polls it to start and stop recording.
+ */
+class MotionDetector {
+public:
+    MotionDetector();
+
+    // Any thread; applied from the next frame. Returns false if the params are out of range.
+    bool configure(const MotionParams& params);
+    MotionParams getParams() const;
+    bool isEnabled() const;
+
+    // Frame thread: yuyv is width * 2 bytes per row
+    void process(const uint8_t* yuyv, int width, int height, int64_t timestampUs);
+
+    MotionState getState() const;
+
+private:
+    static void downsampleRows(const uint8_t* yuyv, int width, int blocksX, int16_t* blocks);
+    static int compareBlocks(const int16_t* blocks, int16_t* background, int count, int16_t threshold, int shift);
+
+    std::shared_ptr<const MotionParams> params_;    // Accessed with std::atomic_load/atomic_store
+
+    // Frame thread only
+    std::vector<int16_t> blocks_;
+    std::vector<int16_t> background_;       // 12.4 fixed point, like blocks_
+    int blocks_x_ = 0;
+    int blocks_y_ = 0;
+    bool primed_ = false;
+    int active_run_ = 0;
+    int64_t last_motion_us_ = 0;
+    std::shared_ptr<const MotionParams> running_params_;
+
+    std::atomic<bool> active_{false};
+    std::atomic<float> score_{0.0f};
+    std::atomic<uint64_t> activations_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<int64_t> last_ns_{0};
+    std::atomic<int64_t> total_ns_{0};
+};
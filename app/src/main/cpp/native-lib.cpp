@@ -6,10 +6,17 @@
 #include <cstring>
 #include <cstdint>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
 #include "uvc_manager.h"
+#include "trace_ring.h"
+#include "jni_bridge.h"
+#include "encoder_delivery.h"
 #include "libircmd.h"
 #include "ircmd_manager.h"
 #include "camera_function_registry.h"
+#include "device_snapshot.h"
+#include "startup_profiler.h"
 
 // Global camera instance
 static std::unique_ptr<UVCCamera> g_camera;
@@ -17,10 +24,12 @@ static std::unique_ptr<UVCCamera> g_camera;
 // Global IrcmdManager instance
 static std::unique_ptr<IrcmdManager> g_ircmd_manager;
 
-// Global variables for direct video recording
-static JavaVM* g_jvm = nullptr;
-static jobject g_video_recorder_obj = nullptr;
-static jmethodID g_encoder_callback_method = nullptr;
+// Warm-start snapshot of the connected device, shared by the UVC and ircmd paths
+static DeviceSnapshot g_snapshot;
+static BadPixelMap g_bad_pixels;     // Per sensor, kept across reconnects
+
+// Carries encoder frames from the libuvc thread to VideoRecorder
+static EncoderDelivery g_encoder_delivery;
 
 // Add new global variables to store the current device configuration
 static int g_current_width = 384;
@@ -28,31 +37,71 @@ static int g_current_height = 288;
 static int g_current_fps = 60;
 
 // Native callback function for direct video encoding
+// Runs on the libuvc thread, which is not attached to the JVM: queue the frame for the
+// delivery thread instead of calling into Kotlin here
 void nativeVideoEncoderCallback(uint8_t* yuvData, int width, int height, int64_t timestampUs, void* userPtr) {
-    if (g_jvm == nullptr || g_video_recorder_obj == nullptr || g_encoder_callback_method == nullptr) {
+    const size_t dataSize = static_cast<size_t>(width) * height * 3 / 2; // YUV420 size
+    g_encoder_delivery.submit(yuvData, dataSize, width, height, timestampUs);
+}
+
+int nativeVideoEncoderRoomCallback(void* userPtr) {
+    return g_encoder_delivery.getFreeSlots();
+}
+
+// Persist the current shadow parameter values into the device snapshot
+static void saveSnapshotParameters() {
+    if (!g_ircmd_manager || !g_ircmd_manager->isInitialized()) {
         return;
     }
-    
-    JNIEnv* env;
-    if (g_jvm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
-        return;
+    std::vector<SnapshotParameter> parameters;
+    for (const ParameterBatchEntry& entry : g_ircmd_manager->getKnownParameters()) {
+        parameters.push_back({static_cast<int32_t>(entry.functionId), entry.value, entry.value2});
     }
-    
-    // Create a Java byte array for the YUV data
-    int dataSize = width * height * 3 / 2; // YUV420 size
-    jbyteArray yuvArray = env->NewByteArray(dataSize);
-    if (yuvArray == nullptr) {
-        return;
+    g_snapshot.saveParameters(parameters);
+}
+
+// Device-side output rate for live frame rate switches; fails when ircmd is not up
+// or the model does not output this rate, and UVCCamera then decimates on the host.
+// The models run a 25/50 or a 30/60 family, told apart by the negotiated link rate.
+static int setDeviceOutputFrameRate(int fps, int linkFps, void* userPtr) {
+    if (!g_ircmd_manager || !g_ircmd_manager->isInitialized()) {
+        return -1;
     }
-    
-    env->SetByteArrayRegion(yuvArray, 0, dataSize, reinterpret_cast<jbyte*>(yuvData));
-    
-    // Call the Java callback method
-    env->CallVoidMethod(g_video_recorder_obj, g_encoder_callback_method, 
-                       yuvArray, width, height, timestampUs);
-    
-    // Clean up local reference
-    env->DeleteLocalRef(yuvArray);
+    if ((linkFps != 50 && linkFps != 60) || (fps != linkFps && fps != linkFps / 2)) {
+        return -1;
+    }
+    return g_ircmd_manager->executeSetFunction(CameraFunctionId::OUTPUT_FRAME_RATE, fps);
+}
+
+// Device access of the FFC scheduler, on its telemetry thread; fails while ircmd is not up
+static int readFfcTemperature(float* celsius, void* userPtr) {
+    if (!g_ircmd_manager || !g_ircmd_manager->isInitialized()) {
+        return -1;
+    }
+    return g_ircmd_manager->readDeviceTemperature(*celsius);
+}
+
+static int performFfc(void* userPtr) {
+    if (!g_ircmd_manager || !g_ircmd_manager->isInitialized()) {
+        return -1;
+    }
+    return g_ircmd_manager->executeActionFunction(CameraFunctionId::FFC_UPDATE);
+}
+
+static int setAutoFfcParam(int param, int value, void* userPtr) {
+    if (!g_ircmd_manager || !g_ircmd_manager->isInitialized()) {
+        return -1;
+    }
+    const int functionId = static_cast<int>(CameraFunctionId::AUTO_FFC_TEMP_THRESHOLD) + param;
+    return g_ircmd_manager->executeSetFunction(static_cast<CameraFunctionId>(functionId), value);
+}
+
+static int getAutoFfcParam(int param, int* value, void* userPtr) {
+    if (!g_ircmd_manager || !g_ircmd_manager->isInitialized()) {
+        return -1;
+    }
+    const int functionId = static_cast<int>(CameraFunctionId::AUTO_FFC_TEMP_THRESHOLD) + param;
+    return g_ircmd_manager->executeGetFunction(static_cast<CameraFunctionId>(functionId), *value);
 }
 
 extern "C" {
@@ -67,6 +116,15 @@ Java_com_example_ircmd_1handle_CameraActivity_nativeOpenUvcCamera(JNIEnv* env, j
     if (!g_camera) {
         g_camera = std::make_unique<UVCCamera>();
     }
+    g_camera->setSnapshot(&g_snapshot);
+    g_camera->setBadPixelMap(&g_bad_pixels);
+    g_camera->setDeviceFrameRateCallback(setDeviceOutputFrameRate, nullptr);
+    FfcDeviceOps ffcOps;
+    ffcOps.readTemperature = readFfcTemperature;
+    ffcOps.performFfc = performFfc;
+    ffcOps.setAutoFfcParam = setAutoFfcParam;
+    ffcOps.getAutoFfcParam = getAutoFfcParam;
+    g_camera->getFfcScheduler().setDeviceOps(ffcOps);
     return g_camera->init(fd) ? JNI_TRUE : JNI_FALSE;
 }
 
@@ -102,13 +160,68 @@ Java_com_example_ircmd_1handle_CameraActivity_nativeStopStreaming(JNIEnv* env, j
 
 JNIEXPORT void JNICALL
 Java_com_example_ircmd_1handle_CameraActivity_nativeCloseUvcCamera(JNIEnv* env, jobject thiz) {
+    saveSnapshotParameters();
     if (g_camera) {
         g_camera->cleanup();
         g_camera.reset();
     }
 }
 
-JNIEXPORT jobject JNICALL
+// Start a new startup profile; called when a connection attempt begins
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeBeginStartupProfile(JNIEnv* env, jobject thiz) {
+    StartupProfiler::getInstance().begin();
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetStartupReport(JNIEnv* env, jobject thiz) {
+    return env->NewStringUTF(StartupProfiler::getInstance().report().c_str());
+}
+
+// Descriptor and USB topology dumps that used to run during init
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeDumpDeviceDiagnostics(JNIEnv* env, jobject thiz) {
+    if (g_camera) {
+        g_camera->dumpDiagnostics();
+    }
+    if (g_ircmd_manager) {
+        g_ircmd_manager->logUsbTopology();
+    }
+}
+
+// Decode the last events of every trace ring into a file; returns the event count or -1
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeDumpTrace(JNIEnv* env, jobject thiz, jstring path, jint maxEvents) {
+    const char* file = env->GetStringUTFChars(path, nullptr);
+    if (!file) {
+        return -1;
+    }
+    const int count = TraceRing::dumpToFile(file, maxEvents > 0 ? static_cast<size_t>(maxEvents) : 0);
+    env->ReleaseStringUTFChars(path, file);
+    return count;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetSnapshotDirectory(JNIEnv* env, jobject thiz, jstring directory) {
+    const char* path = env->GetStringUTFChars(directory, nullptr);
+    if (path) {
+        g_snapshot.setDirectory(path);
+        env->ReleaseStringUTFChars(directory, path);
+    }
+}
+
+// Milliseconds from opening the camera to its first frame, -1 if no frame arrived yet
+JNIEXPORT jlong JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetTimeToFirstFrameMs(JNIEnv* env, jobject thiz) {
+    if (!g_camera) {
+        return -1;
+    }
+    const int64_t us = g_camera->getTimeToFirstFrameUs();
+    return us < 0 ? -1 : static_cast<jlong>(us / 1000);
+}
+
+// [width, height] of the first uncompressed frame descriptor
+JNIEXPORT jintArray JNICALL
 Java_com_example_ircmd_1handle_CameraActivity_nativeGetCameraDimensions(JNIEnv* env, jobject /* this */) {
     if (!g_camera) {
         __android_log_print(ANDROID_LOG_ERROR, "CameraActivity", "Camera not initialized");
@@ -129,27 +242,12 @@ Java_com_example_ircmd_1handle_CameraActivity_nativeGetCameraDimensions(JNIEnv*
             // Get the frame descriptor
             const uvc_frame_desc_t* frame_desc = current_format->frame_descs;
             if (frame_desc) {
-                // Create a Pair object to return the dimensions
-                jclass pairClass = env->FindClass("kotlin/Pair");
-                jmethodID pairConstructor = env->GetMethodID(pairClass, "<init>", "(Ljava/lang/Object;Ljava/lang/Object;)V");
-                
-                // Create Integer objects for width and height
-                jclass integerClass = env->FindClass("java/lang/Integer");
-                jmethodID integerConstructor = env->GetMethodID(integerClass, "<init>", "(I)V");
-                
-                jobject widthObj = env->NewObject(integerClass, integerConstructor, frame_desc->wWidth);
-                jobject heightObj = env->NewObject(integerClass, integerConstructor, frame_desc->wHeight);
-                
-                // Create and return the Pair
-                jobject pair = env->NewObject(pairClass, pairConstructor, widthObj, heightObj);
-                
-                // Clean up local references
-                env->DeleteLocalRef(widthObj);
-                env->DeleteLocalRef(heightObj);
-                env->DeleteLocalRef(integerClass);
-                env->DeleteLocalRef(pairClass);
-                
-                return pair;
+                const jint dimensions[2] = {frame_desc->wWidth, frame_desc->wHeight};
+                jintArray result = env->NewIntArray(2);
+                if (result) {
+                    env->SetIntArrayRegion(result, 0, 2, dimensions);
+                }
+                return result;
             }
         }
         current_format = current_format->next;
@@ -167,8 +265,34 @@ Java_com_example_ircmd_1handle_IrcmdManager_nativeInit(JNIEnv* env, jobject thiz
     return g_ircmd_manager->init(fileDescriptor, deviceType);
 }
 
+// Re-apply the settings stored for this device instead of waiting for the UI to resend them.
+// Needs both the ircmd init and the UVC open (which identifies the device) to have completed.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_IrcmdManager_nativeRestoreSavedParameters(JNIEnv* env, jobject thiz) {
+    if (!g_ircmd_manager || !g_ircmd_manager->isInitialized()) {
+        return -2;
+    }
+
+    std::vector<SnapshotParameter> saved = g_snapshot.getParameters();
+    if (saved.empty()) {
+        return 0;
+    }
+
+    ScopedStartupPhase phase("ircmd: restore parameters");
+    std::vector<ParameterBatchEntry> batch;
+    for (const SnapshotParameter& parameter : saved) {
+        batch.push_back({static_cast<CameraFunctionId>(parameter.functionId), parameter.value, parameter.value2});
+    }
+    std::vector<int> results;
+    int result = g_ircmd_manager->executeSetFunctionBatch(batch, results);
+    __android_log_print(ANDROID_LOG_INFO, "IrcmdManager", "Restored %zu parameters from snapshot (result %d)",
+                        batch.size(), result);
+    return result < 0 ? result : static_cast<jint>(batch.size());
+}
+
 JNIEXPORT void JNICALL
 Java_com_example_ircmd_1handle_IrcmdManager_nativeCleanup(JNIEnv* env, jobject thiz) {
+    saveSnapshotParameters();
     if (g_ircmd_manager) {
         g_ircmd_manager->cleanup();
     }
@@ -208,9 +332,7 @@ Java_com_example_ircmd_1handle_IrcmdManager_nativeExecuteGetFunction(JNIEnv* env
     int result = g_ircmd_manager->executeGetFunction(static_cast<CameraFunction>(functionId), value);
     
     // Set the output value using JNI
-    jclass integerClass = env->GetObjectClass(resultObj);
-    jfieldID valueField = env->GetFieldID(integerClass, "value", "I");
-    env->SetIntField(resultObj, valueField, value);
+    JniBridge::getInstance().setIntWrapper(env, resultObj, value);
     
     return result;
 }
@@ -259,9 +381,7 @@ Java_com_example_ircmd_1handle_IrcmdManager_nativeExecuteRegistryGetFunction(JNI
     int result = g_ircmd_manager->executeGetFunction(static_cast<CameraFunctionId>(functionId), value);
     
     // Set the output value using JNI
-    jclass integerClass = env->GetObjectClass(resultObj);
-    jfieldID valueField = env->GetFieldID(integerClass, "value", "I");
-    env->SetIntField(resultObj, valueField, value);
+    JniBridge::getInstance().setIntWrapper(env, resultObj, value);
     
     return result;
 }
@@ -274,6 +394,68 @@ Java_com_example_ircmd_1handle_IrcmdManager_nativeExecuteRegistryActionFunction(
     return g_ircmd_manager->executeActionFunction(static_cast<CameraFunctionId>(functionId));
 }
 
+// Apply a batch of SET/SET2 functions in one call.
+// entries is a flat array of (functionId, value, value2) triples; returns one result per triple.
+JNIEXPORT jintArray JNICALL
+Java_com_example_ircmd_1handle_IrcmdManager_nativeExecuteRegistryBatch(JNIEnv* env, jobject thiz, jintArray entries) {
+    if (!g_ircmd_manager || entries == nullptr) {
+        return nullptr;
+    }
+
+    const jsize length = env->GetArrayLength(entries);
+    if (length % 3 != 0) {
+        LOGE("Batch payload length %d is not a multiple of 3", length);
+        return nullptr;
+    }
+
+    std::vector<jint> payload(length);
+    env->GetIntArrayRegion(entries, 0, length, payload.data());
+
+    std::vector<ParameterBatchEntry> batch(length / 3);
+    for (size_t i = 0; i < batch.size(); i++) {
+        batch[i].functionId = static_cast<CameraFunctionId>(payload[i * 3]);
+        batch[i].value = payload[i * 3 + 1];
+        batch[i].value2 = payload[i * 3 + 2];
+    }
+
+    std::vector<int> results;
+    g_ircmd_manager->executeSetFunctionBatch(batch, results);
+
+    jintArray resultArray = env->NewIntArray(static_cast<jsize>(results.size()));
+    if (resultArray != nullptr) {
+        env->SetIntArrayRegion(resultArray, 0, static_cast<jsize>(results.size()), results.data());
+    }
+    return resultArray;
+}
+
+// Shadow state of one parameter, written into out as
+// [hasValue, hasRange, value, value2, version, timestampUs, min, max, step]
+JNIEXPORT jboolean JNICALL
+Java_com_example_ircmd_1handle_IrcmdManager_nativeGetParameterState(JNIEnv* env, jobject thiz, jint functionId, jlongArray out) {
+    if (!g_ircmd_manager || out == nullptr || env->GetArrayLength(out) < 9) {
+        return JNI_FALSE;
+    }
+
+    ParameterState state;
+    if (!g_ircmd_manager->getParameterState(static_cast<CameraFunctionId>(functionId), state)) {
+        return JNI_FALSE;
+    }
+
+    const jlong values[9] = {
+        state.hasValue ? 1 : 0,
+        state.hasRange ? 1 : 0,
+        state.value,
+        state.value2,
+        static_cast<jlong>(state.version),
+        state.timestampUs,
+        state.range.min_value,
+        state.range.max_value,
+        state.range.step
+    };
+    env->SetLongArrayRegion(out, 0, 9, values);
+    return JNI_TRUE;
+}
+
 // Function to check if a function is supported
 JNIEXPORT jboolean JNICALL
 Java_com_example_ircmd_1handle_IrcmdManager_nativeIsFunctionSupported(JNIEnv* env, jobject thiz, jint functionType, jint functionId) {
@@ -299,6 +481,12 @@ Java_com_example_ircmd_1handle_IrcmdManager_nativeGetRegisteredFunctionCount(JNI
     return static_cast<jint>(registry.getRegisteredFunctionCount());
 }
 
+// Enable or disable per-command registry logging
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_IrcmdManager_nativeSetRegistryVerboseLogging(JNIEnv* env, jobject thiz, jboolean enabled) {
+    CameraFunctionRegistry::setVerboseLogging(enabled == JNI_TRUE);
+}
+
 // ===== RAW FRAME CAPTURE FOR SUPER RESOLUTION =====
 
 // Set capture flag to capture next raw frame
@@ -321,50 +509,39 @@ Java_com_example_ircmd_1handle_CameraActivity_nativeHasCapturedFrame(JNIEnv* env
     return JNI_FALSE;
 }
 
-// Get the captured raw frame data
-JNIEXPORT jbyteArray JNICALL
-Java_com_example_ircmd_1handle_CameraActivity_nativeGetCapturedFrame(JNIEnv* env, jobject thiz) {
+// Copy the captured raw YUYV frame into a direct ByteBuffer owned by the caller.
+// dims receives [width, height]; returns the number of bytes written, 0 if no frame
+// is pending, or -1 on error (not initialized, not a direct buffer, too small).
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeReadCapturedFrame(JNIEnv* env, jobject thiz, jobject buffer, jintArray dims) {
     if (!g_camera) {
         __android_log_print(ANDROID_LOG_ERROR, "NativeLib", "Camera not initialized");
-        return nullptr;
+        return -1;
     }
     
-    // Allocate buffer for 256x192 YUYV data (max size)
-    const int max_data_size = 256 * 192 * 2; // YUYV = 2 bytes per pixel
-    uint8_t* buffer = new uint8_t[max_data_size];
-    int width, height;
-    
-    bool success = g_camera->getCapturedFrameData(buffer, &width, &height);
-    if (!success) {
-        delete[] buffer;
-        __android_log_print(ANDROID_LOG_WARN, "NativeLib", "No captured frame available");
-        return nullptr;
+    auto* target = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (target == nullptr || capacity <= 0 || env->GetArrayLength(dims) < 2) {
+        __android_log_print(ANDROID_LOG_ERROR, "NativeLib", "Capture target must be a direct buffer and a 2-element array");
+        return -1;
     }
     
-    // Calculate actual data size
-    int actual_data_size = width * height * 2; // YUYV format
-    
-    // Create Java byte array and copy data
-    jbyteArray result = env->NewByteArray(actual_data_size + 8); // +8 for width/height header
-    if (result) {
-        jbyte* java_buffer = env->GetByteArrayElements(result, nullptr);
-        
-        // Pack width and height as first 8 bytes (4 bytes each, little endian)
-        *reinterpret_cast<int32_t*>(java_buffer) = width;
-        *reinterpret_cast<int32_t*>(java_buffer + 4) = height;
-        
-        // Copy frame data
-        std::memcpy(java_buffer + 8, buffer, actual_data_size);
-        
-        env->ReleaseByteArrayElements(result, java_buffer, 0);
-        
-        __android_log_print(ANDROID_LOG_INFO, "NativeLib", 
-                           "📸 Returned captured frame: %dx%d, %d bytes", 
-                           width, height, actual_data_size);
+    int width, height;
+    const int size = g_camera->getCapturedFrameData(target, static_cast<size_t>(capacity), &width, &height);
+    if (size <= 0) {
+        if (size == 0) {
+            __android_log_print(ANDROID_LOG_WARN, "NativeLib", "No captured frame available");
+        }
+        return size;
     }
     
-    delete[] buffer;
-    return result;
+    const jint dimensions[2] = {width, height};
+    env->SetIntArrayRegion(dims, 0, 2, dimensions);
+    
+    __android_log_print(ANDROID_LOG_INFO, "NativeLib", 
+                       "📸 Returned captured frame: %dx%d, %d bytes", 
+                       width, height, size);
+    return size;
 }
 
 // ===== UVC FRAMERATE CONTROL JNI FUNCTIONS =====
@@ -421,6 +598,58 @@ Java_com_example_ircmd_1handle_CameraActivity_nativeGetCurrentFrameRate(JNIEnv *
     return fps;
 }
 
+// Negotiate the other frame rates of this resolution in the background, after the stream is up
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativePreNegotiateFrameRates(JNIEnv *env, jobject /* this */, jint width, jint height) {
+    if (!g_camera) {
+        LOGE("No camera instance");
+        return;
+    }
+
+    g_camera->preNegotiateFrameRates(width, height);
+}
+
+// Fill out[] with every pipeline and telemetry counter in one call, indexed by
+// TelemetryIndex. Returns the number of slots written, or -1 without a camera.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetTelemetry(JNIEnv *env, jobject /* this */, jlongArray out) {
+    if (!g_camera) {
+        return -1;
+    }
+
+    const UVCCamera::PipelineCounters counters = g_camera->getPipelineCounters();
+    const UVCCamera::StreamTimings timings = g_camera->getStreamTimings();
+    const NegotiationCache& cache = NegotiationCache::getInstance();
+
+    jlong values[TELEMETRY_COUNT];
+    values[TELEMETRY_STREAMING] = g_camera->isStreaming() ? 1 : 0;
+    values[TELEMETRY_FRAMES_RECEIVED] = static_cast<jlong>(counters.framesReceived);
+    values[TELEMETRY_FRAMES_DECIMATED] = static_cast<jlong>(counters.framesDecimated);
+    values[TELEMETRY_FRAMES_RENDERED] = static_cast<jlong>(counters.framesRendered);
+    values[TELEMETRY_FRAMES_ENCODED] = static_cast<jlong>(counters.framesEncoded);
+    values[TELEMETRY_TIME_TO_FIRST_FRAME_US] = g_camera->getTimeToFirstFrameUs();
+    values[TELEMETRY_STREAM_START_US] = timings.startUs;
+    values[TELEMETRY_STREAM_START_CACHED] = timings.startCached ? 1 : 0;
+    values[TELEMETRY_FPS_SWITCH_US] = timings.fpsSwitchUs;
+    values[TELEMETRY_FPS_SWITCH_CACHED] = timings.fpsSwitchCached ? 1 : 0;
+    values[TELEMETRY_FPS_SWITCH_MODE] = static_cast<jlong>(timings.fpsSwitchMode);
+    values[TELEMETRY_FPS_SWITCH_LATENCY_US] = timings.fpsSwitchLatencyUs;
+    values[TELEMETRY_FPS_SWITCH_LOST_FRAMES] = timings.fpsSwitchLostFrames;
+    values[TELEMETRY_NEGOTIATION_HITS] = static_cast<jlong>(cache.getHits());
+    values[TELEMETRY_NEGOTIATION_MISSES] = static_cast<jlong>(cache.getMisses());
+    values[TELEMETRY_TRACE_DROPPED_EVENTS] = static_cast<jlong>(TraceRing::getDroppedEvents());
+
+    const EncoderDelivery::Counters delivery = g_encoder_delivery.getCounters();
+    values[TELEMETRY_ENCODER_DELIVERED] = static_cast<jlong>(delivery.delivered);
+    values[TELEMETRY_ENCODER_DROPPED_QUEUE_FULL] = static_cast<jlong>(delivery.droppedQueueFull);
+    values[TELEMETRY_ENCODER_DROPPED_NOT_RUNNING] = static_cast<jlong>(delivery.droppedNotRunning);
+    values[TELEMETRY_ENCODER_DROPPED_FAILED] = static_cast<jlong>(delivery.droppedDeliveryFailed);
+
+    const jsize count = std::min<jsize>(env->GetArrayLength(out), TELEMETRY_COUNT);
+    env->SetLongArrayRegion(out, 0, count, values);
+    return count;
+}
+
 JNIEXPORT void JNICALL
 Java_com_example_ircmd_1handle_CameraActivity_nativeEnumerateAllFrameRates(JNIEnv *env, jobject /* this */) {
     if (!g_camera) {
@@ -431,28 +660,762 @@ Java_com_example_ircmd_1handle_CameraActivity_nativeEnumerateAllFrameRates(JNIEn
     g_camera->enumerateAllFrameRates();
 }
 
+// ===== RADIOMETRIC STREAM JNI FUNCTIONS =====
+
+// Switch the stream layout (StreamLayout values). The device is told which plane to put in
+// the stream first; on MINI2 the dual layout itself is selected by the doubled-height UVC
+// frame, which UVCCamera negotiates. Returns 0, a negative registry/SDK error, -2 when a
+// side is not initialized, or -1 when the stream could not be switched.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetStreamLayout(JNIEnv *env, jobject /* this */, jint layout) {
+    if (!g_camera) {
+        LOGE("No camera instance");
+        return -2;
+    }
+    if (layout < static_cast<jint>(StreamLayout::IMAGE) || layout > static_cast<jint>(StreamLayout::DUAL)) {
+        LOGE("Invalid stream layout %d", layout);
+        return static_cast<jint>(RegistryError::INVALID_PARAMETER);
+    }
+    const StreamLayout target = static_cast<StreamLayout>(layout);
+
+    if (g_ircmd_manager && g_ircmd_manager->isInitialized()) {
+        // The image plane is consumed as YUYV
+        int result = g_ircmd_manager->executeSetFunction(CameraFunctionId::YUV_FORMAT, ADV_YUYV);
+        if (result == 0) {
+            const int source = target == StreamLayout::IMAGE ? ADV_PICTURE_SOURCE_MODE : ADV_TPD_SOURCE_MODE;
+            result = g_ircmd_manager->executeSetFunction(CameraFunctionId::STREAM_SOURCE_MODE, source);
+        }
+        if (result != 0) {
+            LOGE("Failed to select the stream source for layout %d: %d", layout, result);
+            return result;
+        }
+    } else if (target != StreamLayout::IMAGE) {
+        LOGE("ircmd not initialized, cannot select the temperature stream");
+        return -2;
+    }
+
+    return g_camera->setStreamLayout(target) ? 0 : -1;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetRadiometricParams(JNIEnv *env, jobject /* this */, jfloat emissivity, jfloat reflectedC) {
+    if (!g_camera) {
+        LOGE("No camera instance");
+        return;
+    }
+
+    RadiometricParams params = g_camera->getRadiometricParams();
+    params.emissivity = emissivity;
+    params.reflectedC = reflectedC;
+    g_camera->setRadiometricParams(params);
+}
+
+// Copy the latest temperature plane (float °C, native byte order) into a direct buffer.
+// dims receives [width, height]; returns the pixel count, 0 if there is none, -1 on error.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeReadTemperatureFrame(JNIEnv *env, jobject /* this */, jobject buffer, jintArray dims) {
+    if (!g_camera) {
+        return -1;
+    }
+
+    auto* target = static_cast<float*>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (target == nullptr || capacity <= 0 || env->GetArrayLength(dims) < 2) {
+        LOGE("Temperature target must be a direct buffer and a 2-element array");
+        return -1;
+    }
+
+    int width, height;
+    const int count = g_camera->getTemperatureFrame(target, static_cast<size_t>(capacity) / sizeof(float), &width, &height);
+    if (count > 0) {
+        const jint dimensions[2] = {width, height};
+        env->SetIntArrayRegion(dims, 0, 2, dimensions);
+    }
+    return count;
+}
+
+// Fill out[] with the statistics of the latest frame, indexed by FrameStatsIndex. Lock-free,
+// cheap enough to poll from the UI every frame. Returns the slots written, or -1 if none yet.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetFrameStats(JNIEnv *env, jobject /* this */, jdoubleArray out) {
+    FrameStatsRecord record;
+    if (!g_camera || !g_camera->getFrameStats(&record)) {
+        return -1;
+    }
+
+    jdouble values[FRAME_STATS_COUNT];
+    values[FRAME_STATS_FRAME_NUMBER] = static_cast<jdouble>(record.frameNumber);
+    values[FRAME_STATS_TIMESTAMP_US] = static_cast<jdouble>(record.timestampUs);
+    values[FRAME_STATS_SOURCE] = static_cast<jdouble>(record.source);
+    values[FRAME_STATS_WIDTH] = record.width;
+    values[FRAME_STATS_HEIGHT] = record.height;
+    values[FRAME_STATS_MIN] = record.min;
+    values[FRAME_STATS_MAX] = record.max;
+    values[FRAME_STATS_MEAN] = record.mean;
+    values[FRAME_STATS_STDDEV] = record.stddev;
+    values[FRAME_STATS_MIN_X] = record.minX;
+    values[FRAME_STATS_MIN_Y] = record.minY;
+    values[FRAME_STATS_MAX_X] = record.maxX;
+    values[FRAME_STATS_MAX_Y] = record.maxY;
+    values[FRAME_STATS_MIN_C] = record.minC;
+    values[FRAME_STATS_MAX_C] = record.maxC;
+    values[FRAME_STATS_MEAN_C] = record.meanC;
+    values[FRAME_STATS_STDDEV_C] = record.stddevC;
+    values[FRAME_STATS_COMPUTE_US] = static_cast<jdouble>(record.computeUs);
+
+    const jsize count = std::min<jsize>(env->GetArrayLength(out), FRAME_STATS_COUNT);
+    env->SetDoubleArrayRegion(out, 0, count, values);
+    return count;
+}
+
+// ===== ROI MEASUREMENT JNI METHODS =====
+
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeAddRoiRect(JNIEnv *env, jobject /* this */,
+                                                               jint x, jint y, jint width, jint height) {
+    if (!g_camera) {
+        return -1;
+    }
+    return g_camera->getRoiEngine().addRect(x, y, width, height);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeAddRoiPolygon(JNIEnv *env, jobject /* this */, jintArray xy) {
+    if (!g_camera || !xy) {
+        return -1;
+    }
+
+    // Interleaved x, y pairs
+    const jsize length = env->GetArrayLength(xy);
+    std::vector<jint> coordinates(length);
+    env->GetIntArrayRegion(xy, 0, length, coordinates.data());
+    std::vector<RoiPoint> points;
+    points.reserve(length / 2);
+    for (jsize i = 0; i + 1 < length; i += 2) {
+        points.push_back({coordinates[i], coordinates[i + 1]});
+    }
+    return g_camera->getRoiEngine().addPolygon(points);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeAddRoiLine(JNIEnv *env, jobject /* this */,
+                                                               jint x0, jint y0, jint x1, jint y1) {
+    if (!g_camera) {
+        return -1;
+    }
+    return g_camera->getRoiEngine().addLine(x0, y0, x1, y1);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeRemoveRoi(JNIEnv *env, jobject /* this */, jint id) {
+    return g_camera && g_camera->getRoiEngine().remove(id) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeClearRois(JNIEnv *env, jobject /* this */) {
+    if (g_camera) {
+        g_camera->getRoiEngine().clear();
+    }
+}
+
+// Fills out with ROI_RESULT_STRIDE floats per ROI; returns the number of ROIs written
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetRoiResults(JNIEnv *env, jobject /* this */, jfloatArray out) {
+    if (!g_camera || !out) {
+        return 0;
+    }
+
+    std::vector<RoiResult> results;
+    std::vector<jfloat> values;
+    g_camera->getRoiEngine().getResults(&results);
+    const size_t count = std::min<size_t>(results.size(), env->GetArrayLength(out) / ROI_RESULT_STRIDE);
+    values.resize(count * ROI_RESULT_STRIDE);
+    for (size_t i = 0; i < count; i++) {
+        const RoiResult& r = results[i];
+        jfloat* v = &values[i * ROI_RESULT_STRIDE];
+        v[ROI_RESULT_ID] = static_cast<jfloat>(r.id);
+        v[ROI_RESULT_PIXEL_COUNT] = static_cast<jfloat>(r.pixelCount);
+        v[ROI_RESULT_MEAN] = r.mean;
+        v[ROI_RESULT_VARIANCE] = r.variance;
+        v[ROI_RESULT_MIN] = r.min;
+        v[ROI_RESULT_MAX] = r.max;
+        v[ROI_RESULT_MIN_X] = static_cast<jfloat>(r.minX);
+        v[ROI_RESULT_MIN_Y] = static_cast<jfloat>(r.minY);
+        v[ROI_RESULT_MAX_X] = static_cast<jfloat>(r.maxX);
+        v[ROI_RESULT_MAX_Y] = static_cast<jfloat>(r.maxY);
+    }
+    env->SetFloatArrayRegion(out, 0, static_cast<jsize>(values.size()), values.data());
+    return static_cast<jint>(count);
+}
+
+// ===== ISOTHERM OVERLAY JNI METHODS =====
+
+// bounds holds a lower, upper pair per band and colors one 0xAARRGGBB color per band.
+// Returns 0, or -1 if the bands are malformed or there are too many.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetIsotherms(JNIEnv *env, jobject /* this */, jint mode,
+                                                                 jboolean inverse, jfloatArray bounds, jintArray colors) {
+    if (!g_camera || !bounds || !colors || mode < static_cast<jint>(IsothermMode::OFF) ||
+        mode > static_cast<jint>(IsothermMode::TRANSPARENT)) {
+        return -1;
+    }
+
+    const jsize band_count = env->GetArrayLength(colors);
+    if (env->GetArrayLength(bounds) != band_count * 2 || band_count > IsothermOverlay::kMaxBands) {
+        LOGE("Isotherms: %d bounds for %d bands (max %d)", env->GetArrayLength(bounds), band_count,
+             IsothermOverlay::kMaxBands);
+        return -1;
+    }
+
+    jfloat band_bounds[IsothermOverlay::kMaxBands * 2];
+    jint band_colors[IsothermOverlay::kMaxBands];
+    env->GetFloatArrayRegion(bounds, 0, band_count * 2, band_bounds);
+    env->GetIntArrayRegion(colors, 0, band_count, band_colors);
+
+    IsothermConfig config;
+    config.mode = static_cast<IsothermMode>(mode);
+    config.inverse = inverse == JNI_TRUE;
+    for (jsize i = 0; i < band_count; i++) {
+        config.bands.push_back({std::min(band_bounds[i * 2], band_bounds[i * 2 + 1]),
+                                std::max(band_bounds[i * 2], band_bounds[i * 2 + 1]),
+                                static_cast<uint32_t>(band_colors[i])});
+    }
+    return g_camera->setIsotherms(config) ? 0 : -1;
+}
+
+// Display-only digital zoom; filter is a libyuv::FilterMode. Returns 0, or -1 if out of range.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetDisplayZoom(JNIEnv *env, jobject /* this */, jfloat zoom,
+                                                                   jfloat centerX, jfloat centerY, jint filter) {
+    if (!g_camera) {
+        return -1;
+    }
+    DisplayZoom display_zoom;
+    display_zoom.zoom = zoom;
+    display_zoom.centerX = centerX;
+    display_zoom.centerY = centerY;
+    display_zoom.filter = filter;
+    return g_camera->setDisplayZoom(display_zoom) ? 0 : -1;
+}
+
+// Display-only orientation: clockwise rotation in degrees, mirror and flip before it.
+// Returns 0, or -1 if the rotation is not a multiple of 90.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetDisplayOrientation(JNIEnv *env, jobject /* this */,
+                                                                          jint rotation, jboolean mirror,
+                                                                          jboolean flip) {
+    if (!g_camera) {
+        return -1;
+    }
+    DisplayOrientation orientation;
+    orientation.rotation = rotation;
+    orientation.mirror = mirror;
+    orientation.flip = flip;
+    return g_camera->setDisplayOrientation(orientation) ? 0 : -1;
+}
+
+// ===== HOST AGC JNI METHODS =====
+
+// regions holds x, y, width, height, weight per weighted region. Returns 0, or -1 if a
+// parameter is out of range.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetAgc(JNIEnv *env, jobject /* this */, jboolean enabled,
+                                                           jint rawBits, jfloat plateau, jfloat tailRejection,
+                                                           jfloat smoothing, jintArray regions) {
+    if (!g_camera) {
+        return -1;
+    }
+
+    AgcParams params;
+    params.enabled = enabled == JNI_TRUE;
+    params.rawBits = rawBits;
+    params.plateau = plateau;
+    params.tailRejection = tailRejection;
+    params.smoothing = smoothing;
+    if (regions) {
+        const jsize length = env->GetArrayLength(regions);
+        if (length % 5 != 0 || length / 5 > AgcEngine::kMaxRegions) {
+            LOGE("AGC: %d region values, expected up to %d groups of 5", length, AgcEngine::kMaxRegions);
+            return -1;
+        }
+        jint values[AgcEngine::kMaxRegions * 5];
+        env->GetIntArrayRegion(regions, 0, length, values);
+        for (jsize i = 0; i < length; i += 5) {
+            params.regions.push_back({values[i], values[i + 1], values[i + 2], values[i + 3], values[i + 4]});
+        }
+    }
+
+    if (!g_camera->getAgc().configure(params)) {
+        LOGE("AGC: parameters out of range");
+        return -1;
+    }
+    return 0;
+}
+
+// consumers is a mask of DenoiseConsumer bits. Returns 0, or -1 if a parameter is out of range.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetDenoise(JNIEnv *env, jobject /* this */, jboolean enabled,
+                                                               jfloat strength, jint motionThreshold, jint consumers) {
+    if (!g_camera) {
+        return -1;
+    }
+    DenoiseParams params;
+    params.enabled = enabled == JNI_TRUE;
+    params.strength = strength;
+    params.motionThreshold = motionThreshold;
+    params.consumers = consumers;
+    if (!g_camera->getDenoiser().configure(params)) {
+        LOGE("Denoise: parameters out of range");
+        return -1;
+    }
+    return 0;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetDenoiseStats(JNIEnv *env, jobject /* this */, jlongArray out) {
+    if (!g_camera) {
+        return -1;
+    }
+    const DenoiseStats stats = g_camera->getDenoiser().getStats();
+    jlong values[DENOISE_STATS_COUNT];
+    values[DENOISE_STATS_FRAMES] = static_cast<jlong>(stats.frames);
+    values[DENOISE_STATS_LAST_NS] = stats.lastNs;
+    values[DENOISE_STATS_MAX_NS] = stats.maxNs;
+    values[DENOISE_STATS_MEAN_NS] = stats.frames ? stats.totalNs / static_cast<int64_t>(stats.frames) : 0;
+
+    const jsize count = std::min<jsize>(env->GetArrayLength(out), DENOISE_STATS_COUNT);
+    env->SetLongArrayRegion(out, 0, count, values);
+    return count;
+}
+
+// ===== BLOB TRACKING JNI METHODS =====
+
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetBlobTracking(JNIEnv *env, jobject /* this */, jboolean enabled,
+                                                                    jfloat threshold, jint minArea,
+                                                                    jfloat maxMatchDistance, jint maxMissedFrames) {
+    if (!g_camera) {
+        return;
+    }
+
+    BlobTrackerParams params;
+    params.enabled = enabled == JNI_TRUE;
+    params.threshold = threshold;
+    params.minArea = std::max(1, static_cast<int>(minArea));
+    params.maxMatchDistance = std::max(0.0f, static_cast<float>(maxMatchDistance));
+    params.maxMissedFrames = std::max(0, static_cast<int>(maxMissedFrames));
+    g_camera->getBlobTracker().configure(params);
+}
+
+// Fills out with BLOB_STRIDE floats per tracked blob; returns the number of blobs written
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetTrackedBlobs(JNIEnv *env, jobject /* this */, jfloatArray out) {
+    if (!g_camera || !out) {
+        return 0;
+    }
+
+    std::vector<TrackedBlob> blobs;
+    g_camera->getBlobTracker().getTracks(&blobs);
+    const size_t count = std::min<size_t>(blobs.size(), env->GetArrayLength(out) / BLOB_STRIDE);
+    std::vector<jfloat> values(count * BLOB_STRIDE);
+    for (size_t i = 0; i < count; i++) {
+        const TrackedBlob& b = blobs[i];
+        jfloat* v = &values[i * BLOB_STRIDE];
+        v[BLOB_ID] = static_cast<jfloat>(b.id);
+        v[BLOB_AGE] = static_cast<jfloat>(b.age);
+        v[BLOB_AREA] = static_cast<jfloat>(b.area);
+        v[BLOB_CENTROID_X] = b.centroidX;
+        v[BLOB_CENTROID_Y] = b.centroidY;
+        v[BLOB_PEAK] = b.peak;
+        v[BLOB_PEAK_X] = static_cast<jfloat>(b.peakX);
+        v[BLOB_PEAK_Y] = static_cast<jfloat>(b.peakY);
+        v[BLOB_LEFT] = static_cast<jfloat>(b.left);
+        v[BLOB_TOP] = static_cast<jfloat>(b.top);
+        v[BLOB_RIGHT] = static_cast<jfloat>(b.right);
+        v[BLOB_BOTTOM] = static_cast<jfloat>(b.bottom);
+        v[BLOB_VELOCITY_X] = b.velocityX;
+        v[BLOB_VELOCITY_Y] = b.velocityY;
+    }
+    env->SetFloatArrayRegion(out, 0, static_cast<jsize>(values.size()), values.data());
+    return static_cast<jint>(count);
+}
+
+// ===== INFO LINE JNI METHODS =====
+
+// fields holds word, shift, bits per InfoLineField (null keeps the default positions)
+JNIEXPORT jboolean JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetInfoLine(JNIEnv *env, jobject /* this */, jint rows,
+                                                                jintArray fields, jfloat sensorTempScale,
+                                                                jfloat sensorTempOffset) {
+    if (!g_camera) {
+        return JNI_FALSE;
+    }
+
+    InfoLineLayout layout;
+    layout.rows = rows;
+    layout.sensorTempScale = sensorTempScale;
+    layout.sensorTempOffset = sensorTempOffset;
+    if (fields) {
+        constexpr jsize kValues = static_cast<jsize>(InfoLineField::COUNT) * 3;
+        if (env->GetArrayLength(fields) != kValues) {
+            LOGE("Info line: %d field values, expected %d", env->GetArrayLength(fields), kValues);
+            return JNI_FALSE;
+        }
+        jint values[kValues];
+        env->GetIntArrayRegion(fields, 0, kValues, values);
+        for (int i = 0; i < static_cast<int>(InfoLineField::COUNT); i++) {
+            layout.fields[i] = {values[i * 3], values[i * 3 + 1], values[i * 3 + 2]};
+        }
+    }
+    return g_camera->setInfoLineLayout(layout) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetFrameMetadata(JNIEnv *env, jobject /* this */, jlongArray out) {
+    FrameMetadata record;
+    if (!g_camera || !g_camera->getFrameMetadata(&record)) {
+        return -1;
+    }
+
+    jlong values[METADATA_COUNT];
+    values[METADATA_FRAME_NUMBER] = static_cast<jlong>(record.frameNumber);
+    values[METADATA_TIMESTAMP_US] = record.timestampUs;
+    values[METADATA_DEVICE_FRAME_COUNTER] = record.values[static_cast<int>(InfoLineField::FRAME_COUNTER)];
+    values[METADATA_DEVICE_FRAMES_SKIPPED] = static_cast<jlong>(record.deviceFramesSkipped);
+    values[METADATA_SHUTTER_STATUS] = record.values[static_cast<int>(InfoLineField::SHUTTER_STATUS)];
+    values[METADATA_AUTO_SHUTTER_STATUS] = record.values[static_cast<int>(InfoLineField::AUTO_SHUTTER_STATUS)];
+    values[METADATA_MODEL_STATUS] = record.values[static_cast<int>(InfoLineField::MODEL_STATUS)];
+    values[METADATA_TPD_FORMAT] = record.values[static_cast<int>(InfoLineField::TPD_FORMAT)];
+    values[METADATA_MIRROR] = record.values[static_cast<int>(InfoLineField::MIRROR)];
+    values[METADATA_FLIP] = record.values[static_cast<int>(InfoLineField::FLIP)];
+    values[METADATA_FFC_IN_PROGRESS] = record.ffcInProgress ? 1 : 0;
+    values[METADATA_FFC_COUNT] = static_cast<jlong>(record.ffcCount);
+    values[METADATA_SENSOR_TEMP_MILLI_C] = std::isnan(record.sensorTemperatureC)
+        ? INT64_MIN : static_cast<jlong>(std::lround(record.sensorTemperatureC * 1000.0f));
+
+    const jsize count = std::min<jsize>(env->GetArrayLength(out), METADATA_COUNT);
+    env->SetLongArrayRegion(out, 0, count, values);
+    return count;
+}
+
+// ===== TIME SERIES JNI METHODS =====
+
+// spillDirectory may be null or empty: sealed blocks beyond the memory cap are then dropped
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeConfigureTimeSeries(JNIEnv *env, jobject /* this */, jboolean enabled,
+                                                                        jlong memoryCapBytes, jlong spillCapBytes,
+                                                                        jstring spillDirectory) {
+    if (!g_camera) {
+        return;
+    }
+    std::string directory;
+    if (spillDirectory) {
+        const char* path = env->GetStringUTFChars(spillDirectory, nullptr);
+        if (path) {
+            directory = path;
+            env->ReleaseStringUTFChars(spillDirectory, path);
+        }
+    }
+    g_camera->getTimeSeries().configure(enabled == JNI_TRUE, memoryCapBytes > 0 ? static_cast<size_t>(memoryCapBytes) : 0,
+                                        spillCapBytes > 0 ? static_cast<size_t>(spillCapBytes) : 0, directory);
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetTimeSeriesNames(JNIEnv *env, jobject /* this */) {
+    std::vector<std::string> names;
+    if (g_camera) {
+        names = g_camera->getTimeSeries().getSeriesNames();
+    }
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(names.size()), env->FindClass("java/lang/String"), nullptr);
+    for (size_t i = 0; i < names.size(); i++) {
+        jstring name = env->NewStringUTF(names[i].c_str());
+        env->SetObjectArrayElement(result, static_cast<jsize>(i), name);
+        env->DeleteLocalRef(name);
+    }
+    return result;
+}
+
+// Fills out with TIMESERIES_STRIDE doubles per bucket; returns the bucket count, -1 for an unknown series
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeQueryTimeSeries(JNIEnv *env, jobject /* this */, jstring name,
+                                                                    jlong fromUs, jlong toUs, jdoubleArray out) {
+    if (!g_camera || !name) {
+        return -1;
+    }
+    const char* series = env->GetStringUTFChars(name, nullptr);
+    if (!series) {
+        return -1;
+    }
+    const std::string series_name(series);
+    env->ReleaseStringUTFChars(name, series);
+
+    std::vector<RollupBucket> buckets;
+    const int max_points = env->GetArrayLength(out) / TIMESERIES_STRIDE;
+    if (g_camera->getTimeSeries().queryRollup(series_name, fromUs, toUs, max_points, &buckets) < 0) {
+        return -1;
+    }
+    const size_t count = std::min(buckets.size(), static_cast<size_t>(max_points));
+    std::vector<jdouble> values(count * TIMESERIES_STRIDE);
+    for (size_t i = 0; i < count; i++) {
+        jdouble* v = &values[i * TIMESERIES_STRIDE];
+        v[TIMESERIES_START_US] = static_cast<jdouble>(buckets[i].startUs);
+        v[TIMESERIES_MIN] = buckets[i].min;
+        v[TIMESERIES_MAX] = buckets[i].max;
+        v[TIMESERIES_MEAN] = buckets[i].sum / buckets[i].count;
+    }
+    env->SetDoubleArrayRegion(out, 0, static_cast<jsize>(values.size()), values.data());
+    return static_cast<jint>(count);
+}
+
+// ===== ALARM JNI METHODS =====
+
+// spec holds ALARM_RULE_STRIDE ints per rule, limits a threshold, hysteresis pair per rule
+JNIEXPORT jboolean JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetAlarmRules(JNIEnv *env, jobject /* this */, jintArray spec,
+                                                                  jfloatArray limits) {
+    if (!g_camera) {
+        return JNI_FALSE;
+    }
+    const jsize count = env->GetArrayLength(spec) / ALARM_RULE_STRIDE;
+    if (env->GetArrayLength(spec) != count * ALARM_RULE_STRIDE || env->GetArrayLength(limits) != count * 2) {
+        LOGE("Alarm rules: %d ints and %d floats do not describe whole rules",
+             env->GetArrayLength(spec), env->GetArrayLength(limits));
+        return JNI_FALSE;
+    }
+
+    std::vector<jint> ints(count * ALARM_RULE_STRIDE);
+    std::vector<jfloat> floats(count * 2);
+    env->GetIntArrayRegion(spec, 0, static_cast<jsize>(ints.size()), ints.data());
+    env->GetFloatArrayRegion(limits, 0, static_cast<jsize>(floats.size()), floats.data());
+    std::vector<AlarmRule> rules(count);
+    for (jsize i = 0; i < count; i++) {
+        const jint* v = &ints[i * ALARM_RULE_STRIDE];
+        AlarmRule& rule = rules[i];
+        rule.id = v[ALARM_RULE_ID];
+        rule.source = static_cast<AlarmSource>(v[ALARM_RULE_SOURCE]);
+        rule.target = v[ALARM_RULE_TARGET];
+        rule.metric = static_cast<AlarmMetric>(v[ALARM_RULE_METRIC]);
+        rule.op = v[ALARM_RULE_OP] == static_cast<int>(AlarmOp::LESS) ? AlarmOp::LESS : AlarmOp::GREATER;
+        rule.triggerFrames = v[ALARM_RULE_TRIGGER_FRAMES];
+        rule.clearFrames = v[ALARM_RULE_CLEAR_FRAMES];
+        rule.actions = v[ALARM_RULE_ACTIONS];
+        rule.threshold = floats[i * 2];
+        rule.hysteresis = floats[i * 2 + 1];
+    }
+    return g_camera->getAlarmEngine().setRules(rules) ? JNI_TRUE : JNI_FALSE;
+}
+
+// Moves queued alarm transitions into out, ALARM_EVENT_STRIDE doubles each; returns the event count
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetAlarmEvents(JNIEnv *env, jobject /* this */, jdoubleArray out) {
+    if (!g_camera) {
+        return 0;
+    }
+    AlarmEvent events[AlarmEngine::kEventQueueDepth];
+    const size_t capacity = std::min<size_t>(env->GetArrayLength(out) / ALARM_EVENT_STRIDE, AlarmEngine::kEventQueueDepth);
+    const size_t count = g_camera->getAlarmEngine().takeEvents(events, capacity);
+
+    jdouble values[AlarmEngine::kEventQueueDepth * ALARM_EVENT_STRIDE];
+    for (size_t i = 0; i < count; i++) {
+        jdouble* v = &values[i * ALARM_EVENT_STRIDE];
+        v[ALARM_EVENT_RULE_ID] = events[i].ruleId;
+        v[ALARM_EVENT_TRIGGERED] = events[i].triggered ? 1.0 : 0.0;
+        v[ALARM_EVENT_VALUE] = events[i].value;
+        v[ALARM_EVENT_TIMESTAMP_US] = static_cast<jdouble>(events[i].timestampUs);
+        v[ALARM_EVENT_ACTIONS] = events[i].actions;
+    }
+    env->SetDoubleArrayRegion(out, 0, static_cast<jsize>(count * ALARM_EVENT_STRIDE), values);
+    return static_cast<jint>(count);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetAlarmStats(JNIEnv *env, jobject /* this */, jlongArray out) {
+    if (!g_camera) {
+        return -1;
+    }
+    AlarmEngine& alarms = g_camera->getAlarmEngine();
+    const AlarmStats stats = alarms.getStats();
+    jlong values[ALARM_STATS_COUNT];
+    values[ALARM_STATS_RULES] = static_cast<jlong>(alarms.getRuleCount());
+    values[ALARM_STATS_EVALUATIONS] = static_cast<jlong>(stats.evaluations);
+    values[ALARM_STATS_EVENTS] = static_cast<jlong>(stats.events);
+    values[ALARM_STATS_DROPPED_EVENTS] = static_cast<jlong>(stats.droppedEvents);
+    values[ALARM_STATS_LAST_NS] = stats.lastNs;
+    values[ALARM_STATS_MAX_NS] = stats.maxNs;
+    values[ALARM_STATS_MEAN_NS] = stats.evaluations ? stats.totalNs / static_cast<int64_t>(stats.evaluations) : 0;
+
+    const jsize count = std::min<jsize>(env->GetArrayLength(out), ALARM_STATS_COUNT);
+    env->SetLongArrayRegion(out, 0, count, values);
+    return count;
+}
+
+// ===== BAD PIXEL JNI METHODS =====
+
+// Learn from the next frames of a flat scene; nativeGetBadPixelCount is -1 until done
+JNIEXPORT jboolean JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeLearnBadPixels(JNIEnv *env, jobject /* this */, jint frames,
+                                                                   jfloat deviationThreshold, jfloat noiseThreshold) {
+    BadPixelLearnParams params;
+    params.frames = frames;
+    params.deviationThreshold = deviationThreshold;
+    params.noiseThreshold = noiseThreshold;
+    return g_bad_pixels.startLearning(params) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetBadPixelCount(JNIEnv *env, jobject /* this */) {
+    return g_bad_pixels.isLearning() ? -1 : static_cast<jint>(g_bad_pixels.getPixelCount());
+}
+
+// Returns the number of pixels loaded, or -1
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeLoadBadPixels(JNIEnv *env, jobject /* this */, jstring path) {
+    const char* file = env->GetStringUTFChars(path, nullptr);
+    if (!file) {
+        return -1;
+    }
+    const bool loaded = g_bad_pixels.load(file);
+    env->ReleaseStringUTFChars(path, file);
+    return loaded ? static_cast<jint>(g_bad_pixels.getPixelCount()) : -1;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSaveBadPixels(JNIEnv *env, jobject /* this */, jstring path) {
+    const char* file = env->GetStringUTFChars(path, nullptr);
+    if (!file) {
+        return JNI_FALSE;
+    }
+    const bool saved = g_bad_pixels.save(file);
+    env->ReleaseStringUTFChars(path, file);
+    return saved ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeClearBadPixels(JNIEnv *env, jobject /* this */) {
+    g_bad_pixels.clear();
+}
+
+// ===== FFC SCHEDULER JNI METHODS =====
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeConfigureFfcScheduler(JNIEnv *env, jobject /* this */, jboolean enabled,
+                                                                          jfloat toleranceC, jint minIntervalS, jint maxIntervalS,
+                                                                          jint lookaheadS, jfloat fpnTolerance) {
+    if (!g_camera) {
+        return JNI_FALSE;
+    }
+    FfcScheduler& scheduler = g_camera->getFfcScheduler();
+    FfcSchedulerParams params = scheduler.getParams();
+    params.enabled = enabled == JNI_TRUE;
+    params.toleranceC = toleranceC;
+    params.minIntervalS = minIntervalS;
+    params.maxIntervalS = maxIntervalS;
+    params.lookaheadS = lookaheadS;
+    params.fpnTolerance = fpnTolerance;
+    scheduler.configure(params);
+    return JNI_TRUE;
+}
+
+// Defers FFCs while a measurement must not see the shutter close
+JNIEXPORT void JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetFfcHold(JNIEnv *env, jobject /* this */, jboolean hold) {
+    if (g_camera) {
+        g_camera->getFfcScheduler().setHold(hold == JNI_TRUE);
+    }
+}
+
+// Fills out with FFC_ESTIMATE_COUNT values; returns 0 while the scheduler is disabled
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetFfcEstimate(JNIEnv *env, jobject /* this */, jdoubleArray out) {
+    if (!g_camera) {
+        return -1;
+    }
+    FfcScheduler& scheduler = g_camera->getFfcScheduler();
+    if (!scheduler.getParams().enabled) {
+        return 0;
+    }
+    const FfcEstimate estimate = scheduler.getEstimate();
+    jdouble values[FFC_ESTIMATE_COUNT];
+    values[FFC_SECONDS_TO_NEXT] = estimate.secondsToNext;
+    values[FFC_SENSOR_TEMP_C] = estimate.sensorTempC;
+    values[FFC_DRIFT_C] = estimate.driftC;
+    values[FFC_SLOPE_C_PER_MIN] = estimate.slopeCPerMin;
+    values[FFC_SECONDS_SINCE_LAST] = estimate.secondsSinceLast;
+    values[FFC_FPN] = estimate.fpn;
+    values[FFC_SCENE_STATIC] = estimate.sceneStatic ? 1.0 : 0.0;
+    values[FFC_HOLD] = estimate.hold ? 1.0 : 0.0;
+    values[FFC_HOST_COUNT] = static_cast<jdouble>(estimate.hostCount);
+    values[FFC_DEVICE_COUNT] = static_cast<jdouble>(estimate.deviceCount);
+
+    const jsize count = std::min<jsize>(env->GetArrayLength(out), FFC_ESTIMATE_COUNT);
+    env->SetDoubleArrayRegion(out, 0, count, values);
+    return count;
+}
+
+// ===== MOTION RECORDING JNI METHODS =====
+
+// Arms (or disarms) motion detection and the pre-roll kept for the next recording.
+// Returns 0, or -1 if a parameter is out of range.
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeSetMotionRecording(JNIEnv *env, jobject /* this */, jboolean enabled,
+                                                                       jint threshold, jfloat activeFraction,
+                                                                       jint holdOffMs, jint preRollMs) {
+    if (!g_camera) {
+        return -1;
+    }
+    MotionParams params = g_camera->getMotionDetector().getParams();
+    params.enabled = enabled == JNI_TRUE;
+    params.threshold = threshold;
+    params.activeFraction = activeFraction;
+    params.holdOffMs = holdOffMs;
+    if (preRollMs < 0 || !g_camera->getMotionDetector().configure(params)) {
+        LOGE("Motion recording: parameters out of range");
+        return -1;
+    }
+    g_camera->getPreRoll().setDurationMs(params.enabled ? preRollMs : 0);
+    return 0;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ircmd_1handle_CameraActivity_nativeGetMotionState(JNIEnv *env, jobject /* this */, jdoubleArray out) {
+    if (!g_camera) {
+        return -1;
+    }
+    const MotionState state = g_camera->getMotionDetector().getState();
+    jdouble values[MOTION_STATE_COUNT];
+    values[MOTION_ACTIVE] = state.active ? 1.0 : 0.0;
+    values[MOTION_SCORE] = state.score;
+    values[MOTION_ACTIVATIONS] = static_cast<jdouble>(state.activations);
+    values[MOTION_FRAMES] = static_cast<jdouble>(state.frames);
+    values[MOTION_LAST_NS] = static_cast<jdouble>(state.lastNs);
+    values[MOTION_MEAN_NS] = state.frames ? static_cast<jdouble>(state.totalNs) / state.frames : 0.0;
+    values[MOTION_PRE_ROLL_FRAMES] = static_cast<jdouble>(g_camera->getPreRoll().getFrameCount());
+
+    const jsize count = std::min<jsize>(env->GetArrayLength(out), MOTION_STATE_COUNT);
+    env->SetDoubleArrayRegion(out, 0, count, values);
+    return count;
+}
+
 // ===== DIRECT VIDEO RECORDING JNI METHODS =====
 
 JNIEXPORT void JNICALL
 Java_com_example_ircmd_1handle_VideoRecorder_nativeSetupDirectRecording(JNIEnv *env, jobject videoRecorderObj) {
-    // Store Java VM reference for callbacks
-    env->GetJavaVM(&g_jvm);
-    
-    // Store global reference to VideoRecorder object
-    g_video_recorder_obj = env->NewGlobalRef(videoRecorderObj);
-    
-    // Get the callback method ID
-    jclass videoRecorderClass = env->GetObjectClass(videoRecorderObj);
-    g_encoder_callback_method = env->GetMethodID(videoRecorderClass, "onNativeYUVFrame", "([BIIJ)V");
-    
-    if (g_encoder_callback_method == nullptr) {
+    // The callback method ID was resolved in JNI_OnLoad
+    if (!JniBridge::getInstance().hasEncoderFrameMethod()) {
         LOGE("Failed to find onNativeYUVFrame method");
         return;
     }
     
+    // Frames go to this VideoRecorder from now on, through the attached delivery thread
+    JniBridge::getInstance().setEncoderTarget(env, videoRecorderObj);
+    if (!g_encoder_delivery.start(JniBridge::getInstance().getJavaVM())) {
+        LOGE("Failed to start encoder delivery thread");
+        return;
+    }
+    
     // Set up the native callback in UVC camera
     if (g_camera) {
-        g_camera->setVideoEncoderCallback(nativeVideoEncoderCallback, nullptr);
+        g_camera->setVideoEncoderCallback(nativeVideoEncoderCallback, nullptr, nativeVideoEncoderRoomCallback);
         LOGI("✅ Direct video recording setup complete");
     } else {
         LOGE("No camera instance for direct recording setup");
@@ -492,13 +1455,9 @@ Java_com_example_ircmd_1handle_VideoRecorder_nativeStopDirectRecording(JNIEnv *e
 
 JNIEXPORT void JNICALL
 Java_com_example_ircmd_1handle_VideoRecorder_nativeCleanupDirectRecording(JNIEnv *env, jobject /* this */) {
-    if (g_video_recorder_obj != nullptr) {
-        env->DeleteGlobalRef(g_video_recorder_obj);
-        g_video_recorder_obj = nullptr;
-    }
-    
-    g_encoder_callback_method = nullptr;
-    g_jvm = nullptr;
+    // Joins the delivery thread, so no frame is in flight when the target goes away
+    g_encoder_delivery.stop();
+    JniBridge::getInstance().setEncoderTarget(env, nullptr);
     
     LOGI("🧹 Direct video recording cleanup complete");
 }
@@ -0,0 +1,71 @@
+#include "negotiation_cache.h"
+#include <algorithm>
+
+bool NegotiationCache::lookup(const NegotiationKey& key, NegotiationEntry* outEntry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const NegotiationEntry& entry : entries_) {
+        if (entry.key == key) {
+            *outEntry = entry;
+            hits_++;
+            return true;
+        }
+    }
+    misses_++;
+    return false;
+}
+
+bool NegotiationCache::contains(const NegotiationKey& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::any_of(entries_.begin(), entries_.end(),
+                       [&key](const NegotiationEntry& entry) { return entry.key == key; });
+}
+
+void NegotiationCache::store(const NegotiationKey& key, uvc_frame_format format, const uvc_stream_ctrl_t& ctrl) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (NegotiationEntry& entry : entries_) {
+        if (entry.key == key) {
+            entry.format = format;
+            entry.ctrl = ctrl;
+            return;
+        }
+    }
+
+    if (entries_.size() >= kMaxEntries) {
+        entries_.erase(entries_.begin());
+    }
+    entries_.push_back({key, format, ctrl});
+    NEGOTIATION_LOGI("Cached %dx%d @ %dfps for %04x:%04x (format %d, interval %u)",
+                     key.width, key.height, key.fps, key.vendorId, key.productId,
+                     format, ctrl.dwFrameInterval);
+}
+
+void NegotiationCache::invalidate(const NegotiationKey& key, const char* reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [&key](const NegotiationEntry& entry) { return entry.key == key; });
+    if (it != entries_.end()) {
+        entries_.erase(it);
+        NEGOTIATION_LOGW("Dropped %dx%d @ %dfps: %s", key.width, key.height, key.fps, reason);
+    }
+}
+
+uvc_frame_format NegotiationCache::preferredFormat(uint16_t vendorId, uint16_t productId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+        if (it->key.vendorId == vendorId && it->key.productId == productId &&
+            it->format != UVC_FRAME_FORMAT_UNKNOWN) {
+            return it->format;
+        }
+    }
+    return UVC_FRAME_FORMAT_UNKNOWN;
+}
+
+uint32_t NegotiationCache::getHits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint32_t NegotiationCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
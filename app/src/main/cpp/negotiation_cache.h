@@ -0,0 +1,74 @@
+#pragma once
+
+#include <android/log.h>
+#include <libuvc/libuvc.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Logging macros
+#define NEGOTIATION_TAG "NegotiationCache"
+#define NEGOTIATION_LOGI(...) __android_log_print(ANDROID_LOG_INFO, NEGOTIATION_TAG, __VA_ARGS__)
+#define NEGOTIATION_LOGW(...) __android_log_print(ANDROID_LOG_WARN, NEGOTIATION_TAG, __VA_ARGS__)
+
+// One stream request of one camera model
+struct NegotiationKey {
+    uint16_t vendorId;
+    uint16_t productId;
+    int width;
+    int height;
+    int fps;
+
+    bool operator==(const NegotiationKey& other) const {
+        return vendorId == other.vendorId && productId == other.productId &&
+               width == other.width && height == other.height && fps == other.fps;
+    }
+};
+
+// The format that won negotiation and the control block the device returned for it
+struct NegotiationEntry {
+    NegotiationKey key;
+    uvc_frame_format format;
+    uvc_stream_ctrl_t ctrl;
+};
+
+/**
+ * Stream controls that were already negotiated, so startStream() and setFrameRate()
+ * can commit them directly instead of probing formats one by one.
+ *
+ * Lives for the whole process, across camera re-opens. Entries are only hints: a
+ * caller whose cached control is rejected by the device invalidates it and probes.
+ *
+ * Thread-safe: the stream path and the background pre-negotiation both use it.
+ */
+class NegotiationCache {
+public:
+    static NegotiationCache& getInstance() {
+        static NegotiationCache instance;
+        return instance;
+    }
+
+    bool lookup(const NegotiationKey& key, NegotiationEntry* outEntry);
+    bool contains(const NegotiationKey& key) const;
+    void store(const NegotiationKey& key, uvc_frame_format format, const uvc_stream_ctrl_t& ctrl);
+    void invalidate(const NegotiationKey& key, const char* reason);
+
+    // Format that last won negotiation on this camera model, UVC_FRAME_FORMAT_UNKNOWN if none
+    uvc_frame_format preferredFormat(uint16_t vendorId, uint16_t productId) const;
+
+    uint32_t getHits() const;
+    uint32_t getMisses() const;
+
+private:
+    NegotiationCache() = default;
+    NegotiationCache(const NegotiationCache&) = delete;
+    NegotiationCache& operator=(const NegotiationCache&) = delete;
+
+    // A camera has a handful of resolution/fps combinations; the oldest entry goes first
+    static constexpr size_t kMaxEntries = 32;
+
+    mutable std::mutex mutex_;
+    std::vector<NegotiationEntry> entries_;
+    uint32_t hits_ = 0;
+    uint32_t misses_ = 0;
+};
@@ -0,0 +1,121 @@
+#include "parameter_store.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// value2 ranges of the SET2 functions, as documented in libircmd.h
+struct Value2Range {
+    CameraFunctionId id;
+    param_attribute_t range;    // max, min, step
+};
+
+constexpr Value2Range kValue2Ranges[] = {
+    {CameraFunctionId::ANALOG_VIDEO_OUTPUT, {ADV_PAL_FORMAT, ADV_NTSC_FORMAT, 1}},  // Analog formats only
+};
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+ParameterStore::ParameterStore() {
+    reset();
+}
+
+void ParameterStore::reset() {
+    memset(states_, 0, sizeof(states_));
+    version_ = 0;
+    for (const Value2Range& entry : kValue2Ranges) {
+        ParameterState& state = states_[denseFunctionIndex(entry.id)];
+        state.range2 = entry.range;
+        state.hasRange2 = true;
+    }
+}
+
+int ParameterStore::fetchRanges(IrcmdHandle_t* handle) {
+    auto& registry = CameraFunctionRegistry::getInstance();
+    int fetched = 0;
+    for (int i = 0; i < kFunctionCount; i++) {
+        const CameraFunctionId id = functionIdAtIndex(i);
+        if (!registry.isAttributeFunctionRegistered(id)) {
+            continue;
+        }
+
+        param_attribute_t range = {};
+        int result = registry.executeAttributeFunction(id, handle, &range);
+        if (result != 0 || range.min_value > range.max_value) {
+            PARAM_STORE_LOGW("No usable range for function ID %d (result %d), SETs will not be validated",
+                             static_cast<int>(id), result);
+            continue;
+        }
+
+        states_[i].range = range;
+        states_[i].hasRange = true;
+        fetched++;
+    }
+    PARAM_STORE_LOGI("Fetched %d parameter ranges", fetched);
+    return fetched;
+}
+
+void ParameterStore::recordSet(CameraFunctionId id, int value, int value2) {
+    const int index = denseFunctionIndex(id);
+    if (index < 0) {
+        return;
+    }
+
+    auto& registry = CameraFunctionRegistry::getInstance();
+    if (registry.invalidatesImageLevels(id)) {
+        // The device loaded new image levels; only the scene/palette/device values are still known
+        for (int i = 0; i < kFunctionCount; i++) {
+            if (registry.isImageLevel(functionIdAtIndex(i))) {
+                states_[i].hasValue = false;
+            }
+        }
+    }
+
+    ParameterState& state = states_[index];
+    state.hasValue = true;
+    state.value = value;
+    state.value2 = value2;
+    state.version = ++version_;
+    state.timestampUs = nowMicros();
+}
+
+bool ParameterStore::inRange(const param_attribute_t& range, int value) {
+    if (value < range.min_value || value > range.max_value) {
+        return false;
+    }
+    // A step of 0 or 1 allows every value
+    return range.step <= 1 || (value - range.min_value) % range.step == 0;
+}
+
+int ParameterStore::validate(CameraFunctionId id, int value, int value2) const {
+    const ParameterState* state = get(id);
+    if (!state) {
+        return static_cast<int>(RegistryError::SUCCESS);
+    }
+    if (state->hasRange && !inRange(state->range, value)) {
+        PARAM_STORE_LOGW("Rejecting function ID %d value %d, device range is [%u, %u] step %u",
+                         static_cast<int>(id), value, state->range.min_value, state->range.max_value, state->range.step);
+        return static_cast<int>(RegistryError::OUT_OF_RANGE);
+    }
+    if (state->hasRange2 && !inRange(state->range2, value2)) {
+        PARAM_STORE_LOGW("Rejecting function ID %d second value %d, range is [%u, %u] step %u",
+                         static_cast<int>(id), value2, state->range2.min_value, state->range2.max_value, state->range2.step);
+        return static_cast<int>(RegistryError::OUT_OF_RANGE);
+    }
+    return static_cast<int>(RegistryError::SUCCESS);
+}
+
+bool ParameterStore::matches(CameraFunctionId id, int value, int value2) const {
+    const ParameterState* state = get(id);
+    return state && state->hasValue && state->value == value && state->value2 == value2;
+}
+
+const ParameterState* ParameterStore::get(CameraFunctionId id) const {
+    const int index = denseFunctionIndex(id);
+    return index >= 0 ? &states_[index] : nullptr;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <android/log.h>
+#include "libircmd.h"
+#include "camera_function_registry.h"
+
+// Logging macros
+#define PARAM_STORE_TAG "ParameterStore"
+#define PARAM_STORE_LOGI(...) __android_log_print(ANDROID_LOG_INFO, PARAM_STORE_TAG, __VA_ARGS__)
+#define PARAM_STORE_LOGW(...) __android_log_print(ANDROID_LOG_WARN, PARAM_STORE_TAG, __VA_ARGS__)
+
+// Shadow copy of one device parameter
+struct ParameterState {
+    bool hasValue;              // A SET succeeded since connect (and was not invalidated)
+    bool hasRange;              // range was reported by the device at connect time
+    bool hasRange2;             // range2 is known (SET2 functions, from the SDK documentation)
+    int value;
+    int value2;                 // Only used by SET2 functions
+    uint32_t version;           // Store-wide sequence number of the SET that produced value
+    int64_t timestampUs;        // steady_clock time of that SET
+    param_attribute_t range;
+    param_attribute_t range2;   // Of value2
+};
+
+/**
+ * Native shadow of the device parameters, indexed by denseFunctionIndex().
+ *
+ * Most GET commands crash inside libircmd (standard_cmd_read), so the device is never read back.
+ * Instead every successful SET is recorded here, and the min/max/step of each parameter is
+ * fetched once at connect time through the basic_attribute_of_*_get calls, which are safe.
+ * Reads are then answered without any USB traffic and out-of-range SETs are rejected locally.
+ * The second value of SET2 functions has no attribute call; its range comes from the SDK header.
+ *
+ * Not thread-safe: IrcmdManager owns the store and only touches it with its mutex held.
+ */
+class ParameterStore {
+public:
+    ParameterStore();
+
+    // Forget all values and ranges (device disconnected)
+    void reset();
+
+    // Query the range of every parameter that has an attribute function. Returns how many were fetched.
+    int fetchRanges(IrcmdHandle_t* handle);
+
+    // Record a successful SET. Applying a function that reloads the image levels forgets them.
+    void recordSet(CameraFunctionId id, int value, int value2);
+
+    // RegistryError::SUCCESS, or RegistryError::OUT_OF_RANGE if a known range excludes value or
+    // value2, or either is off the range's step. value2 is ignored by functions without range2.
+    int validate(CameraFunctionId id, int value, int value2) const;
+
+    // True if the last recorded SET had exactly these values
+    bool matches(CameraFunctionId id, int value, int value2) const;
+
+    // nullptr for unknown IDs
+    const ParameterState* get(CameraFunctionId id) const;
+
+    // Incremented on every recordSet(), lets callers detect any change cheaply
+    uint32_t getVersion() const { return version_; }
+
+private:
+    static bool inRange(const param_attribute_t& range, int value);
+
+    ParameterState states_[kFunctionCount];
+    uint32_t version_;
+};
@@ -0,0 +1,43 @@
+#include "pre_roll_buffer.h"
+#include <cstring>
+#include <utility>
+
+void PreRollBuffer::push(const uint8_t* yuyv, int width, int height, int64_t captureUs, bool trim) {
+    if (!frames_.empty() && (frames_.back().width != width || frames_.back().height != height)) {
+        clear();
+    }
+
+    PreRollFrame frame;
+    if (!pool_.empty()) {
+        frame = std::move(pool_.back());
+        pool_.pop_back();
+    }
+    const size_t size = static_cast<size_t>(width) * height * 2;
+    frame.yuyv.resize(size);
+    std::memcpy(frame.yuyv.data(), yuyv, size);
+    frame.width = width;
+    frame.height = height;
+    frame.captureUs = captureUs;
+    frames_.push_back(std::move(frame));
+    bytes_ += size;
+
+    const int64_t oldest_us = captureUs - static_cast<int64_t>(duration_ms_.load(std::memory_order_relaxed)) * 1000;
+    while (frames_.size() > 1 && (bytes_ > kMaxBytes || (trim && frames_.front().captureUs < oldest_us))) {
+        pop();
+    }
+    frame_count_.store(frames_.size(), std::memory_order_relaxed);
+}
+
+void PreRollBuffer::pop() {
+    bytes_ -= frames_.front().yuyv.size();
+    pool_.push_back(std::move(frames_.front()));
+    frames_.pop_front();
+    frame_count_.store(frames_.size(), std::memory_order_relaxed);
+}
+
+void PreRollBuffer::clear() {
+    while (!frames_.empty()) {
+        pop();
+    }
+    pool_.clear();
+}
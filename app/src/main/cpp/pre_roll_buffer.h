@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+struct PreRollFrame {
+    std::vector<uint8_t> yuyv;
+    int width = 0;
+    int height = 0;
+    int64_t captureUs = 0;
+};
+
+/**
+ * The last seconds of recording frames kept in memory while motion-triggered recording is
+ * armed, so a recording started on activity begins before the activity was detected.
+ *
+ * Frames are stored as YUYV copies: a memcpy per frame is all a static scene costs. When
+ * recording starts the buffer is drained oldest first, and frames arriving meanwhile queue
+ * behind it, so the encoder sees one monotonic sequence. Frame buffers are recycled.
+ */
+class PreRollBuffer {
+public:
+    static constexpr size_t kMaxBytes = 48u * 1024 * 1024;
+
+    // Any thread; 0 disables. Frames over the duration are dropped on the next push.
+    void setDurationMs(int durationMs) { duration_ms_.store(durationMs, std::memory_order_relaxed); }
+    bool isEnabled() const { return duration_ms_.load(std::memory_order_relaxed) > 0; }
+
+    // Frame thread. trim drops frames older than the duration; while draining nothing is
+    // dropped except to stay under kMaxBytes.
+    void push(const uint8_t* yuyv, int width, int height, int64_t captureUs, bool trim);
+    bool empty() const { return frames_.empty(); }
+    const PreRollFrame& front() const { return frames_.front(); }
+    void pop();
+    void clear();
+
+    size_t getFrameCount() const { return frame_count_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int> duration_ms_{0};
+
+    // Frame thread only
+    std::deque<PreRollFrame> frames_;
+    std::vector<PreRollFrame> pool_;
+    size_t bytes_ = 0;
+
+    std::atomic<size_t> frame_count_{0};
+};
@@ -0,0 +1,166 @@
+#include "radiometric.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr float kKelvinOffset = 273.15f;
+constexpr size_t kRawCountRange = 65536;
+
+} // namespace
+
+bool splitFramePlanes(const uint8_t* data, size_t dataBytes, int width, int frameHeight,
+                      StreamLayout layout, FramePlanes* planes) {
+    const size_t frameBytes = static_cast<size_t>(width) * frameHeight * 2;
+    if (!data || width <= 0 || frameHeight <= 0 || dataBytes < frameBytes) {
+        return false;
+    }
+
+    planes->width = width;
+    switch (layout) {
+        case StreamLayout::IMAGE:
+            planes->image = data;
+            planes->raw = nullptr;
+            planes->height = frameHeight;
+            return true;
+        case StreamLayout::TEMPERATURE:
+            planes->image = nullptr;
+            planes->raw = reinterpret_cast<const uint16_t*>(data);
+            planes->height = frameHeight;
+            return true;
+        case StreamLayout::DUAL:
+            if (frameHeight % 2 != 0) {
+                return false;
+            }
+            planes->height = frameHeight / 2;
+            planes->image = data;
+            planes->raw = reinterpret_cast<const uint16_t*>(data + static_cast<size_t>(width) * planes->height * 2);
+            return true;
+    }
+    return false;
+}
+
+void rawToGrayYuyv(const uint16_t* raw, int width, int height, uint8_t* yuyv) {
+    const size_t count = static_cast<size_t>(width) * height;
+    if (count == 0) {
+        return;
+    }
+
+    uint16_t lo = 0xFFFF;
+    uint16_t hi = 0;
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    uint16x8_t vlo = vdupq_n_u16(0xFFFF);
+    uint16x8_t vhi = vdupq_n_u16(0);
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t v = vld1q_u16(raw + i);
+        vlo = vminq_u16(vlo, v);
+        vhi = vmaxq_u16(vhi, v);
+    }
+    uint16_t lanes_lo[8];
+    uint16_t lanes_hi[8];
+    vst1q_u16(lanes_lo, vlo);
+    vst1q_u16(lanes_hi, vhi);
+    for (int lane = 0; lane < 8; lane++) {
+        lo = std::min(lo, lanes_lo[lane]);
+        hi = std::max(hi, lanes_hi[lane]);
+    }
+#endif
+    for (; i < count; i++) {
+        lo = std::min(lo, raw[i]);
+        hi = std::max(hi, raw[i]);
+    }
+
+    // 16.16 fixed point gain from [lo, hi] to [0, 255]
+    const uint32_t range = hi > lo ? hi - lo : 1;
+    const uint32_t gain = (255u << 16) / range;
+    for (i = 0; i < count; i++) {
+        yuyv[i * 2] = static_cast<uint8_t>(((raw[i] - lo) * gain) >> 16);
+        yuyv[i * 2 + 1] = 128;
+    }
+}
+
+TemperatureLut::TemperatureLut() {
+    configure(RadiometricParams());
+}
+
+void TemperatureLut::configure(const RadiometricParams& params) {
+    auto table = std::make_shared<Table>();
+    table->params = params;
+    table->params.emissivity = std::min(1.0f, std::max(0.01f, params.emissivity));
+    if (table->params.countsPerKelvin <= 0.0f) {
+        table->params.countsPerKelvin = RadiometricParams().countsPerKelvin;
+    }
+
+    const float emissivity = table->params.emissivity;
+    const float countsPerKelvin = table->params.countsPerKelvin;
+    table->linear = emissivity >= 0.9999f;
+    table->scale = 1.0f / countsPerKelvin;
+    table->offset = -kKelvinOffset;
+
+    if (!table->linear) {
+        // Measured radiance = e * object + (1 - e) * reflected, radiance ~ T^4
+        const double reflectedK = table->params.reflectedC + kKelvinOffset;
+        const double reflected4 = (1.0 - emissivity) * reflectedK * reflectedK * reflectedK * reflectedK;
+        table->celsius.resize(kRawCountRange);
+        for (size_t count = 0; count < kRawCountRange; count++) {
+            const double apparentK = count / static_cast<double>(countsPerKelvin);
+            const double object4 = (apparentK * apparentK * apparentK * apparentK - reflected4) / emissivity;
+            const double objectK = object4 > 0.0 ? std::sqrt(std::sqrt(object4)) : 0.0;
+            table->celsius[count] = static_cast<float>(objectK - kKelvinOffset);
+        }
+    }
+
+    std::atomic_store(&table_, std::shared_ptr<const Table>(std::move(table)));
+    RADIOMETRIC_LOGI("Temperature conversion: emissivity %.2f, reflected %.1f °C, %.0f counts/K (%s)",
+                     params.emissivity, params.reflectedC, countsPerKelvin,
+                     emissivity >= 0.9999f ? "linear" : "lookup table");
+}
+
+RadiometricParams TemperatureLut::getParams() const {
+    return std::atomic_load(&table_)->params;
+}
+
+float TemperatureLut::toCelsius(uint16_t raw) const {
+    const std::shared_ptr<const Table> table = std::atomic_load(&table_);
+    return table->linear ? raw * table->scale + table->offset : table->celsius[raw];
+}
+
+void TemperatureLut::convert(const uint16_t* raw, float* celsius, size_t count) const {
+    const std::shared_ptr<const Table> table = std::atomic_load(&table_);
+    size_t i = 0;
+
+    if (table->linear) {
+#if defined(__ARM_NEON)
+        const float32x4_t scale = vdupq_n_f32(table->scale);
+        const float32x4_t offset = vdupq_n_f32(table->offset);
+        for (; i + 8 <= count; i += 8) {
+            const uint16x8_t v = vld1q_u16(raw + i);
+            const float32x4_t low = vcvtq_f32_u32(vmovl_u16(vget_low_u16(v)));
+            const float32x4_t high = vcvtq_f32_u32(vmovl_u16(vget_high_u16(v)));
+            vst1q_f32(celsius + i, vmlaq_f32(offset, low, scale));
+            vst1q_f32(celsius + i + 4, vmlaq_f32(offset, high, scale));
+        }
+#endif
+        for (; i < count; i++) {
+            celsius[i] = raw[i] * table->scale + table->offset;
+        }
+        return;
+    }
+
+    const float* lut = table->celsius.data();
+    for (; i + 4 <= count; i += 4) {
+        celsius[i] = lut[raw[i]];
+        celsius[i + 1] = lut[raw[i + 1]];
+        celsius[i + 2] = lut[raw[i + 2]];
+        celsius[i + 3] = lut[raw[i + 3]];
+    }
+    for (; i < count; i++) {
+        celsius[i] = lut[raw[i]];
+    }
+}
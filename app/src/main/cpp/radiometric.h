@@ -0,0 +1,85 @@
+#pragma once
+
+#include <android/log.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Logging macros
+#define RADIOMETRIC_TAG "Radiometric"
+#define RADIOMETRIC_LOGI(...) __android_log_print(ANDROID_LOG_INFO, RADIOMETRIC_TAG, __VA_ARGS__)
+#define RADIOMETRIC_LOGW(...) __android_log_print(ANDROID_LOG_WARN, RADIOMETRIC_TAG, __VA_ARGS__)
+
+// What the device puts in each UVC frame. Values are shared with Kotlin.
+enum class StreamLayout {
+    IMAGE = 0,          // YUYV image only (ADV_PICTURE_SOURCE_MODE)
+    TEMPERATURE = 1,    // 16-bit raw temperature only (ADV_TPD_SOURCE_MODE)
+    DUAL = 2            // YUYV image on top, raw temperature below: twice the sensor height
+};
+
+// Inputs of the raw count -> temperature conversion
+struct RadiometricParams {
+    float emissivity = 0.95f;       // (0, 1]
+    float reflectedC = 25.0f;       // Reflected apparent temperature
+    float countsPerKelvin = 64.0f;  // TPD output is Kelvin in 1/64 K steps
+};
+
+// One frame split into its planes; pointers alias the UVC frame or UVCCamera buffers and
+// are only valid during the callback they are passed to
+struct ThermalFrame {
+    const uint8_t* image;           // YUYV, width * 2 bytes per row
+    const uint16_t* raw;            // Raw temperature counts, nullptr in IMAGE layout
+    const float* celsius;           // Temperature per pixel, nullptr in IMAGE layout
+    int width;
+    int height;
+    int64_t timestampUs;
+};
+
+// Pointers into one frame of the given layout; nothing is copied
+struct FramePlanes {
+    const uint8_t* image;
+    const uint16_t* raw;
+    int width;
+    int height;                     // Sensor height, half the frame height in DUAL
+};
+
+// Split a frame of width x frameHeight into its planes. Returns false if the frame is
+// too short for the layout.
+bool splitFramePlanes(const uint8_t* data, size_t dataBytes, int width, int frameHeight,
+                      StreamLayout layout, FramePlanes* planes);
+
+// Gray YUYV picture of a raw temperature plane, stretched between its min and max, for
+// layouts without an image plane
+void rawToGrayYuyv(const uint16_t* raw, int width, int height, uint8_t* yuyv);
+
+/**
+ * Raw temperature counts to degrees Celsius through a 64K-entry lookup table.
+ *
+ * The table folds in the emissivity correction (Stefan-Boltzmann, reflected radiation
+ * removed), so per pixel the conversion is a single load. When emissivity is 1 the
+ * mapping is linear and is done with NEON arithmetic instead, which beats the table
+ * (NEON has no gather). configure() builds the new table off to the side, so it can be
+ * called while frames are being converted.
+ */
+class TemperatureLut {
+public:
+    TemperatureLut();
+
+    void configure(const RadiometricParams& params);
+    RadiometricParams getParams() const;
+
+    void convert(const uint16_t* raw, float* celsius, size_t count) const;
+    float toCelsius(uint16_t raw) const;
+
+private:
+    struct Table {
+        RadiometricParams params;
+        bool linear;
+        float scale;                // Linear case: celsius = raw * scale + offset
+        float offset;
+        std::vector<float> celsius; // Indexed by raw count, empty when linear
+    };
+
+    std::shared_ptr<const Table> table_;    // Accessed with std::atomic_load/atomic_store
+};
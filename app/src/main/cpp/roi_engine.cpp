@@ -0,0 +1,415 @@
+#include "roi_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+constexpr int kBlockShift = 3;          // Pyramid level 0 blocks are 8x8 pixels
+constexpr int kMaxCoordinate = 4096;    // Rasterization bound, well above any sensor
+
+struct Span {
+    int x0, x1;                         // Half-open
+
+    bool operator==(const Span& other) const {
+        return x0 == other.x0 && x1 == other.x1;
+    }
+};
+
+} // namespace
+
+int RoiEngine::addRect(int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return -1;
+    }
+    return addRoi(RoiShape::RECT, {{x, y, x + width, y + height}});
+}
+
+int RoiEngine::addPolygon(const std::vector<RoiPoint>& points) {
+    if (points.size() < 3) {
+        return -1;
+    }
+
+    // Vertices lie on pixel corners; a pixel is inside when its center is (even-odd rule)
+    int top = kMaxCoordinate;
+    int bottom = 0;
+    for (const RoiPoint& p : points) {
+        top = std::min(top, p.y);
+        bottom = std::max(bottom, p.y);
+    }
+    top = std::max(top, 0);
+    bottom = std::min(bottom, kMaxCoordinate);
+
+    std::vector<Rect> rects;
+    std::vector<Span> spans;
+    std::vector<Span> previous;
+    std::vector<float> crossings;
+    size_t open_rects = 0;      // Rects of the previous row's spans, at the end of rects
+    for (int y = top; y < bottom; y++) {
+        const float center_y = y + 0.5f;
+        crossings.clear();
+        for (size_t i = 0; i < points.size(); i++) {
+            const RoiPoint& a = points[i];
+            const RoiPoint& b = points[(i + 1) % points.size()];
+            if ((a.y <= center_y) != (b.y <= center_y)) {
+                crossings.push_back(a.x + (center_y - a.y) * (b.x - a.x) / static_cast<float>(b.y - a.y));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        spans.clear();
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            const int x0 = std::max(0, static_cast<int>(std::ceil(crossings[i] - 0.5f)));
+            const int x1 = std::min(kMaxCoordinate, static_cast<int>(std::ceil(crossings[i + 1] - 0.5f)));
+            if (x1 > x0) {
+                spans.push_back({x0, x1});
+            }
+        }
+
+        // Rows with the same spans as the row above grow its rects instead of adding new ones
+        if (!spans.empty() && spans == previous) {
+            for (size_t i = rects.size() - open_rects; i < rects.size(); i++) {
+                rects[i].y1 = y + 1;
+            }
+            continue;
+        }
+        for (const Span& span : spans) {
+            rects.push_back({span.x0, y, span.x1, y + 1});
+        }
+        open_rects = spans.size();
+        previous.swap(spans);
+    }
+
+    return addRoi(RoiShape::POLYGON, std::move(rects));
+}
+
+int RoiEngine::addLine(int x0, int y0, int x1, int y1) {
+    // Bresenham, both end points included; pixels on one row are merged into a run
+    std::vector<Rect> rects;
+    const int dx = std::abs(x1 - x0);
+    const int dy = -std::abs(y1 - y0);
+    const int step_x = x0 < x1 ? 1 : -1;
+    const int step_y = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    int x = x0;
+    int y = y0;
+    while (true) {
+        if (x >= 0 && y >= 0 && x < kMaxCoordinate && y < kMaxCoordinate) {
+            Rect* last = rects.empty() ? nullptr : &rects.back();
+            if (last && last->y0 == y && last->x1 == x) {
+                last->x1 = x + 1;
+            } else if (last && last->y0 == y && last->x0 == x + 1) {
+                last->x0 = x;
+            } else {
+                rects.push_back({x, y, x + 1, y + 1});
+            }
+        }
+        if (x == x1 && y == y1) {
+            break;
+        }
+        const int doubled = 2 * error;
+        if (doubled >= dy) {
+            error += dy;
+            x += step_x;
+        }
+        if (doubled <= dx) {
+            error += dx;
+            y += step_y;
+        }
+    }
+
+    return addRoi(RoiShape::LINE, std::move(rects));
+}
+
+int RoiEngine::addRoi(RoiShape shape, std::vector<Rect> rects) {
+    if (rects.empty()) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(roi_mutex_);
+    if (rois_.size() >= static_cast<size_t>(kMaxRois)) {
+        ROI_LOGW("ROI limit of %d reached", kMaxRois);
+        return -1;
+    }
+    const int id = next_id_++;
+    ROI_LOGI("Added ROI %d (shape %d, %zu rects)", id, static_cast<int>(shape), rects.size());
+    rois_.push_back({id, shape, std::move(rects)});
+    return id;
+}
+
+bool RoiEngine::remove(int id) {
+    std::lock_guard<std::mutex> lock(roi_mutex_);
+    auto it = std::find_if(rois_.begin(), rois_.end(), [id](const Roi& roi) { return roi.id == id; });
+    if (it == rois_.end()) {
+        return false;
+    }
+    rois_.erase(it);
+
+    // Drop its result now rather than on the next frame, which may never come
+    std::lock_guard<std::mutex> result_lock(result_mutex_);
+    results_.erase(std::remove_if(results_.begin(), results_.end(),
+                                  [id](const RoiResult& result) { return result.id == id; }),
+                   results_.end());
+    return true;
+}
+
+void RoiEngine::clear() {
+    {
+        std::lock_guard<std::mutex> lock(roi_mutex_);
+        rois_.clear();
+    }
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    results_.clear();
+}
+
+size_t RoiEngine::getRoiCount() {
+    std::lock_guard<std::mutex> lock(roi_mutex_);
+    return rois_.size();
+}
+
+void RoiEngine::process(const ThermalFrame& frame) {
+    if ((!frame.celsius && !frame.image) || frame.width <= 0 || frame.height <= 0) {
+        return;
+    }
+
+    std::vector<RoiResult> results;
+    {
+        std::lock_guard<std::mutex> lock(roi_mutex_);
+        if (rois_.empty()) {
+            // Nothing to build; publish the empty set so no stale result outlives its ROI
+            std::lock_guard<std::mutex> result_lock(result_mutex_);
+            results_.clear();
+            return;
+        }
+
+        loadValues(frame);
+        buildIntegrals();
+        buildPyramid();
+
+        results.reserve(rois_.size());
+        for (const Roi& roi : rois_) {
+            Accumulator acc;
+            for (const Rect& rect : roi.rects) {
+                const Rect clipped = {std::max(rect.x0, 0), std::max(rect.y0, 0),
+                                      std::min(rect.x1, width_), std::min(rect.y1, height_)};
+                if (clipped.x1 > clipped.x0 && clipped.y1 > clipped.y0) {
+                    measureRect(clipped, &acc);
+                }
+            }
+
+            RoiResult result = {};
+            result.id = roi.id;
+            result.shape = roi.shape;
+            result.pixelCount = acc.count;
+            if (acc.count > 0) {
+                const double mean = acc.sum / acc.count;
+                result.mean = static_cast<float>(mean);
+                result.variance = static_cast<float>(std::max(0.0, acc.sumSq / acc.count - mean * mean));
+                result.min = acc.extremes.min;
+                result.max = acc.extremes.max;
+                result.minX = acc.extremes.minIndex % width_;
+                result.minY = acc.extremes.minIndex / width_;
+                result.maxX = acc.extremes.maxIndex % width_;
+                result.maxY = acc.extremes.maxIndex / width_;
+            } else {
+                result.mean = result.variance = result.min = result.max = NAN;
+                result.minX = result.minY = result.maxX = result.maxY = -1;
+            }
+            results.push_back(result);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    results_.swap(results);
+}
+
+void RoiEngine::getResults(std::vector<RoiResult>* out) {
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    *out = results_;
+}
+
+void RoiEngine::loadValues(const ThermalFrame& frame) {
+    width_ = frame.width;
+    height_ = frame.height;
+    if (frame.celsius) {
+        values_ = frame.celsius;
+        return;
+    }
+
+    const size_t count = static_cast<size_t>(width_) * height_;
+    luma_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        luma_[i] = frame.image[i * 2];
+    }
+    values_ = luma_.data();
+}
+
+void RoiEngine::buildIntegrals() {
+    // Entry (x, y) holds the sum over [0, x) x [0, y); row and column 0 stay zero
+    const size_t stride = static_cast<size_t>(width_) + 1;
+    sum_.resize(stride * (height_ + 1));
+    sum_sq_.resize(stride * (height_ + 1));
+    std::fill(sum_.begin(), sum_.begin() + stride, 0.0);
+    std::fill(sum_sq_.begin(), sum_sq_.begin() + stride, 0.0);
+
+    for (int y = 0; y < height_; y++) {
+        const float* row = values_ + static_cast<size_t>(y) * width_;
+        const double* sum_above = &sum_[y * stride];
+        const double* sq_above = &sum_sq_[y * stride];
+        double* sum_out = &sum_[(y + 1) * stride];
+        double* sq_out = &sum_sq_[(y + 1) * stride];
+        sum_out[0] = 0.0;
+        sq_out[0] = 0.0;
+        double row_sum = 0.0;
+        double row_sq = 0.0;
+        for (int x = 0; x < width_; x++) {
+            const double v = row[x];
+            row_sum += v;
+            row_sq += v * v;
+            sum_out[x + 1] = sum_above[x + 1] + row_sum;
+            sq_out[x + 1] = sq_above[x + 1] + row_sq;
+        }
+    }
+}
+
+void RoiEngine::buildPyramid() {
+    // Level geometry only changes with the frame size; storage is reused across frames
+    const int block = 1 << kBlockShift;
+    int columns = (width_ + block - 1) >> kBlockShift;
+    int rows = (height_ + block - 1) >> kBlockShift;
+    level_columns_.assign(1, columns);
+    level_rows_.assign(1, rows);
+    while (columns > 1 || rows > 1) {
+        columns = (columns + 1) / 2;
+        rows = (rows + 1) / 2;
+        level_columns_.push_back(columns);
+        level_rows_.push_back(rows);
+    }
+    pyramid_.resize(level_columns_.size());
+    for (size_t level = 0; level < pyramid_.size(); level++) {
+        pyramid_[level].resize(static_cast<size_t>(level_columns_[level]) * level_rows_[level]);
+    }
+
+    // Level 0: min/max of each 8x8 block, partial at the right and bottom edges
+    for (int by = 0; by < level_rows_[0]; by++) {
+        for (int bx = 0; bx < level_columns_[0]; bx++) {
+            Block b = {INFINITY, -INFINITY, -1, -1};
+            const int y_end = std::min(height_, (by + 1) * block);
+            const int x_end = std::min(width_, (bx + 1) * block);
+            for (int y = by * block; y < y_end; y++) {
+                for (int x = bx * block; x < x_end; x++) {
+                    const int32_t index = y * width_ + x;
+                    const float v = values_[index];
+                    if (v < b.min) {
+                        b.min = v;
+                        b.minIndex = index;
+                    }
+                    if (v > b.max) {
+                        b.max = v;
+                        b.maxIndex = index;
+                    }
+                }
+            }
+            pyramid_[0][by * level_columns_[0] + bx] = b;
+        }
+    }
+
+    // Each further level merges 2x2 blocks of the one below, down to a single block
+    for (size_t level = 1; level < pyramid_.size(); level++) {
+        const std::vector<Block>& below = pyramid_[level - 1];
+        const int below_columns = level_columns_[level - 1];
+        const int below_rows = level_rows_[level - 1];
+        for (int by = 0; by < level_rows_[level]; by++) {
+            for (int bx = 0; bx < level_columns_[level]; bx++) {
+                Block b = {INFINITY, -INFINITY, -1, -1};
+                for (int cy = by * 2; cy < std::min(below_rows, by * 2 + 2); cy++) {
+                    for (int cx = bx * 2; cx < std::min(below_columns, bx * 2 + 2); cx++) {
+                        const Block& child = below[cy * below_columns + cx];
+                        if (child.min < b.min) {
+                            b.min = child.min;
+                            b.minIndex = child.minIndex;
+                        }
+                        if (child.max > b.max) {
+                            b.max = child.max;
+                            b.maxIndex = child.maxIndex;
+                        }
+                    }
+                }
+                pyramid_[level][by * level_columns_[level] + bx] = b;
+            }
+        }
+    }
+}
+
+void RoiEngine::measureRect(const Rect& rect, Accumulator* acc) const {
+    const size_t stride = static_cast<size_t>(width_) + 1;
+    const size_t top_left = rect.y0 * stride + rect.x0;
+    const size_t top_right = rect.y0 * stride + rect.x1;
+    const size_t bottom_left = rect.y1 * stride + rect.x0;
+    const size_t bottom_right = rect.y1 * stride + rect.x1;
+    acc->sum += sum_[bottom_right] - sum_[bottom_left] - sum_[top_right] + sum_[top_left];
+    acc->sumSq += sum_sq_[bottom_right] - sum_sq_[bottom_left] - sum_sq_[top_right] + sum_sq_[top_left];
+    acc->count += (rect.x1 - rect.x0) * (rect.y1 - rect.y0);
+
+    queryExtremes(static_cast<int>(pyramid_.size()) - 1, 0, 0, rect, acc);
+}
+
+void RoiEngine::queryExtremes(int level, int bx, int by, const Rect& rect, Accumulator* acc) const {
+    const int size = 1 << (kBlockShift + level);
+    const int block_x0 = bx * size;
+    const int block_y0 = by * size;
+    const int block_x1 = std::min(width_, block_x0 + size);
+    const int block_y1 = std::min(height_, block_y0 + size);
+    const int x0 = std::max(rect.x0, block_x0);
+    const int y0 = std::max(rect.y0, block_y0);
+    const int x1 = std::min(rect.x1, block_x1);
+    const int y1 = std::min(rect.y1, block_y1);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    // Blocks inside the rect answer from the pyramid; only border blocks are descended
+    if (x0 == block_x0 && y0 == block_y0 && x1 == block_x1 && y1 == block_y1) {
+        mergeExtremes(pyramid_[level][by * level_columns_[level] + bx], acc);
+        return;
+    }
+
+    if (level == 0) {
+        Block b = {INFINITY, -INFINITY, -1, -1};
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                const int32_t index = y * width_ + x;
+                const float v = values_[index];
+                if (v < b.min) {
+                    b.min = v;
+                    b.minIndex = index;
+                }
+                if (v > b.max) {
+                    b.max = v;
+                    b.maxIndex = index;
+                }
+            }
+        }
+        mergeExtremes(b, acc);
+        return;
+    }
+
+    const int child_columns = level_columns_[level - 1];
+    const int child_rows = level_rows_[level - 1];
+    for (int cy = by * 2; cy < std::min(child_rows, by * 2 + 2); cy++) {
+        for (int cx = bx * 2; cx < std::min(child_columns, bx * 2 + 2); cx++) {
+            queryExtremes(level - 1, cx, cy, rect, acc);
+        }
+    }
+}
+
+void RoiEngine::mergeExtremes(const Block& block, Accumulator* acc) {
+    if (acc->extremes.minIndex < 0 || block.min < acc->extremes.min) {
+        acc->extremes.min = block.min;
+        acc->extremes.minIndex = block.minIndex;
+    }
+    if (acc->extremes.maxIndex < 0 || block.max > acc->extremes.max) {
+        acc->extremes.max = block.max;
+        acc->extremes.maxIndex = block.maxIndex;
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <android/log.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "radiometric.h"
+
+// Logging macros
+#define ROI_TAG "RoiEngine"
+#define ROI_LOGI(...) __android_log_print(ANDROID_LOG_INFO, ROI_TAG, __VA_ARGS__)
+#define ROI_LOGW(...) __android_log_print(ANDROID_LOG_WARN, ROI_TAG, __VA_ARGS__)
+
+enum class RoiShape {
+    RECT = 0,
+    POLYGON = 1,
+    LINE = 2
+};
+
+struct RoiPoint {
+    int x;
+    int y;
+};
+
+// Measurement of one ROI on the latest frame, in °C when the frame has a temperature
+// plane and in luma otherwise
+struct RoiResult {
+    int id;
+    RoiShape shape;
+    int pixelCount;         // 0 when the ROI lies outside the frame
+    float mean;
+    float variance;
+    float min;
+    float max;
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+};
+
+// Floats per ROI in the array filled by nativeGetRoiResults; keep in sync with CameraActivity.ROI_RESULT_*
+enum RoiResultIndex {
+    ROI_RESULT_ID = 0,
+    ROI_RESULT_PIXEL_COUNT,
+    ROI_RESULT_MEAN,
+    ROI_RESULT_VARIANCE,
+    ROI_RESULT_MIN,
+    ROI_RESULT_MAX,
+    ROI_RESULT_MIN_X,
+    ROI_RESULT_MIN_Y,
+    ROI_RESULT_MAX_X,
+    ROI_RESULT_MAX_Y,
+    ROI_RESULT_STRIDE
+};
+
+/**
+ * Area measurements for any number of ROIs, without a USB round trip per ROI.
+ *
+ * Every ROI is rasterized once, when it is added, into rectangles: a polygon's scanline
+ * spans are merged across rows that share them, a line becomes its horizontal pixel runs.
+ * Per frame the engine builds summed-area and squared-sum tables over the whole frame and
+ * a min/max pyramid of 8x8 blocks, merged 2x2 per level. Mean and variance of a rectangle
+ * are then four table reads; min and max descend the pyramid and only touch pixels along
+ * the rectangle's border. Nothing is built while no ROI is defined.
+ */
+class RoiEngine {
+public:
+    static constexpr int kMaxRois = 256;
+
+    // Coordinates are sensor pixels. Each returns the new ROI id, or -1 if it is empty or
+    // kMaxRois are already defined.
+    int addRect(int x, int y, int width, int height);
+    int addPolygon(const std::vector<RoiPoint>& points);
+    int addLine(int x0, int y0, int x1, int y1);
+    bool remove(int id);
+    void clear();
+    size_t getRoiCount();
+
+    // Frame thread
+    void process(const ThermalFrame& frame);
+
+    // Results of the latest processed frame, in the order the ROIs were added
+    void getResults(std::vector<RoiResult>* out);
+
+private:
+    struct Rect {
+        int x0, y0, x1, y1;     // Half-open
+    };
+
+    struct Roi {
+        int id;
+        RoiShape shape;
+        std::vector<Rect> rects;
+    };
+
+    struct Block {
+        float min;
+        float max;
+        int32_t minIndex;       // Pixel index into the frame
+        int32_t maxIndex;
+    };
+
+    struct Accumulator {
+        double sum = 0.0;
+        double sumSq = 0.0;
+        int count = 0;
+        Block extremes = {0.0f, 0.0f, -1, -1};
+    };
+
+    int addRoi(RoiShape shape, std::vector<Rect> rects);
+
+    // Per-frame tables
+    void loadValues(const ThermalFrame& frame);
+    void buildIntegrals();
+    void buildPyramid();
+    void measureRect(const Rect& rect, Accumulator* acc) const;
+    void queryExtremes(int level, int bx, int by, const Rect& rect, Accumulator* acc) const;
+    static void mergeExtremes(const Block& block, Accumulator* acc);
+
+    std::mutex roi_mutex_;
+    std::vector<Roi> rois_;
+    int next_id_ = 0;
+
+    // Frame thread only
+    int width_ = 0;
+    int height_ = 0;
+    const float* values_ = nullptr;         // Temperature plane, or luma_ below
+    std::vector<float> luma_;
+    std::vector<double> sum_;               // (width + 1) x (height + 1)
+    std::vector<double> sum_sq_;
+    std::vector<std::vector<Block>> pyramid_;
+    std::vector<int> level_columns_;
+    std::vector<int> level_rows_;
+
+    std::mutex result_mutex_;
+    std::vector<RoiResult> results_;
+};
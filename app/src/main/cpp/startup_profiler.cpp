@@ -0,0 +1,54 @@
+#include "startup_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+int64_t StartupProfiler::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void StartupProfiler::begin() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    origin_us_ = nowUs();
+    phase_count_ = 0;
+    STARTUP_LOGI("Startup profile started");
+}
+
+void StartupProfiler::record(const char* phase, int64_t startUs, int64_t endUs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (origin_us_ == 0 || phase_count_ >= kMaxPhases) {
+        return;
+    }
+    phases_[phase_count_++] = {phase, startUs, endUs};
+}
+
+void StartupProfiler::mark(const char* event) {
+    const int64_t now = nowUs();
+    record(event, now, now);
+}
+
+std::string StartupProfiler::report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Phase sorted[kMaxPhases];
+    std::copy(phases_, phases_ + phase_count_, sorted);
+    std::stable_sort(sorted, sorted + phase_count_, [](const Phase& a, const Phase& b) {
+        return a.startUs < b.startUs;
+    });
+
+    std::string result = "Startup profile (offset / duration):\n";
+    char line[128];
+    for (int i = 0; i < phase_count_; i++) {
+        const Phase& phase = sorted[i];
+        if (phase.endUs == phase.startUs) {
+            snprintf(line, sizeof(line), "  %8.1f ms            %s\n",
+                     (phase.startUs - origin_us_) / 1000.0, phase.name);
+        } else {
+            snprintf(line, sizeof(line), "  %8.1f ms %8.1f ms  %s\n",
+                     (phase.startUs - origin_us_) / 1000.0, (phase.endUs - phase.startUs) / 1000.0, phase.name);
+        }
+        result += line;
+    }
+    return result;
+}
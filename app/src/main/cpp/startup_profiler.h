@@ -0,0 +1,69 @@
+#pragma once
+
+#include <android/log.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Logging macros
+#define STARTUP_TAG "StartupProfiler"
+#define STARTUP_LOGI(...) __android_log_print(ANDROID_LOG_INFO, STARTUP_TAG, __VA_ARGS__)
+
+/**
+ * Records the phases of a camera connection (USB setup, negotiation, ircmd init, ...)
+ * relative to the moment the connection attempt began, so time-to-first-frame can be
+ * broken down. Phases may run on different threads concurrently.
+ *
+ * Phase names must be string literals; they are stored by pointer.
+ */
+class StartupProfiler {
+public:
+    static StartupProfiler& getInstance() {
+        static StartupProfiler instance;
+        return instance;
+    }
+
+    // Start a new profile; all later timestamps are relative to this call
+    void begin();
+
+    // Record a finished phase or a point event (startUs == endUs)
+    void record(const char* phase, int64_t startUs, int64_t endUs);
+    void mark(const char* event);
+
+    // One line per phase in start order, with offset from begin() and duration
+    std::string report() const;
+
+    static int64_t nowUs();
+
+private:
+    StartupProfiler() = default;
+    StartupProfiler(const StartupProfiler&) = delete;
+    StartupProfiler& operator=(const StartupProfiler&) = delete;
+
+    static constexpr int kMaxPhases = 32;
+
+    struct Phase {
+        const char* name;
+        int64_t startUs;
+        int64_t endUs;
+    };
+
+    mutable std::mutex mutex_;
+    int64_t origin_us_ = 0;
+    Phase phases_[kMaxPhases] = {};
+    int phase_count_ = 0;
+};
+
+// Times the enclosing scope as one startup phase
+class ScopedStartupPhase {
+public:
+    explicit ScopedStartupPhase(const char* phase)
+        : phase_(phase), start_us_(StartupProfiler::nowUs()) {}
+    ~ScopedStartupPhase() {
+        StartupProfiler::getInstance().record(phase_, start_us_, StartupProfiler::nowUs());
+    }
+
+private:
+    const char* phase_;
+    int64_t start_us_;
+};
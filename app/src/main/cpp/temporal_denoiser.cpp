@@ -0,0 +1,141 @@
+#include "temporal_denoiser.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+constexpr int kFractionBits = 4;            // History fixed point
+constexpr int16_t kUnitWeight = 32767;      // Q15 weight of the new frame at full motion
+constexpr int64_t kRestartGapNs = 500000000;
+
+// Scalar model of vqrdmulhq_s16, so both paths produce the same frames
+inline int16_t roundingDoublingMultiplyHigh(int16_t a, int16_t b) {
+    const int32_t product = (2 * static_cast<int32_t>(a) * b + (1 << 15)) >> 16;
+    return static_cast<int16_t>(std::min(product, 32767));
+}
+
+} // namespace
+
+TemporalDenoiser::TemporalDenoiser() {
+    configure(DenoiseParams());
+}
+
+bool TemporalDenoiser::configure(const DenoiseParams& params) {
+    if (params.strength < 0.0f || params.strength > 0.95f || params.motionThreshold < 1 ||
+        params.motionThreshold > 255 || (params.consumers & ~(DENOISE_DISPLAY | DENOISE_RECORDING | DENOISE_CAPTURE)) != 0) {
+        return false;
+    }
+    std::atomic_store(&params_, std::shared_ptr<const DenoiseParams>(std::make_shared<DenoiseParams>(params)));
+    DENOISE_LOGI("Temporal denoise %s: strength %.2f, motion threshold %d, consumers 0x%x",
+                 params.enabled ? "enabled" : "disabled", params.strength, params.motionThreshold, params.consumers);
+    return true;
+}
+
+DenoiseParams TemporalDenoiser::getParams() const {
+    return *std::atomic_load(&params_);
+}
+
+int TemporalDenoiser::getConsumers() const {
+    const std::shared_ptr<const DenoiseParams> params = std::atomic_load(&params_);
+    return params->enabled ? params->consumers : 0;
+}
+
+const uint8_t* TemporalDenoiser::process(const uint8_t* yuyv, size_t srcStride, int width, int height) {
+    const int64_t start_ns = steadyNanos();
+    const std::shared_ptr<const DenoiseParams> params = std::atomic_load(&params_);
+    const size_t pixels = static_cast<size_t>(width) * height;
+    const size_t row_bytes = static_cast<size_t>(width) * 2;
+
+    // A new size or a pause (filter off, stream restarted) leaves nothing to average with
+    if (width != width_ || height != height_ || start_ns - last_frame_ns_ > kRestartGapNs) {
+        width_ = width;
+        height_ = height;
+        history_.resize(pixels);
+        output_.resize(pixels * 2);
+        for (int y = 0; y < height; y++) {
+            const uint8_t* src = yuyv + y * srcStride;
+            int16_t* history = history_.data() + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++) {
+                history[x] = static_cast<int16_t>(src[x * 2] << kFractionBits);
+            }
+            std::memcpy(output_.data() + y * row_bytes, src, row_bytes);
+        }
+    } else {
+        // Weight of the new frame: base within the noise level, ramping to unit at the threshold
+        const int16_t base = static_cast<int16_t>(std::lround((1.0f - params->strength) * kUnitWeight));
+        const int16_t threshold = static_cast<int16_t>(params->motionThreshold << kFractionBits);
+        const int16_t noise = static_cast<int16_t>(threshold / 2);
+        const int16_t gain = static_cast<int16_t>(kUnitWeight / (threshold - noise));
+        for (int y = 0; y < height; y++) {
+            filterRow(yuyv + y * srcStride, history_.data() + static_cast<size_t>(y) * width,
+                      output_.data() + y * row_bytes, width, base, gain, noise, threshold);
+        }
+    }
+    last_frame_ns_ = start_ns;
+
+    const int64_t elapsed_ns = steadyNanos() - start_ns;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    last_ns_.store(elapsed_ns, std::memory_order_relaxed);
+    total_ns_.fetch_add(elapsed_ns, std::memory_order_relaxed);
+    if (elapsed_ns > max_ns_.load(std::memory_order_relaxed)) {
+        max_ns_.store(elapsed_ns, std::memory_order_relaxed);
+    }
+    return output_.data();
+}
+
+void TemporalDenoiser::filterRow(const uint8_t* src, int16_t* history, uint8_t* dst, int width,
+                                 int16_t baseWeight, int16_t rampGain, int16_t noiseLevel, int16_t motionThreshold) {
+    const int16_t span = static_cast<int16_t>(kUnitWeight - baseWeight);
+    int x = 0;
+#if defined(__ARM_NEON)
+    const int16x8_t base_v = vdupq_n_s16(baseWeight);
+    const int16x8_t span_v = vdupq_n_s16(span);
+    const int16x8_t gain_v = vdupq_n_s16(rampGain);
+    const int16x8_t noise_v = vdupq_n_s16(noiseLevel);
+    const int16x8_t range_v = vdupq_n_s16(static_cast<int16_t>(motionThreshold - noiseLevel));
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x2_t pixels = vld2q_u8(src + x * 2);     // val[0] luma, val[1] chroma
+        uint8x8_t luma_out[2];
+        for (int half = 0; half < 2; half++) {
+            const uint8x8_t luma = half == 0 ? vget_low_u8(pixels.val[0]) : vget_high_u8(pixels.val[0]);
+            const int16x8_t current = vreinterpretq_s16_u16(vshll_n_u8(luma, kFractionBits));
+            int16x8_t h = vld1q_s16(history + x + half * 8);
+            const int16x8_t diff = vsubq_s16(current, h);
+            const int16x8_t motion = vminq_s16(vmaxq_s16(vsubq_s16(vabsq_s16(diff), noise_v), vdupq_n_s16(0)), range_v);
+            const int16x8_t weight = vaddq_s16(base_v, vqrdmulhq_s16(vmulq_s16(motion, gain_v), span_v));
+            h = vaddq_s16(h, vqrdmulhq_s16(diff, weight));
+            vst1q_s16(history + x + half * 8, h);
+            luma_out[half] = vqrshrun_n_s16(h, kFractionBits);
+        }
+        pixels.val[0] = vcombine_u8(luma_out[0], luma_out[1]);
+        vst2q_u8(dst + x * 2, pixels);
+    }
+#endif
+    for (; x < width; x++) {
+        const int16_t current = static_cast<int16_t>(src[x * 2] << kFractionBits);
+        const int16_t diff = static_cast<int16_t>(current - history[x]);
+        const int16_t motion = static_cast<int16_t>(
+            std::clamp(std::abs(diff) - noiseLevel, 0, motionThreshold - noiseLevel));
+        const int16_t weight = static_cast<int16_t>(
+            baseWeight + roundingDoublingMultiplyHigh(static_cast<int16_t>(motion * rampGain), span));
+        history[x] = static_cast<int16_t>(history[x] + roundingDoublingMultiplyHigh(diff, weight));
+        dst[x * 2] = static_cast<uint8_t>(std::min((history[x] + (1 << (kFractionBits - 1))) >> kFractionBits, 255));
+        dst[x * 2 + 1] = src[x * 2 + 1];
+    }
+}
+
+DenoiseStats TemporalDenoiser::getStats() const {
+    return {frames_.load(std::memory_order_relaxed), last_ns_.load(std::memory_order_relaxed),
+            max_ns_.load(std::memory_order_relaxed), total_ns_.load(std::memory_order_relaxed)};
+}
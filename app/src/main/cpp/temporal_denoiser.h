@@ -0,0 +1,94 @@
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Logging macros
+#define DENOISE_TAG "TemporalDenoiser"
+#define DENOISE_LOGI(...) __android_log_print(ANDROID_LOG_INFO, DENOISE_TAG, __VA_ARGS__)
+
+// Bits of DenoiseParams::consumers; keep in sync with CameraActivity.DENOISE_*
+enum DenoiseConsumer {
+    DENOISE_DISPLAY = 1,
+    DENOISE_RECORDING = 2,
+    DENOISE_CAPTURE = 4
+};
+
+struct DenoiseParams {
+    bool enabled = false;
+    float strength = 0.75f;         // Share of the history kept on still pixels, 0..0.95
+    int motionThreshold = 12;       // Luma change at which a pixel is taken from the new frame alone
+    int consumers = DENOISE_DISPLAY | DENOISE_RECORDING;
+};
+
+// Slots of the array filled by nativeGetDenoiseStats; keep in sync with CameraActivity.DENOISE_STATS_*
+enum DenoiseStatsIndex {
+    DENOISE_STATS_FRAMES = 0,
+    DENOISE_STATS_LAST_NS,
+    DENOISE_STATS_MAX_NS,
+    DENOISE_STATS_MEAN_NS,
+    DENOISE_STATS_COUNT
+};
+
+struct DenoiseStats {
+    uint64_t frames;
+    int64_t lastNs;
+    int64_t maxNs;
+    int64_t totalNs;
+};
+
+/**
+ * Motion-adaptive recursive temporal filter on the luma of the image plane, a host-side
+ * alternative to the device's TNR that only the selected consumers see.
+ *
+ * The history is kept per pixel in 12.4 fixed point. Each frame moves it towards the new
+ * luma by a weight of 1 - strength while the pixel differs from the history by less than
+ * half of motionThreshold, taken as noise, ramping linearly to 1 at the threshold. Still
+ * areas average over several frames while moving edges follow the new frame without
+ * ghosting. The weight and the update are two saturating rounding doubling multiplies per
+ * pixel, 16 pixels per NEON iteration.
+ * Chroma is copied from the source.
+ *
+ * The filtered frame goes to a separate buffer; the source frame stays untouched for the
+ * consumers not selected and for the measurements, which read the temperature plane.
+ */
+class TemporalDenoiser {
+public:
+    TemporalDenoiser();
+
+    // Any thread; applied from the next frame. Returns false if the params are out of range.
+    bool configure(const DenoiseParams& params);
+    DenoiseParams getParams() const;
+
+    // DenoiseConsumer bits that get filtered frames, 0 while disabled
+    int getConsumers() const;
+
+    // Frame thread: filter the YUYV source (srcStride bytes per row) into the internal buffer
+    // and return it, width * 2 bytes per row. The history restarts when the size
+    // changes or after a gap in the frames.
+    const uint8_t* process(const uint8_t* yuyv, size_t srcStride, int width, int height);
+
+    DenoiseStats getStats() const;
+
+private:
+    static void filterRow(const uint8_t* src, int16_t* history, uint8_t* dst, int width,
+                          int16_t baseWeight, int16_t rampGain, int16_t noiseLevel, int16_t motionThreshold);
+
+    std::shared_ptr<const DenoiseParams> params_;   // Accessed with std::atomic_load/atomic_store
+
+    // Frame thread only
+    std::vector<int16_t> history_;             // Luma, 12.4 fixed point
+    std::vector<uint8_t> output_;
+    int width_ = 0;
+    int height_ = 0;
+    int64_t last_frame_ns_ = 0;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<int64_t> last_ns_{0};
+    std::atomic<int64_t> max_ns_{0};
+    std::atomic<int64_t> total_ns_{0};
+};
@@ -0,0 +1,600 @@
+#include "timeseries_store.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// ===== BLOCK CODEC =====
+
+void writeVarint(std::vector<uint8_t>* out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<uint8_t>(value));
+}
+
+bool readVarint(const uint8_t* data, size_t size, size_t* pos, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && *pos < size; shift += 7) {
+        const uint8_t byte = data[(*pos)++];
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>* out) : out_(out) {}
+
+    // count <= 32
+    void write(uint32_t value, int count) {
+        const uint64_t mask = count >= 32 ? 0xFFFFFFFFull : (1ull << count) - 1;
+        accumulator_ = (accumulator_ << count) | (value & mask);
+        pending_ += count;
+        while (pending_ >= 8) {
+            pending_ -= 8;
+            out_->push_back(static_cast<uint8_t>(accumulator_ >> pending_));
+        }
+        accumulator_ &= (1ull << pending_) - 1;
+    }
+
+    void flush() {
+        if (pending_ > 0) {
+            out_->push_back(static_cast<uint8_t>(accumulator_ << (8 - pending_)));
+            pending_ = 0;
+            accumulator_ = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>* out_;
+    uint64_t accumulator_ = 0;
+    int pending_ = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    uint32_t read(int count) {
+        uint32_t value = 0;
+        while (count > 0) {
+            if (byte_ >= size_) {
+                return count >= 32 ? 0 : value << count;
+            }
+            const int available = 8 - bit_;
+            const int take = std::min(available, count);
+            const uint32_t chunk = (data_[byte_] >> (available - take)) & ((1u << take) - 1);
+            value = (value << take) | chunk;
+            bit_ += take;
+            if (bit_ == 8) {
+                bit_ = 0;
+                byte_++;
+            }
+            count -= take;
+        }
+        return value;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t byte_ = 0;
+    int bit_ = 0;
+};
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Layout: varint count, varint timestamp bytes, timestamp varints, value bits
+void encodeBlock(const std::vector<int64_t>& times, const std::vector<float>& values, std::vector<uint8_t>* out) {
+    std::vector<uint8_t> timestamps;
+    timestamps.reserve(times.size() + 16);
+    writeVarint(&timestamps, zigzag(times[0]));
+    int64_t previous_delta = 0;
+    for (size_t i = 1; i < times.size(); i++) {
+        const int64_t delta = times[i] - times[i - 1];
+        writeVarint(&timestamps, zigzag(delta - previous_delta));
+        previous_delta = delta;
+    }
+
+    out->clear();
+    writeVarint(out, times.size());
+    writeVarint(out, timestamps.size());
+    out->insert(out->end(), timestamps.begin(), timestamps.end());
+
+    BitWriter bits(out);
+    uint32_t previous = floatBits(values[0]);
+    bits.write(previous, 32);
+    int window_leading = -1;
+    int window_trailing = 0;
+    for (size_t i = 1; i < values.size(); i++) {
+        const uint32_t current = floatBits(values[i]);
+        const uint32_t x = current ^ previous;
+        previous = current;
+        if (x == 0) {
+            bits.write(0, 1);
+            continue;
+        }
+        bits.write(1, 1);
+        const int leading = __builtin_clz(x);
+        const int trailing = __builtin_ctz(x);
+        if (window_leading >= 0 && leading >= window_leading && trailing >= window_trailing) {
+            // Meaningful bits fit the previous window
+            bits.write(0, 1);
+            bits.write(x >> window_trailing, 32 - window_leading - window_trailing);
+        } else {
+            const int length = 32 - leading - trailing;
+            bits.write(1, 1);
+            bits.write(leading, 5);
+            bits.write(length - 1, 5);
+            bits.write(x >> trailing, length);
+            window_leading = leading;
+            window_trailing = trailing;
+        }
+    }
+    bits.flush();
+}
+
+} // namespace
+
+TimeSeriesStore::~TimeSeriesStore() {
+    stopSpillThread();
+    releaseSegments();
+}
+
+void TimeSeriesStore::configure(bool enabled, size_t memoryCapBytes, size_t spillCapBytes,
+                                const std::string& spillDirectory) {
+    bool start_thread = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        memory_cap_ = std::max<size_t>(memoryCapBytes, 1024 * 1024);
+        spill_cap_ = std::max<size_t>(spillCapBytes, 1024 * 1024);
+        spill_directory_ = spillDirectory;
+        start_thread = !spill_directory_.empty() && !spill_thread_.joinable();
+        spill_stop_ = false;
+        enforceCapLocked();
+        enforceSpillCapLocked();
+    }
+    if (start_thread) {
+        spill_thread_ = std::thread(&TimeSeriesStore::spillLoop, this);
+    }
+    enabled_.store(enabled, std::memory_order_relaxed);
+    TIMESERIES_LOGI("📊 Time series %s: %zu KB memory cap, spill to %s (%zu KB cap)", enabled ? "enabled" : "disabled",
+                    memoryCapBytes / 1024, spillDirectory.empty() ? "(none)" : spillDirectory.c_str(), spillCapBytes / 1024);
+}
+
+int TimeSeriesStore::getSeries(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = series_ids_.find(name);
+    if (it != series_ids_.end()) {
+        return it->second;
+    }
+    auto series = std::make_unique<Series>();
+    series->name = name;
+    series->openTimes.reserve(kBlockPoints);
+    series->openValues.reserve(kBlockPoints);
+    series_.push_back(std::move(series));
+    const int id = static_cast<int>(series_.size()) - 1;
+    series_ids_[name] = id;
+    return id;
+}
+
+std::vector<std::string> TimeSeriesStore::getSeriesNames() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    names.reserve(series_.size());
+    for (const auto& series : series_) {
+        names.push_back(series->name);
+    }
+    return names;
+}
+
+void TimeSeriesStore::append(int id, int64_t timestampUs, float value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id < 0 || id >= static_cast<int>(series_.size())) {
+        return;
+    }
+    Series& series = *series_[id];
+    if (!series.openTimes.empty() && timestampUs < series.openTimes.back()) {
+        return;
+    }
+    if (series.rollups[0].empty()) {
+        series.firstUs = timestampUs;
+    }
+    series.openTimes.push_back(timestampUs);
+    series.openValues.push_back(value);
+
+    for (int level = 0; level < kRollupLevels; level++) {
+        std::deque<RollupBucket>& buckets = series.rollups[level];
+        const int64_t start = timestampUs - timestampUs % kRollupWidthUs[level];
+        if (buckets.empty() || buckets.back().startUs != start) {
+            buckets.push_back({start, value, value, value, 1});
+            if (buckets.size() > kRollupRetention[level]) {
+                buckets.pop_front();
+            }
+            continue;
+        }
+        RollupBucket& bucket = buckets.back();
+        bucket.min = std::min(bucket.min, value);
+        bucket.max = std::max(bucket.max, value);
+        bucket.sum += value;
+        bucket.count++;
+    }
+
+    if (series.openTimes.size() >= static_cast<size_t>(kBlockPoints)) {
+        sealLocked(series);
+    }
+}
+
+void TimeSeriesStore::sealLocked(Series& series) {
+    Block block;
+    block.sequence = next_sequence_++;
+    block.firstUs = series.openTimes.front();
+    block.lastUs = series.openTimes.back();
+    block.count = static_cast<uint32_t>(series.openTimes.size());
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    encodeBlock(series.openTimes, series.openValues, bytes.get());
+    bytes->shrink_to_fit();
+    memory_bytes_ += bytes->size();
+    block.bytes = std::move(bytes);
+    series.blocks.push_back(std::move(block));
+    series.openTimes.clear();
+    series.openValues.clear();
+    enforceCapLocked();
+}
+
+void TimeSeriesStore::enforceCapLocked() {
+    if (memory_bytes_ <= memory_cap_) {
+        return;
+    }
+    if (spill_thread_.joinable() && !spill_directory_.empty() && memory_bytes_ <= memory_cap_ * 2) {
+        spill_requested_ = true;
+        spill_cv_.notify_one();
+        return;
+    }
+
+    // No spill directory, or the spill thread fell far behind: drop the oldest blocks
+    while (memory_bytes_ > memory_cap_) {
+        Series* oldest_series = nullptr;
+        size_t oldest_index = 0;
+        uint64_t oldest_sequence = UINT64_MAX;
+        for (const auto& series : series_) {
+            for (size_t i = 0; i < series->blocks.size(); i++) {
+                if (series->blocks[i].bytes) {
+                    if (series->blocks[i].sequence < oldest_sequence) {
+                        oldest_sequence = series->blocks[i].sequence;
+                        oldest_series = series.get();
+                        oldest_index = i;
+                    }
+                    break;
+                }
+            }
+        }
+        if (!oldest_series) {
+            break;
+        }
+        memory_bytes_ -= oldest_series->blocks[oldest_index].bytes->size();
+        oldest_series->blocks.erase(oldest_series->blocks.begin() + oldest_index);
+    }
+}
+
+void TimeSeriesStore::spillLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            spill_cv_.wait(lock, [this] { return spill_requested_ || spill_stop_; });
+            if (spill_stop_) {
+                return;
+            }
+            spill_requested_ = false;
+        }
+        spillOnce();
+    }
+}
+
+void TimeSeriesStore::spillOnce() {
+    struct Picked {
+        Series* series;
+        uint64_t sequence;
+        std::shared_ptr<const std::vector<uint8_t>> bytes;
+        size_t offset;
+    };
+    std::vector<Picked> picked;
+    size_t total = 0;
+    std::string path;
+
+    // Pick the oldest in-memory blocks until half the cap would be free again. Only their
+    // byte vectors are shared here; the frame thread's append() waits on this lock, so the
+    // copy into the segment happens after it is released.
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (memory_bytes_ <= memory_cap_ / 2 || spill_directory_.empty()) {
+            return;
+        }
+        std::vector<std::pair<uint64_t, Series*>> candidates;
+        for (const auto& series : series_) {
+            for (const Block& block : series->blocks) {
+                if (block.bytes) {
+                    candidates.emplace_back(block.sequence, series.get());
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const std::pair<uint64_t, Series*>& a, const std::pair<uint64_t, Series*>& b) { return a.first < b.first; });
+
+        const size_t target = memory_bytes_ - memory_cap_ / 2;
+        for (const auto& candidate : candidates) {
+            if (total >= target) {
+                break;
+            }
+            for (const Block& block : candidate.second->blocks) {
+                if (block.sequence == candidate.first) {
+                    picked.push_back({candidate.second, block.sequence, block.bytes, total});
+                    total += block.bytes->size();
+                    break;
+                }
+            }
+        }
+        path = spill_directory_ + "/segment_" + std::to_string(next_segment_++) + ".tsb";
+    }
+    if (total == 0) {
+        return;
+    }
+
+    const int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+    if (fd < 0) {
+        TIMESERIES_LOGE("Cannot create spill segment %s", path.c_str());
+        return;
+    }
+    size_t written = 0;
+    for (const Picked& block : picked) {
+        size_t done = 0;
+        while (done < block.bytes->size()) {
+            const ssize_t result = write(fd, block.bytes->data() + done, block.bytes->size() - done);
+            if (result <= 0) {
+                break;
+            }
+            done += static_cast<size_t>(result);
+        }
+        written += done;
+        if (done < block.bytes->size()) {
+            break;
+        }
+    }
+    void* map = written == total ? mmap(nullptr, total, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        TIMESERIES_LOGE("Spilling %zu bytes to %s failed", total, path.c_str());
+        unlink(path.c_str());
+        return;
+    }
+
+    // Blocks dropped meanwhile are simply not found
+    std::lock_guard<std::mutex> lock(mutex_);
+    segments_.push_back({path, map, total});
+    spill_bytes_ += total;
+    const uint8_t* base = static_cast<const uint8_t*>(map);
+    for (const Picked& picked_block : picked) {
+        for (Block& block : picked_block.series->blocks) {
+            if (block.sequence == picked_block.sequence && block.bytes) {
+                memory_bytes_ -= block.bytes->size();
+                block.mapped = base + picked_block.offset;
+                block.mappedSize = picked_block.bytes->size();
+                block.bytes.reset();
+                break;
+            }
+        }
+    }
+    TIMESERIES_LOGI("Spilled %zu blocks (%zu KB) to %s", picked.size(), total / 1024, path.c_str());
+    enforceSpillCapLocked();
+}
+
+void TimeSeriesStore::enforceSpillCapLocked() {
+    while (spill_bytes_ > spill_cap_ && !segments_.empty()) {
+        // The oldest segment holds the oldest spilled blocks of each series; drop them before unmapping
+        const Segment segment = segments_.front();
+        const uint8_t* begin = static_cast<const uint8_t*>(segment.map);
+        const uint8_t* end = begin + segment.size;
+        size_t dropped = 0;
+        for (const auto& series : series_) {
+            std::deque<Block>& blocks = series->blocks;
+            const size_t before = blocks.size();
+            blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                        [begin, end](const Block& block) {
+                                            return block.mapped >= begin && block.mapped < end;
+                                        }),
+                         blocks.end());
+            dropped += before - blocks.size();
+        }
+        munmap(segment.map, segment.size);
+        unlink(segment.path.c_str());
+        spill_bytes_ -= segment.size;
+        segments_.erase(segments_.begin());
+        TIMESERIES_LOGI("Deleted %s (%zu blocks) over the %zu KB spill cap", segment.path.c_str(), dropped,
+                        spill_cap_ / 1024);
+    }
+}
+
+void TimeSeriesStore::stopSpillThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        spill_stop_ = true;
+    }
+    spill_cv_.notify_one();
+    if (spill_thread_.joinable()) {
+        spill_thread_.join();
+    }
+}
+
+void TimeSeriesStore::releaseSegments() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Segment& segment : segments_) {
+        munmap(segment.map, segment.size);
+        unlink(segment.path.c_str());
+    }
+    segments_.clear();
+    spill_bytes_ = 0;
+}
+
+void TimeSeriesStore::decodeBlock(const Block& block, int64_t fromUs, int64_t toUs,
+                                  std::vector<TimeSeriesPoint>* out) const {
+    const uint8_t* data = block.mapped ? block.mapped : block.bytes->data();
+    const size_t size = block.mapped ? block.mappedSize : block.bytes->size();
+    size_t pos = 0;
+    uint64_t count = 0;
+    uint64_t timestamp_bytes = 0;
+    if (!readVarint(data, size, &pos, &count) || !readVarint(data, size, &pos, &timestamp_bytes) ||
+        pos + timestamp_bytes > size || count == 0) {
+        return;
+    }
+
+    const size_t values_start = pos + timestamp_bytes;
+    BitReader bits(data + values_start, size - values_start);
+    uint64_t raw = 0;
+    int64_t timestamp = 0;
+    int64_t delta = 0;
+    uint32_t value = 0;
+    int window_leading = 0;
+    int window_trailing = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        if (!readVarint(data, values_start, &pos, &raw)) {
+            return;
+        }
+        if (i == 0) {
+            timestamp = unzigzag(raw);
+            value = bits.read(32);
+        } else {
+            delta += unzigzag(raw);
+            timestamp += delta;
+            if (bits.read(1)) {
+                if (bits.read(1)) {
+                    window_leading = static_cast<int>(bits.read(5));
+                    const int length = static_cast<int>(bits.read(5)) + 1;
+                    window_trailing = 32 - window_leading - length;
+                }
+                const int length = 32 - window_leading - window_trailing;
+                value ^= bits.read(length) << window_trailing;
+            }
+        }
+        if (timestamp >= fromUs && timestamp <= toUs) {
+            out->push_back({timestamp, bitsFloat(value)});
+        }
+    }
+}
+
+int TimeSeriesStore::queryRollup(const std::string& name, int64_t fromUs, int64_t toUs, int maxPoints,
+                                 std::vector<RollupBucket>* out) {
+    out->clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = series_ids_.find(name);
+    if (it == series_ids_.end()) {
+        return -1;
+    }
+    const Series& series = *series_[it->second];
+    if (series.rollups[0].empty()) {
+        return 0;
+    }
+    maxPoints = std::max(1, maxPoints);
+    toUs = std::min(toUs, series.rollups[0].back().startUs + kRollupWidthUs[0]);
+    // Nothing is older than the first point or the coarsest bucket left; a range reaching
+    // further back would otherwise be covered by no level but the coarsest
+    fromUs = std::max(fromUs, std::max(series.firstUs, series.rollups[kRollupLevels - 1].front().startUs));
+
+    // Finest level that holds the whole range in maxPoints buckets, else the finest that
+    // holds the range at all, else the one reaching furthest back
+    int chosen = -1;
+    int covering = -1;
+    for (int level = 0; level < kRollupLevels; level++) {
+        const std::deque<RollupBucket>& buckets = series.rollups[level];
+        const bool covers = !buckets.empty() && buckets.front().startUs <= fromUs;
+        if (covers && covering < 0) {
+            covering = level;
+        }
+        if (covers && (toUs - fromUs) / kRollupWidthUs[level] + 1 <= maxPoints) {
+            chosen = level;
+            break;
+        }
+    }
+    if (chosen < 0) {
+        chosen = covering >= 0 ? covering : kRollupLevels - 1;
+    }
+
+    const int64_t width = kRollupWidthUs[chosen];
+    for (const RollupBucket& bucket : series.rollups[chosen]) {
+        if (bucket.startUs + width > fromUs && bucket.startUs <= toUs) {
+            out->push_back(bucket);
+        }
+    }
+
+    // Merge neighbours when the range still has too many buckets
+    if (out->size() > static_cast<size_t>(maxPoints)) {
+        const size_t group = (out->size() + maxPoints - 1) / maxPoints;
+        size_t merged = 0;
+        for (size_t i = 0; i < out->size(); i += group) {
+            RollupBucket bucket = (*out)[i];
+            for (size_t j = i + 1; j < std::min(out->size(), i + group); j++) {
+                const RollupBucket& next = (*out)[j];
+                bucket.min = std::min(bucket.min, next.min);
+                bucket.max = std::max(bucket.max, next.max);
+                bucket.sum += next.sum;
+                bucket.count += next.count;
+            }
+            (*out)[merged++] = bucket;
+        }
+        out->resize(merged);
+    }
+    return static_cast<int>(out->size());
+}
+
+int TimeSeriesStore::queryRaw(const std::string& name, int64_t fromUs, int64_t toUs,
+                              std::vector<TimeSeriesPoint>* out) {
+    out->clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = series_ids_.find(name);
+    if (it == series_ids_.end()) {
+        return -1;
+    }
+    const Series& series = *series_[it->second];
+    for (const Block& block : series.blocks) {
+        if (block.lastUs >= fromUs && block.firstUs <= toUs) {
+            decodeBlock(block, fromUs, toUs, out);
+        }
+    }
+    for (size_t i = 0; i < series.openTimes.size(); i++) {
+        if (series.openTimes[i] >= fromUs && series.openTimes[i] <= toUs) {
+            out->push_back({series.openTimes[i], series.openValues[i]});
+        }
+    }
+    return static_cast<int>(out->size());
+}
+
+size_t TimeSeriesStore::getMemoryBytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memory_bytes_;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Logging macros
+#define TIMESERIES_TAG "TimeSeries"
+#define TIMESERIES_LOGI(...) __android_log_print(ANDROID_LOG_INFO, TIMESERIES_TAG, __VA_ARGS__)
+#define TIMESERIES_LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TIMESERIES_TAG, __VA_ARGS__)
+
+// Aggregate of the points of one series in [startUs, startUs + width)
+struct RollupBucket {
+    int64_t startUs;
+    float min;
+    float max;
+    double sum;
+    uint32_t count;
+};
+
+// Doubles per bucket in the array filled by nativeQueryTimeSeries; keep in sync with CameraActivity.TIMESERIES_*
+enum TimeSeriesBucketIndex {
+    TIMESERIES_START_US = 0,
+    TIMESERIES_MIN,
+    TIMESERIES_MAX,
+    TIMESERIES_MEAN,
+    TIMESERIES_STRIDE
+};
+
+struct TimeSeriesPoint {
+    int64_t timestampUs;
+    float value;
+};
+
+/**
+ * In-memory store for per-frame measurements over long sessions.
+ *
+ * Each series appends into an open block of kBlockPoints timestamps and values. A full
+ * block is sealed into a compressed column pair: timestamps as zigzag varint
+ * delta-of-deltas (one byte per point at a steady frame rate), values XORed with their
+ * predecessor and bit-packed by leading/trailing zero counts, which leaves a few bits for
+ * slowly changing temperatures. Alongside, every point updates min/max/sum buckets at four
+ * resolutions with bounded retention, so a chart over hours reads a thousand buckets
+ * instead of decoding millions of points.
+ *
+ * When sealed blocks exceed the memory cap, a spill thread writes the oldest of them into
+ * a segment file in the spill directory and maps it read-only; queries read spilled blocks
+ * through the mapping. Once the segments exceed the spill cap the oldest is deleted along with
+ * the blocks it holds; the rest are deleted with the store.
+ */
+class TimeSeriesStore {
+public:
+    static constexpr int kBlockPoints = 1024;
+    static constexpr int kRollupLevels = 4;
+    static constexpr int64_t kRollupWidthUs[kRollupLevels] = {
+        1000000LL, 10000000LL, 60000000LL, 600000000LL      // 1 s, 10 s, 1 min, 10 min
+    };
+    static constexpr size_t kRollupRetention[kRollupLevels] = {
+        3600, 2160, 1440, 1008                              // 1 h, 6 h, 24 h, 7 days
+    };
+
+    TimeSeriesStore() = default;
+    ~TimeSeriesStore();
+
+    // Any thread. Without a spill directory sealed blocks beyond the memory cap are dropped,
+    // oldest first; with one, segment files beyond the spill cap are.
+    void configure(bool enabled, size_t memoryCapBytes, size_t spillCapBytes, const std::string& spillDirectory);
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Id of the named series, created on first use
+    int getSeries(const std::string& name);
+    std::vector<std::string> getSeriesNames();
+
+    // Frame thread; timestamps must not decrease within a series
+    void append(int series, int64_t timestampUs, float value);
+
+    // Buckets covering [fromUs, toUs] from the finest resolution that still holds the range,
+    // with fromUs raised to the oldest retained point, merged further so at most maxPoints are returned. Returns the bucket count, or -1
+    // for an unknown series.
+    int queryRollup(const std::string& name, int64_t fromUs, int64_t toUs, int maxPoints,
+                    std::vector<RollupBucket>* out);
+
+    // Every stored point in [fromUs, toUs]; -1 for an unknown series
+    int queryRaw(const std::string& name, int64_t fromUs, int64_t toUs, std::vector<TimeSeriesPoint>* out);
+
+    // Compressed bytes held in memory, excluding open blocks and rollups
+    size_t getMemoryBytes();
+
+private:
+    TimeSeriesStore(const TimeSeriesStore&) = delete;
+    TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+    struct Block {
+        uint64_t sequence;              // Store-wide seal order, identifies the block while spilling
+        int64_t firstUs;
+        int64_t lastUs;
+        uint32_t count;
+        std::shared_ptr<const std::vector<uint8_t>> bytes;     // Null once spilled; shared with a spill in progress
+        const uint8_t* mapped = nullptr;
+        size_t mappedSize = 0;
+    };
+
+    struct Series {
+        std::string name;
+        int64_t firstUs = 0;            // First point appended
+        std::vector<int64_t> openTimes;
+        std::vector<float> openValues;
+        std::deque<Block> blocks;
+        std::deque<RollupBucket> rollups[kRollupLevels];
+    };
+
+    struct Segment {
+        std::string path;
+        void* map;
+        size_t size;
+    };
+
+    void sealLocked(Series& series);
+    void decodeBlock(const Block& block, int64_t fromUs, int64_t toUs, std::vector<TimeSeriesPoint>* out) const;
+    void enforceCapLocked();
+    void enforceSpillCapLocked();
+    void spillLoop();
+    void spillOnce();
+    void stopSpillThread();
+    void releaseSegments();
+
+    std::atomic<bool> enabled_{false};
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Series>> series_;
+    std::unordered_map<std::string, int> series_ids_;
+    size_t memory_bytes_ = 0;
+    size_t memory_cap_ = 64 * 1024 * 1024;
+    uint64_t next_sequence_ = 0;
+    size_t spill_bytes_ = 0;
+    size_t spill_cap_ = 256 * 1024 * 1024;
+    uint64_t next_segment_ = 0;
+    std::string spill_directory_;
+    std::vector<Segment> segments_;
+
+    std::thread spill_thread_;
+    std::condition_variable spill_cv_;
+    bool spill_requested_ = false;
+    bool spill_stop_ = false;
+};
@@ -0,0 +1,230 @@
+#include "trace_ring.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+static_assert((TraceRing::kRingCapacity & (TraceRing::kRingCapacity - 1)) == 0,
+              "ring capacity must be a power of two");
+
+constexpr int64_t kEscalationIntervalNs = 1000000000;
+
+constexpr const char* kEventNames[kTraceEventCount] = {
+#define TRACE_EVENT_NAME(name, priority, format) #name,
+    TRACE_EVENT_LIST(TRACE_EVENT_NAME)
+#undef TRACE_EVENT_NAME
+};
+
+constexpr int kEventPriorities[kTraceEventCount] = {
+#define TRACE_EVENT_PRIORITY(name, priority, format) priority,
+    TRACE_EVENT_LIST(TRACE_EVENT_PRIORITY)
+#undef TRACE_EVENT_PRIORITY
+};
+
+constexpr const char* kEventFormats[kTraceEventCount] = {
+#define TRACE_EVENT_FORMAT(name, priority, format) format,
+    TRACE_EVENT_LIST(TRACE_EVENT_FORMAT)
+#undef TRACE_EVENT_FORMAT
+};
+
+struct ThreadRing {
+    std::atomic<bool> inUse;
+    std::atomic<uint64_t> head;     // Sequence number of the next record
+    TraceRecord records[TraceRing::kRingCapacity];
+};
+
+ThreadRing g_rings[TraceRing::kMaxRings];
+
+// Escalation state per event
+std::atomic<int64_t> g_last_escalation_ns[kTraceEventCount];
+std::atomic<uint32_t> g_suppressed[kTraceEventCount];
+
+// Holds the calling thread's ring and hands it back when the thread exits
+struct RingLease {
+    ThreadRing* ring = nullptr;
+    int32_t tid = 0;
+    bool exhausted = false;
+
+    ~RingLease() {
+        if (ring) {
+            ring->inUse.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local RingLease t_lease;
+
+int64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+bool claimRing(ThreadRing& ring) {
+    bool expected = false;
+    if (!ring.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return false;
+    }
+    t_lease.ring = &ring;
+    t_lease.tid = static_cast<int32_t>(gettid());
+    t_lease.exhausted = false;
+    return true;
+}
+
+ThreadRing* acquireRing() {
+    if (t_lease.ring || t_lease.exhausted) {
+        return t_lease.ring;
+    }
+    for (int i = 0; i < TraceRing::kMaxRings; i++) {
+        if (i != TraceRing::kFrameThreadRing && claimRing(g_rings[i])) {
+            return t_lease.ring;
+        }
+    }
+    t_lease.exhausted = true;
+    return nullptr;
+}
+
+void formatRecord(char* out, size_t size, const TraceRecord& record) {
+    const int32_t* a = record.args;
+    snprintf(out, size, kEventFormats[record.event], a[0], a[1], a[2], a[3]);
+}
+
+char priorityLetter(int priority) {
+    switch (priority) {
+        case ANDROID_LOG_VERBOSE: return 'V';
+        case ANDROID_LOG_DEBUG: return 'D';
+        case ANDROID_LOG_INFO: return 'I';
+        case ANDROID_LOG_WARN: return 'W';
+        default: return 'E';
+    }
+}
+
+} // namespace
+
+std::atomic<uint64_t> TraceRing::dropped_events_{0};
+
+void TraceRing::bindFrameThread() {
+    // A frame thread that already recorded into a pool ring keeps it; one without a
+    // ring retries the reserved ring each frame until its previous owner has exited
+    if (t_lease.ring) {
+        return;
+    }
+    if (!claimRing(g_rings[kFrameThreadRing])) {
+        // Still leased to the previous frame thread; fall back to the pool
+        acquireRing();
+    }
+}
+
+void TraceRing::write(TraceEvent event, const int32_t* args, int argCount) {
+    ThreadRing* ring = acquireRing();
+    if (!ring) {
+        dropped_events_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Single writer per ring: only this thread advances head
+    const uint64_t sequence = ring->head.load(std::memory_order_relaxed);
+    TraceRecord& record = ring->records[sequence & (kRingCapacity - 1)];
+    record.timestampNs = monotonicNs();
+    record.tid = t_lease.tid;
+    record.event = static_cast<uint16_t>(event);
+    record.argCount = static_cast<uint16_t>(argCount);
+    memcpy(record.args, args, sizeof(record.args));
+    ring->head.store(sequence + 1, std::memory_order_release);
+
+    if (kEventPriorities[static_cast<int>(event)] >= ANDROID_LOG_WARN) {
+        escalate(event, args);
+    }
+}
+
+void TraceRing::escalate(TraceEvent event, const int32_t* args) {
+    const int index = static_cast<int>(event);
+    const int64_t now = monotonicNs();
+
+    int64_t last = g_last_escalation_ns[index].load(std::memory_order_relaxed);
+    if ((last != 0 && now - last < kEscalationIntervalNs) ||
+        !g_last_escalation_ns[index].compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        g_suppressed[index].fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceRecord record = {};
+    record.event = static_cast<uint16_t>(event);
+    memcpy(record.args, args, sizeof(record.args));
+    char message[256];
+    formatRecord(message, sizeof(message), record);
+
+    const uint32_t suppressed = g_suppressed[index].exchange(0, std::memory_order_relaxed);
+    if (suppressed > 0) {
+        __android_log_print(kEventPriorities[index], TRACE_TAG, "%s: %s (%u more in the last second)",
+                            kEventNames[index], message, suppressed);
+    } else {
+        __android_log_print(kEventPriorities[index], TRACE_TAG, "%s: %s", kEventNames[index], message);
+    }
+}
+
+std::string TraceRing::dump(size_t maxEvents) {
+    std::vector<TraceRecord> events;
+    events.reserve(kMaxRings * kRingCapacity);
+
+    for (ThreadRing& ring : g_rings) {
+        const uint64_t head = ring.head.load(std::memory_order_acquire);
+        const uint64_t count = std::min<uint64_t>(head, kRingCapacity);
+        const size_t first = events.size();
+        for (uint64_t sequence = head - count; sequence < head; sequence++) {
+            events.push_back(ring.records[sequence & (kRingCapacity - 1)]);
+        }
+
+        // The writer keeps going while we copy; drop whatever it may have overwritten
+        const uint64_t oldest = head - count;
+        const uint64_t headAfter = ring.head.load(std::memory_order_acquire);
+        const uint64_t validFrom = headAfter > kRingCapacity ? headAfter - kRingCapacity : 0;
+        const uint64_t overwritten = validFrom > oldest ? std::min<uint64_t>(validFrom - oldest, count) : 0;
+        events.erase(events.begin() + first, events.begin() + first + overwritten);
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const TraceRecord& a, const TraceRecord& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+    const size_t start = events.size() > maxEvents ? events.size() - maxEvents : 0;
+
+    std::string result;
+    char line[320];
+    char message[256];
+    snprintf(line, sizeof(line), "Trace dump: %zu of %zu events, %llu dropped\n",
+             events.size() - start, events.size(),
+             static_cast<unsigned long long>(dropped_events_.load(std::memory_order_relaxed)));
+    result += line;
+
+    for (size_t i = start; i < events.size(); i++) {
+        const TraceRecord& record = events[i];
+        if (record.event >= kTraceEventCount) {
+            continue;
+        }
+        formatRecord(message, sizeof(message), record);
+        snprintf(line, sizeof(line), "%14.6f %6d %c %-24s %s\n",
+                 record.timestampNs / 1e9, record.tid, priorityLetter(kEventPriorities[record.event]),
+                 kEventNames[record.event], message);
+        result += line;
+    }
+    return result;
+}
+
+int TraceRing::dumpToFile(const char* path, size_t maxEvents) {
+    const std::string text = dump(maxEvents);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        TRACE_LOGE("Cannot write trace dump to %s", path);
+        return -1;
+    }
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+
+    const int lines = static_cast<int>(std::count(text.begin(), text.end(), '\n')) - 1;
+    TRACE_LOGI("Wrote %d trace events to %s", lines, path);
+    return lines;
+}
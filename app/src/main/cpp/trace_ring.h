@@ -0,0 +1,114 @@
+#pragma once
+
+#include <android/log.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Logging macros
+#define TRACE_TAG "Trace"
+#define TRACE_LOGI(...) __android_log_print(ANDROID_LOG_INFO, TRACE_TAG, __VA_ARGS__)
+#define TRACE_LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TRACE_TAG, __VA_ARGS__)
+
+// X(name, logcat priority, format). Arguments are int32, so formats use %d/%u/%x only.
+// Events at ANDROID_LOG_WARN or above are also escalated to logcat, at most once per
+// second per event; the others are only visible in a dump.
+#define TRACE_EVENT_LIST(X) \
+    X(FRAME_RECEIVED,           ANDROID_LOG_VERBOSE, "frame %d: format %d, %dx%d") \
+    X(FRAME_NO_TARGET,          ANDROID_LOG_WARN,    "frame dropped: streaming %d, window %d, frame %d") \
+    X(FRAME_UNSUPPORTED_FORMAT, ANDROID_LOG_ERROR,   "unsupported frame format %d") \
+    X(FRAME_INVALID_SIZE,       ANDROID_LOG_ERROR,   "invalid frame %dx%d, %d bytes") \
+    X(FRAME_SHORT,              ANDROID_LOG_WARN,    "short frame: %d bytes, expected %d for %dx%d") \
+    X(FRAME_TOO_SHORT,          ANDROID_LOG_ERROR,   "frame skipped, %d bytes is too short even for one channel of %dx%d") \
+    X(FRAME_MJPEG_PLACEHOLDER,  ANDROID_LOG_WARN,    "MJPEG decoding not implemented, gray placeholder shown") \
+    X(FRAME_CONVERSION_FAILED,  ANDROID_LOG_ERROR,   "conversion of format %d failed: %d") \
+    X(FRAME_ABGR_FAILED,        ANDROID_LOG_ERROR,   "ARGBToABGR failed: %d") \
+    X(FRAME_ORIENT_FAILED,      ANDROID_LOG_ERROR,   "orientation %d, mirror %d failed: %d") \
+    X(FRAME_RADIOMETRIC_SHORT,  ANDROID_LOG_ERROR,   "radiometric frame dropped: %d bytes for %dx%d in layout %d") \
+    X(WINDOW_GEOMETRY_FAILED,   ANDROID_LOG_ERROR,   "ANativeWindow_setBuffersGeometry failed: %d") \
+    X(WINDOW_LOCK_FAILED,       ANDROID_LOG_ERROR,   "ANativeWindow_lock failed: %d") \
+    X(WINDOW_BUFFER_TOO_SMALL,  ANDROID_LOG_ERROR,   "window buffer %dx%d smaller than frame %dx%d") \
+    X(WINDOW_STRIDE_TOO_SMALL,  ANDROID_LOG_ERROR,   "window stride %d bytes, frame needs %d") \
+    X(WINDOW_POST_FAILED,       ANDROID_LOG_ERROR,   "ANativeWindow_unlockAndPost failed: %d") \
+    X(STREAM_STARTED,           ANDROID_LOG_INFO,    "stream started %dx%d @ %d fps, cached control %d") \
+    X(STREAM_STOPPED,           ANDROID_LOG_INFO,    "stream stopped") \
+    X(FPS_SWITCH,               ANDROID_LOG_INFO,    "frame rate switch to %d fps, mode %d, call took %d us") \
+    X(FPS_SWITCH_FIRST_FRAME,   ANDROID_LOG_INFO,    "first frame after frame rate switch: %d us, %d frames lost") \
+    X(ALARM_TRANSITION,         ANDROID_LOG_INFO,    "alarm rule %d: triggered %d, value %d (x1000), actions %x") \
+    X(CAPTURE_UNSUPPORTED_SIZE, ANDROID_LOG_WARN,    "capture request dropped, raw capture needs 256x192, frame is %dx%d") \
+    X(BLOB_RUNS_OVERFLOW,       ANDROID_LOG_WARN,    "more than %d hot runs, frame labeled partially") \
+    X(REGISTRY_SET,             ANDROID_LOG_VERBOSE, "registry SET %d = %d") \
+    X(REGISTRY_SET2,            ANDROID_LOG_VERBOSE, "registry SET2 %d = %d, %d") \
+    X(REGISTRY_GET,             ANDROID_LOG_VERBOSE, "registry GET %d -> %d") \
+    X(REGISTRY_ACTION,          ANDROID_LOG_VERBOSE, "registry ACTION %d") \
+    X(REGISTRY_ATTRIBUTE,       ANDROID_LOG_VERBOSE, "registry ATTRIBUTE %d -> [%u, %u], step %u") \
+    X(REGISTRY_SET_FAILED,      ANDROID_LOG_WARN,    "registry SET %d failed with SDK error %d") \
+    X(REGISTRY_SET2_FAILED,     ANDROID_LOG_WARN,    "registry SET2 %d failed with SDK error %d") \
+    X(REGISTRY_GET_FAILED,      ANDROID_LOG_WARN,    "registry GET %d failed with SDK error %d") \
+    X(REGISTRY_ACTION_FAILED,   ANDROID_LOG_WARN,    "registry ACTION %d failed with SDK error %d") \
+    X(REGISTRY_ATTRIBUTE_FAILED, ANDROID_LOG_WARN,   "registry ATTRIBUTE %d failed with SDK error %d")
+
+enum class TraceEvent : uint16_t {
+#define TRACE_EVENT_ENUM(name, priority, format) name,
+    TRACE_EVENT_LIST(TRACE_EVENT_ENUM)
+#undef TRACE_EVENT_ENUM
+    COUNT
+};
+
+constexpr int kTraceEventCount = static_cast<int>(TraceEvent::COUNT);
+constexpr int kTraceMaxArgs = 4;
+
+// Fixed-size binary record; formatting happens only when the ring is dumped
+struct TraceRecord {
+    int64_t timestampNs;            // CLOCK_MONOTONIC
+    int32_t tid;
+    uint16_t event;
+    uint16_t argCount;
+    int32_t args[kTraceMaxArgs];
+};
+
+/**
+ * Per-thread binary event rings for the hot paths (frame callback, registry commands).
+ *
+ * Each thread that records gets its own single-writer ring on first use, so recording
+ * is a timestamp, a 32-byte store and a release increment: no lock, no formatting, no
+ * syscall. dump() merges all rings by timestamp and decodes them with the format table.
+ *
+ * Rings are static and reused after their thread exits; a dump still shows what the
+ * exited thread recorded until the ring is overwritten. Ring 0 is held back for the
+ * libuvc frame thread, so short-lived workers cannot crowd out the hottest writer.
+ */
+class TraceRing {
+public:
+    static constexpr int kRingCapacity = 4096;     // Events per thread, power of two
+    static constexpr int kMaxRings = 8;
+    static constexpr int kFrameThreadRing = 0;     // Only claimed through bindFrameThread()
+
+    template <typename... Args>
+    static void record(TraceEvent event, Args... args) {
+        static_assert(sizeof...(Args) <= kTraceMaxArgs, "trace events take at most 4 arguments");
+        const int32_t values[kTraceMaxArgs] = {static_cast<int32_t>(args)...};
+        write(event, values, static_cast<int>(sizeof...(Args)));
+    }
+
+    // Called at the top of the frame callback; gives the calling thread the reserved ring
+    static void bindFrameThread();
+
+    // Decode the last maxEvents events of all threads, oldest first
+    static std::string dump(size_t maxEvents);
+
+    // Same as dump(), written to a file; returns the number of events or -1
+    static int dumpToFile(const char* path, size_t maxEvents);
+
+    // Events that could not be recorded because every ring was taken
+    static uint64_t getDroppedEvents() { return dropped_events_.load(std::memory_order_relaxed); }
+
+private:
+    static void write(TraceEvent event, const int32_t* args, int argCount);
+    static void escalate(TraceEvent event, const int32_t* args);
+
+    static std::atomic<uint64_t> dropped_events_;
+};
+
+#define TRACE(event, ...) TraceRing::record(TraceEvent::event, ##__VA_ARGS__)
@@ -1,10 +1,14 @@
 #include "uvc_manager.h"
+#include "startup_profiler.h"
+#include "trace_ring.h"
 #include <jni.h>
 #include <android/native_window.h>
 #include <android/native_window_jni.h>
 #include <android/log.h>
 #include <libusb.h>
 #include <libyuv.h>
+#include <algorithm>
+#include <cmath>
 #include <cstring>   // For memcpy
 #include <chrono>    // For video recording timestamps
 
@@ -13,6 +17,21 @@ inline int clamp(int value, int min, int max) {
     return value < min ? min : (value > max ? max : value);
 }
 
+static int64_t steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* formatName(uvc_frame_format format) {
+    switch (format) {
+        case UVC_FRAME_FORMAT_YUYV: return "YUYV";
+        case UVC_FRAME_FORMAT_UYVY: return "UYVY";
+        case UVC_FRAME_FORMAT_MJPEG: return "MJPEG";
+        case UVC_FRAME_FORMAT_UNCOMPRESSED: return "UNCOMPRESSED";
+        default: return "UNKNOWN";
+    }
+}
+
 extern "C" uvc_error_t uvc_wrap(int sys_dev, uvc_context_t *context, uvc_device_handle_t **devh);
 
 // Global camera instance
@@ -73,7 +92,22 @@ UVCCamera::UVCCamera()
       capture_next_frame_(false), has_captured_frame_(false),
       captured_frame_width_(0), captured_frame_height_(0),
       video_recording_enabled_(false), video_encoder_callback_(nullptr), 
-      video_callback_user_ptr_(nullptr), video_recording_start_time_(0) {
+      video_callback_user_ptr_(nullptr), video_recording_start_time_(0),
+      snapshot_(nullptr), warm_start_(false), init_start_us_(0), stream_start_us_(0),
+      time_to_first_frame_us_(-1), first_frame_seen_(false),
+      first_frame_width_(0), first_frame_height_(0),
+      keep_snapshot_validation_running_(false), vendor_id_(0), product_id_(0),
+      stream_timings_{-1, false, -1, false, FrameRateSwitchMode::NONE, -1, 0},
+      keep_pre_negotiation_running_(false),
+      device_frame_rate_callback_(nullptr), device_frame_rate_user_ptr_(nullptr),
+      stream_width_(0), stream_height_(0), output_fps_(0), device_output_fps_(0),
+      decimation_fps_(0), decimation_link_fps_(0), decimation_reset_(false), decimation_credit_(0),
+      last_frame_us_(0), switch_pending_(false), switch_request_us_(0), switch_last_frame_us_(0),
+      switch_interval_us_(0), switch_latency_us_(-1), switch_lost_frames_(0),
+      frames_received_(0), frames_decimated_(0), frames_rendered_(0), frames_encoded_(0),
+      stream_layout_(StreamLayout::IMAGE), temperature_width_(0), temperature_height_(0),
+      thermal_frame_callback_(nullptr), thermal_frame_user_ptr_(nullptr) {
+    alarm_engine_.setCallback(&UVCCamera::alarmCallback, this);
 }
 
 UVCCamera::~UVCCamera() {
@@ -88,6 +122,13 @@ bool UVCCamera::init(int fileDescriptor) {
         return true;
     }
 
+    // Start of the plug-to-first-frame measurement
+    init_start_us_ = steadyMicros();
+    time_to_first_frame_us_.store(-1);
+    if (snapshot_) {
+        snapshot_->close();
+    }
+
     LOGI("Setting libusb global option NO_DEVICE_DISCOVERY");
     // Set option globally before initializing any specific context, as per the guide
     int res_option = libusb_set_option(NULL, LIBUSB_OPTION_NO_DEVICE_DISCOVERY, NULL);
@@ -96,6 +137,9 @@ bool UVCCamera::init(int fileDescriptor) {
         LOGW("Failed to set libusb global option NO_DEVICE_DISCOVERY: %s. Continuing...", libusb_error_name(res_option));
     }
 
+    StartupProfiler& profiler = StartupProfiler::getInstance();
+    int64_t phase_start = StartupProfiler::nowUs();
+
     LOGI("Initializing libusb context");
     int res_libusb = libusb_init(&usb_ctx_);
     if (res_libusb != LIBUSB_SUCCESS) {
@@ -118,6 +162,8 @@ bool UVCCamera::init(int fileDescriptor) {
 
     // Note: Do not call libusb_set_option(usb_ctx_, ...) for NO_DEVICE_DISCOVERY here again,
     // as it was set globally above.
+    profiler.record("uvc: libusb init + event thread", phase_start, StartupProfiler::nowUs());
+    phase_start = StartupProfiler::nowUs();
 
     LOGI("Initializing UVC context with provided libusb context");
     uvc_error_t res_uvc = uvc_init(&ctx_, usb_ctx_);
@@ -142,6 +188,8 @@ bool UVCCamera::init(int fileDescriptor) {
         return false;
     }
     LOGI("Device wrapped successfully");
+    profiler.record("uvc: context init + wrap fd", phase_start, StartupProfiler::nowUs());
+    phase_start = StartupProfiler::nowUs();
 
     // Get the device from the handle
     dev_ = uvc_get_device(devh_);
@@ -167,14 +215,21 @@ bool UVCCamera::init(int fileDescriptor) {
         LOGI("  Vendor ID: 0x%04x", dev_desc->idVendor);
         LOGI("  Product ID: 0x%04x", dev_desc->idProduct);
         LOGI("  UVC Version: %d.%d", (dev_desc->bcdUVC >> 8) & 0xFF, dev_desc->bcdUVC & 0xFF);
+
+        // Negotiation cache entries are per camera model
+        vendor_id_ = dev_desc->idVendor;
+        product_id_ = dev_desc->idProduct;
+
+        // Look up the warm-start snapshot for this exact device
+        if (snapshot_) {
+            snapshot_->load(dev_desc->idVendor, dev_desc->idProduct, dev_desc->serialNumber);
+        }
         uvc_free_device_descriptor(dev_desc);
     }
 
-    // After successful device initialization, enumerate interfaces and formats
-    LOGI("Enumerating device interfaces and formats:");
-    printDeviceInfo();
-    enumerateInterfaces();
-    enumerateFormats();
+    profiler.record("uvc: device descriptor + snapshot", phase_start, StartupProfiler::nowUs());
+
+    // The interface/format dump is no longer part of startup, see dumpDiagnostics()
 
     LOGI("UVC device initialized and configured successfully via FD wrapping");
     return true;
@@ -208,6 +263,7 @@ void UVCCamera::closeDevice() {
 
 bool UVCCamera::startStream(int width, int height, int fps, ANativeWindow* window) {
     std::lock_guard<std::mutex> lock(mutex_);
+    height = frameHeightFor(height);
     
     if (is_streaming_) {
         LOGI("Camera already streaming");
@@ -222,47 +278,77 @@ bool UVCCamera::startStream(int width, int height, int fps, ANativeWindow* windo
     LOGI("startStream: ANativeWindow pointer: %p", window);
     window_ = window; // Assign early to check in callback even if uvc_start_streaming fails
 
-    LOGI("Attempting to get stream control for %dx%d @ %dfps, format YUYV", width, height, fps);
-    
-    // Try different formats in order of preference
-    uvc_frame_format formats[] = {
-        UVC_FRAME_FORMAT_YUYV,
-        UVC_FRAME_FORMAT_UYVY,
-        UVC_FRAME_FORMAT_MJPEG,
-        UVC_FRAME_FORMAT_UNCOMPRESSED
-    };
-    
-    const char* format_names[] = {"YUYV", "UYVY", "MJPEG", "UNCOMPRESSED"};
-    
-    uvc_error_t res = UVC_ERROR_NOT_FOUND;
-    uvc_frame_format successful_format = UVC_FRAME_FORMAT_UNKNOWN;
-    
-    for (int i = 0; i < 4; i++) {
-        LOGI("Trying format %s (%d)...", format_names[i], formats[i]);
-        res = uvc_get_stream_ctrl_format_size(
-            devh_, &ctrl_,
-            formats[i],
-            width, height, fps
-        );
-        
-        if (res == UVC_SUCCESS) {
-            successful_format = formats[i];
-            LOGI("✅ Successfully negotiated format %s", format_names[i]);
-            break;
-        } else {
-            LOGI("❌ Format %s failed: %s", format_names[i], uvc_strerror(res));
+    stream_start_us_ = steadyMicros();
+    first_frame_seen_.store(false);
+    warm_start_ = false;
+
+    // A new stream runs at the rate it was negotiated for
+    stream_width_ = width;
+    stream_height_ = height;
+    output_fps_ = 0;
+    device_output_fps_ = 0;
+    decimation_fps_.store(0);
+    switch_pending_.store(false);
+
+    NegotiationCache& cache = NegotiationCache::getInstance();
+    const NegotiationKey key = negotiationKey(width, height, fps);
+
+    // Warm start: commit a control negotiated earlier in this process, or the one the
+    // snapshot stored for this request, and skip negotiation
+    NegotiationEntry cached;
+    bool have_cached = cache.lookup(key, &cached);
+    bool from_snapshot = false;
+    if (!have_cached && snapshot_ && snapshot_->findStreamControl(width, height, fps, &cached.ctrl)) {
+        cached.format = UVC_FRAME_FORMAT_UNKNOWN;
+        have_cached = true;
+        from_snapshot = true;
+    }
+
+    if (have_cached) {
+        LOGI("⚡ Warm start: using %s stream control (format %u, frame %u, interval %u)",
+             from_snapshot ? "stored" : "cached",
+             cached.ctrl.bFormatIndex, cached.ctrl.bFrameIndex, cached.ctrl.dwFrameInterval);
+        ctrl_ = cached.ctrl;
+        ScopedStartupPhase phase("uvc: start streaming (warm)");
+        uvc_error_t warm_res = uvc_start_streaming(devh_, &ctrl_, frameCallback, this, 0);
+        if (warm_res == UVC_SUCCESS) {
+            is_streaming_ = true;
+            warm_start_ = true;
+            if (from_snapshot) {
+                cache.store(key, cached.format, ctrl_);
+                keep_snapshot_validation_running_.store(true);
+                snapshot_validation_thread_ = std::thread(&UVCCamera::snapshotValidationLoop, this, width, height);
+            } else if (snapshot_) {
+                snapshot_->saveStream(uvc_get_format_descs(devh_), ctrl_, width, height, fps);
+            }
+            stream_timings_.startUs = steadyMicros() - stream_start_us_;
+            stream_timings_.startCached = true;
+            TRACE(STREAM_STARTED, width, height, fps, 1);
+            LOGI("Camera streaming started from %s control in %.1f ms.",
+                 from_snapshot ? "snapshot" : "cached", stream_timings_.startUs / 1000.0);
+            return true;
+        }
+        LOGW("Warm start failed: %s, falling back to format negotiation", uvc_strerror(warm_res));
+        cache.invalidate(key, "stream control rejected by device");
+        if (from_snapshot) {
+            snapshot_->invalidate("stored stream control rejected by device");
         }
     }
 
+    LOGI("Attempting to get stream control for %dx%d @ %dfps", width, height, fps);
+
+    uvc_frame_format successful_format = UVC_FRAME_FORMAT_UNKNOWN;
+    int64_t phase_start = StartupProfiler::nowUs();
+    uvc_error_t res = negotiateLocked(width, height, fps, &ctrl_, &successful_format);
+    StartupProfiler::getInstance().record("uvc: format negotiation", phase_start, StartupProfiler::nowUs());
+
     if (res != UVC_SUCCESS) {
         LOGE("Failed to get stream control: %s (%d). Check if format/resolution/fps is supported.", uvc_strerror(res), res);
         window_ = nullptr; // Clear window if control negotiation failed
         return false;
     }
     LOGI("Stream control obtained successfully. Negotiated parameters:");
-    LOGI("  Format: %s (%d)", format_names[successful_format == UVC_FRAME_FORMAT_YUYV ? 0 : 
-                                       successful_format == UVC_FRAME_FORMAT_UYVY ? 1 :
-                                       successful_format == UVC_FRAME_FORMAT_MJPEG ? 2 : 3], successful_format);
+    LOGI("  Format: %s (%d)", formatName(successful_format), successful_format);
     LOGI("  bmHint: %u", ctrl_.bmHint);
     LOGI("  bFormatIndex: %u", ctrl_.bFormatIndex);
     LOGI("  bFrameIndex: %u", ctrl_.bFrameIndex);
@@ -279,21 +365,34 @@ bool UVCCamera::startStream(int width, int height, int fps, ANativeWindow* windo
 
     // Start streaming
     LOGI("Starting UVC streaming with window %p...", window_);
+    phase_start = StartupProfiler::nowUs();
     res = uvc_start_streaming(devh_, &ctrl_, frameCallback, this, 0);
+    StartupProfiler::getInstance().record("uvc: start streaming", phase_start, StartupProfiler::nowUs());
     if (res != UVC_SUCCESS) {
         LOGE("Failed to start streaming: %s (%d)", uvc_strerror(res), res);
+        cache.invalidate(key, "stream control rejected by device");
         window_ = nullptr; // Clear window if streaming failed
         return false;
     }
 
     is_streaming_ = true;
-    LOGI("Camera streaming started successfully.");
+    stream_timings_.startUs = steadyMicros() - stream_start_us_;
+    stream_timings_.startCached = false;
+    TRACE(STREAM_STARTED, width, height, fps, 0);
+    LOGI("Camera streaming started successfully in %.1f ms.", stream_timings_.startUs / 1000.0);
+
+    // Remember what worked so the next connect can skip negotiation
+    if (snapshot_) {
+        snapshot_->saveStream(uvc_get_format_descs(devh_), ctrl_, width, height, fps);
+    }
     return true;
 }
 
 void UVCCamera::stopStream() {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+
+    stopSnapshotValidation();
+
     if (!is_streaming_) {
         LOGI("Stream not active, no need to stop.");
         return;
@@ -312,13 +411,19 @@ void UVCCamera::stopStream() {
 
     is_streaming_ = false;
     window_ = nullptr; // Release native window reference from our side
+    TRACE(STREAM_STOPPED);
     LOGI("Camera streaming stopped logic completed in UVCCamera::stopStream.");
 }
 
 void UVCCamera::cleanup() {
+    // Joined before taking mutex_, the pre-negotiation thread locks it per probe
+    stopPreNegotiation();
+
     std::lock_guard<std::mutex> lock(mutex_);
     LOGI("UVCCamera::cleanup called");
 
+    stopSnapshotValidation();
+
     if (is_streaming_) {
         // Attempt to stop stream if still running
         LOGI("Stream was active, calling internal stopStream measures.");
@@ -384,51 +489,68 @@ void UVCCamera::cleanup() {
     LOGI("UVCCamera::cleanup finished");
 }
 
+// Runs on the frame thread from alarm_engine_.evaluate()
+void UVCCamera::alarmCallback(const AlarmEvent& event, void* ptr) {
+    UVCCamera* camera = static_cast<UVCCamera*>(ptr);
+    TRACE(ALARM_TRANSITION, event.ruleId, event.triggered, static_cast<int32_t>(std::lround(event.value * 1000.0f)),
+          event.actions);
+    if (event.triggered && (event.actions & ALARM_ACTION_SNAPSHOT)) {
+        camera->capture_next_frame_.store(true);
+    }
+}
+
 // Frame callback needs to be a static member or a free function
 void UVCCamera::frameCallback(uvc_frame_t* frame, void* ptr) {
     UVCCamera* camera = static_cast<UVCCamera*>(ptr);
+    TraceRing::bindFrameThread();
+
+    if (!camera) {
+        LOGE("frameCallback: camera pointer is null!");
+        return;
+    }
+    if (!camera->is_streaming_ || !camera->window_ || !frame) {
+        TRACE(FRAME_NO_TARGET, camera->is_streaming_, camera->window_ != nullptr, frame != nullptr);
+        return;
+    }
+
+
+    if (!camera->first_frame_seen_.load(std::memory_order_relaxed)) {
+        camera->recordFirstFrame(frame);
+    }
+    camera->frames_received_.fetch_add(1, std::memory_order_relaxed);
 
-    if (!camera || !camera->is_streaming_ || !camera->window_ || !frame) {
-        if (!camera) LOGE("frameCallback: camera pointer is null!");
-        else if (!camera->is_streaming_) LOGE("frameCallback: Not streaming");
-        else if (!camera->window_) LOGE("frameCallback: window is null");
-        else if (!frame) LOGE("frameCallback: frame is null");
+    // Host-side decimation after a live switch to a lower frame rate
+    if (!camera->shouldDeliverFrame()) {
+        camera->frames_decimated_.fetch_add(1, std::memory_order_relaxed);
         return;
     }
 
+    const int64_t frame_us = steadyMicros();
+    if (camera->switch_pending_.load(std::memory_order_acquire)) {
+        camera->recordSwitchFrame(frame_us);
+    }
+    camera->last_frame_us_.store(frame_us, std::memory_order_relaxed);
 
     // Verify frame format - support multiple formats
-    const char* format_name = "UNKNOWN";
     switch (frame->frame_format) {
         case UVC_FRAME_FORMAT_YUYV:
-            format_name = "YUYV";
-            break;
         case UVC_FRAME_FORMAT_UYVY:
-            format_name = "UYVY";
-            break;
         case UVC_FRAME_FORMAT_MJPEG:
-            format_name = "MJPEG";
-            break;
         case UVC_FRAME_FORMAT_UNCOMPRESSED:
-            format_name = "UNCOMPRESSED";
             break;
         default:
-            LOGE("frameCallback: Unsupported frame format: %d", frame->frame_format);
+            TRACE(FRAME_UNSUPPORTED_FORMAT, frame->frame_format);
             return;
     }
     
-    // Log frame processing info periodically (every 100 frames) to avoid spam
+    // Every frame goes into the trace ring; logcat only sees failures, rate-limited
     static int frame_count = 0;
     frame_count++;
-    if (frame_count % 100 == 0) {
-        LOGI("frameCallback: Processed %d %s frames %dx%d, %zu bytes", 
-             frame_count, format_name, frame->width, frame->height, frame->data_bytes);
-    }
+    TRACE(FRAME_RECEIVED, frame_count, frame->frame_format, frame->width, frame->height);
 
     // Verify frame dimensions
     if (frame->width <= 0 || frame->height <= 0 || frame->data_bytes <= 0) {
-        LOGE("frameCallback: Invalid frame dimensions: %dx%d, data_size=%zu",
-             frame->width, frame->height, frame->data_bytes);
+        TRACE(FRAME_INVALID_SIZE, frame->width, frame->height, frame->data_bytes);
         return;
     }
 
@@ -452,22 +574,100 @@ void UVCCamera::frameCallback(uvc_frame_t* frame, void* ptr) {
             break;
     }
     
-    if (frame->data_bytes < expected_size) {
-        LOGE("frameCallback: Frame data size mismatch: received %zu bytes, expected %zu bytes for %dx%d %s",
-             frame->data_bytes, expected_size, frame->width, frame->height, format_name);
-        LOGE("  Frame details: format=%d, step=%zu", frame->frame_format, frame->step);
-        
-        // For MJPEG, size variation is normal
-        if (frame->frame_format == UVC_FRAME_FORMAT_MJPEG) {
-            LOGW("  MJPEG frame size variation is normal, proceeding...");
-        } else {
-            // Try to work with what we have if it's at least the minimum viable size
-            if (frame->data_bytes < (frame->width * frame->height)) {
-                LOGE("  Data too small even for single channel, skipping frame");
-                return;
-            } else {
-                LOGW("  Attempting to process frame with smaller than expected data size");
-            }
+    // For MJPEG, size variation is normal
+    if (frame->data_bytes < expected_size && frame->frame_format != UVC_FRAME_FORMAT_MJPEG) {
+        // Try to work with what we have if it's at least the minimum viable size
+        if (frame->data_bytes < (frame->width * frame->height)) {
+            TRACE(FRAME_TOO_SHORT, frame->data_bytes, frame->width, frame->height);
+            return;
+        }
+        TRACE(FRAME_SHORT, frame->data_bytes, expected_size, frame->width, frame->height);
+    }
+
+    // Info line rows below the planes are decoded here; nothing after this sees them
+    const int info_rows = camera->info_line_.getRows();
+    uvc_frame_t planes_view;
+    if (info_rows > 0 && static_cast<int>(frame->height) > info_rows) {
+        const size_t row_bytes = frame->step ? frame->step : static_cast<size_t>(frame->width) * 2;
+        const size_t planes_bytes = row_bytes * (frame->height - info_rows);
+        if (frame->data_bytes >= planes_bytes + row_bytes * info_rows) {
+            camera->info_line_.parse(static_cast<const uint8_t*>(frame->data) + planes_bytes,
+                                     row_bytes * info_rows, frame_us);
+            planes_view = *frame;
+            planes_view.height = frame->height - info_rows;
+            planes_view.data_bytes = planes_bytes;
+            frame = &planes_view;
+        }
+    }
+
+    // Defective pixels are replaced in the frame buffer itself, which this callback owns
+    const StreamLayout layout = camera->stream_layout_.load(std::memory_order_relaxed);
+    if (camera->bad_pixels_ && camera->bad_pixels_->isActive() &&
+        (layout != StreamLayout::IMAGE || frame->frame_format == UVC_FRAME_FORMAT_YUYV)) {
+        FramePlanes planes;
+        if (splitFramePlanes(static_cast<const uint8_t*>(frame->data), frame->data_bytes,
+                             frame->width, frame->height, layout, &planes)) {
+            camera->bad_pixels_->process(const_cast<uint8_t*>(planes.image), const_cast<uint16_t*>(planes.raw),
+                                         planes.width, planes.height);
+        }
+    }
+
+    // Radiometric layouts: the temperature plane is split off and published here, and the
+    // rest of the pipeline works on the image plane
+    uvc_frame_t image_view;
+    ThermalFrame thermal = {nullptr, nullptr, nullptr, static_cast<int>(frame->width), static_cast<int>(frame->height), frame_us};
+    const bool agc_enabled = camera->agc_.isEnabled();
+    if (layout != StreamLayout::IMAGE) {
+        if (!camera->splitRadiometricFrame(frame, frame_us, !agc_enabled, &image_view, &thermal)) {
+            return;
+        }
+        frame = &image_view;
+    } else if (frame->frame_format == UVC_FRAME_FORMAT_YUYV) {
+        thermal.image = static_cast<const uint8_t*>(frame->data);
+    }
+    if (agc_enabled && camera->applyAgc(frame, &image_view, &thermal)) {
+        frame = &image_view;
+    }
+
+    camera->frame_stats_.update(thermal, camera->temperature_lut_);
+    camera->roi_engine_.process(thermal);
+    camera->blob_tracker_.process(thermal);
+    if (thermal.image && camera->motion_detector_.isEnabled()) {
+        camera->motion_detector_.process(thermal.image, thermal.width, thermal.height, frame_us);
+    }
+    camera->alarm_engine_.evaluate(camera->frame_stats_, camera->roi_engine_, camera->blob_tracker_);
+    camera->ffc_scheduler_.onFrame(camera->frame_stats_, camera->info_line_, camera->video_recording_enabled_.load());
+    if (camera->time_series_.isEnabled()) {
+        camera->measurement_recorder_.record(camera->time_series_, camera->frame_stats_, camera->roi_engine_, camera->info_line_);
+    }
+    if (camera->thermal_frame_callback_) {
+        camera->thermal_frame_callback_(thermal, camera->thermal_frame_user_ptr_);
+    }
+
+    // Temporal denoise for the consumers that asked for it; the others get the source frame.
+    // The filtered view has the same size and format, only its data differs.
+    const uvc_frame_t* capture_frame = frame;
+    const uvc_frame_t* recording_frame = frame;
+    const uvc_frame_t* display_frame = frame;
+    uvc_frame_t denoised_view;
+    const int denoise_consumers = camera->denoiser_.getConsumers();
+    if (denoise_consumers && frame->frame_format == UVC_FRAME_FORMAT_YUYV &&
+        ((denoise_consumers & ~DENOISE_RECORDING) || camera->video_recording_enabled_.load() ||
+         camera->pre_roll_.isEnabled())) {
+        const size_t src_stride = frame->step ? frame->step : static_cast<size_t>(frame->width) * 2;
+        denoised_view = *frame;
+        denoised_view.data = const_cast<uint8_t*>(
+            camera->denoiser_.process(static_cast<const uint8_t*>(frame->data), src_stride, frame->width, frame->height));
+        denoised_view.step = frame->width * 2;
+        denoised_view.data_bytes = static_cast<size_t>(frame->width) * frame->height * 2;
+        if (denoise_consumers & DENOISE_CAPTURE) {
+            capture_frame = &denoised_view;
+        }
+        if (denoise_consumers & DENOISE_RECORDING) {
+            recording_frame = &denoised_view;
+        }
+        if (denoise_consumers & DENOISE_DISPLAY) {
+            display_frame = &denoised_view;
         }
     }
 
@@ -478,7 +678,7 @@ void UVCCamera::frameCallback(uvc_frame_t* frame, void* ptr) {
         // Use actual frame size instead of calculated size for capture
         size_t capture_size = std::min(frame->data_bytes, static_cast<size_t>(frame->width * frame->height * 2));
         camera->captured_frame_data_.resize(capture_size);
-        std::memcpy(camera->captured_frame_data_.data(), frame->data, capture_size);
+        std::memcpy(camera->captured_frame_data_.data(), capture_frame->data, capture_size);
         
         camera->captured_frame_width_ = frame->width;
         camera->captured_frame_height_ = frame->height;
@@ -487,154 +687,136 @@ void UVCCamera::frameCallback(uvc_frame_t* frame, void* ptr) {
         
         LOGI("🎯 Captured raw thermal frame: %dx%d, %zu bytes (actual: %zu)", 
              frame->width, frame->height, capture_size, frame->data_bytes);
+    } else if (camera->capture_next_frame_.load(std::memory_order_relaxed)) {
+        // Other modes never satisfy the check above; drop the request instead of leaving it pending
+        camera->capture_next_frame_.store(false);
+        TRACE(CAPTURE_UNSUPPORTED_SIZE, frame->width, frame->height);
     }
 
     // 🎥 DIRECT VIDEO RECORDING
     if (camera->video_recording_enabled_.load() && camera->video_encoder_callback_ != nullptr) {
         if (frame->frame_format == UVC_FRAME_FORMAT_YUYV) {
-            // Calculate YUV420 buffer size (1.5 bytes per pixel)
-            const int yuv420_size = frame->width * frame->height * 3 / 2;
-            
-            // Allocate temporary buffer for YUV420 conversion
-            uint8_t* yuv420_buffer = new uint8_t[yuv420_size];
-            
-            // Convert YUYV to YUV420 directly
-            camera->convertYUYVToYUV420(
-                static_cast<const uint8_t*>(frame->data),
-                yuv420_buffer,
-                frame->width,
-                frame->height
-            );
-            
-            // Calculate timestamp relative to recording start
-            auto now = std::chrono::duration_cast<std::chrono::microseconds>(
-                std::chrono::steady_clock::now().time_since_epoch()
-            ).count();
-            
-            // Initialize recording start time on first frame
-            if (camera->video_recording_start_time_ == 0) {
-                camera->video_recording_start_time_ = now;
+            const uint8_t* yuyv = static_cast<const uint8_t*>(recording_frame->data);
+            if (camera->pre_roll_.empty()) {
+                camera->encodeRecordingFrame(yuyv, frame->width, frame->height, frame_us);
+            } else {
+                // Pre-roll goes first and this frame queues behind it. Only as many frames are
+                // handed over as the encoder queue has free slots, so none displaces another;
+                // the rest wait here, bounded by PreRollBuffer::kMaxBytes
+                camera->pre_roll_.push(yuyv, frame->width, frame->height, frame_us, false);
+                const int room = camera->video_encoder_room_callback_
+                    ? camera->video_encoder_room_callback_(camera->video_callback_user_ptr_) : 1;
+                for (int i = 0; i < room && !camera->pre_roll_.empty(); i++) {
+                    const PreRollFrame& queued = camera->pre_roll_.front();
+                    camera->encodeRecordingFrame(queued.yuyv.data(), queued.width, queued.height, queued.captureUs);
+                    camera->pre_roll_.pop();
+                }
             }
-            
-            int64_t timestampUs = now - camera->video_recording_start_time_;
-            
-            // Call the video encoder callback with converted YUV420 data
-            camera->video_encoder_callback_(
-                yuv420_buffer,
-                frame->width,
-                frame->height,
-                timestampUs,
-                camera->video_callback_user_ptr_
-            );
-            
-            // Clean up temporary buffer
-            delete[] yuv420_buffer;
         }
+    } else if (camera->pre_roll_.isEnabled()) {
+        if (frame->frame_format == UVC_FRAME_FORMAT_YUYV) {
+            camera->pre_roll_.push(static_cast<const uint8_t*>(recording_frame->data), frame->width, frame->height,
+                                   frame_us, true);
+        }
+    } else if (!camera->pre_roll_.empty()) {
+        camera->pre_roll_.clear();
     }
 
+    // Rotated by a quarter turn, the window buffer is the frame's size transposed
+    int output_width = 0;
+    int output_height = 0;
+    camera->display_renderer_.getOutputSize(display_frame, &output_width, &output_height);
+
     ANativeWindow_Buffer buffer;
     // For little-endian systems (like Android), RGBA_8888 is actually stored as ABGR in memory
-    int set_geom_ret = ANativeWindow_setBuffersGeometry(camera->window_, frame->width, frame->height, WINDOW_FORMAT_RGBA_8888);
+    int set_geom_ret = ANativeWindow_setBuffersGeometry(camera->window_, output_width, output_height, WINDOW_FORMAT_RGBA_8888);
     if (set_geom_ret != 0) {
-        LOGE("frameCallback: Failed to set buffers geometry: %d", set_geom_ret);
+        TRACE(WINDOW_GEOMETRY_FAILED, set_geom_ret);
         return;
     }
 
     int lock_ret = ANativeWindow_lock(camera->window_, &buffer, nullptr);
     if (lock_ret != 0) {
-        LOGE("frameCallback: Failed to lock native window: %d", lock_ret);
+        TRACE(WINDOW_LOCK_FAILED, lock_ret);
         return;
     }
 
 
     // Verify buffer dimensions
-    if (buffer.width < frame->width || buffer.height < frame->height) {
-        LOGE("frameCallback: Buffer too small: %dx%d < %dx%d",
-             buffer.width, buffer.height, frame->width, frame->height);
+    if (buffer.width < output_width || buffer.height < output_height) {
+        TRACE(WINDOW_BUFFER_TOO_SMALL, buffer.width, buffer.height, output_width, output_height);
         ANativeWindow_unlockAndPost(camera->window_);
         return;
     }
 
     // Calculate expected stride for RGBA (4 bytes per pixel)
-    size_t expected_stride = frame->width * 4;
+    size_t expected_stride = output_width * 4;
     if (buffer.stride * 4 < expected_stride) {
-        LOGE("frameCallback: Buffer stride too small: %d < %zu",
-             buffer.stride * 4, expected_stride);
+        TRACE(WINDOW_STRIDE_TOO_SMALL, buffer.stride * 4, expected_stride);
         ANativeWindow_unlockAndPost(camera->window_);
         return;
     }
 
-    // Use appropriate libyuv conversion based on format
-    int result = -1;
-    switch (frame->frame_format) {
-        case UVC_FRAME_FORMAT_YUYV:
-            result = libyuv::YUY2ToARGB(
-                static_cast<const uint8_t*>(frame->data),     // src_yuy2
-                frame->step,                                  // src_stride_yuy2 (use frame->step)
-                static_cast<uint8_t*>(buffer.bits),           // dst_argb
-                buffer.stride * 4,                            // dst_stride_argb (4 bytes per pixel)
-                frame->width,                                 // width
-                frame->height                                 // height
-            );
-            break;
-        case UVC_FRAME_FORMAT_UYVY:
-            result = libyuv::UYVYToARGB(
-                static_cast<const uint8_t*>(frame->data),     // src_uyvy
-                frame->step,                                  // src_stride_uyvy
-                static_cast<uint8_t*>(buffer.bits),           // dst_argb
-                buffer.stride * 4,                            // dst_stride_argb
-                frame->width,                                 // width
-                frame->height                                 // height
-            );
-            break;
-        case UVC_FRAME_FORMAT_MJPEG:
-            // MJPEG needs to be decoded first - for now, create a placeholder
-            LOGW("frameCallback: MJPEG decoding not yet implemented, using placeholder");
-            memset(buffer.bits, 0x80, buffer.width * buffer.height * 4); // Gray placeholder
-            result = 0;
-            break;
-        case UVC_FRAME_FORMAT_UNCOMPRESSED:
-            // Try YUYV conversion as fallback for uncompressed
-            result = libyuv::YUY2ToARGB(
-                static_cast<const uint8_t*>(frame->data),
-                frame->step,
-                static_cast<uint8_t*>(buffer.bits),
-                buffer.stride * 4,
-                frame->width,
-                frame->height
-            );
-            break;
-        default:
-            LOGE("frameCallback: No conversion available for format %d", frame->frame_format);
-            ANativeWindow_unlockAndPost(camera->window_);
-            return;
-    }
-    
-    if (result != 0) {
-        LOGE("frameCallback: Format conversion failed: %d for %s", result, format_name);
-        ANativeWindow_unlockAndPost(camera->window_);
-        return;
-    }
-    
-    // Convert from ARGB to ABGR using libyuv function
-    result = libyuv::ARGBToABGR(
-        static_cast<uint8_t*>(buffer.bits),           // src_argb
-        buffer.stride * 4,                            // src_stride_argb
-        static_cast<uint8_t*>(buffer.bits),           // dst_abgr (same buffer)
-        buffer.stride * 4,                            // dst_stride_abgr
-        frame->width,                                 // width
-        frame->height                                 // height
-    );
-    
-    if (result != 0) {
-        LOGE("frameCallback: ARGBToABGR conversion failed: %d", result);
+    // Conversion and overlays; failures are traced by the renderer
+    if (camera->display_renderer_.render(display_frame, thermal, static_cast<uint8_t*>(buffer.bits), buffer.stride * 4) != 0) {
         ANativeWindow_unlockAndPost(camera->window_);
         return;
     }
 
     int post_ret = ANativeWindow_unlockAndPost(camera->window_);
     if (post_ret != 0) {
-        LOGE("frameCallback: Failed to unlock and post: %d", post_ret);
+        TRACE(WINDOW_POST_FAILED, post_ret);
+        return;
+    }
+    camera->frames_rendered_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ===== WARM START =====
+
+void UVCCamera::recordFirstFrame(const uvc_frame_t* frame) {
+    first_frame_width_.store(frame->width);
+    first_frame_height_.store(frame->height);
+
+    const int64_t now = steadyMicros();
+    time_to_first_frame_us_.store(now - init_start_us_);
+    first_frame_seen_.store(true);
+    StartupProfiler::getInstance().mark("first frame");
+
+    LOGI("⏱️ First frame %ux%u: %.1f ms after init, %.1f ms after stream start (%s start)",
+         frame->width, frame->height, (now - init_start_us_) / 1000.0, (now - stream_start_us_) / 1000.0,
+         warm_start_ ? "warm" : "cold");
+}
+
+// Runs after a warm start, off the streaming path. The stream is already running on the
+// stored control; this only decides whether the snapshot may be used for the next connect.
+void UVCCamera::snapshotValidationLoop(int width, int height) {
+    if (!snapshot_->matchesDescriptors(uvc_get_format_descs(devh_))) {
+        snapshot_->invalidate("device descriptors changed");
+        return;
+    }
+
+    // The device accepted the commit; make sure it actually streams what we asked for
+    const int64_t deadline = steadyMicros() + 2000000;
+    while (keep_snapshot_validation_running_.load() && !first_frame_seen_.load()) {
+        if (steadyMicros() > deadline) {
+            snapshot_->invalidate("no frame within 2 s of warm start");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    if (first_frame_seen_.load() &&
+        (first_frame_width_.load() != width || first_frame_height_.load() != height)) {
+        snapshot_->invalidate("first frame does not match the requested size");
+        return;
+    }
+    LOGI("Snapshot validated");
+}
+
+void UVCCamera::stopSnapshotValidation() {
+    keep_snapshot_validation_running_.store(false);
+    if (snapshot_validation_thread_.joinable()) {
+        snapshot_validation_thread_.join();
     }
 }
 
@@ -844,12 +1026,26 @@ void UVCCamera::printDeviceInfo() {
     uvc_free_device_descriptor(desc);
 }
 
+void UVCCamera::dumpDiagnostics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    LOGI("Enumerating device interfaces and formats:");
+    printDeviceInfo();
+    enumerateInterfaces();
+    enumerateFormats();
+    enumerateAllFrameRates();
+}
+
 // Raw frame capture implementation
-bool UVCCamera::getCapturedFrameData(uint8_t* buffer, int* width, int* height) {
+int UVCCamera::getCapturedFrameData(uint8_t* buffer, size_t capacity, int* width, int* height) {
     std::lock_guard<std::mutex> lock(capture_mutex_);
     
     if (!has_captured_frame_.load() || captured_frame_data_.empty()) {
-        return false;
+        return 0;
+    }
+    if (captured_frame_data_.size() > capacity) {
+        LOGE("Capture buffer too small: %zu bytes, frame needs %zu", capacity, captured_frame_data_.size());
+        return -1;
     }
     
     *width = captured_frame_width_;
@@ -864,13 +1060,407 @@ bool UVCCamera::getCapturedFrameData(uint8_t* buffer, int* width, int* height) {
     LOGI("📸 Retrieved captured frame: %dx%d, %zu bytes", 
          *width, *height, captured_frame_data_.size());
     
+    return static_cast<int>(captured_frame_data_.size());
+}
+
+// ===== STREAM CONTROL NEGOTIATION =====
+
+NegotiationKey UVCCamera::negotiationKey(int width, int height, int fps) const {
+    return {vendor_id_, product_id_, width, height, fps};
+}
+
+// Probes the formats in order of preference, starting with the one that won last time on
+// this camera model, and caches the first control the device accepts
+uvc_error_t UVCCamera::negotiateLocked(int width, int height, int fps, uvc_stream_ctrl_t* ctrl, uvc_frame_format* format) {
+    static const uvc_frame_format kFormats[] = {
+        UVC_FRAME_FORMAT_YUYV,
+        UVC_FRAME_FORMAT_UYVY,
+        UVC_FRAME_FORMAT_MJPEG,
+        UVC_FRAME_FORMAT_UNCOMPRESSED
+    };
+
+    NegotiationCache& cache = NegotiationCache::getInstance();
+    const uvc_frame_format preferred = cache.preferredFormat(vendor_id_, product_id_);
+
+    uvc_frame_format order[5];
+    int count = 0;
+    if (preferred != UVC_FRAME_FORMAT_UNKNOWN) {
+        order[count++] = preferred;
+    }
+    for (uvc_frame_format candidate : kFormats) {
+        if (candidate != preferred) {
+            order[count++] = candidate;
+        }
+    }
+
+    uvc_error_t res = UVC_ERROR_NOT_FOUND;
+    for (int i = 0; i < count; i++) {
+        LOGI("Trying format %s (%d)...", formatName(order[i]), order[i]);
+        res = uvc_get_stream_ctrl_format_size(devh_, ctrl, order[i], width, height, fps);
+        if (res == UVC_SUCCESS) {
+            LOGI("✅ Successfully negotiated format %s", formatName(order[i]));
+            *format = order[i];
+            cache.store(negotiationKey(width, height, fps), order[i], *ctrl);
+            return UVC_SUCCESS;
+        }
+        LOGI("❌ Format %s failed: %s", formatName(order[i]), uvc_strerror(res));
+    }
+    return res;
+}
+
+void UVCCamera::preNegotiateFrameRates(int width, int height) {
+    height = frameHeightFor(height);
+    stopPreNegotiation();
+    keep_pre_negotiation_running_.store(true);
+    pre_negotiation_thread_ = std::thread(&UVCCamera::preNegotiationLoop, this, width, height);
+}
+
+// Only PROBE requests are sent, the control committed for the running stream is untouched.
+// mutex_ is taken per probe so a stream start or fps switch never waits for the whole list.
+void UVCCamera::preNegotiationLoop(int width, int height) {
+    NegotiationCache& cache = NegotiationCache::getInstance();
+    const int64_t start = steadyMicros();
+    int negotiated = 0;
+
+    for (int fps : getSupportedFrameRates(width, height)) {
+        if (!keep_pre_negotiation_running_.load()) {
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!devh_) {
+            break;
+        }
+        if (cache.contains(negotiationKey(width, height, fps))) {
+            continue;
+        }
+
+        uvc_stream_ctrl_t ctrl;
+        uvc_frame_format format;
+        if (negotiateLocked(width, height, fps, &ctrl, &format) == UVC_SUCCESS) {
+            negotiated++;
+        }
+    }
+
+    LOGI("Pre-negotiated %d frame rates for %dx%d in %.1f ms",
+         negotiated, width, height, (steadyMicros() - start) / 1000.0);
+}
+
+void UVCCamera::stopPreNegotiation() {
+    keep_pre_negotiation_running_.store(false);
+    if (pre_negotiation_thread_.joinable()) {
+        pre_negotiation_thread_.join();
+    }
+}
+
+UVCCamera::StreamTimings UVCCamera::getStreamTimings() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StreamTimings timings = stream_timings_;
+    timings.fpsSwitchLatencyUs = switch_latency_us_.load();
+    timings.fpsSwitchLostFrames = switch_lost_frames_.load();
+    return timings;
+}
+
+// ===== RADIOMETRIC STREAM =====
+
+int UVCCamera::frameHeightFor(int sensorHeight) const {
+    const int planes = stream_layout_.load() == StreamLayout::DUAL ? sensorHeight * 2 : sensorHeight;
+    return planes + info_line_.getRows();
+}
+
+int UVCCamera::sensorHeightFor(int frameHeight) const {
+    const int planes = frameHeight - info_line_.getRows();
+    return stream_layout_.load() == StreamLayout::DUAL ? planes / 2 : planes;
+}
+
+bool UVCCamera::hasFrameSize(int width, int height) {
+    if (!devh_) {
+        return false;
+    }
+    for (const uvc_format_desc_t* format_desc = uvc_get_format_descs(devh_); format_desc; format_desc = format_desc->next) {
+        for (const uvc_frame_desc_t* frame_desc = format_desc->frame_descs; frame_desc; frame_desc = frame_desc->next) {
+            if (frame_desc->wWidth == width && frame_desc->wHeight == height) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool UVCCamera::setStreamLayout(StreamLayout layout) {
+    const StreamLayout current = stream_layout_.load();
+    if (layout == current) {
+        return true;
+    }
+
+    int width;
+    int sensor_height;
+    int fps;
+    ANativeWindow* window;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const bool resize = (current == StreamLayout::DUAL) != (layout == StreamLayout::DUAL);
+        if (!is_streaming_ || !resize) {
+            stream_layout_.store(layout);
+            LOGI("🌡️ Stream layout %d", static_cast<int>(layout));
+            return true;
+        }
+        width = stream_width_;
+        sensor_height = sensorHeightFor(stream_height_);
+        fps = ctrl_.dwFrameInterval ? (int)round(10000000.0 / ctrl_.dwFrameInterval) : 0;
+        window = window_;
+    }
+
+    const int frame_height = (layout == StreamLayout::DUAL ? sensor_height * 2 : sensor_height) + info_line_.getRows();
+    if (!hasFrameSize(width, frame_height)) {
+        LOGE("Device has no %dx%d frame for stream layout %d", width, frame_height, static_cast<int>(layout));
+        return false;
+    }
+
+    LOGI("🌡️ Restarting stream for layout %d: %dx%d", static_cast<int>(layout), width, frame_height);
+    stopStream();
+    stream_layout_.store(layout);
+    if (!startStream(width, sensor_height, fps, window)) {
+        LOGE("Failed to restart stream for layout %d", static_cast<int>(layout));
+        return false;
+    }
+    return true;
+}
+
+bool UVCCamera::setInfoLineLayout(const InfoLineLayout& layout) {
+    const int rows = std::max(0, layout.rows);
+    int width;
+    int sensor_height;
+    int fps;
+    ANativeWindow* window;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!is_streaming_ || rows == info_line_.getRows()) {
+            info_line_.configure(layout);
+            return true;
+        }
+        width = stream_width_;
+        sensor_height = sensorHeightFor(stream_height_);
+        fps = ctrl_.dwFrameInterval ? (int)round(10000000.0 / ctrl_.dwFrameInterval) : 0;
+        window = window_;
+    }
+
+    const int frame_height = frameHeightFor(sensor_height) - info_line_.getRows() + rows;
+    if (!hasFrameSize(width, frame_height)) {
+        LOGE("Device has no %dx%d frame for %d info line rows", width, frame_height, rows);
+        return false;
+    }
+
+    LOGI("📋 Restarting stream for %d info line rows: %dx%d", rows, width, frame_height);
+    stopStream();
+    info_line_.configure(layout);
+    if (!startStream(width, sensor_height, fps, window)) {
+        LOGE("Failed to restart stream for %d info line rows", rows);
+        return false;
+    }
     return true;
 }
 
+bool UVCCamera::applyAgc(const uvc_frame_t* frame, uvc_frame_t* imageView, ThermalFrame* thermal) {
+    const size_t pixels = static_cast<size_t>(thermal->width) * thermal->height;
+    if (thermal->raw) {
+        gray_yuyv_.resize(pixels * 2);
+        agc_.processRaw(thermal->raw, thermal->width, thermal->height, gray_yuyv_.data());
+    } else if (thermal->image) {
+        gray_yuyv_.resize(pixels * 2);
+        agc_.processLuma(thermal->image, thermal->width, thermal->height, gray_yuyv_.data());
+    } else {
+        return false;
+    }
+    thermal->image = gray_yuyv_.data();
+
+    if (frame != imageView) {
+        *imageView = *frame;
+    }
+    imageView->data = gray_yuyv_.data();
+    imageView->data_bytes = pixels * 2;
+    imageView->height = thermal->height;
+    imageView->step = thermal->width * 2;
+    imageView->frame_format = UVC_FRAME_FORMAT_YUYV;
+    return true;
+}
+
+bool UVCCamera::splitRadiometricFrame(const uvc_frame_t* frame, int64_t timestampUs, bool grayStretch,
+                                      uvc_frame_t* imageView, ThermalFrame* thermal) {
+    const StreamLayout layout = stream_layout_.load(std::memory_order_relaxed);
+    FramePlanes planes;
+    if (!splitFramePlanes(static_cast<const uint8_t*>(frame->data), frame->data_bytes,
+                          frame->width, frame->height, layout, &planes)) {
+        TRACE(FRAME_RADIOMETRIC_SHORT, frame->data_bytes, frame->width, frame->height, static_cast<int>(layout));
+        return false;
+    }
+
+    const size_t pixels = static_cast<size_t>(planes.width) * planes.height;
+    temperature_back_.resize(pixels);
+    temperature_lut_.convert(planes.raw, temperature_back_.data(), pixels);
+
+    // Without an image plane the pipeline shows a gray stretch of the raw counts, or the
+    // AGC output rendered into the same buffer afterwards
+    const uint8_t* image = planes.image;
+    if (!image && !grayStretch) {
+        gray_yuyv_.resize(pixels * 2);
+        image = gray_yuyv_.data();
+    } else if (!image) {
+        gray_yuyv_.resize(pixels * 2);
+        rawToGrayYuyv(planes.raw, planes.width, planes.height, gray_yuyv_.data());
+        image = gray_yuyv_.data();
+    }
+
+    // Published as a copy: the converted plane stays in temperature_back_ for the consumers
+    // of this frame, which run after this returns
+    {
+        std::lock_guard<std::mutex> lock(temperature_mutex_);
+        temperature_front_.assign(temperature_back_.begin(), temperature_back_.end());
+        temperature_width_ = planes.width;
+        temperature_height_ = planes.height;
+    }
+    *thermal = {image, planes.raw, temperature_back_.data(), planes.width, planes.height, timestampUs};
+
+    *imageView = *frame;
+    imageView->data = const_cast<uint8_t*>(image);
+    imageView->data_bytes = pixels * 2;
+    imageView->height = planes.height;
+    imageView->step = planes.width * 2;
+    imageView->frame_format = UVC_FRAME_FORMAT_YUYV;
+    return true;
+}
+
+int UVCCamera::getTemperatureFrame(float* out, size_t capacity, int* width, int* height) {
+    std::lock_guard<std::mutex> lock(temperature_mutex_);
+    if (stream_layout_.load() == StreamLayout::IMAGE || temperature_front_.empty()) {
+        return 0;
+    }
+    if (temperature_front_.size() > capacity) {
+        return -1;
+    }
+    std::memcpy(out, temperature_front_.data(), temperature_front_.size() * sizeof(float));
+    *width = temperature_width_;
+    *height = temperature_height_;
+    return static_cast<int>(temperature_front_.size());
+}
+
+void UVCCamera::setThermalFrameCallback(void (*callback)(const ThermalFrame& frame, void* userPtr), void* userPtr) {
+    thermal_frame_user_ptr_ = userPtr;
+    thermal_frame_callback_ = callback;
+}
+
+UVCCamera::PipelineCounters UVCCamera::getPipelineCounters() const {
+    return {
+        frames_received_.load(std::memory_order_relaxed),
+        frames_decimated_.load(std::memory_order_relaxed),
+        frames_rendered_.load(std::memory_order_relaxed),
+        frames_encoded_.load(std::memory_order_relaxed)
+    };
+}
+
+// ===== LIVE FRAME RATE SWITCHING =====
+
+void UVCCamera::setDeviceFrameRateCallback(int (*callback)(int fps, int linkFps, void* userPtr), void* userPtr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    device_frame_rate_callback_ = callback;
+    device_frame_rate_user_ptr_ = userPtr;
+}
+
+// The stream keeps its committed control; either the device changes its output rate or
+// the frame callback drops frames. No transfer is torn down, so the preview never blanks.
+// Decimation runs against the rate the device actually sends, which an earlier accepted
+// device switch may have lowered below the link rate.
+bool UVCCamera::switchFrameRateLiveLocked(int fps, int linkFps, int64_t switchStartUs) {
+    beginSwitchMeasurement(fps, switchStartUs);
+
+    FrameRateSwitchMode mode = FrameRateSwitchMode::DECIMATION;
+    int source_fps = device_output_fps_ > 0 ? device_output_fps_ : linkFps;
+    bool reached = true;
+    if (device_frame_rate_callback_ && device_frame_rate_callback_(fps, linkFps, device_frame_rate_user_ptr_) == 0) {
+        mode = FrameRateSwitchMode::DEVICE;
+        device_output_fps_ = fps < linkFps ? fps : 0;
+        source_fps = fps;
+        decimation_fps_.store(0);
+    } else if (fps <= source_fps) {
+        decimation_link_fps_.store(source_fps);
+        decimation_reset_.store(true);
+        decimation_fps_.store(fps < source_fps ? fps : 0);
+    } else {
+        // Above what the device sends and the device refused to go faster
+        decimation_fps_.store(0);
+        reached = false;
+    }
+    const int delivered_fps = reached ? fps : source_fps;
+    output_fps_ = delivered_fps < linkFps ? delivered_fps : 0;
+
+    stream_timings_.fpsSwitchUs = steadyMicros() - switchStartUs;
+    stream_timings_.fpsSwitchCached = false;
+    stream_timings_.fpsSwitchMode = mode;
+    if (!reached) {
+        switch_pending_.store(false);
+        LOGW("⚠️ Frame rate %d fps not reachable: the device sends %d fps and rejected the change", fps, source_fps);
+        return false;
+    }
+    TRACE(FPS_SWITCH, fps, static_cast<int>(mode), stream_timings_.fpsSwitchUs);
+    LOGI("⏱️ Frame rate switch to %d fps (stream at %d fps, device sending %d fps) took %.1f ms, %s, stream kept running",
+         fps, linkFps, source_fps, stream_timings_.fpsSwitchUs / 1000.0,
+         mode == FrameRateSwitchMode::DEVICE ? "device output rate" : "host decimation");
+    return true;
+}
+
+// Latency and lost frames are taken from the first frame delivered after the request
+void UVCCamera::beginSwitchMeasurement(int fps, int64_t switchStartUs) {
+    switch_request_us_ = switchStartUs;
+    switch_last_frame_us_ = last_frame_us_.load(std::memory_order_relaxed);
+    switch_interval_us_ = 1000000 / (fps > 0 ? fps : 1);
+    switch_latency_us_.store(-1);
+    switch_lost_frames_.store(0);
+    switch_pending_.store(true, std::memory_order_release);
+}
+
+void UVCCamera::recordSwitchFrame(int64_t nowUs) {
+    switch_pending_.store(false, std::memory_order_relaxed);
+
+    // Frames the output should have shown between the last one before the switch and this one
+    int lost = 0;
+    if (switch_last_frame_us_ > 0) {
+        const int64_t gap = nowUs - switch_last_frame_us_;
+        lost = std::max(0, static_cast<int>((gap + switch_interval_us_ / 2) / switch_interval_us_) - 1);
+    }
+    switch_latency_us_.store(nowUs - switch_request_us_);
+    switch_lost_frames_.store(lost);
+    TRACE(FPS_SWITCH_FIRST_FRAME, nowUs - switch_request_us_, lost);
+
+    LOGI("⏱️ First frame after the frame rate switch: %.1f ms after the request, %d frames lost",
+         (nowUs - switch_request_us_) / 1000.0, lost);
+}
+
+// Spreads the delivered frames evenly: target out of every link frames, also for
+// non-integer ratios such as 50 -> 30
+bool UVCCamera::shouldDeliverFrame() {
+    const int target = decimation_fps_.load(std::memory_order_relaxed);
+    if (target <= 0) {
+        return true;
+    }
+
+    const int link = decimation_link_fps_.load(std::memory_order_relaxed);
+    if (decimation_reset_.exchange(false, std::memory_order_relaxed)) {
+        decimation_credit_ = link;  // Deliver the first frame after a switch right away
+    }
+
+    decimation_credit_ += target;
+    if (decimation_credit_ >= link) {
+        decimation_credit_ -= link;
+        return true;
+    }
+    return false;
+}
+
 // ===== UVC FRAMERATE CONTROL IMPLEMENTATION =====
 
 std::vector<int> UVCCamera::getSupportedFrameRates(int width, int height) {
     std::vector<int> frameRates;
+    height = frameHeightFor(height);
     
     if (!devh_) {
         LOGE("Device not initialized");
@@ -941,6 +1531,7 @@ std::vector<int> UVCCamera::getSupportedFrameRates(int width, int height) {
 
 bool UVCCamera::setFrameRate(int width, int height, int fps) {
     std::lock_guard<std::mutex> lock(mutex_);
+    height = frameHeightFor(height);
     
     if (!devh_) {
         LOGE("Device not initialized");
@@ -948,10 +1539,18 @@ bool UVCCamera::setFrameRate(int width, int height, int fps) {
     }
     
     LOGI("🎯 Setting frame rate to %d fps for %dx%d", fps, width, height);
+    const int64_t switch_start = steadyMicros();
+
+    // Up to the rate the stream was negotiated for, the running stream can deliver it
+    const int link_fps = ctrl_.dwFrameInterval ? (int)round(10000000.0 / ctrl_.dwFrameInterval) : 0;
+    if (is_streaming_ && width == stream_width_ && height == stream_height_ && fps <= link_fps) {
+        return switchFrameRateLiveLocked(fps, link_fps, switch_start);
+    }
     
     // Stop current streaming if active
     bool was_streaming = is_streaming_;
     if (was_streaming) {
+        beginSwitchMeasurement(fps, switch_start);
         LOGI("Stopping current stream to change framerate...");
         if (devh_) {
             uvc_stop_streaming(devh_);
@@ -959,13 +1558,20 @@ bool UVCCamera::setFrameRate(int width, int height, int fps) {
         is_streaming_ = false;
     }
     
-    // Get new stream control with desired framerate
+    // Get new stream control with desired framerate, from the cache when it was negotiated before
+    NegotiationCache& cache = NegotiationCache::getInstance();
+    const NegotiationKey key = negotiationKey(width, height, fps);
     uvc_stream_ctrl_t new_ctrl;
-    uvc_error_t res = uvc_get_stream_ctrl_format_size(
-        devh_, &new_ctrl,
-        UVC_FRAME_FORMAT_YUYV,
-        width, height, fps
-    );
+    uvc_frame_format new_format;
+    NegotiationEntry cached;
+    const bool cached_hit = cache.lookup(key, &cached);
+    uvc_error_t res = UVC_SUCCESS;
+    if (cached_hit) {
+        LOGI("⚡ Using cached stream control for %d fps", fps);
+        new_ctrl = cached.ctrl;
+    } else {
+        res = negotiateLocked(width, height, fps, &new_ctrl, &new_format);
+    }
     
     if (res != UVC_SUCCESS) {
         LOGE("Failed to get stream control for %dx%d @ %dfps: %s (%d)", 
@@ -995,6 +1601,14 @@ bool UVCCamera::setFrameRate(int width, int height, int fps) {
     if (was_streaming && window_) {
         LOGI("Restarting stream with new framerate...");
         res = uvc_start_streaming(devh_, &ctrl_, frameCallback, this, 0);
+        if (res != UVC_SUCCESS && cached_hit) {
+            LOGW("Cached stream control rejected: %s, renegotiating", uvc_strerror(res));
+            cache.invalidate(key, "stream control rejected by device");
+            res = negotiateLocked(width, height, fps, &ctrl_, &new_format);
+            if (res == UVC_SUCCESS) {
+                res = uvc_start_streaming(devh_, &ctrl_, frameCallback, this, 0);
+            }
+        }
         if (res != UVC_SUCCESS) {
             LOGE("Failed to restart streaming: %s (%d)", uvc_strerror(res), res);
             return false;
@@ -1002,6 +1616,28 @@ bool UVCCamera::setFrameRate(int width, int height, int fps) {
         is_streaming_ = true;
         LOGI("✅ Stream restarted successfully with new framerate");
     }
+
+    // The new control delivers the requested rate itself; undo any earlier live switch
+    stream_width_ = width;
+    stream_height_ = height;
+    output_fps_ = 0;
+    device_output_fps_ = 0;
+    decimation_fps_.store(0);
+    if (device_frame_rate_callback_) {
+        const int link_rate = ctrl_.dwFrameInterval ? (int)round(10000000.0 / ctrl_.dwFrameInterval) : fps;
+        device_frame_rate_callback_(fps, link_rate, device_frame_rate_user_ptr_);
+    }
+
+    stream_timings_.fpsSwitchUs = steadyMicros() - switch_start;
+    stream_timings_.fpsSwitchCached = cached_hit;
+    stream_timings_.fpsSwitchMode = FrameRateSwitchMode::RENEGOTIATION;
+    TRACE(FPS_SWITCH, fps, static_cast<int>(FrameRateSwitchMode::RENEGOTIATION), stream_timings_.fpsSwitchUs);
+    LOGI("⏱️ Frame rate switch to %d fps took %.1f ms (%s control)",
+         fps, stream_timings_.fpsSwitchUs / 1000.0, cached_hit ? "cached" : "negotiated");
+
+    if (snapshot_) {
+        snapshot_->saveStream(uvc_get_format_descs(devh_), ctrl_, width, height, fps);
+    }
     
     return true;
 }
@@ -1011,6 +1647,11 @@ int UVCCamera::getCurrentFrameRate() {
         LOGE("Camera not streaming");
         return 0;
     }
+
+    if (output_fps_ > 0) {
+        LOGI("📊 Current frame rate: %d fps (stream negotiated at interval %u)", output_fps_, ctrl_.dwFrameInterval);
+        return output_fps_;
+    }
     
     float fps = 10000000.0f / ctrl_.dwFrameInterval;
     LOGI("📊 Current frame rate: %.2f fps (interval: %u)", fps, ctrl_.dwFrameInterval);
@@ -1062,12 +1703,39 @@ void UVCCamera::enumerateAllFrameRates() {
 
 // ===== DIRECT VIDEO RECORDING IMPLEMENTATION =====
 
-void UVCCamera::setVideoEncoderCallback(void (*callback)(uint8_t* yuvData, int width, int height, int64_t timestampUs, void* userPtr), void* userPtr) {
+void UVCCamera::setVideoEncoderCallback(void (*callback)(uint8_t* yuvData, int width, int height, int64_t timestampUs, void* userPtr),
+                                        void* userPtr, int (*roomCallback)(void* userPtr)) {
     video_encoder_callback_ = callback;
+    video_encoder_room_callback_ = roomCallback;
     video_callback_user_ptr_ = userPtr;
     LOGI("🎥 Video encoder callback set: %p", callback);
 }
 
+// Frame callback thread: convert and hand one frame to the encoder, stamped relative to
+// the first frame of the recording
+void UVCCamera::encodeRecordingFrame(const uint8_t* yuyv, int width, int height, int64_t captureUs) {
+    // Calculate YUV420 buffer size (1.5 bytes per pixel)
+    const int yuv420_size = width * height * 3 / 2;
+
+    // Conversion buffer, kept across frames
+    yuv420_buffer_.resize(yuv420_size);
+    uint8_t* yuv420_buffer = yuv420_buffer_.data();
+
+    // Convert YUYV to YUV420 directly
+    convertYUYVToYUV420(yuyv, yuv420_buffer, width, height);
+
+    // Initialize recording start time on first frame
+    if (video_recording_start_time_ == 0) {
+        video_recording_start_time_ = captureUs;
+    }
+
+    int64_t timestampUs = captureUs - video_recording_start_time_;
+
+    // Call the video encoder callback with converted YUV420 data
+    video_encoder_callback_(yuv420_buffer, width, height, timestampUs, video_callback_user_ptr_);
+    frames_encoded_.fetch_add(1, std::memory_order_relaxed);
+}
+
 void UVCCamera::convertYUYVToYUV420(const uint8_t* yuyv_data, uint8_t* yuv420_data, int width, int height) {
     // YUYV format: Y0 U0 Y1 V0 (4 bytes for 2 pixels)
     // YUV420 format: All Y values, then U values (1/4 size), then V values (1/4 size)
@@ -9,6 +9,23 @@
 #include <thread>  // Added for std::thread
 #include <atomic>  // Added for std::atomic
 #include <vector>  // Added for captured frame storage
+#include "device_snapshot.h"
+#include "negotiation_cache.h"
+#include "radiometric.h"
+#include "frame_stats.h"
+#include "roi_engine.h"
+#include "display_renderer.h"
+#include "agc_engine.h"
+#include "blob_tracker.h"
+#include "info_line.h"
+#include "timeseries_store.h"
+#include "measurement_recorder.h"
+#include "alarm_engine.h"
+#include "bad_pixel_map.h"
+#include "ffc_scheduler.h"
+#include "temporal_denoiser.h"
+#include "motion_detector.h"
+#include "pre_roll_buffer.h"
 
 // Logging macros
 #define LOG_TAG "UVCCamera"
@@ -16,6 +33,14 @@
 #define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
+// How the last setFrameRate() reached the requested rate
+enum class FrameRateSwitchMode {
+    NONE = 0,
+    DEVICE = 1,          // ircmd OUTPUT_FRAME_RATE, stream kept running
+    DECIMATION = 2,      // host drops frames evenly, stream kept running
+    RENEGOTIATION = 3    // stream stopped, new control committed, stream restarted
+};
+
 class UVCCamera {
 public:
     UVCCamera();
@@ -40,10 +65,16 @@ public:
     bool enumerateInterfaces();
     bool enumerateFormats();
     void printDeviceInfo();
+
+    // Full descriptor dump (device info, interfaces, formats, frame rates). Diagnostic only:
+    // init() no longer runs it, call it off the startup path when the output is wanted.
+    void dumpDiagnostics();
     
     // Raw frame capture for super resolution
     void setCaptureNextFrame(bool capture) { capture_next_frame_ = capture; }
-    bool getCapturedFrameData(uint8_t* buffer, int* width, int* height);
+    // Copies the captured frame into buffer; returns its size in bytes, 0 if no frame is
+    // pending, or -1 if capacity is too small (the frame stays pending)
+    int getCapturedFrameData(uint8_t* buffer, size_t capacity, int* width, int* height);
     bool hasNewCapturedFrame() const { return has_captured_frame_; }
     
     // UVC framerate control
@@ -59,9 +90,123 @@ public:
             video_recording_start_time_ = 0;  // Reset timing on stop
         }
     }
-    void setVideoEncoderCallback(void (*callback)(uint8_t* yuvData, int width, int height, int64_t timestampUs, void* userPtr), void* userPtr);
+    // roomCallback, if set, reports how many frames the encoder queue takes without dropping
+    // one; the pre-roll is drained no faster than that
+    void setVideoEncoderCallback(void (*callback)(uint8_t* yuvData, int width, int height, int64_t timestampUs, void* userPtr),
+                                 void* userPtr, int (*roomCallback)(void* userPtr) = nullptr);
     bool isVideoRecordingEnabled() const { return video_recording_enabled_; }
 
+    // Warm start: the snapshot is owned by the caller and must outlive this camera
+    void setSnapshot(DeviceSnapshot* snapshot) { snapshot_ = snapshot; }
+    bool isWarmStarted() const { return warm_start_; }
+
+    // Time from init() to the first frame of the current stream, -1 until a frame arrived
+    int64_t getTimeToFirstFrameUs() const { return time_to_first_frame_us_.load(); }
+
+    // Probe every supported frame rate of this resolution on a background thread and
+    // cache the results, so later fps switches can commit without negotiating
+    void preNegotiateFrameRates(int width, int height);
+
+    // Device-side output rate control (ircmd OUTPUT_FRAME_RATE), returns 0 on success and
+    // fails for rates the model cannot output at the stream's negotiated rate linkFps.
+    // Lets setFrameRate() change the rate without restarting the stream.
+    void setDeviceFrameRateCallback(int (*callback)(int fps, int linkFps, void* userPtr), void* userPtr);
+
+    // Duration of the last startStream()/setFrameRate() and whether it used a cached control
+    struct StreamTimings {
+        int64_t startUs;
+        bool startCached;
+        int64_t fpsSwitchUs;
+        bool fpsSwitchCached;
+        FrameRateSwitchMode fpsSwitchMode;
+        int64_t fpsSwitchLatencyUs;     // Request to first frame at the new rate, -1 until it arrived
+        int fpsSwitchLostFrames;        // Output frames missing around the switch (decimation not counted)
+    };
+    StreamTimings getStreamTimings();
+
+    // Frame counters since the camera was created. Frames that reached the pipeline but
+    // were neither decimated nor rendered failed somewhere; the trace ring says where.
+    struct PipelineCounters {
+        uint64_t framesReceived;
+        uint64_t framesDecimated;
+        uint64_t framesRendered;
+        uint64_t framesEncoded;
+    };
+    PipelineCounters getPipelineCounters() const;
+    bool isStreaming() const { return is_streaming_; }
+
+    // Radiometric stream layout. Heights passed to startStream(), setFrameRate(),
+    // getSupportedFrameRates() and preNegotiateFrameRates() are sensor heights; in DUAL
+    // the stream carries twice that, so switching into or out of DUAL restarts the stream.
+    // The device side (ircmd stream source) is the caller's job.
+    bool setStreamLayout(StreamLayout layout);
+    StreamLayout getStreamLayout() const { return stream_layout_.load(); }
+    bool hasFrameSize(int width, int height);
+
+    // Raw count -> °C conversion settings, applied from the next frame on
+    void setRadiometricParams(const RadiometricParams& params) { temperature_lut_.configure(params); }
+    RadiometricParams getRadiometricParams() const { return temperature_lut_.getParams(); }
+
+    // Copies the latest temperature plane (°C) into out; returns the pixel count, 0 if
+    // there is none (IMAGE layout or no frame yet), or -1 if capacity is too small
+    int getTemperatureFrame(float* out, size_t capacity, int* width, int* height);
+
+    // Called on the frame thread for every delivered frame with all of its planes
+    void setThermalFrameCallback(void (*callback)(const ThermalFrame& frame, void* userPtr), void* userPtr);
+
+    // Statistics of the latest frame, computed on every delivered frame; false until the first
+    bool getFrameStats(FrameStatsRecord* out) const { return frame_stats_.read(out); }
+
+    // ROIs measured natively on every delivered frame
+    RoiEngine& getRoiEngine() { return roi_engine_; }
+
+    // Isotherm bands drawn on the display; changes apply from the next frame
+    bool setIsotherms(const IsothermConfig& config) { return display_renderer_.getIsotherms().configure(config); }
+
+    // Digital zoom and pan of the display only; recording and capture keep the full frame
+    bool setDisplayZoom(const DisplayZoom& zoom) { return display_renderer_.setZoom(zoom); }
+
+    // Rotation and mirroring of the display only, done while converting; the device
+    // orientation (MIRROR_AND_FLIP) and the other consumers are left as they are
+    bool setDisplayOrientation(const DisplayOrientation& orientation) { return display_renderer_.setOrientation(orientation); }
+
+    // Host-side AGC; while enabled, the displayed, encoded and captured image is the
+    // equalized raw plane (or luma) instead of the device's picture
+    AgcEngine& getAgc() { return agc_; }
+
+    // Host-side temporal noise reduction for the selected consumers (display, recording,
+    // capture); measurements always see the unfiltered frame
+    TemporalDenoiser& getDenoiser() { return denoiser_; }
+
+    // Hot object detection and tracking, run on every delivered frame while enabled
+    BlobTracker& getBlobTracker() { return blob_tracker_; }
+
+    // Embedded info line below the picture. A change of row count restarts a running stream
+    // with the matching frame height (the device must offer it).
+    bool setInfoLineLayout(const InfoLineLayout& layout);
+    // Device state decoded from the latest frame's info line; false until the first
+    bool getFrameMetadata(FrameMetadata* out) const { return info_line_.read(out); }
+
+    // Frame, ROI and device measurements recorded on every delivered frame while enabled
+    TimeSeriesStore& getTimeSeries() { return time_series_; }
+
+    // Threshold alarms evaluated on every delivered frame. Snapshot actions are handled
+    // here; events are queued for the app, which owns recording.
+    AlarmEngine& getAlarmEngine() { return alarm_engine_; }
+
+    // Host-side defective pixel correction, applied to the frame before any other stage.
+    // The map is owned by the caller, outlives this camera and is set before streaming.
+    void setBadPixelMap(BadPixelMap* map) { bad_pixels_ = map; }
+
+    // Host-scheduled flat field correction; fed scene and shutter state from every frame
+    FfcScheduler& getFfcScheduler() { return ffc_scheduler_; }
+
+    // Scene activity for motion-triggered recording, and the frames kept from before it.
+    // While the pre-roll is enabled and not recording, recording frames are buffered; the
+    // next recording starts with them.
+    MotionDetector& getMotionDetector() { return motion_detector_; }
+    PreRollBuffer& getPreRoll() { return pre_roll_; }
+
 private:
     // This function is deprecated in favor of init(int fileDescriptor)
     bool findAndOpenDevice();
@@ -71,10 +216,41 @@ private:
 
     // Frame callback for UVC streaming
     static void frameCallback(uvc_frame_t* frame, void* ptr);
+    // Alarm transitions, on the frame thread
+    static void alarmCallback(const AlarmEvent& event, void* ptr);
 
     // USB event handling
     void usbEventThreadLoop(); // New method for the event thread
 
+    // Warm start helpers
+    void recordFirstFrame(const uvc_frame_t* frame);
+    void snapshotValidationLoop(int width, int height);
+    void stopSnapshotValidation();
+
+    // Stream control negotiation, expects mutex_ to be held
+    NegotiationKey negotiationKey(int width, int height, int fps) const;
+    uvc_error_t negotiateLocked(int width, int height, int fps, uvc_stream_ctrl_t* ctrl, uvc_frame_format* format);
+    void preNegotiationLoop(int width, int height);
+    void stopPreNegotiation();
+
+    // Frame rate switching without a stream restart
+    bool switchFrameRateLiveLocked(int fps, int linkFps, int64_t switchStartUs);
+    void beginSwitchMeasurement(int fps, int64_t switchStartUs);
+    void recordSwitchFrame(int64_t nowUs);
+    bool shouldDeliverFrame();
+
+    // Radiometric helpers. splitRadiometricFrame runs on the frame thread: it converts and
+    // publishes the temperature plane, points imageView at the image plane and fills thermal.
+    // grayStretch renders a stand-in image plane when the layout has none.
+    // frameHeightFor/sensorHeightFor convert between the sensor height and the streamed
+    // frame height (DUAL doubling, info line rows).
+    int frameHeightFor(int sensorHeight) const;
+    int sensorHeightFor(int frameHeight) const;
+    bool splitRadiometricFrame(const uvc_frame_t* frame, int64_t timestampUs, bool grayStretch,
+                               uvc_frame_t* imageView, ThermalFrame* thermal);
+    // Frame thread: replaces the image plane with the AGC output in gray_yuyv_
+    bool applyAgc(const uvc_frame_t* frame, uvc_frame_t* imageView, ThermalFrame* thermal);
+
     // UVC context and device handles
     uvc_context_t* ctx_;
     uvc_device_t* dev_;
@@ -102,8 +278,81 @@ private:
     // Direct video recording members
     std::atomic<bool> video_recording_enabled_;
     void (*video_encoder_callback_)(uint8_t* yuvData, int width, int height, int64_t timestampUs, void* userPtr);
+    int (*video_encoder_room_callback_)(void* userPtr) = nullptr;
     void* video_callback_user_ptr_;
     int64_t video_recording_start_time_;
+    std::vector<uint8_t> yuv420_buffer_;        // Frame callback thread only
+
+    // Warm start state
+    DeviceSnapshot* snapshot_;
+    bool warm_start_;
+    int64_t init_start_us_;
+    int64_t stream_start_us_;
+    std::atomic<int64_t> time_to_first_frame_us_;
+    std::atomic<bool> first_frame_seen_;
+    std::atomic<int> first_frame_width_;
+    std::atomic<int> first_frame_height_;
+    std::thread snapshot_validation_thread_;
+    std::atomic<bool> keep_snapshot_validation_running_;
+
+    // Negotiation cache state
+    uint16_t vendor_id_;
+    uint16_t product_id_;
+    StreamTimings stream_timings_;
+    std::thread pre_negotiation_thread_;
+    std::atomic<bool> keep_pre_negotiation_running_;
+
+    // Frame rate switching state. The frame callback never takes mutex_ (stopping the
+    // stream joins it while mutex_ is held), so what it reads or writes is atomic.
+    int (*device_frame_rate_callback_)(int fps, int linkFps, void* userPtr);
+    void* device_frame_rate_user_ptr_;
+    int stream_width_;
+    int stream_height_;
+    int output_fps_;                            // Rate delivered after a live switch, 0 = link rate
+    int device_output_fps_;                     // Rate the device sends after it accepted one, 0 = link rate
+    std::atomic<int> decimation_fps_;           // Host-side target rate, 0 = deliver every frame
+    std::atomic<int> decimation_link_fps_;
+    std::atomic<bool> decimation_reset_;
+    int decimation_credit_;                     // Frame callback thread only
+    std::atomic<int64_t> last_frame_us_;
+    std::atomic<bool> switch_pending_;
+    int64_t switch_request_us_;                 // Published by switch_pending_
+    int64_t switch_last_frame_us_;
+    int64_t switch_interval_us_;
+    std::atomic<int64_t> switch_latency_us_;
+    std::atomic<int> switch_lost_frames_;
+
+    // Pipeline counters
+    std::atomic<uint64_t> frames_received_;
+    std::atomic<uint64_t> frames_decimated_;
+    std::atomic<uint64_t> frames_rendered_;
+    std::atomic<uint64_t> frames_encoded_;
+
+    // Radiometric state
+    std::atomic<StreamLayout> stream_layout_;
+    TemperatureLut temperature_lut_;
+    std::vector<float> temperature_back_;       // Frame callback thread only
+    std::vector<uint8_t> gray_yuyv_;            // Frame callback thread only
+    std::vector<float> temperature_front_;      // Latest complete plane, guarded by temperature_mutex_
+    int temperature_width_;
+    int temperature_height_;
+    std::mutex temperature_mutex_;
+    void (*thermal_frame_callback_)(const ThermalFrame& frame, void* userPtr);
+    void* thermal_frame_user_ptr_;
+    FrameStats frame_stats_;
+    RoiEngine roi_engine_;
+    DisplayRenderer display_renderer_;
+    AgcEngine agc_;
+    TemporalDenoiser denoiser_;
+    BlobTracker blob_tracker_;
+    InfoLineParser info_line_;
+    TimeSeriesStore time_series_;
+    MeasurementRecorder measurement_recorder_;  // Frame callback thread only
+    AlarmEngine alarm_engine_;
+    BadPixelMap* bad_pixels_ = nullptr;
+    FfcScheduler ffc_scheduler_;
+    MotionDetector motion_detector_;
+    PreRollBuffer pre_roll_;
 
     // Updated to use libusb_interface_descriptor instead of uvc_interface_descriptor_t
     void printInterfaceInfo(const libusb_interface_descriptor* if_desc);
@@ -112,4 +361,5 @@ private:
     
     // YUV conversion functions for direct recording
     void convertYUYVToYUV420(const uint8_t* yuyv_data, uint8_t* yuv420_data, int width, int height);
+    void encodeRecordingFrame(const uint8_t* yuyv, int width, int height, int64_t captureUs);
 }; 
\ No newline at end of file
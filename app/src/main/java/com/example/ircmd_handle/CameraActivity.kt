@@ -11,7 +11,9 @@ import android.os.Build
 import android.os.Bundle
 import android.os.Handler
 import android.os.Looper
+import android.os.SystemClock
 import android.util.Log
+import android.view.ScaleGestureDetector
 import android.view.Surface
 import android.view.TextureView
 import android.view.View
@@ -39,6 +41,7 @@ import androidx.core.view.WindowInsetsControllerCompat
 import androidx.core.view.ViewCompat
 import androidx.core.widget.NestedScrollView
 import android.content.pm.ActivityInfo
+import android.content.pm.ApplicationInfo
 import android.view.WindowManager
 import android.graphics.Color
 import android.view.Window
@@ -83,6 +86,236 @@ class CameraActivity : AppCompatActivity() {
         private const val ACTION_USB_PERMISSION = "android.hardware.usb.action.USB_PERMISSION"
         private const val PERMISSION_REQUEST_TIMEOUT = 5000L // 5 seconds
         private const val CAMERA_PERMISSION_REQUEST_CODE = 1001
+        private const val TRACE_DUMP_FILE = "trace_dump.txt"
+        private const val TRACE_DUMP_EVENTS = 4000
+        // A burst of errors keeps the dump from the first one instead of rewriting it each time
+        private const val TRACE_DUMP_INTERVAL_MS = 10_000L
+        private const val BAD_PIXEL_MAP_FILE = "bad_pixels.bpm"
+        // Largest raw YUYV frame a capture can return (640x512, 2 bytes per pixel)
+        private const val CAPTURE_BUFFER_BYTES = 640 * 512 * 2
+        // Largest temperature plane (640x512 float °C)
+        private const val TEMPERATURE_BUFFER_BYTES = 640 * 512 * 4
+        private const val DEFAULT_REFLECTED_C = 25f   // RadiometricParams::reflectedC
+        
+        // Stream layouts of nativeSetStreamLayout(), same values as StreamLayout in radiometric.h
+        const val STREAM_LAYOUT_IMAGE = 0
+        const val STREAM_LAYOUT_TEMPERATURE = 1
+        const val STREAM_LAYOUT_DUAL = 2
+        
+        // Isotherm modes of nativeSetIsotherms(), same values as IsothermMode in isotherm_overlay.h
+        const val ISOTHERM_MODE_OFF = 0
+        const val ISOTHERM_MODE_SOLID = 1
+        const val ISOTHERM_MODE_TRANSPARENT = 2
+        private const val AGC_RAW_BITS = 16          // AgcParams::rawBits
+        private const val AGC_TAIL_REJECTION = 0.001f
+        private const val AGC_SMOOTHING = 0.25f
+        private const val ISOTHERM_COLOR = 0xB0FF2000.toInt()   // Translucent red-orange
+        
+        // Slots of nativeGetFrameStats(), same order as FrameStatsIndex in frame_stats.h
+        private const val FRAME_STATS_FRAME_NUMBER = 0
+        private const val FRAME_STATS_TIMESTAMP_US = 1
+        private const val FRAME_STATS_SOURCE = 2
+        private const val FRAME_STATS_WIDTH = 3
+        private const val FRAME_STATS_HEIGHT = 4
+        private const val FRAME_STATS_MIN = 5
+        private const val FRAME_STATS_MAX = 6
+        private const val FRAME_STATS_MEAN = 7
+        private const val FRAME_STATS_STDDEV = 8
+        private const val FRAME_STATS_MIN_X = 9
+        private const val FRAME_STATS_MIN_Y = 10
+        private const val FRAME_STATS_MAX_X = 11
+        private const val FRAME_STATS_MAX_Y = 12
+        private const val FRAME_STATS_MIN_C = 13
+        private const val FRAME_STATS_MAX_C = 14
+        private const val FRAME_STATS_MEAN_C = 15
+        private const val FRAME_STATS_STDDEV_C = 16
+        private const val FRAME_STATS_COMPUTE_US = 17
+        private const val FRAME_STATS_COUNT = 18
+        private const val FRAME_STATS_UI_INTERVAL_MS = 500L
+        
+        // Floats per ROI in nativeGetRoiResults(), same order as RoiResultIndex in roi_engine.h
+        private const val ROI_RESULT_ID = 0
+        private const val ROI_RESULT_PIXEL_COUNT = 1
+        private const val ROI_RESULT_MEAN = 2
+        private const val ROI_RESULT_VARIANCE = 3
+        private const val ROI_RESULT_MIN = 4
+        private const val ROI_RESULT_MAX = 5
+        private const val ROI_RESULT_MIN_X = 6
+        private const val ROI_RESULT_MIN_Y = 7
+        private const val ROI_RESULT_MAX_X = 8
+        private const val ROI_RESULT_MAX_Y = 9
+        private const val ROI_RESULT_STRIDE = 10
+        private const val MAX_ROIS = 256 // RoiEngine::kMaxRois
+        private const val ROI_SHAPE_RECT = 0
+        private const val ROI_SHAPE_CIRCLE = 1
+        private const val ROI_SHAPE_LINE = 2
+        private const val ROI_CIRCLE_VERTICES = 16
+        private const val ROI_TEXT_LINES = 4
+        
+        // Floats per blob in nativeGetTrackedBlobs(), same order as TrackedBlobIndex in blob_tracker.h
+        private const val BLOB_ID = 0
+        private const val BLOB_AGE = 1
+        private const val BLOB_AREA = 2
+        private const val BLOB_CENTROID_X = 3
+        private const val BLOB_CENTROID_Y = 4
+        private const val BLOB_PEAK = 5
+        private const val BLOB_PEAK_X = 6
+        private const val BLOB_PEAK_Y = 7
+        private const val BLOB_LEFT = 8
+        private const val BLOB_TOP = 9
+        private const val BLOB_RIGHT = 10
+        private const val BLOB_BOTTOM = 11
+        private const val BLOB_VELOCITY_X = 12
+        private const val BLOB_VELOCITY_Y = 13
+        private const val BLOB_STRIDE = 14
+        private const val MAX_TRACKED_BLOBS = 32 // BlobTracker::kMaxTracks
+        private const val BLOB_THRESHOLD_C = 40f
+        private const val BLOB_THRESHOLD_LUMA = 200f
+        private const val BLOB_MIN_AREA = 4
+        private const val BLOB_MAX_MATCH_DISTANCE = 24f
+        private const val BLOB_MAX_MISSED_FRAMES = 5
+        
+        // Slots of nativeGetTelemetry(), same order as TelemetryIndex in jni_bridge.h
+        private const val TELEMETRY_STREAMING = 0
+        private const val TELEMETRY_FRAMES_RECEIVED = 1
+        private const val TELEMETRY_FRAMES_DECIMATED = 2
+        private const val TELEMETRY_FRAMES_RENDERED = 3
+        private const val TELEMETRY_FRAMES_ENCODED = 4
+        private const val TELEMETRY_TIME_TO_FIRST_FRAME_US = 5
+        private const val TELEMETRY_STREAM_START_US = 6
+        private const val TELEMETRY_STREAM_START_CACHED = 7
+        private const val TELEMETRY_FPS_SWITCH_US = 8
+        private const val TELEMETRY_FPS_SWITCH_CACHED = 9
+        private const val TELEMETRY_FPS_SWITCH_MODE = 10
+        private const val TELEMETRY_FPS_SWITCH_LATENCY_US = 11
+        private const val TELEMETRY_FPS_SWITCH_LOST_FRAMES = 12
+        private const val TELEMETRY_NEGOTIATION_HITS = 13
+        private const val TELEMETRY_NEGOTIATION_MISSES = 14
+        private const val TELEMETRY_TRACE_DROPPED_EVENTS = 15
+        private const val TELEMETRY_ENCODER_DELIVERED = 16
+        private const val TELEMETRY_ENCODER_DROPPED_QUEUE_FULL = 17
+        private const val TELEMETRY_ENCODER_DROPPED_NOT_RUNNING = 18
+        private const val TELEMETRY_ENCODER_DROPPED_FAILED = 19
+        private const val TELEMETRY_COUNT = 20
+        
+        // Slots of nativeGetFrameMetadata(), same order as FrameMetadataIndex in info_line.h
+        private const val METADATA_FRAME_NUMBER = 0
+        private const val METADATA_TIMESTAMP_US = 1
+        private const val METADATA_DEVICE_FRAME_COUNTER = 2
+        private const val METADATA_DEVICE_FRAMES_SKIPPED = 3
+        private const val METADATA_SHUTTER_STATUS = 4
+        private const val METADATA_AUTO_SHUTTER_STATUS = 5
+        private const val METADATA_MODEL_STATUS = 6
+        private const val METADATA_TPD_FORMAT = 7
+        private const val METADATA_MIRROR = 8
+        private const val METADATA_FLIP = 9
+        private const val METADATA_FFC_IN_PROGRESS = 10
+        private const val METADATA_FFC_COUNT = 11
+        private const val METADATA_SENSOR_TEMP_MILLI_C = 12
+        private const val METADATA_COUNT = 13
+        private const val INFO_LINE_ROWS = 2
+        private const val INFO_LINE_SENSOR_TEMP_SCALE = 0.01f   // InfoLineLayout::sensorTempScale
+        
+        // Doubles per bucket of nativeQueryTimeSeries(), same order as TimeSeriesBucketIndex in timeseries_store.h
+        private const val TIMESERIES_START_US = 0
+        private const val TIMESERIES_MIN = 1
+        private const val TIMESERIES_MAX = 2
+        private const val TIMESERIES_MEAN = 3
+        private const val TIMESERIES_STRIDE = 4
+        private const val TIMESERIES_LOG_BUCKETS = 6
+        private const val TIMESERIES_MEMORY_CAP_BYTES = 16L * 1024 * 1024
+        private const val TIMESERIES_SPILL_CAP_BYTES = 256L * 1024 * 1024
+        private const val TIMESERIES_SPILL_DIRECTORY = "timeseries"
+        
+        // Alarm rules, same values as AlarmSource / AlarmMetric / AlarmOp / AlarmAction in alarm_engine.h
+        const val ALARM_SOURCE_GLOBAL = 0
+        const val ALARM_SOURCE_ROI = 1
+        const val ALARM_SOURCE_BLOB = 2
+        const val ALARM_METRIC_MIN = 0
+        const val ALARM_METRIC_MAX = 1
+        const val ALARM_METRIC_MEAN = 2
+        const val ALARM_METRIC_STDDEV = 3
+        const val ALARM_METRIC_AREA = 4
+        const val ALARM_METRIC_COUNT = 5
+        const val ALARM_OP_GREATER = 0
+        const val ALARM_OP_LESS = 1
+        const val ALARM_ACTION_SNAPSHOT = 1
+        const val ALARM_ACTION_RECORD = 2
+        
+        // Ints per rule of nativeSetAlarmRules(), same order as AlarmRuleIndex in alarm_engine.h
+        const val ALARM_RULE_ID = 0
+        const val ALARM_RULE_SOURCE = 1
+        const val ALARM_RULE_TARGET = 2
+        const val ALARM_RULE_METRIC = 3
+        const val ALARM_RULE_OP = 4
+        const val ALARM_RULE_TRIGGER_FRAMES = 5
+        const val ALARM_RULE_CLEAR_FRAMES = 6
+        const val ALARM_RULE_ACTIONS = 7
+        const val ALARM_RULE_STRIDE = 8
+        private const val OVER_TEMPERATURE_ALARM_ID = 1
+        private const val ALARM_TRIGGER_FRAMES = 3
+        private const val ALARM_CLEAR_FRAMES = 15
+        private const val ALARM_HYSTERESIS = 2f
+        
+        // Doubles per event of nativeGetAlarmEvents(), same order as AlarmEventIndex
+        private const val ALARM_EVENT_RULE_ID = 0
+        private const val ALARM_EVENT_TRIGGERED = 1
+        private const val ALARM_EVENT_VALUE = 2
+        private const val ALARM_EVENT_TIMESTAMP_US = 3
+        private const val ALARM_EVENT_ACTIONS = 4
+        private const val ALARM_EVENT_STRIDE = 5
+        private const val MAX_ALARM_EVENTS = 64
+        
+        // Slots of nativeGetAlarmStats(), same order as AlarmStatsIndex
+        private const val ALARM_STATS_RULES = 0
+        private const val ALARM_STATS_EVALUATIONS = 1
+        private const val ALARM_STATS_EVENTS = 2
+        private const val ALARM_STATS_DROPPED_EVENTS = 3
+        private const val ALARM_STATS_LAST_NS = 4
+        private const val ALARM_STATS_MAX_NS = 5
+        private const val ALARM_STATS_MEAN_NS = 6
+        private const val ALARM_STATS_COUNT = 7
+        
+        // Keep in sync with FfcEstimateIndex in ffc_scheduler.h
+        private const val FFC_SECONDS_TO_NEXT = 0
+        private const val FFC_SENSOR_TEMP_C = 1
+        private const val FFC_DRIFT_C = 2
+        private const val FFC_SLOPE_C_PER_MIN = 3
+        private const val FFC_SECONDS_SINCE_LAST = 4
+        private const val FFC_FPN = 5
+        private const val FFC_SCENE_STATIC = 6
+        private const val FFC_HOLD = 7
+        private const val FFC_HOST_COUNT = 8
+        private const val FFC_DEVICE_COUNT = 9
+        private const val FFC_ESTIMATE_COUNT = 10
+        private const val FFC_TOLERANCE_C = 0.5f
+        private const val FFC_MIN_INTERVAL_S = 30
+        private const val FFC_MAX_INTERVAL_S = 600
+        private const val FFC_LOOKAHEAD_S = 30
+        
+        // Keep in sync with DenoiseConsumer and DenoiseStatsIndex in temporal_denoiser.h
+        const val DENOISE_DISPLAY = 1
+        const val DENOISE_RECORDING = 2
+        const val DENOISE_CAPTURE = 4
+        private const val DENOISE_STATS_FRAMES = 0
+        private const val DENOISE_STATS_LAST_NS = 1
+        private const val DENOISE_STATS_MAX_NS = 2
+        private const val DENOISE_STATS_MEAN_NS = 3
+        private const val DENOISE_STATS_COUNT = 4
+        private const val DENOISE_MOTION_THRESHOLD = 12
+        
+        // Keep in sync with MotionStateIndex in motion_detector.h
+        private const val MOTION_ACTIVE = 0
+        private const val MOTION_SCORE = 1
+        private const val MOTION_ACTIVATIONS = 2
+        private const val MOTION_FRAMES = 3
+        private const val MOTION_LAST_NS = 4
+        private const val MOTION_MEAN_NS = 5
+        private const val MOTION_PRE_ROLL_FRAMES = 6
+        private const val MOTION_STATE_COUNT = 7
+        
+        private const val MAX_DISPLAY_ZOOM = 8f    // DisplayRenderer::kMaxZoom
+        private const val DISPLAY_ZOOM_FILTER_BILINEAR = 2
         private const val STORAGE_PERMISSION_REQUEST_CODE = 1002
         private const val AUDIO_PERMISSION_REQUEST_CODE = 1003
         
@@ -157,17 +390,134 @@ class CameraActivity : AppCompatActivity() {
     // Native methods for raw frame capture
     private external fun nativeSetCaptureFlag(capture: Boolean)
     private external fun nativeHasCapturedFrame(): Boolean
-    private external fun nativeGetCapturedFrame(): ByteArray?
+    private external fun nativeReadCapturedFrame(buffer: ByteBuffer, dims: IntArray): Int
     
     // Native methods for UVC framerate control
     private external fun nativeGetSupportedFrameRates(width: Int, height: Int): IntArray?
     private external fun nativeSetFrameRate(width: Int, height: Int, fps: Int): Boolean
     private external fun nativeGetCurrentFrameRate(): Int
     private external fun nativeEnumerateAllFrameRates()
+    private external fun nativePreNegotiateFrameRates(width: Int, height: Int)
+    private external fun nativeGetTelemetry(out: LongArray): Int
+    
+    // Native methods for the radiometric (temperature) stream
+    private external fun nativeSetStreamLayout(layout: Int): Int
+    private external fun nativeSetRadiometricParams(emissivity: Float, reflectedC: Float)
+    private external fun nativeReadTemperatureFrame(buffer: ByteBuffer, dims: IntArray): Int
+    private external fun nativeGetFrameStats(out: DoubleArray): Int
+    
+    // Native ROI measurements, evaluated on every frame without USB traffic.
+    // Coordinates are sensor pixels; the add methods return the ROI id or -1.
+    external fun nativeAddRoiRect(x: Int, y: Int, width: Int, height: Int): Int
+    external fun nativeAddRoiPolygon(xy: IntArray): Int
+    external fun nativeAddRoiLine(x0: Int, y0: Int, x1: Int, y1: Int): Int
+    external fun nativeRemoveRoi(id: Int): Boolean
+    external fun nativeClearRois()
+    private external fun nativeGetRoiResults(out: FloatArray): Int
+    
+    // Native isotherm bands, drawn from the next frame: bounds holds a lower, upper pair
+    // per band (°C, or luma without a temperature stream), colors one ARGB color per band
+    external fun nativeSetIsotherms(mode: Int, inverse: Boolean, bounds: FloatArray, colors: IntArray): Int
+    
+    // Display-only zoom and pan, applied natively from the next frame; recording keeps the full
+    // frame. filter is libyuv's FilterMode (0 none, 1 linear, 2 bilinear, 3 box).
+    private external fun nativeSetDisplayZoom(zoom: Float, centerX: Float, centerY: Float, filter: Int): Int
+    
+    // Display-only rotation (clockwise degrees, a multiple of 90) and mirroring, done natively
+    // while converting the frame; no device command is sent
+    private external fun nativeSetDisplayOrientation(rotation: Int, mirror: Boolean, flip: Boolean): Int
+    
+    // Native plateau-equalization AGC, independent of the device's contrast commands.
+    // regions holds x, y, width, height, weight per weighted region (may be null).
+    external fun nativeSetAgc(enabled: Boolean, rawBits: Int, plateau: Float, tailRejection: Float,
+                              smoothing: Float, regions: IntArray?): Int
+    
+    // Native motion-adaptive temporal denoise, a per-consumer alternative to the device's TNR.
+    // consumers is a mask of DENOISE_DISPLAY, DENOISE_RECORDING and DENOISE_CAPTURE.
+    private external fun nativeSetDenoise(enabled: Boolean, strength: Float, motionThreshold: Int, consumers: Int): Int
+    private external fun nativeGetDenoiseStats(out: LongArray): Int
+    
+    // Native scene change detection; threshold is the luma change of a 4x4 block, activeFraction
+    // the share of changed blocks that counts as activity. preRollMs of frames are kept in memory.
+    private external fun nativeSetMotionRecording(enabled: Boolean, threshold: Int, activeFraction: Float,
+                                                  holdOffMs: Int, preRollMs: Int): Int
+    private external fun nativeGetMotionState(out: DoubleArray): Int
+    
+    // Native hot object tracking; threshold is °C, or luma without a temperature stream
+    external fun nativeSetBlobTracking(enabled: Boolean, threshold: Float, minArea: Int,
+                                       maxMatchDistance: Float, maxMissedFrames: Int)
+    private external fun nativeGetTrackedBlobs(out: FloatArray): Int
+    
+    // Device state from the info line embedded below each frame (rows 0 disables it).
+    // fields holds word, shift, bits per field in InfoLineField order, or null for the defaults.
+    external fun nativeSetInfoLine(rows: Int, fields: IntArray?, sensorTempScale: Float, sensorTempOffset: Float): Boolean
+    private external fun nativeGetFrameMetadata(out: LongArray): Int
+    
+    // Native time series of frame, ROI and device measurements. spillDirectory (may be null)
+    // receives compressed blocks beyond memoryCapBytes; without it the oldest are dropped.
+    // Spilled segments beyond spillCapBytes are deleted, oldest first.
+    private external fun nativeConfigureTimeSeries(enabled: Boolean, memoryCapBytes: Long, spillCapBytes: Long,
+                                                   spillDirectory: String?)
+    private external fun nativeGetTimeSeriesNames(): Array<String>
+    // Buckets over [fromUs, toUs] (steady clock), at most out.size / TIMESERIES_STRIDE
+    external fun nativeQueryTimeSeries(name: String, fromUs: Long, toUs: Long, out: DoubleArray): Int
+    
+    // Native per-frame alarms: spec holds ALARM_RULE_STRIDE ints per rule, limits a threshold,
+    // hysteresis pair per rule. Replaces all rules; false if one is invalid.
+    private external fun nativeSetAlarmRules(spec: IntArray, limits: FloatArray): Boolean
+    private external fun nativeGetAlarmEvents(out: DoubleArray): Int
+    private external fun nativeGetAlarmStats(out: LongArray): Int
+    
+    // Host-side defective pixel map; the count is -1 while learning
+    private external fun nativeLearnBadPixels(frames: Int, deviationThreshold: Float, noiseThreshold: Float): Boolean
+    private external fun nativeGetBadPixelCount(): Int
+    private external fun nativeLoadBadPixels(path: String): Int
+    private external fun nativeSaveBadPixels(path: String): Boolean
+    private external fun nativeClearBadPixels()
+    
+    // Host-scheduled FFC: taken early when the scene is static and nothing holds it, with the
+    // device's auto FFC kept as a looser backstop. fpnTolerance 0 ignores pattern noise.
+    private external fun nativeConfigureFfcScheduler(enabled: Boolean, toleranceC: Float, minIntervalS: Int, maxIntervalS: Int,
+                                                     lookaheadS: Int, fpnTolerance: Float): Boolean
+    private external fun nativeSetFfcHold(hold: Boolean)
+    private external fun nativeGetFfcEstimate(out: DoubleArray): Int
     
     private lateinit var usbManager: UsbManager
     private var deviceConnection: UsbDeviceConnection? = null
     private var currentDevice: UsbDevice? = null
+    private var firstFrameReported = false
+    
+    // Reused across native calls instead of allocating per call
+    private val telemetry = LongArray(TELEMETRY_COUNT)
+    private val frameMetadata = LongArray(METADATA_COUNT)
+    private var infoLineEnabled = false
+    private var ffcSchedulerEnabled = false
+    private val frameStats = DoubleArray(FRAME_STATS_COUNT)
+    private var frameStatsShownAtMs = 0L
+    private var traceDumpedAtMs = 0L
+    private val roiResults = FloatArray(MAX_ROIS * ROI_RESULT_STRIDE)
+    private val roiIds = mutableListOf<Int>()
+    private val trackedBlobs = FloatArray(MAX_TRACKED_BLOBS * BLOB_STRIDE)
+    private val timeSeriesBuckets = DoubleArray(TIMESERIES_LOG_BUCKETS * TIMESERIES_STRIDE)
+    private val alarmEvents = DoubleArray(MAX_ALARM_EVENTS * ALARM_EVENT_STRIDE)
+    private val alarmStats = LongArray(ALARM_STATS_COUNT)
+    private val ffcEstimate = DoubleArray(FFC_ESTIMATE_COUNT)
+    private val denoiseStats = LongArray(DENOISE_STATS_COUNT)
+    private val motionState = DoubleArray(MOTION_STATE_COUNT)
+    private var motionRecordingArmed = false
+    private var motionStartedRecording = false
+    private var displayZoom = 1f
+    private var displayZoomCenterX = 0.5f
+    private var displayZoomCenterY = 0.5f
+    private var displayRotation = 0
+    private var displayMirror = false
+    private val captureBuffer: ByteBuffer by lazy { ByteBuffer.allocateDirect(CAPTURE_BUFFER_BYTES) }
+    private val captureDims = IntArray(2)
+    private var temperatureStreamEnabled = false
+    private val temperatureBuffer: ByteBuffer by lazy {
+        ByteBuffer.allocateDirect(TEMPERATURE_BUFFER_BYTES).order(ByteOrder.nativeOrder())
+    }
+    private val temperatureDims = IntArray(2)
     private var permissionRequestTime: Long = 0
 
     // 1) A PendingIntent that we'll use when calling requestPermission(...)
@@ -265,6 +615,13 @@ class CameraActivity : AppCompatActivity() {
             // Initialize IrcmdManager
             ircmdManager = IrcmdManager.getInstance()
             
+            // Device snapshots let a reconnect skip stream negotiation and restore settings
+            nativeSetSnapshotDirectory(filesDir.absolutePath)
+            val badPixels = nativeLoadBadPixels(java.io.File(filesDir, BAD_PIXEL_MAP_FILE).absolutePath)
+            if (badPixels >= 0) {
+                Log.i(TAG, "Loaded bad pixel map: $badPixels pixels")
+            }
+            
             // Views are now available through binding
             Log.i(TAG, "onCreate: Views initialized through ViewBinding")
             
@@ -351,10 +708,131 @@ class CameraActivity : AppCompatActivity() {
             binding.frameRate50Button.setOnClickListener {
                 setFrameRate(50)
             }
+            
+            binding.addRoiRectButton.setOnClickListener {
+                addRoi(ROI_SHAPE_RECT)
+            }
+            
+            binding.addRoiCircleButton.setOnClickListener {
+                addRoi(ROI_SHAPE_CIRCLE)
+            }
+            
+            binding.addRoiLineButton.setOnClickListener {
+                addRoi(ROI_SHAPE_LINE)
+            }
+            
+            binding.removeRoiButton.setOnClickListener {
+                roiIds.removeLastOrNull()?.let { id ->
+                    nativeRemoveRoi(id)
+                    Log.i(TAG, "📐 Removed ROI $id")
+                }
+            }
+            
+            binding.clearRoisButton.setOnClickListener {
+                nativeClearRois()
+                roiIds.clear()
+                Log.i(TAG, "📐 Cleared all ROIs")
+            }
+            
+            binding.learnBadPixelsButton.setOnClickListener {
+                learnBadPixelMap()
+            }
+            
+            binding.clearBadPixelsButton.setOnClickListener {
+                clearBadPixelMap()
+            }
+            
+            binding.hostAgcSwitch.setOnCheckedChangeListener { _, _ ->
+                applyHostAgc()
+            }
+            
+            binding.setAgcPlateauButton.setOnClickListener {
+                applyHostAgc()
+            }
+            
+            binding.isothermSwitch.setOnCheckedChangeListener { _, _ ->
+                applyIsotherm()
+            }
+            
+            binding.setIsothermThresholdButton.setOnClickListener {
+                applyIsotherm()
+            }
+            
+            binding.blobTrackingSwitch.setOnCheckedChangeListener { _, isChecked ->
+                setBlobTracking(isChecked)
+            }
+            
+            binding.infoLineSwitch.setOnCheckedChangeListener { _, isChecked ->
+                if (isChecked != infoLineEnabled) {
+                    setInfoLine(isChecked)
+                }
+            }
+            
+            binding.alarmSwitch.setOnCheckedChangeListener { _, _ ->
+                applyAlarm()
+            }
+            
+            binding.setAlarmThresholdButton.setOnClickListener {
+                applyAlarm()
+            }
+            
+            binding.timeSeriesSwitch.setOnCheckedChangeListener { _, isChecked ->
+                setTimeSeries(isChecked)
+            }
+            
+            binding.ffcSchedulerSwitch.setOnCheckedChangeListener { _, isChecked ->
+                if (isChecked != ffcSchedulerEnabled) {
+                    setFfcScheduler(isChecked)
+                }
+            }
+            
+            binding.ffcHoldSwitch.setOnCheckedChangeListener { _, isChecked ->
+                nativeSetFfcHold(isChecked)
+                Log.i(TAG, "📸 FFC ${if (isChecked) "held" else "released"}")
+            }
+            
+            binding.denoiseSwitch.setOnCheckedChangeListener { _, _ ->
+                applyDenoise()
+            }
+            
+            binding.setDenoiseStrengthButton.setOnClickListener {
+                applyDenoise()
+            }
+            
+            binding.motionRecordingSwitch.setOnCheckedChangeListener { _, isChecked ->
+                if (isChecked != motionRecordingArmed && !setMotionRecording(isChecked)) {
+                    showError("Motion recording not available")
+                    binding.motionRecordingSwitch.isChecked = motionRecordingArmed
+                }
+            }
+            
+            binding.rotateDisplayButton.setOnClickListener {
+                if (!setDisplayOrientation(displayRotation + 90, displayMirror)) {
+                    showError("Display orientation needs an open camera")
+                }
+            }
+            
+            binding.mirrorDisplaySwitch.setOnCheckedChangeListener { _, isChecked ->
+                if (isChecked != displayMirror && !setDisplayOrientation(displayRotation, isChecked)) {
+                    showError("Display orientation needs an open camera")
+                    binding.mirrorDisplaySwitch.isChecked = displayMirror
+                }
+            }
+            
+            binding.temperatureStreamSwitch.setOnCheckedChangeListener { _, isChecked ->
+                if (isChecked != temperatureStreamEnabled) {
+                    setTemperatureStream(isChecked)
+                }
+            }
+            
+            binding.setEmissivityButton.setOnClickListener {
+                setEmissivity(binding.emissivitySlider.progress)
+            }
 
             // Set up expandable groups
             setupExpandableGroup(binding.imageSettingsHeader, binding.imageSettingsContent)
             setupExpandableGroup(binding.noiseReductionHeader, binding.noiseReductionContent)
+            setupExpandableGroup(binding.hostProcessingHeader, binding.hostProcessingContent)
 
             // 2) Get the system UsbManager
             usbManager = getSystemService(UsbManager::class.java)
@@ -444,18 +922,19 @@ class CameraActivity : AppCompatActivity() {
             val screenWidth = displayMetrics.widthPixels
             val screenHeight = displayMetrics.heightPixels
             
-            // Calculate dimensions to maintain 4:3 aspect ratio
+            // Calculate dimensions to maintain 4:3 aspect ratio, 3:4 when turned a quarter natively
+            val (aspectWidth, aspectHeight) = if (displayRotation % 180 != 0) 3 to 4 else 4 to 3
             val targetWidth: Int
             val targetHeight: Int
             
             if (screenWidth > screenHeight) { // Landscape
                 // In landscape, height is the limiting factor
                 targetHeight = screenHeight
-                targetWidth = (targetHeight * 4) / 3
+                targetWidth = (targetHeight * aspectWidth) / aspectHeight
             } else { // Portrait
                 // In portrait, width is the limiting factor
                 targetWidth = screenWidth
-                targetHeight = (targetWidth * 3) / 4
+                targetHeight = (targetWidth * aspectHeight) / aspectWidth
             }
             
             // Create layout params for the camera container
@@ -499,7 +978,7 @@ class CameraActivity : AppCompatActivity() {
                 // Restore the camera's aspect ratio if we have dimensions
                 val dimensions = nativeGetCameraDimensions()
                 if (dimensions != null) {
-                    dimensionRatio = "${dimensions.first}:${dimensions.second}"
+                    dimensionRatio = "${dimensions[0]}:${dimensions[1]}"
                 }
             }
             binding.cameraContainer.layoutParams = params
@@ -527,6 +1006,16 @@ class CameraActivity : AppCompatActivity() {
     }
     
     private fun showError(message: String, action: (() -> Unit)? = null) {
+        // Keep the native event history leading up to the failure
+        val now = SystemClock.elapsedRealtime()
+        if (traceDumpedAtMs == 0L || now - traceDumpedAtMs >= TRACE_DUMP_INTERVAL_MS) {
+            traceDumpedAtMs = now
+            val traceFile = java.io.File(filesDir, TRACE_DUMP_FILE).absolutePath
+            lifecycleScope.launch(Dispatchers.IO) {
+                nativeDumpTrace(traceFile, TRACE_DUMP_EVENTS)
+            }
+        }
+        
         val snackbar = Snackbar.make(binding.root, message, Snackbar.LENGTH_LONG)
         action?.let { 
             snackbar.setAction("Retry") { it() }
@@ -534,6 +1023,35 @@ class CameraActivity : AppCompatActivity() {
         snackbar.show()
     }
     
+    // Learn the bad pixel map from the next frames; the camera must see a uniform scene
+    // (lens cap or closed shutter). The map is saved for the next session.
+    private fun learnBadPixelMap(frames: Int = 32) {
+        if (!nativeLearnBadPixels(frames, 8.0f, 6.0f)) {
+            showError("Bad pixel learning not started")
+            return
+        }
+        binding.learnBadPixelsButton.isEnabled = false
+        lifecycleScope.launch(Dispatchers.IO) {
+            while (nativeGetBadPixelCount() < 0) {
+                delay(100)
+            }
+            val count = nativeGetBadPixelCount()
+            nativeSaveBadPixels(java.io.File(filesDir, BAD_PIXEL_MAP_FILE).absolutePath)
+            withContext(Dispatchers.Main) {
+                binding.learnBadPixelsButton.isEnabled = true
+                showSuccess("Bad pixel map: $count pixels")
+            }
+        }
+    }
+    
+    // Drop the map and its saved copy, so the next session starts without one too
+    private fun clearBadPixelMap() {
+        nativeClearBadPixels()
+        java.io.File(filesDir, BAD_PIXEL_MAP_FILE).delete()
+        Log.i(TAG, "Cleared bad pixel map")
+        showSuccess("Bad pixel map cleared")
+    }
+    
     private fun showSuccess(message: String) {
         Snackbar.make(binding.root, message, Snackbar.LENGTH_SHORT).show()
     }
@@ -707,6 +1225,15 @@ class CameraActivity : AppCompatActivity() {
                 return
             }
 
+            nativeBeginStartupProfile()
+
+            // The control interface wraps the fd in its own libusb context, so it can be
+            // initialized while the video path opens the camera
+            val ircmdManager = IrcmdManager.getInstance()
+            val ircmdInit = lifecycleScope.async(Dispatchers.IO) {
+                ircmdManager.init(fd, deviceConfig.deviceType)
+            }
+
             // Pass the device configuration to native code
             if (!nativeOpenUvcCamera(fd, deviceConfig.width, deviceConfig.height, deviceConfig.fps)) {
                 Log.e(TAG, "Failed to initialize UVC camera with native library")
@@ -719,9 +1246,20 @@ class CameraActivity : AppCompatActivity() {
             // Set up the video surface
             setupVideoSurface()
 
-            // Initialize IrcmdManager with the device configuration
-            val ircmdManager = IrcmdManager.getInstance()
-            if (!ircmdManager.init(fd, deviceConfig.deviceType)) {
+            lifecycleScope.launch {
+                onControlInterfaceReady(device, deviceConfig, ircmdInit.await())
+            }
+        } catch (e: Exception) {
+            Log.e(TAG, "Error opening camera", e)
+            showError("Camera initialization error: ${e.message}") {
+                finish()
+            }
+        }
+    }
+
+    private fun onControlInterfaceReady(device: UsbDevice, deviceConfig: DeviceConfig, initialized: Boolean) {
+        try {
+            if (!initialized) {
                 Log.e(TAG, "Failed to initialize thermal camera control interface")
                 showError("Thermal camera controls failed to initialize. Basic video streaming may still work.") {
                     // Allow continuing with just video streaming
@@ -730,12 +1268,12 @@ class CameraActivity : AppCompatActivity() {
             }
             Log.i(TAG, "Camera initialized successfully with device type: ${deviceConfig.deviceType}")
             
+            // Settings stored for this device by the previous session
+            ircmdManager.restoreSavedParameters()
+            
             // Test registry functionality
             logRegistryStatus()
             
-            // Enumerate all supported frame rates
-            nativeEnumerateAllFrameRates()
-            
             // Get supported frame rates for current resolution
             val supportedFps = nativeGetSupportedFrameRates(deviceConfig.width, deviceConfig.height)
             if (supportedFps != null && supportedFps.isNotEmpty()) {
@@ -767,6 +1305,14 @@ class CameraActivity : AppCompatActivity() {
     }
 
     private fun setupVideoSurface() {
+        firstFrameReported = false
+        displayZoom = 1f
+        displayZoomCenterX = 0.5f
+        displayZoomCenterY = 0.5f
+        // The native camera is new and unrotated; keep the mount orientation chosen in the UI
+        if (!setDisplayOrientation(displayRotation, displayMirror)) {
+            displayRotation = 0
+        }
         // Force software rendering to avoid Vulkan issues
         binding.cameraView.setLayerType(View.LAYER_TYPE_SOFTWARE, null)
         Log.i(TAG, "Set TextureView to software rendering to avoid Vulkan issues")
@@ -774,6 +1320,23 @@ class CameraActivity : AppCompatActivity() {
         // Configure TextureView for thermal camera format
         binding.cameraView.isOpaque = false
         
+        // Pinch zooms the picture natively, keeping the point between the fingers in place
+        val zoomDetector = ScaleGestureDetector(this, object : ScaleGestureDetector.SimpleOnScaleGestureListener() {
+            override fun onScale(detector: ScaleGestureDetector): Boolean {
+                val view = binding.cameraView
+                if (view.width == 0 || view.height == 0) return false
+                val zoom = (displayZoom * detector.scaleFactor).coerceIn(1f, MAX_DISPLAY_ZOOM)
+                val focusX = detector.focusX / view.width - 0.5f
+                val focusY = detector.focusY / view.height - 0.5f
+                displayZoomCenterX = (displayZoomCenterX + focusX * (1f / displayZoom - 1f / zoom)).coerceIn(0f, 1f)
+                displayZoomCenterY = (displayZoomCenterY + focusY * (1f / displayZoom - 1f / zoom)).coerceIn(0f, 1f)
+                displayZoom = zoom
+                nativeSetDisplayZoom(displayZoom, displayZoomCenterX, displayZoomCenterY, DISPLAY_ZOOM_FILTER_BILINEAR)
+                return true
+            }
+        })
+        binding.cameraView.setOnTouchListener { _, event -> zoomDetector.onTouchEvent(event) }
+        
         // Try to set a compatible surface format
         try {
             // Get current surface texture and configure it
@@ -799,15 +1362,15 @@ class CameraActivity : AppCompatActivity() {
                     // Get the camera dimensions from native code
                     val dimensions = nativeGetCameraDimensions()
                     if (dimensions != null) {
-                        Log.i(TAG, "✅ Camera dimensions: ${dimensions.first}x${dimensions.second}")
+                        Log.i(TAG, "✅ Camera dimensions: ${dimensions[0]}x${dimensions[1]}")
                         
                         // Update the container's aspect ratio to match camera
                         val params = binding.cameraContainer.layoutParams as ConstraintLayout.LayoutParams
                         if (!isFullscreen) {
                             // Only set aspect ratio in portrait mode
-                            params.dimensionRatio = "${dimensions.first}:${dimensions.second}"
+                            params.dimensionRatio = "${dimensions[0]}:${dimensions[1]}"
                             binding.cameraContainer.layoutParams = params
-                            Log.i(TAG, "Updated container aspect ratio to ${dimensions.first}:${dimensions.second}")
+                            Log.i(TAG, "Updated container aspect ratio to ${dimensions[0]}:${dimensions[1]}")
                         }
                     } else {
                         Log.w(TAG, "Could not get camera dimensions from native code")
@@ -832,7 +1395,34 @@ class CameraActivity : AppCompatActivity() {
             }
             
             override fun onSurfaceTextureUpdated(texture: SurfaceTexture) {
-                // Handle surface updates if needed
+                pollAlarmEvents()
+                pollMotionRecording()
+                updateFrameStatsText()
+                
+                // Report plug-to-first-frame once per connection (measured natively from camera open)
+                if (!firstFrameReported) {
+                    val ms = nativeGetTimeToFirstFrameMs()
+                    if (ms >= 0) {
+                        firstFrameReported = true
+                        Log.i(TAG, "⏱️ Time to first frame: $ms ms")
+                        Log.i(TAG, nativeGetStartupReport())
+                        logStreamTimings()
+                        
+                        // Negotiate the other frame rates now so a later switch can skip probing
+                        currentDevice?.let { device ->
+                            DeviceConfigs.configs[device.productId]?.let { config ->
+                                nativePreNegotiateFrameRates(config.width, config.height)
+                            }
+                        }
+                        
+                        // Descriptor dumps are kept out of startup; debug builds still get them, after the first frame
+                        if ((applicationInfo.flags and ApplicationInfo.FLAG_DEBUGGABLE) != 0) {
+                            lifecycleScope.launch(Dispatchers.IO) {
+                                nativeDumpDeviceDiagnostics()
+                            }
+                        }
+                    }
+                }
             }
         }
     }
@@ -884,7 +1474,13 @@ class CameraActivity : AppCompatActivity() {
     private external fun nativeStartStreaming(surface: Surface): Boolean
     private external fun nativeStopStreaming()
     private external fun nativeCloseUvcCamera()
-    private external fun nativeGetCameraDimensions(): Pair<Int, Int>?
+    private external fun nativeGetCameraDimensions(): IntArray?
+    private external fun nativeSetSnapshotDirectory(directory: String)
+    private external fun nativeBeginStartupProfile()
+    private external fun nativeGetStartupReport(): String
+    private external fun nativeDumpDeviceDiagnostics()
+    private external fun nativeDumpTrace(path: String, maxEvents: Int): Int
+    private external fun nativeGetTimeToFirstFrameMs(): Long
 
     /**
      * Find a compatible camera device that's already connected and attempt to connect to it.
@@ -1366,6 +1962,12 @@ class CameraActivity : AppCompatActivity() {
                         DeviceConfigs.configs = DeviceConfigs.configs + (device.productId to updatedConfig)
                         
                         Log.i(TAG, "✅ UVC frame rate changed: requested ${fps}fps, actual ${actualFps}fps")
+                        
+                        // Switch latency and lost frames are measured on the first frame at the new rate
+                        lifecycleScope.launch {
+                            delay(1000)
+                            logStreamTimings()
+                        }
                         updateLastCommand("Frame Rate", actualFps, true)
                         showSuccess("Frame rate changed to ${actualFps}fps via UVC")
                         
@@ -1394,6 +1996,445 @@ class CameraActivity : AppCompatActivity() {
         }
     }
     
+    // The dual layout keeps the image plane for display and adds the temperature plane, so
+    // frame statistics and ROIs are also reported in °C
+    private fun setTemperatureStream(enabled: Boolean) {
+        val layout = if (enabled) STREAM_LAYOUT_DUAL else STREAM_LAYOUT_IMAGE
+        lifecycleScope.launch {
+            val result = withContext(Dispatchers.IO) {
+                nativeSetStreamLayout(layout)
+            }
+            if (result == 0) {
+                temperatureStreamEnabled = enabled
+                if (binding.blobTrackingSwitch.isChecked) {
+                    setBlobTracking(true)
+                }
+                Log.i(TAG, "🌡️ Temperature stream ${if (enabled) "on" else "off"}")
+                showSuccess("Temperature stream ${if (enabled) "on" else "off"}")
+            } else {
+                Log.e(TAG, "Stream layout $layout failed: $result")
+                showError("Temperature stream not available: Error $result")
+                binding.temperatureStreamSwitch.isChecked = temperatureStreamEnabled
+            }
+        }
+    }
+    
+    // Plateau equalization on the host instead of the device's contrast; the slider's
+    // progress 0..99 maps to a plateau of 0.1%..10% of the pixels per bin
+    private fun applyHostAgc() {
+        val enabled = binding.hostAgcSwitch.isChecked
+        val plateau = (binding.agcPlateauSlider.progress + 1) / 1000f
+        val result = nativeSetAgc(enabled, AGC_RAW_BITS, plateau, AGC_TAIL_REJECTION, AGC_SMOOTHING, null)
+        if (result != 0) {
+            showError("Host AGC not applied: Error $result")
+            return
+        }
+        Log.i(TAG, "🎚️ Host AGC ${if (enabled) "on, plateau $plateau" else "off"}")
+    }
+    
+    // progress 0..95 is the share of the history kept on still pixels; captures stay undenoised
+    private fun applyDenoise() {
+        val enabled = binding.denoiseSwitch.isChecked
+        val strength = binding.denoiseStrengthSlider.progress / 100f
+        val result = nativeSetDenoise(enabled, strength, DENOISE_MOTION_THRESHOLD, DENOISE_DISPLAY or DENOISE_RECORDING)
+        if (result != 0) {
+            showError("Denoise not applied: Error $result")
+            return
+        }
+        Log.i(TAG, "🧹 Temporal denoise ${if (enabled) "on, strength $strength" else "off"}")
+    }
+    
+    // One band from the slider's threshold up, blended over the picture; the threshold is °C
+    // with the temperature stream and luma without it
+    private fun applyIsotherm() {
+        val enabled = binding.isothermSwitch.isChecked
+        val threshold = binding.isothermThresholdSlider.progress.toFloat()
+        val result = nativeSetIsotherms(if (enabled) ISOTHERM_MODE_TRANSPARENT else ISOTHERM_MODE_OFF, false,
+            floatArrayOf(threshold, Float.MAX_VALUE), intArrayOf(ISOTHERM_COLOR))
+        if (result != 0) {
+            showError("Isotherm not applied: Error $result")
+            return
+        }
+        Log.i(TAG, "🎨 Isotherm ${if (enabled) "above $threshold" else "off"}")
+    }
+    
+    // One rule: frame max above the threshold for ALARM_TRIGGER_FRAMES frames snapshots the
+    // frame and starts recording; off replaces the rules with none
+    private fun applyAlarm() {
+        val enabled = binding.alarmSwitch.isChecked
+        val threshold = binding.alarmThresholdSlider.progress.toFloat()
+        val applied = if (enabled) {
+            val spec = IntArray(ALARM_RULE_STRIDE)
+            spec[ALARM_RULE_ID] = OVER_TEMPERATURE_ALARM_ID
+            spec[ALARM_RULE_SOURCE] = ALARM_SOURCE_GLOBAL
+            spec[ALARM_RULE_METRIC] = ALARM_METRIC_MAX
+            spec[ALARM_RULE_OP] = ALARM_OP_GREATER
+            spec[ALARM_RULE_TRIGGER_FRAMES] = ALARM_TRIGGER_FRAMES
+            spec[ALARM_RULE_CLEAR_FRAMES] = ALARM_CLEAR_FRAMES
+            spec[ALARM_RULE_ACTIONS] = ALARM_ACTION_SNAPSHOT or ALARM_ACTION_RECORD
+            nativeSetAlarmRules(spec, floatArrayOf(threshold, ALARM_HYSTERESIS))
+        } else {
+            nativeSetAlarmRules(IntArray(0), FloatArray(0))
+        }
+        if (!applied) {
+            showError("Alarm not applied")
+            return
+        }
+        Log.i(TAG, "🚨 Alarm ${if (enabled) "above $threshold" else "off"}")
+    }
+    
+    // progress 0..99 maps to emissivity 0.01..1.00
+    private fun setEmissivity(progress: Int) {
+        val emissivity = (progress + 1) / 100f
+        nativeSetRadiometricParams(emissivity, DEFAULT_REFLECTED_C)
+        Log.i(TAG, "🌡️ Emissivity $emissivity, reflected $DEFAULT_REFLECTED_C °C")
+        showSuccess(String.format(Locale.US, "Emissivity set to %.2f", emissivity))
+    }
+    
+    // Write the latest temperature plane next to a capture: float °C, native byte order, row by row
+    private fun saveTemperatureFrame() {
+        val count = nativeReadTemperatureFrame(temperatureBuffer, temperatureDims)
+        if (count <= 0) {
+            Log.w(TAG, "No temperature frame to save")
+            return
+        }
+        val timestamp = SimpleDateFormat("yyyyMMdd_HHmmss", Locale.getDefault()).format(Date())
+        val file = java.io.File(getExternalFilesDir(null) ?: filesDir,
+            "Temperature_${timestamp}_${temperatureDims[0]}x${temperatureDims[1]}.f32")
+        temperatureBuffer.clear()
+        temperatureBuffer.limit(count * 4)
+        java.io.FileOutputStream(file).channel.use { it.write(temperatureBuffer) }
+        Log.i(TAG, "🌡️ Saved ${temperatureDims[0]}x${temperatureDims[1]} temperature frame to ${file.absolutePath}")
+    }
+    
+    private fun logStreamTimings() {
+        if (nativeGetTelemetry(telemetry) < TELEMETRY_COUNT) return
+        val t = telemetry
+        Log.i(TAG, "⏱️ Stream start: ${t[TELEMETRY_STREAM_START_US] / 1000.0} ms " +
+                "(${if (t[TELEMETRY_STREAM_START_CACHED] != 0L) "cached" else "negotiated"}), " +
+                "negotiation cache hits/misses: ${t[TELEMETRY_NEGOTIATION_HITS]}/${t[TELEMETRY_NEGOTIATION_MISSES]}")
+        Log.i(TAG, "📊 Frames received ${t[TELEMETRY_FRAMES_RECEIVED]}, decimated ${t[TELEMETRY_FRAMES_DECIMATED]}, " +
+                "rendered ${t[TELEMETRY_FRAMES_RENDERED]}, encoded ${t[TELEMETRY_FRAMES_ENCODED]}, " +
+                "trace events dropped ${t[TELEMETRY_TRACE_DROPPED_EVENTS]}")
+        logFrameStats()
+        if (t[TELEMETRY_FRAMES_ENCODED] > 0) {
+            Log.i(TAG, "🎥 Encoder frames delivered ${t[TELEMETRY_ENCODER_DELIVERED]}, dropped: " +
+                    "queue full ${t[TELEMETRY_ENCODER_DROPPED_QUEUE_FULL]}, " +
+                    "not running ${t[TELEMETRY_ENCODER_DROPPED_NOT_RUNNING]}, " +
+                    "failed ${t[TELEMETRY_ENCODER_DROPPED_FAILED]}")
+        }
+        if (t[TELEMETRY_FPS_SWITCH_US] >= 0) {
+            val mode = when (t[TELEMETRY_FPS_SWITCH_MODE]) {
+                1L -> "device output rate"
+                2L -> "host decimation"
+                3L -> if (t[TELEMETRY_FPS_SWITCH_CACHED] != 0L) "restart, cached control" else "restart, negotiated"
+                else -> "unknown"
+            }
+            val latencyUs = t[TELEMETRY_FPS_SWITCH_LATENCY_US]
+            val latency = if (latencyUs >= 0) "${latencyUs / 1000.0} ms" else "no frame yet"
+            Log.i(TAG, "⏱️ Last fps switch ($mode): call ${t[TELEMETRY_FPS_SWITCH_US] / 1000.0} ms, " +
+                    "first frame after $latency, ${t[TELEMETRY_FPS_SWITCH_LOST_FRAMES]} frames lost")
+        }
+    }
+    
+    // Live readout of the native per-frame statistics, refreshed at most every FRAME_STATS_UI_INTERVAL_MS
+    private fun updateFrameStatsText() {
+        val now = SystemClock.elapsedRealtime()
+        if (now - frameStatsShownAtMs < FRAME_STATS_UI_INTERVAL_MS) return
+        if (nativeGetFrameStats(frameStats) < FRAME_STATS_COUNT) return
+        frameStatsShownAtMs = now
+        val s = frameStats
+        val frame = if (s[FRAME_STATS_MIN_C].isNaN()) {
+            String.format(Locale.US, "Min %d (%d, %d)  Max %d (%d, %d)  Mean %.1f",
+                s[FRAME_STATS_MIN].toInt(), s[FRAME_STATS_MIN_X].toInt(), s[FRAME_STATS_MIN_Y].toInt(),
+                s[FRAME_STATS_MAX].toInt(), s[FRAME_STATS_MAX_X].toInt(), s[FRAME_STATS_MAX_Y].toInt(),
+                s[FRAME_STATS_MEAN])
+        } else {
+            String.format(Locale.US, "Min %.1f °C (%d, %d)  Max %.1f °C (%d, %d)  Mean %.1f °C",
+                s[FRAME_STATS_MIN_C], s[FRAME_STATS_MIN_X].toInt(), s[FRAME_STATS_MIN_Y].toInt(),
+                s[FRAME_STATS_MAX_C], s[FRAME_STATS_MAX_X].toInt(), s[FRAME_STATS_MAX_Y].toInt(),
+                s[FRAME_STATS_MEAN_C])
+        }
+        val unit = if (s[FRAME_STATS_MIN_C].isNaN()) "" else " °C"
+        val count = nativeGetRoiResults(roiResults)
+        val rois = (0 until min(count, ROI_TEXT_LINES)).joinToString("") { i ->
+            val base = i * ROI_RESULT_STRIDE
+            val r = roiResults
+            if (r[base + ROI_RESULT_PIXEL_COUNT] == 0f) "\nROI ${r[base + ROI_RESULT_ID].toInt()}: outside the frame"
+            else String.format(Locale.US, "\nROI %d: mean %.1f%s  max %.1f%s", r[base + ROI_RESULT_ID].toInt(),
+                r[base + ROI_RESULT_MEAN], unit, r[base + ROI_RESULT_MAX], unit)
+        }
+        val blobs = if (binding.blobTrackingSwitch.isChecked) "\nHot blobs: ${nativeGetTrackedBlobs(trackedBlobs)}" else ""
+        val device = if (infoLineEnabled && nativeGetFrameMetadata(frameMetadata) >= METADATA_COUNT) {
+            val m = frameMetadata
+            "\nDevice: FFC ${if (m[METADATA_FFC_IN_PROGRESS] != 0L) "running" else "idle"} " +
+                    "(${m[METADATA_FFC_COUNT]} so far), ${m[METADATA_DEVICE_FRAMES_SKIPPED]} frames skipped"
+        } else ""
+        val ffc = if (ffcSchedulerEnabled && nativeGetFfcEstimate(ffcEstimate) >= FFC_ESTIMATE_COUNT) {
+            String.format(Locale.US, "\nFFC: next in %.0f s, drift %+.2f °C%s", ffcEstimate[FFC_SECONDS_TO_NEXT],
+                ffcEstimate[FFC_DRIFT_C], if (ffcEstimate[FFC_HOLD] != 0.0) ", held" else "")
+        } else ""
+        val motion = if (motionRecordingArmed && nativeGetMotionState(motionState) >= MOTION_STATE_COUNT) {
+            "\nMotion: ${if (motionState[MOTION_ACTIVE] != 0.0) "active" else "quiet"}"
+        } else ""
+        binding.frameStatsText.text = frame + rois + blobs + device + ffc + motion
+    }
+    
+    // Device state is then read from rows the firmware appends below each frame instead of
+    // being polled; changing the row count restarts the stream
+    private fun setInfoLine(enabled: Boolean) {
+        lifecycleScope.launch {
+            val applied = withContext(Dispatchers.IO) {
+                nativeSetInfoLine(if (enabled) INFO_LINE_ROWS else 0, null, INFO_LINE_SENSOR_TEMP_SCALE, 0f)
+            }
+            if (applied) {
+                infoLineEnabled = enabled
+                Log.i(TAG, "📋 Info line ${if (enabled) "on, $INFO_LINE_ROWS rows" else "off"}")
+            } else {
+                showError("Info line not available on this device")
+                binding.infoLineSwitch.isChecked = infoLineEnabled
+            }
+        }
+    }
+    
+    // Keeps frame, ROI and device measurements for the session; blocks beyond the memory cap go
+    // to the cache directory, which holds at most TIMESERIES_SPILL_CAP_BYTES of them
+    private fun setTimeSeries(enabled: Boolean) {
+        val spillDirectory = java.io.File(cacheDir, TIMESERIES_SPILL_DIRECTORY)
+        spillDirectory.mkdirs()
+        nativeConfigureTimeSeries(enabled, TIMESERIES_MEMORY_CAP_BYTES, TIMESERIES_SPILL_CAP_BYTES, spillDirectory.absolutePath)
+        Log.i(TAG, "🗂️ Time series ${if (enabled) "recording" else "stopped"}")
+    }
+    
+    // The host takes FFCs at quiet moments and leaves the device's auto FFC as a looser
+    // backstop; programming the device goes over USB, so it runs off the main thread
+    private fun setFfcScheduler(enabled: Boolean) {
+        lifecycleScope.launch {
+            val applied = withContext(Dispatchers.IO) {
+                nativeConfigureFfcScheduler(enabled, FFC_TOLERANCE_C, FFC_MIN_INTERVAL_S, FFC_MAX_INTERVAL_S,
+                    FFC_LOOKAHEAD_S, 0f)
+            }
+            if (applied) {
+                ffcSchedulerEnabled = enabled
+                Log.i(TAG, "📸 Host FFC scheduling ${if (enabled) "on" else "off"}")
+            } else {
+                showError("FFC scheduler needs an open camera")
+                binding.ffcSchedulerSwitch.isChecked = ffcSchedulerEnabled
+            }
+        }
+    }
+    
+    // Tracks objects above 40 °C with the temperature stream, or above luma 200 without it
+    private fun setBlobTracking(enabled: Boolean) {
+        val threshold = if (temperatureStreamEnabled) BLOB_THRESHOLD_C else BLOB_THRESHOLD_LUMA
+        nativeSetBlobTracking(enabled, threshold, BLOB_MIN_AREA, BLOB_MAX_MATCH_DISTANCE, BLOB_MAX_MISSED_FRAMES)
+        Log.i(TAG, "🔥 Blob tracking ${if (enabled) "on, threshold $threshold" else "off"}")
+    }
+    
+    // A new ROI is placed on the current hottest pixel: a rect or circle an eighth of the frame
+    // across, or a horizontal line through it
+    private fun addRoi(shape: Int) {
+        if (nativeGetFrameStats(frameStats) < FRAME_STATS_COUNT) {
+            showError("No frame to place the ROI on yet")
+            return
+        }
+        val width = frameStats[FRAME_STATS_WIDTH].toInt()
+        val height = frameStats[FRAME_STATS_HEIGHT].toInt()
+        val x = frameStats[FRAME_STATS_MAX_X].toInt()
+        val y = frameStats[FRAME_STATS_MAX_Y].toInt()
+        val radius = max(2, min(width, height) / 16)
+        val id = when (shape) {
+            ROI_SHAPE_RECT -> nativeAddRoiRect(x - radius, y - radius, 2 * radius, 2 * radius)
+            ROI_SHAPE_CIRCLE -> nativeAddRoiPolygon(IntArray(2 * ROI_CIRCLE_VERTICES) { i ->
+                val angle = 2 * PI * (i / 2) / ROI_CIRCLE_VERTICES
+                if (i % 2 == 0) x + (radius * cos(angle)).roundToInt() else y + (radius * sin(angle)).roundToInt()
+            })
+            else -> nativeAddRoiLine(0, y, width - 1, y)
+        }
+        if (id < 0) {
+            showError("ROI not added, the limit is $MAX_ROIS")
+            return
+        }
+        roiIds.add(id)
+        Log.i(TAG, "📐 Added ROI $id (shape $shape) at ($x, $y)")
+    }
+    
+    private fun logFrameStats() {
+        if (nativeGetFrameStats(frameStats) < FRAME_STATS_COUNT) return
+        val s = frameStats
+        val extremes = "min ${s[FRAME_STATS_MIN].toInt()} at (${s[FRAME_STATS_MIN_X].toInt()}, ${s[FRAME_STATS_MIN_Y].toInt()}), " +
+                "max ${s[FRAME_STATS_MAX].toInt()} at (${s[FRAME_STATS_MAX_X].toInt()}, ${s[FRAME_STATS_MAX_Y].toInt()})"
+        val celsius = if (s[FRAME_STATS_MIN_C].isNaN()) "" else
+            String.format(Locale.US, ", %.1f..%.1f °C, mean %.1f °C ± %.2f",
+                s[FRAME_STATS_MIN_C], s[FRAME_STATS_MAX_C], s[FRAME_STATS_MEAN_C], s[FRAME_STATS_STDDEV_C])
+        Log.i(TAG, "📈 Frame ${s[FRAME_STATS_FRAME_NUMBER].toLong()} " +
+                "(${s[FRAME_STATS_WIDTH].toInt()}x${s[FRAME_STATS_HEIGHT].toInt()}, source ${s[FRAME_STATS_SOURCE].toInt()}): " +
+                "$extremes, mean ${"%.1f".format(s[FRAME_STATS_MEAN])} ± ${"%.1f".format(s[FRAME_STATS_STDDEV])}$celsius, " +
+                "computed in ${s[FRAME_STATS_COMPUTE_US].toLong()} us")
+        logRoiResults()
+        logTrackedBlobs()
+        logFrameMetadata()
+        logTimeSeries()
+        logAlarmStats()
+        logFfcEstimate()
+        logDenoiseStats()
+        logMotionState()
+    }
+    
+    // Alarm transitions are evaluated natively per frame; recording is started from here
+    private fun pollAlarmEvents() {
+        val count = nativeGetAlarmEvents(alarmEvents)
+        for (i in 0 until count) {
+            val base = i * ALARM_EVENT_STRIDE
+            val e = alarmEvents
+            val triggered = e[base + ALARM_EVENT_TRIGGERED] != 0.0
+            val actions = e[base + ALARM_EVENT_ACTIONS].toInt()
+            Log.i(TAG, String.format(Locale.US, "🚨 Alarm %d %s at %.2f (frame time %d us)",
+                e[base + ALARM_EVENT_RULE_ID].toInt(), if (triggered) "triggered" else "cleared",
+                e[base + ALARM_EVENT_VALUE], e[base + ALARM_EVENT_TIMESTAMP_US].toLong()))
+            if (triggered && (actions and ALARM_ACTION_RECORD) != 0 &&
+                ::videoRecorder.isInitialized && !videoRecorder.isRecording()) {
+                startVideoRecording()
+            }
+        }
+    }
+    
+    private fun logAlarmStats() {
+        if (nativeGetAlarmStats(alarmStats) < ALARM_STATS_COUNT || alarmStats[ALARM_STATS_RULES] == 0L) return
+        val a = alarmStats
+        Log.i(TAG, "🚨 ${a[ALARM_STATS_RULES]} alarm rules: ${a[ALARM_STATS_EVALUATIONS]} evaluations, " +
+                "${a[ALARM_STATS_EVENTS]} events (${a[ALARM_STATS_DROPPED_EVENTS]} dropped), " +
+                "last ${a[ALARM_STATS_LAST_NS] / 1000.0} us, mean ${a[ALARM_STATS_MEAN_NS] / 1000.0} us, " +
+                "max ${a[ALARM_STATS_MAX_NS] / 1000.0} us")
+    }
+    
+    private fun logFfcEstimate() {
+        if (nativeGetFfcEstimate(ffcEstimate) < FFC_ESTIMATE_COUNT) return
+        val f = ffcEstimate
+        Log.i(TAG, String.format(Locale.US, "📸 Next FFC in %.0f s (last %.0f s ago): sensor %.2f °C, drift %+.2f °C, " +
+                "%+.3f °C/min, pattern noise %.3f, scene %s%s, %d host / %d device FFCs",
+            f[FFC_SECONDS_TO_NEXT], f[FFC_SECONDS_SINCE_LAST], f[FFC_SENSOR_TEMP_C], f[FFC_DRIFT_C],
+            f[FFC_SLOPE_C_PER_MIN], f[FFC_FPN], if (f[FFC_SCENE_STATIC] != 0.0) "static" else "moving",
+            if (f[FFC_HOLD] != 0.0) ", held" else "", f[FFC_HOST_COUNT].toLong(), f[FFC_DEVICE_COUNT].toLong()))
+    }
+    
+    // Rotate and mirror the picture on the host, for mounts the device's MIRROR_AND_FLIP can't
+    // express; recording and capture keep the sensor orientation
+    private fun setDisplayOrientation(rotation: Int, mirror: Boolean = false, flip: Boolean = false): Boolean {
+        if (nativeSetDisplayOrientation(rotation, mirror, flip) != 0) return false
+        displayRotation = ((rotation % 360) + 360) % 360
+        displayMirror = mirror
+        updateLayoutForOrientation(resources.configuration.orientation)
+        Log.i(TAG, "🔄 Display orientation: ${displayRotation}°${if (mirror) ", mirrored" else ""}${if (flip) ", flipped" else ""}")
+        return true
+    }
+    
+    // Record only while the scene changes: the recording starts with the native pre-roll and
+    // stops once the detector has been quiet for holdOffMs
+    private fun setMotionRecording(enabled: Boolean, threshold: Int = 6, activeFraction: Float = 0.002f,
+                                   holdOffMs: Int = 3000, preRollMs: Int = 2000): Boolean {
+        if (nativeSetMotionRecording(enabled, threshold, activeFraction, holdOffMs, preRollMs) != 0) return false
+        motionRecordingArmed = enabled
+        // A recording the detector started ends with it
+        if (!enabled && motionStartedRecording && ::videoRecorder.isInitialized && videoRecorder.isRecording()) {
+            stopVideoRecording()
+        }
+        motionStartedRecording = false
+        Log.i(TAG, "🏃 Motion-triggered recording ${if (enabled) "armed" else "disarmed"}")
+        return true
+    }
+    
+    private fun pollMotionRecording() {
+        if (!motionRecordingArmed || !::videoRecorder.isInitialized) return
+        if (nativeGetMotionState(motionState) < MOTION_STATE_COUNT) return
+        val active = motionState[MOTION_ACTIVE] != 0.0
+        if (active && !videoRecorder.isRecording()) {
+            startVideoRecording()
+            motionStartedRecording = videoRecorder.isRecording()
+            if (!motionStartedRecording) {
+                // startVideoRecording() already reported why; retrying every frame would repeat it
+                Log.w(TAG, "🏃 Motion recording could not start, disarming")
+                setMotionRecording(false)
+                binding.motionRecordingSwitch.isChecked = false
+            }
+        } else if (!active && motionStartedRecording && videoRecorder.isRecording()) {
+            motionStartedRecording = false
+            stopVideoRecording()
+        }
+    }
+    
+    private fun logMotionState() {
+        if (!motionRecordingArmed || nativeGetMotionState(motionState) < MOTION_STATE_COUNT) return
+        val m = motionState
+        Log.i(TAG, String.format(Locale.US, "🏃 Motion %s, score %.4f, %d activations, %d pre-roll frames, " +
+                "detection %.1f us (mean %.1f us)", if (m[MOTION_ACTIVE] != 0.0) "active" else "quiet",
+            m[MOTION_SCORE], m[MOTION_ACTIVATIONS].toLong(), m[MOTION_PRE_ROLL_FRAMES].toLong(),
+            m[MOTION_LAST_NS] / 1000.0, m[MOTION_MEAN_NS] / 1000.0))
+    }
+    
+    private fun logDenoiseStats() {
+        if (nativeGetDenoiseStats(denoiseStats) < DENOISE_STATS_COUNT || denoiseStats[DENOISE_STATS_FRAMES] == 0L) return
+        val d = denoiseStats
+        Log.i(TAG, "🧹 Denoised ${d[DENOISE_STATS_FRAMES]} frames: last ${d[DENOISE_STATS_LAST_NS] / 1000.0} us, " +
+                "mean ${d[DENOISE_STATS_MEAN_NS] / 1000.0} us, max ${d[DENOISE_STATS_MAX_NS] / 1000.0} us")
+    }
+    
+    private fun logTimeSeries() {
+        if (!binding.timeSeriesSwitch.isChecked) return
+        val count = nativeQueryTimeSeries("frame.max", 0, Long.MAX_VALUE, timeSeriesBuckets)
+        if (count <= 0) return
+        val b = timeSeriesBuckets
+        val history = (0 until count).joinToString(", ") { i ->
+            val base = i * TIMESERIES_STRIDE
+            String.format(Locale.US, "%.1f/%.1f/%.1f", b[base + TIMESERIES_MIN], b[base + TIMESERIES_MEAN], b[base + TIMESERIES_MAX])
+        }
+        val spanS = (b[(count - 1) * TIMESERIES_STRIDE + TIMESERIES_START_US] - b[TIMESERIES_START_US]) / 1e6
+        Log.i(TAG, "🗂️ Frame max history (min/mean/max over ${"%.0f".format(spanS)} s): $history; " +
+                "series ${nativeGetTimeSeriesNames().joinToString(", ")}")
+    }
+    
+    private fun logFrameMetadata() {
+        if (nativeGetFrameMetadata(frameMetadata) < METADATA_COUNT) return
+        val m = frameMetadata
+        val sensorTemp = if (m[METADATA_SENSOR_TEMP_MILLI_C] == Long.MIN_VALUE) "n/a"
+            else "${m[METADATA_SENSOR_TEMP_MILLI_C] / 1000.0} °C"
+        Log.i(TAG, "📋 Info line of frame ${m[METADATA_FRAME_NUMBER]}: device frame ${m[METADATA_DEVICE_FRAME_COUNTER]} " +
+                "(${m[METADATA_DEVICE_FRAMES_SKIPPED]} skipped), shutter ${m[METADATA_SHUTTER_STATUS]}, " +
+                "auto shutter ${m[METADATA_AUTO_SHUTTER_STATUS]}, FFC ${if (m[METADATA_FFC_IN_PROGRESS] != 0L) "running" else "idle"} " +
+                "(${m[METADATA_FFC_COUNT]} so far), model status ${m[METADATA_MODEL_STATUS]}, " +
+                "TPD format ${m[METADATA_TPD_FORMAT]}, mirror ${m[METADATA_MIRROR]}, flip ${m[METADATA_FLIP]}, sensor $sensorTemp")
+    }
+    
+    private fun logTrackedBlobs() {
+        val count = nativeGetTrackedBlobs(trackedBlobs)
+        for (i in 0 until count) {
+            val base = i * BLOB_STRIDE
+            val b = trackedBlobs
+            Log.i(TAG, String.format(Locale.US,
+                "🔥 Blob %d (%d frames): %d px at (%.1f, %.1f), peak %.1f at (%d, %d), box %d,%d-%d,%d, moving (%.1f, %.1f) px/frame",
+                b[base + BLOB_ID].toInt(), b[base + BLOB_AGE].toInt(), b[base + BLOB_AREA].toInt(),
+                b[base + BLOB_CENTROID_X], b[base + BLOB_CENTROID_Y],
+                b[base + BLOB_PEAK], b[base + BLOB_PEAK_X].toInt(), b[base + BLOB_PEAK_Y].toInt(),
+                b[base + BLOB_LEFT].toInt(), b[base + BLOB_TOP].toInt(), b[base + BLOB_RIGHT].toInt(), b[base + BLOB_BOTTOM].toInt(),
+                b[base + BLOB_VELOCITY_X], b[base + BLOB_VELOCITY_Y]))
+        }
+    }
+    
+    private fun logRoiResults() {
+        val count = nativeGetRoiResults(roiResults)
+        for (i in 0 until count) {
+            val base = i * ROI_RESULT_STRIDE
+            val r = roiResults
+            if (r[base + ROI_RESULT_PIXEL_COUNT] == 0f) continue
+            Log.i(TAG, String.format(Locale.US,
+                "📐 ROI %d (%d px): mean %.2f, variance %.3f, min %.2f at (%d, %d), max %.2f at (%d, %d)",
+                r[base + ROI_RESULT_ID].toInt(), r[base + ROI_RESULT_PIXEL_COUNT].toInt(),
+                r[base + ROI_RESULT_MEAN], r[base + ROI_RESULT_VARIANCE],
+                r[base + ROI_RESULT_MIN], r[base + ROI_RESULT_MIN_X].toInt(), r[base + ROI_RESULT_MIN_Y].toInt(),
+                r[base + ROI_RESULT_MAX], r[base + ROI_RESULT_MAX_X].toInt(), r[base + ROI_RESULT_MAX_Y].toInt()))
+        }
+    }
+    
     private fun restartCameraWithNewFrameRate(device: UsbDevice, deviceConfig: DeviceConfig) {
         try {
             Log.i(TAG, "🔄 Restarting camera with new framerate: ${deviceConfig.fps}fps")
@@ -1555,6 +2596,12 @@ class CameraActivity : AppCompatActivity() {
                 
                 Log.i(TAG, "🎯 Captured raw thermal frame: ${rawFrameData.width}x${rawFrameData.height}, ${rawFrameData.data.size} bytes")
                 
+                if (temperatureStreamEnabled) {
+                    withContext(Dispatchers.IO) {
+                        saveTemperatureFrame()
+                    }
+                }
+                
                 // Convert raw YUYV to display bitmap for comparison
                 val originalBitmap = convertYUYVToBitmap(rawFrameData)
                 
@@ -1610,18 +2657,19 @@ class CameraActivity : AppCompatActivity() {
                 return@withContext null
             }
             
-            val frameData = nativeGetCapturedFrame()
-            if (frameData == null || frameData.size < 8) {
+            // Native code copies the frame straight into the preallocated direct buffer
+            val size = nativeReadCapturedFrame(captureBuffer, captureDims)
+            if (size <= 0) {
                 Log.e(TAG, "Invalid frame data received")
                 return@withContext null
             }
             
-            // Extract width and height from first 8 bytes
-            val width = ByteBuffer.wrap(frameData, 0, 4).order(ByteOrder.LITTLE_ENDIAN).int
-            val height = ByteBuffer.wrap(frameData, 4, 4).order(ByteOrder.LITTLE_ENDIAN).int
+            val width = captureDims[0]
+            val height = captureDims[1]
             
-            // Extract YUYV data (skip first 8 bytes)
-            val yuvData = frameData.copyOfRange(8, frameData.size)
+            val yuvData = ByteArray(size)
+            captureBuffer.clear()
+            captureBuffer.get(yuvData, 0, size)
             
             Log.i(TAG, "📸 Raw frame captured: ${width}x${height}, ${yuvData.size} bytes YUYV")
             
@@ -2157,6 +3205,7 @@ class CameraActivity : AppCompatActivity() {
         recordingDurationUpdateJob?.cancel()
         
         Log.i(TAG, "🛑 Video recording stopped")
+        logStreamTimings()
         showSuccess("Recording saved to gallery!")
     }
     
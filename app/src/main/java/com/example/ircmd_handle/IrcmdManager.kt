@@ -41,6 +41,11 @@ class IrcmdManager private constructor() {
         const val ERROR_FUNCTION_NOT_FOUND = -1001
         const val ERROR_INVALID_HANDLE = -1002
         const val ERROR_REGISTRY_ERROR = -1004
+        const val ERROR_OUT_OF_RANGE = -1005
+        const val ERROR_VALUE_UNKNOWN = -1006
+        
+        // Batch entry result: value already applied, no command sent
+        const val RESULT_SKIPPED_UNCHANGED = 1
         
         // Function types for registry
         const val FUNCTION_TYPE_SET = 0
@@ -107,6 +112,10 @@ class IrcmdManager private constructor() {
             const val MIRROR_AND_FLIP = 5006
             const val AUTO_FFC_STATUS = 5007
             const val ALL_FFC_FUNCTION_STATUS = 5008
+            const val STREAM_SOURCE_MODE = 5009
+            const val AUTO_FFC_TEMP_THRESHOLD = 5010
+            const val AUTO_FFC_MIN_INTERVAL = 5011
+            const val AUTO_FFC_MAX_INTERVAL = 5012
         }
     }
     
@@ -126,10 +135,41 @@ class IrcmdManager private constructor() {
     private external fun nativeExecuteRegistryActionFunction(functionId: Int): Int
     private external fun nativeIsFunctionSupported(functionType: Int, functionId: Int): Boolean
     private external fun nativeGetRegisteredFunctionCount(): Int
+    private external fun nativeExecuteRegistryBatch(entries: IntArray): IntArray?
+    private external fun nativeSetRegistryVerboseLogging(enabled: Boolean)
+    private external fun nativeGetParameterState(functionId: Int, out: LongArray): Boolean
+    private external fun nativeRestoreSavedParameters(): Int
     
     // Wrapper class for passing reference values via JNI
     class MutableIntWrapper(var value: Int)
     
+    /**
+     * One parameter of a batched update
+     * @param functionId The function ID from CameraFunctionId
+     * @param value The value to set
+     * @param value2 The second value, only used by two-parameter functions
+     */
+    data class ParameterEntry(val functionId: Int, val value: Int, val value2: Int = 0)
+    
+    /**
+     * Native shadow state of one parameter
+     * @param hasValue Whether a SET succeeded since connect (image levels are forgotten on scene mode changes)
+     * @param hasRange Whether the device reported a range at connect time
+     * @param version Increases with every successful SET, across all parameters
+     * @param timestampUs Monotonic time of the SET that produced value
+     */
+    data class ParameterState(
+        val hasValue: Boolean,
+        val hasRange: Boolean,
+        val value: Int,
+        val value2: Int,
+        val version: Long,
+        val timestampUs: Long,
+        val minValue: Int,
+        val maxValue: Int,
+        val step: Int
+    )
+    
     // State tracking
     private var isInitialized = false
     
@@ -377,7 +417,7 @@ class IrcmdManager private constructor() {
      * Execute a registry-based set function with a value parameter
      * @param functionId The function ID from CameraFunctionId
      * @param value The value to set
-     * @return 0 on success, negative error code on failure
+     * @return 0 on success, ERROR_OUT_OF_RANGE if the device range excludes value, or another negative error code
      */
     fun executeRegistrySetFunction(functionId: Int, value: Int): Int {
         if (!isInitialized) {
@@ -407,7 +447,9 @@ class IrcmdManager private constructor() {
     }
     
     /**
-     * Execute a registry-based get function
+     * Execute a registry-based get function.
+     * The value comes from the native parameter store, not the device; ERROR_VALUE_UNKNOWN
+     * is returned until the parameter has been set since connect.
      * @param functionId The function ID from CameraFunctionId
      * @return a pair of (result code, value) where result code is 0 on success
      */
@@ -424,6 +466,85 @@ class IrcmdManager private constructor() {
         return Pair(code, result.value)
     }
     
+    /**
+     * Re-apply the settings saved for this device when it was last disconnected.
+     * Call after both init() and the UVC camera open have completed.
+     * @return the number of parameters restored, or a negative error code
+     */
+    fun restoreSavedParameters(): Int {
+        if (!isInitialized) {
+            Log.e(TAG, "Cannot restore parameters: IrcmdManager not initialized")
+            return ERROR_NOT_INITIALIZED
+        }
+        
+        val result = nativeRestoreSavedParameters()
+        Log.d(TAG, "Restored saved parameters: $result")
+        return result
+    }
+    
+    /**
+     * Read the native shadow state of a parameter. No command is sent to the device.
+     * @param functionId The function ID from CameraFunctionId
+     * @return the state, or null for unknown IDs or when not initialized
+     */
+    fun getParameterState(functionId: Int): ParameterState? {
+        if (!isInitialized) {
+            return null
+        }
+        
+        val out = LongArray(9)
+        if (!nativeGetParameterState(functionId, out)) {
+            return null
+        }
+        return ParameterState(
+            hasValue = out[0] != 0L,
+            hasRange = out[1] != 0L,
+            value = out[2].toInt(),
+            value2 = out[3].toInt(),
+            version = out[4],
+            timestampUs = out[5],
+            minValue = out[6].toInt(),
+            maxValue = out[7].toInt(),
+            step = out[8].toInt()
+        )
+    }
+    
+    /**
+     * Apply several registry SET functions in a single native call.
+     * Entries are applied in dependency order (e.g. scene mode before image levels) and
+     * entries whose value is already applied on the device are skipped.
+     * @param entries The parameters to apply
+     * @return one result per entry: 0 on success, RESULT_SKIPPED_UNCHANGED, or a negative error code
+     */
+    fun applyParameterBatch(entries: List<ParameterEntry>): IntArray {
+        if (!isInitialized) {
+            Log.e(TAG, "Cannot execute registry batch: IrcmdManager not initialized")
+            return IntArray(entries.size) { ERROR_NOT_INITIALIZED }
+        }
+        
+        val payload = IntArray(entries.size * 3)
+        entries.forEachIndexed { i, entry ->
+            payload[i * 3] = entry.functionId
+            payload[i * 3 + 1] = entry.value
+            payload[i * 3 + 2] = entry.value2
+        }
+        
+        val results = nativeExecuteRegistryBatch(payload) ?: IntArray(entries.size) { ERROR_UNKNOWN }
+        
+        // Keep the locally tracked values in sync with what reached the device
+        entries.forEachIndexed { i, entry ->
+            if (results[i] == ERROR_SUCCESS) {
+                when (entry.functionId) {
+                    CameraFunctionId.BRIGHTNESS -> lastBrightnessValue = entry.value
+                    CameraFunctionId.CONTRAST -> lastContrastValue = entry.value
+                }
+            }
+        }
+        
+        Log.d(TAG, "Executed registry batch of ${entries.size} entries: ${results.joinToString(", ")}")
+        return results
+    }
+    
     // ===== FRAMERATE CONTROL FUNCTIONS =====
     
     /**
@@ -521,6 +642,13 @@ class IrcmdManager private constructor() {
         return nativeGetRegisteredFunctionCount()
     }
     
+    /**
+     * Enable per-command logging in the native function registry (off by default)
+     */
+    fun setRegistryVerboseLogging(enabled: Boolean) {
+        nativeSetRegistryVerboseLogging(enabled)
+    }
+    
     /**
      * NEW: Set brightness using registry-based approach
      * @param level The brightness level (0-100)
@@ -739,4 +867,17 @@ class IrcmdManager private constructor() {
         }
         return executeRegistrySetFunction(Companion.CameraFunctionId.ALL_FFC_FUNCTION_STATUS, status)
     }
+    
+    /**
+     * Set the intermediate stream source (adv_stream_source_mode_e)
+     * @param mode 9=temperature (TPD), 11=picture after all algorithms; see libircmd.h for the rest
+     * @return 0 on success, negative error code on failure
+     */
+    fun setStreamSourceMode(mode: Int): Int {
+        if (mode < 0 || mode > 11) {
+            Log.e(TAG, "Invalid stream source mode: $mode")
+            return ERROR_INVALID_PARAM
+        }
+        return executeRegistrySetFunction(Companion.CameraFunctionId.STREAM_SOURCE_MODE, mode)
+    }
 } 
\ No newline at end of file
@@ -93,9 +93,10 @@ class VideoRecorder(private val context: Context) {
     private external fun nativeStopDirectRecording()
     private external fun nativeCleanupDirectRecording()
     
-    // Native callback for direct YUV frame data
+    // Native callback for direct YUV frame data; yuvData is a native direct buffer
+    // that is only valid during this call
     @Suppress("unused") // Called from native code
-    private fun onNativeYUVFrame(yuvData: ByteArray, width: Int, height: Int, timestampUs: Long) {
+    private fun onNativeYUVFrame(yuvData: ByteBuffer, width: Int, height: Int, timestampUs: Long) {
         if (!isRecording.get() || isPaused.get()) {
             return
         }
@@ -111,7 +112,10 @@ class VideoRecorder(private val context: Context) {
             val inputBufferIndex = encoder.dequeueInputBuffer(TIMEOUT_USEC)
             if (inputBufferIndex >= 0) {
                 val inputBuffer = encoder.getInputBuffer(inputBufferIndex)
-                if (inputBuffer != null && yuvData.size <= inputBuffer.capacity()) {
+                // The same buffer is passed for every frame, so start from its beginning
+                yuvData.rewind()
+                val frameSize = yuvData.remaining()
+                if (inputBuffer != null && frameSize <= inputBuffer.capacity()) {
                     inputBuffer.clear()
                     inputBuffer.put(yuvData)
                     
@@ -119,7 +123,7 @@ class VideoRecorder(private val context: Context) {
                     encoder.queueInputBuffer(
                         inputBufferIndex,
                         0,
-                        yuvData.size,
+                        frameSize,
                         timestampUs,
                         0
                     )
@@ -133,7 +137,7 @@ class VideoRecorder(private val context: Context) {
                         }
                     }
                 } else {
-                    Log.w(TAG, "Input buffer too small or null: buffer capacity=${inputBuffer?.capacity()}, data size=${yuvData.size}")
+                    Log.w(TAG, "Input buffer too small or null: buffer capacity=${inputBuffer?.capacity()}, data size=$frameSize")
                     encoder.queueInputBuffer(inputBufferIndex, 0, 0, 0, 0)
                 }
             } else {
@@ -0,0 +1,173 @@
+// Host benchmark: BlobTracker on a synthetic scene.
+//
+// The scene is a noisy 20 °C background with hot discs (60 °C at the center, falling off
+// to the edge), each circling its own point at its own speed. Every frame is labeled and
+// tracked. The benchmark reports the mean and worst time per frame. It checks that each disc
+// is still tracked at the end under the id it got first, and that disabling the tracker
+// clears its tracks. The temperature plane and the luma fallback (YUYV image only) run at
+// 256x192 and 640x512.
+//
+// Build and run from the repository root; android/log.h is taken from the NDK sysroot,
+// after the host headers (one command line):
+//
+//   g++ -std=gnu++17 -O2 -Iapp/src/main/cpp
+//       -idirafter $ANDROID_NDK_HOME/toolchains/llvm/prebuilt/linux-x86_64/sysroot/usr/include
+//       bench_blob_tracker.cpp app/src/main/cpp/blob_tracker.cpp app/src/main/cpp/trace_ring.cpp -lpthread -o bench_blob_tracker
+//   ./bench_blob_tracker
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+#include "app/src/main/cpp/blob_tracker.h"
+
+extern "C" int __android_log_print(int /* prio */, const char* /* tag */, const char* /* fmt */, ...) {
+    return 0;
+}
+
+namespace {
+
+constexpr int kFrames = 600;
+constexpr int kWarmupFrames = 30;
+constexpr int kDiscs = 8;
+constexpr float kBackgroundC = 20.0f;
+constexpr float kPeakC = 60.0f;
+constexpr float kThresholdC = 35.0f;
+
+struct Disc {
+    float x, y;             // Center of the orbit
+    float orbit;            // Orbit radius, pixels
+    float speed;            // Radians per frame
+    float radius;
+};
+
+class Scene {
+public:
+    Scene(int width, int height) : width_(width), height_(height),
+                                   celsius_(static_cast<size_t>(width) * height),
+                                   yuyv_(static_cast<size_t>(width) * height * 2, 128),
+                                   noise_(static_cast<size_t>(width) * height) {
+        std::mt19937 random(7);
+        std::normal_distribution<float> noise(0.0f, 0.5f);
+        for (float& n : noise_) {
+            n = noise(random);
+        }
+        // Discs on a 4x2 grid; the orbits keep them apart and inside the frame
+        const float radius = std::max(3.0f, std::min(width, height) / 24.0f);
+        for (int i = 0; i < kDiscs; i++) {
+            const float column = (i % 4 + 0.5f) / 4.0f;
+            const float row = (i / 4 + 0.5f) / 2.0f;
+            const float speed = (i % 2 ? 1.0f : -1.0f) * (0.03f + 0.005f * i);
+            discs_.push_back({column * width, row * height, width / 16.0f, speed, radius});
+        }
+    }
+
+    ThermalFrame render(int frame, bool withCelsius) {
+        // Noise pattern shifted per frame so no two frames are identical
+        const size_t shift = static_cast<size_t>(frame) * 7919 % noise_.size();
+        for (size_t i = 0; i < celsius_.size(); i++) {
+            celsius_[i] = kBackgroundC + noise_[(i + shift) % noise_.size()];
+        }
+        for (const Disc& disc : discs_) {
+            const float cx = disc.x + disc.orbit * std::cos(disc.speed * frame);
+            const float cy = disc.y + disc.orbit * std::sin(disc.speed * frame);
+            const int x0 = std::max(0, static_cast<int>(cx - disc.radius));
+            const int x1 = std::min(width_ - 1, static_cast<int>(cx + disc.radius));
+            const int y0 = std::max(0, static_cast<int>(cy - disc.radius));
+            const int y1 = std::min(height_ - 1, static_cast<int>(cy + disc.radius));
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    const float d = std::hypot(x - cx, y - cy) / disc.radius;
+                    if (d < 1.0f) {
+                        float& value = celsius_[static_cast<size_t>(y) * width_ + x];
+                        value = std::max(value, kPeakC - (kPeakC - kBackgroundC) * d * d);
+                    }
+                }
+            }
+        }
+
+        ThermalFrame thermal = {};
+        thermal.width = width_;
+        thermal.height = height_;
+        thermal.timestampUs = static_cast<int64_t>(frame) * 33333;
+        if (withCelsius) {
+            thermal.celsius = celsius_.data();
+        } else {
+            // Luma = 4 counts per °C above 0, as a white-hot palette would show it
+            for (size_t i = 0; i < celsius_.size(); i++) {
+                yuyv_[i * 2] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, celsius_[i] * 4.0f)));
+            }
+            thermal.image = yuyv_.data();
+        }
+        return thermal;
+    }
+
+private:
+    int width_;
+    int height_;
+    std::vector<float> celsius_;
+    std::vector<uint8_t> yuyv_;
+    std::vector<float> noise_;
+    std::vector<Disc> discs_;
+};
+
+void run(int width, int height, bool withCelsius) {
+    Scene scene(width, height);
+    BlobTracker tracker;
+    BlobTrackerParams params;
+    params.enabled = true;
+    params.threshold = withCelsius ? kThresholdC : kThresholdC * 4.0f;
+    tracker.configure(params);
+
+    // Only process() is timed, not rendering
+    std::vector<TrackedBlob> tracks;
+    std::set<int> firstIds;
+    double totalUs = 0.0;
+    double worstUs = 0.0;
+    for (int frame = 0; frame < kWarmupFrames + kFrames; frame++) {
+        const ThermalFrame thermal = scene.render(frame, withCelsius);
+        const auto start = std::chrono::steady_clock::now();
+        tracker.process(thermal);
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (frame == 0) {
+            tracker.getTracks(&tracks);
+            for (const TrackedBlob& blob : tracks) {
+                firstIds.insert(blob.id);
+            }
+        }
+        if (frame >= kWarmupFrames) {
+            totalUs += us;
+            worstUs = std::max(worstUs, us);
+        }
+    }
+
+    tracker.getTracks(&tracks);
+    int kept = 0;
+    for (const TrackedBlob& blob : tracks) {
+        kept += firstIds.count(blob.id) ? 1 : 0;
+    }
+    const size_t tracked = tracks.size();
+
+    params.enabled = false;
+    tracker.configure(params);
+    tracker.process(scene.render(0, withCelsius));
+    tracker.getTracks(&tracks);
+
+    printf("  %4dx%-4d %-8s %7.1f us/frame (worst %7.1f), %zu/%d tracked, %d kept their first id, "
+           "%zu left after disable\n", width, height, withCelsius ? "celsius" : "luma", totalUs / kFrames,
+           worstUs, tracked, kDiscs, kept, tracks.size());
+}
+
+}
+
+int main() {
+    printf("BlobTracker, %d moving hot discs, %d frames\n", kDiscs, kFrames);
+    run(256, 192, true);
+    run(256, 192, false);
+    run(640, 512, true);
+    run(640, 512, false);
+    return 0;
+}
@@ -0,0 +1,199 @@
+// Host microbenchmark: registry dispatch before and after the constexpr table.
+//
+// "map" is the registry as it was before the table (unordered_map of std::function per
+// operation type, REGISTRY_LOGI on every call); "map, no log" is the same lookup with the
+// per-call logging taken out; "table" is the current CameraFunctionRegistry, trace ring
+// included. Every ID with both a SET and a GET is cycled through. The SDK calls are stubs,
+// so only the dispatch and the logging in front of them are measured. The log stub formats
+// the message like liblog does but does not send it to logd, so on a device the old path
+// costs more than shown here.
+//
+// Build and run from the repository root; android/log.h is taken from the NDK sysroot,
+// after the host headers (one command line):
+//
+//   g++ -std=gnu++17 -O2 -Iapp/src/main/cpp -Iapp/src/main/cpp/Include
+//       -idirafter $ANDROID_NDK_HOME/toolchains/llvm/prebuilt/linux-x86_64/sysroot/usr/include
+//       bench_registry_dispatch.cpp app/src/main/cpp/camera_function_registry.cpp
+//       app/src/main/cpp/trace_ring.cpp -lpthread -o bench_registry_dispatch
+//   ./bench_registry_dispatch
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "app/src/main/cpp/camera_function_registry.h"
+
+// Formats like liblog, then drops the message
+extern "C" int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    char buffer[1024];
+    va_list args;
+    va_start(args, fmt);
+    const int length = vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    return prio == 0 ? buffer[0] : length;
+}
+
+extern "C" int __android_log_write(int prio, const char* tag, const char* text) {
+    return 0;
+}
+
+// Stubs of the SDK calls in the dispatch table
+#define SDK_STUB(name, ...) \
+    extern "C" IrlibError_e name(IrcmdHandle_t*, __VA_ARGS__) { return IRLIB_SUCCESS; }
+#define SDK_STUB_GET(name) \
+    extern "C" IrlibError_e name(IrcmdHandle_t*, int* value) { *value = 50; return IRLIB_SUCCESS; }
+
+SDK_STUB(adv_analog_video_output_set, int, int)
+SDK_STUB(adv_device_sleep_set, int)
+SDK_STUB_GET(adv_edge_enhance_get)
+SDK_STUB(adv_edge_enhance_set, int)
+SDK_STUB(adv_output_frame_rate_set, int)
+SDK_STUB(adv_picture_freeze_status_set, int)
+SDK_STUB(adv_shutter_status_set, int)
+SDK_STUB_GET(adv_stream_source_mode_get)
+SDK_STUB(adv_stream_source_mode_set, int)
+SDK_STUB(adv_yuv_format_set, int)
+SDK_STUB(basic_all_ffc_function_status_set, int)
+SDK_STUB(basic_attribute_of_agc_level_get, param_attribute_t*)
+SDK_STUB(basic_attribute_of_brightness_level_get, param_attribute_t*)
+SDK_STUB(basic_attribute_of_contrast_level_get, param_attribute_t*)
+SDK_STUB(basic_attribute_of_detail_enhance_level_get, param_attribute_t*)
+SDK_STUB(basic_attribute_of_global_contrast_level_get, param_attribute_t*)
+SDK_STUB(basic_attribute_of_noise_reduction_level_get, param_attribute_t*)
+SDK_STUB(basic_attribute_of_roi_level_get, param_attribute_t*)
+SDK_STUB(basic_attribute_of_scene_mode_get, param_attribute_t*)
+SDK_STUB(basic_auto_ffc_current_params_get, int, int*)
+SDK_STUB(basic_auto_ffc_current_params_set, int, int)
+SDK_STUB(basic_auto_ffc_params_attribute_get, int, param_attribute_t*)
+SDK_STUB(basic_auto_ffc_status_set, int)
+SDK_STUB_GET(basic_current_agc_level_get)
+SDK_STUB_GET(basic_current_brightness_level_get)
+SDK_STUB_GET(basic_current_contrast_level_get)
+SDK_STUB_GET(basic_current_detail_enhance_level_get)
+SDK_STUB_GET(basic_current_image_noise_reduction_level_get)
+SDK_STUB_GET(basic_current_image_roi_level_get)
+SDK_STUB_GET(basic_current_image_scene_mode_get)
+extern "C" IrlibError_e basic_ffc_update(IrcmdHandle_t*) { return IRLIB_SUCCESS; }
+SDK_STUB_GET(basic_global_contrast_level_get)
+SDK_STUB(basic_global_contrast_level_set, int)
+SDK_STUB(basic_image_agc_level_set, int)
+SDK_STUB(basic_image_brightness_level_set, int)
+SDK_STUB(basic_image_contrast_level_set, int)
+SDK_STUB(basic_image_detail_enhance_level_set, int)
+SDK_STUB(basic_image_noise_reduction_level_set, int)
+SDK_STUB(basic_image_roi_level_set, int)
+SDK_STUB(basic_image_scene_mode_set, int)
+SDK_STUB(basic_mirror_and_flip_status_set, int)
+SDK_STUB_GET(basic_palette_idx_get)
+SDK_STUB(basic_palette_idx_set, int)
+SDK_STUB(basic_space_noise_reduce_attribute_get, param_attribute_t*)
+SDK_STUB(basic_space_noise_reduce_level_set, int)
+SDK_STUB(basic_time_noise_reduce_attribute_get, param_attribute_t*)
+SDK_STUB(basic_time_noise_reduce_level_set, int)
+
+namespace {
+
+// The map-based registry as of the baseline, reduced to the SET/GET paths
+class MapRegistry {
+public:
+    using SetFunction = std::function<int(IrcmdHandle_t*, int)>;
+    using GetFunction = std::function<int(IrcmdHandle_t*, int*)>;
+
+    MapRegistry(const std::vector<CameraFunctionId>& ids, bool logging) : logging_(logging) {
+        for (CameraFunctionId id : ids) {
+            setFunctions_[id] = [](IrcmdHandle_t* handle, int value) -> int {
+                return static_cast<int>(basic_image_brightness_level_set(handle, value));
+            };
+            getFunctions_[id] = [](IrcmdHandle_t* handle, int* value) -> int {
+                return static_cast<int>(basic_current_brightness_level_get(handle, value));
+            };
+        }
+    }
+
+    int executeSetFunction(CameraFunctionId id, IrcmdHandle_t* handle, int value) {
+        if (!handle) {
+            return static_cast<int>(RegistryError::INVALID_HANDLE);
+        }
+        auto it = setFunctions_.find(id);
+        if (it == setFunctions_.end()) {
+            return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
+        }
+        if (logging_) {
+            REGISTRY_LOGI("Executing SET function ID: %d with value: %d", static_cast<int>(id), value);
+        }
+        return it->second(handle, value);
+    }
+
+    int executeGetFunction(CameraFunctionId id, IrcmdHandle_t* handle, int* value) {
+        if (!handle || !value) {
+            return static_cast<int>(RegistryError::INVALID_PARAMETER);
+        }
+        auto it = getFunctions_.find(id);
+        if (it == getFunctions_.end()) {
+            return static_cast<int>(RegistryError::FUNCTION_NOT_FOUND);
+        }
+        if (logging_) {
+            REGISTRY_LOGI("Executing GET function ID: %d", static_cast<int>(id));
+        }
+        int result = it->second(handle, value);
+        if (result == 0 && logging_) {
+            REGISTRY_LOGI("GET function ID: %d returned value: %d", static_cast<int>(id), *value);
+        }
+        return result;
+    }
+
+private:
+    bool logging_;
+    std::unordered_map<CameraFunctionId, SetFunction> setFunctions_;
+    std::unordered_map<CameraFunctionId, GetFunction> getFunctions_;
+};
+
+constexpr int kIterations = 2000000;
+
+// One SET and one GET per iteration, cycling through ids; returns ns per call
+template <typename Registry>
+double measure(Registry& registry, const std::vector<CameraFunctionId>& ids, long* checksum) {
+    IrcmdHandle_t* handle = reinterpret_cast<IrcmdHandle_t*>(checksum);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        const CameraFunctionId id = ids[i % ids.size()];
+        int value = 0;
+        *checksum += registry.executeSetFunction(id, handle, i & 0xff);
+        *checksum += registry.executeGetFunction(id, handle, &value) + value;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (2.0 * kIterations);
+}
+
+}
+
+int main() {
+    CameraFunctionRegistry& table = CameraFunctionRegistry::getInstance();
+    std::vector<CameraFunctionId> ids;
+    for (int i = 0; i < kFunctionCount; i++) {
+        const CameraFunctionId id = functionIdAtIndex(i);
+        if (table.isSetFunctionRegistered(id) && table.isGetFunctionRegistered(id)) {
+            ids.push_back(id);
+        }
+    }
+    MapRegistry mapLogged(ids, true);
+    MapRegistry mapQuiet(ids, false);
+    long checksum = 0;
+
+    // Warm up caches and the trace ring lease
+    measure(mapQuiet, ids, &checksum);
+    measure(table, ids, &checksum);
+
+    const double mapLoggedNs = measure(mapLogged, ids, &checksum);
+    const double mapQuietNs = measure(mapQuiet, ids, &checksum);
+    const double tableNs = measure(table, ids, &checksum);
+
+    printf("registry dispatch, %zu IDs, %d SET+GET pairs\n", ids.size(), kIterations);
+    printf("  map:          %6.1f ns/call\n", mapLoggedNs);
+    printf("  map, no log:  %6.1f ns/call\n", mapQuietNs);
+    printf("  table:        %6.1f ns/call\n", tableNs);
+    printf("  checksum %ld\n", checksum);
+    return 0;
+}